@@ -46,6 +46,7 @@
 #include "gui/ministatuswindow.h"
 #include "gui/npcdialog.h"
 #include "gui/outfitwindow.h"
+#include "gui/perfoverlay.h"
 #include "gui/setup.h"
 #include "gui/shopwindow.h"
 #include "gui/shortcutwindow.h"
@@ -814,6 +815,12 @@ impHandler0(questsWindowShow)
     return true;
 }
 
+impHandler0(perfOverlayShow)
+{
+    perfOverlay.toggle();
+    return true;
+}
+
 impHandler0(changeMapMode)
 {
     if (viewport)
@@ -120,6 +120,7 @@ namespace ActionManager
     decHandler(whoIsOnlineWindowShow);
     decHandler(didYouKnowWindowShow);
     decHandler(questsWindowShow);
+    decHandler(perfOverlayShow);
 }  // namespace ActionManager
 
 #undef decHandler
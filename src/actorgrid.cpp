@@ -0,0 +1,212 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "actorgrid.h"
+
+#include "actorsprite.h"
+
+#include <algorithm>
+
+#include "debug.h"
+
+// cell size in tiles
+static const int cellSize = 8;
+
+namespace
+{
+    struct ActorDistance final
+    {
+        ActorDistance(ActorSprite *const actor0, const int dist0) :
+            actor(actor0),
+            dist(dist0)
+        {
+        }
+
+        bool operator<(const ActorDistance &other) const
+        { return dist < other.dist; }
+
+        ActorSprite *actor;
+        int dist;
+    };
+}  // namespace
+
+ActorGrid::ActorGrid() :
+    mCells(1),
+    mActorCells(),
+    mWidth(1),
+    mHeight(1)
+{
+}
+
+void ActorGrid::setSize(const int width, const int height)
+{
+    const int cellsWidth = std::max(1, (width + cellSize - 1) / cellSize);
+    const int cellsHeight = std::max(1, (height + cellSize - 1) / cellSize);
+    if (cellsWidth == mWidth && cellsHeight == mHeight)
+        return;
+
+    mWidth = cellsWidth;
+    mHeight = cellsHeight;
+    mCells.clear();
+    mCells.resize(mWidth * mHeight);
+    FOR_EACH (ActorCellsIter, it, mActorCells)
+    {
+        ActorSprite *const actor = const_cast<ActorSprite*>(it->first);
+        it->second = getCell(actor);
+        mCells[it->second].push_back(actor);
+    }
+}
+
+int ActorGrid::getCell(const int x, const int y) const
+{
+    int cellX = x / cellSize;
+    int cellY = y / cellSize;
+    if (cellX < 0 || x < 0)
+        cellX = 0;
+    else if (cellX >= mWidth)
+        cellX = mWidth - 1;
+    if (cellY < 0 || y < 0)
+        cellY = 0;
+    else if (cellY >= mHeight)
+        cellY = mHeight - 1;
+    return cellX + cellY * mWidth;
+}
+
+int ActorGrid::getCell(const ActorSprite *const actor) const
+{
+    return getCell(actor->getTileX(), actor->getTileY());
+}
+
+void ActorGrid::eraseFromCell(std::vector<ActorSprite*> &cell,
+                              const ActorSprite *const actor)
+{
+    const std::vector<ActorSprite*>::iterator it
+        = std::find(cell.begin(), cell.end(), actor);
+    if (it != cell.end())
+    {
+        *it = cell.back();
+        cell.pop_back();
+    }
+}
+
+void ActorGrid::add(ActorSprite *const actor)
+{
+    if (!actor || mActorCells.find(actor) != mActorCells.end())
+        return;
+
+    const int cell = getCell(actor);
+    mActorCells[actor] = cell;
+    mCells[cell].push_back(actor);
+}
+
+void ActorGrid::remove(const ActorSprite *const actor)
+{
+    const ActorCellsIter it = mActorCells.find(actor);
+    if (it == mActorCells.end())
+        return;
+
+    eraseFromCell(mCells[it->second], actor);
+    mActorCells.erase(it);
+}
+
+void ActorGrid::update(ActorSprite *const actor)
+{
+    const ActorCellsIter it = mActorCells.find(actor);
+    if (it == mActorCells.end())
+        return;
+
+    const int cell = getCell(actor);
+    if (cell == it->second)
+        return;
+
+    eraseFromCell(mCells[it->second], actor);
+    it->second = cell;
+    mCells[cell].push_back(actor);
+}
+
+void ActorGrid::clear()
+{
+    mActorCells.clear();
+    FOR_EACH (Cells::iterator, it, mCells)
+        (*it).clear();
+}
+
+void ActorGrid::findInRect(std::vector<ActorSprite*> &actors,
+                           const int x1, const int y1,
+                           const int x2, const int y2) const
+{
+    if (x1 > x2 || y1 > y2)
+        return;
+
+    const int start = getCell(x1, y1);
+    const int end = getCell(x2, y2);
+    const int startX = start % mWidth;
+    const int endX = end % mWidth;
+    for (int cellY = start / mWidth; cellY <= end / mWidth; cellY ++)
+    {
+        for (int cellX = startX; cellX <= endX; cellX ++)
+        {
+            const std::vector<ActorSprite*> &cell
+                = mCells[cellX + cellY * mWidth];
+            FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, cell)
+            {
+                ActorSprite *const actor = *it;
+                const int x = actor->getTileX();
+                const int y = actor->getTileY();
+                if (x >= x1 && x <= x2 && y >= y1 && y <= y2)
+                    actors.push_back(actor);
+            }
+        }
+    }
+}
+
+void ActorGrid::findNearest(std::vector<ActorSprite*> &actors,
+                            const int x, const int y,
+                            const int radius, const int count) const
+{
+    std::vector<ActorSprite*> found;
+    findInRect(found, x - radius, y - radius, x + radius, y + radius);
+
+    const int maxDist = radius * radius;
+    std::vector<ActorDistance> sorted;
+    sorted.reserve(found.size());
+    FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, found)
+    {
+        const int dx = (*it)->getTileX() - x;
+        const int dy = (*it)->getTileY() - y;
+        const int dist = dx * dx + dy * dy;
+        if (dist <= maxDist)
+            sorted.push_back(ActorDistance(*it, dist));
+    }
+
+    if (count > 0 && static_cast<size_t>(count) < sorted.size())
+    {
+        std::partial_sort(sorted.begin(), sorted.begin() + count,
+            sorted.end());
+        sorted.resize(count, ActorDistance(nullptr, 0));
+    }
+    else
+    {
+        std::stable_sort(sorted.begin(), sorted.end());
+    }
+
+    FOR_EACH (std::vector<ActorDistance>::const_iterator, it, sorted)
+        actors.push_back((*it).actor);
+}
@@ -0,0 +1,96 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACTORGRID_H
+#define ACTORGRID_H
+
+#include <map>
+#include <vector>
+
+#include "localconsts.h"
+
+class ActorSprite;
+
+/**
+ * Spatial index of actors. Map is split to square cells of few tiles, and
+ * each cell keeps actors standing on its tiles, so queries look only at
+ * actors near the requested area.
+ */
+class ActorGrid final
+{
+    public:
+        ActorGrid();
+
+        A_DELETE_COPY(ActorGrid)
+
+        /**
+         * Sets map size in tiles. Actors outside of map are kept in border
+         * cells.
+         */
+        void setSize(const int width, const int height);
+
+        void add(ActorSprite *const actor);
+
+        void remove(const ActorSprite *const actor);
+
+        /**
+         * Moves actor to cell of its current tile.
+         */
+        void update(ActorSprite *const actor);
+
+        void clear();
+
+        /**
+         * Adds to actors vector actors which tiles are inside of rectangle,
+         * including its borders.
+         */
+        void findInRect(std::vector<ActorSprite*> &actors,
+                        const int x1, const int y1,
+                        const int x2, const int y2) const;
+
+        /**
+         * Adds to actors vector actors not farther than radius tiles from
+         * the given tile, sorted by distance. If count is positive, only
+         * count nearest actors are added.
+         */
+        void findNearest(std::vector<ActorSprite*> &actors,
+                         const int x, const int y,
+                         const int radius, const int count = 0) const;
+
+    private:
+        int getCell(const int x, const int y) const A_WARN_UNUSED;
+
+        int getCell(const ActorSprite *const actor) const A_WARN_UNUSED;
+
+        static void eraseFromCell(std::vector<ActorSprite*> &cell,
+                                  const ActorSprite *const actor);
+
+        typedef std::vector<std::vector<ActorSprite*> > Cells;
+        typedef std::map<const ActorSprite*, int> ActorCells;
+        typedef ActorCells::iterator ActorCellsIter;
+        typedef ActorCells::const_iterator ActorCellsCIter;
+
+        Cells mCells;
+        ActorCells mActorCells;
+        int mWidth;
+        int mHeight;
+};
+
+#endif  // ACTORGRID_H
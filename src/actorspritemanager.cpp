@@ -51,6 +51,9 @@
 #define for_actors for (ActorSpritesConstIterator it = mActors.begin(), \
     it_end = mActors.end() ; it != it_end; ++it)
 
+// pixel position of walking being can lag behind its tile
+static const int gridMargin = 2;
+
 class FindBeingFunctor final
 {
     public:
@@ -183,6 +186,7 @@ class SortBeingFunctor final
 ActorSpriteManager::ActorSpriteManager() :
     mActors(),
     mDeleteActors(),
+    mGrid(),
     mBlockedBeings(),
     mMap(nullptr),
     mSpellHeal1(serverConfig.getValue("spellHeal1", "#lum")),
@@ -215,6 +219,10 @@ ActorSpriteManager::~ActorSpriteManager()
 void ActorSpriteManager::setMap(Map *const map)
 {
     mMap = map;
+    if (map)
+        mGrid.setSize(map->getWidth(), map->getHeight());
+    else
+        mGrid.setSize(0, 0);
 
     if (player_node)
         player_node->setMap(map);
@@ -224,6 +232,7 @@ void ActorSpriteManager::setPlayer(LocalPlayer *const player)
 {
     player_node = player;
     mActors.insert(player);
+    mGrid.add(player);
     if (socialWindow)
         socialWindow->updateAttackFilter();
     if (socialWindow)
@@ -237,6 +246,7 @@ Being *ActorSpriteManager::createBeing(const int id,
     Being *const being = new Being(id, type, subtype, mMap);
 
     mActors.insert(being);
+    mGrid.add(being);
     return being;
 }
 
@@ -252,6 +262,7 @@ FloorItem *ActorSpriteManager::createItem(const int id, const int itemId,
     if (!checkForPickup(floorItem))
         floorItem->disableHightlight();
     mActors.insert(floorItem);
+    mGrid.add(floorItem);
     return floorItem;
 }
 
@@ -269,6 +280,7 @@ void ActorSpriteManager::erase(ActorSprite *const actor)
         return;
 
     mActors.erase(actor);
+    mGrid.remove(actor);
 }
 
 void ActorSpriteManager::undelete(const ActorSprite *const actor)
@@ -308,10 +320,14 @@ Being *ActorSpriteManager::findBeing(const int x, const int y,
     beingActorFinder.y = static_cast<uint16_t>(y);
     beingActorFinder.type = type;
 
-    const ActorSpritesConstIterator it = std::find_if(
-        mActors.begin(), mActors.end(), beingActorFinder);
+    // npcs are found also from tile below them
+    std::vector<ActorSprite*> actors;
+    mGrid.findInRect(actors, x - gridMargin, y - gridMargin,
+        x + gridMargin, y + 1 + gridMargin);
+    const std::vector<ActorSprite*>::const_iterator it = std::find_if(
+        actors.begin(), actors.end(), beingActorFinder);
 
-    return (it == mActors.end()) ? nullptr : static_cast<Being*>(*it);
+    return (it == actors.end()) ? nullptr : static_cast<Being*>(*it);
 }
 
 Being *ActorSpriteManager::findBeingByPixel(const int x, const int y,
@@ -321,13 +337,15 @@ Being *ActorSpriteManager::findBeingByPixel(const int x, const int y,
         return nullptr;
 
     const bool targetDead = mTargetDeadPlayers;
+    std::vector<ActorSprite*> actors;
+    findActorsNearPixel(actors, x, y);
 
     if (mExtMouseTargeting)
     {
         Being *tempBeing = nullptr;
         bool noBeing(false);
 
-        for_actors
+        FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
         {
             if (!*it)
                 continue;
@@ -387,7 +405,7 @@ Being *ActorSpriteManager::findBeingByPixel(const int x, const int y,
     }
     else
     {
-        for_actors
+        FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
         {
             if (!*it)
                 continue;
@@ -425,7 +443,9 @@ void ActorSpriteManager::findBeingsByPixel(std::vector<ActorSprite*> &beings,
     const int xtol = 16;
     const int uptol = 32;
 
-    for_actors
+    std::vector<ActorSprite*> actors;
+    findActorsNearPixel(actors, x, y);
+    FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
     {
         if (!*it)
             continue;
@@ -459,12 +479,26 @@ void ActorSpriteManager::findBeingsByPixel(std::vector<ActorSprite*> &beings,
     }
 }
 
+void ActorSpriteManager::findActorsNearPixel(std::vector<ActorSprite*>
+                                             &actors,
+                                             const int x, const int y) const
+{
+    // sprites are searched up to one tile left, right and above of point
+    // and two tiles below it
+    const int tileX = x / 32;
+    const int tileY = y / 32;
+    mGrid.findInRect(actors, tileX - 1 - gridMargin, tileY - 1 - gridMargin,
+        tileX + 1 + gridMargin, tileY + 2 + gridMargin);
+}
+
 Being *ActorSpriteManager::findPortalByTile(const int x, const int y) const
 {
     if (!mMap)
         return nullptr;
 
-    for_actors
+    std::vector<ActorSprite*> actors;
+    mGrid.findInRect(actors, x, y, x, y);
+    FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
     {
         if (!*it)
             continue;
@@ -500,7 +534,9 @@ FloorItem *ActorSpriteManager::findItem(const int id) const
 
 FloorItem *ActorSpriteManager::findItem(const int x, const int y) const
 {
-    for_actors
+    std::vector<ActorSprite*> actors;
+    mGrid.findInRect(actors, x, y, x, y);
+    FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
     {
         if (!*it)
             continue;
@@ -524,9 +560,11 @@ bool ActorSpriteManager::pickUpAll(const int x1, const int y1,
 
     bool finded(false);
     const bool allowAll = mPickupItemsSet.find("") != mPickupItemsSet.end();
+    std::vector<ActorSprite*> actors;
+    mGrid.findInRect(actors, x1, y1, x2, y2);
     if (!serverBuggy)
     {
-        for_actors
+        FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
         {
             if (!*it)
                 continue;
@@ -561,7 +599,7 @@ bool ActorSpriteManager::pickUpAll(const int x1, const int y1,
     {
         FloorItem *item = nullptr;
         unsigned cnt = 65535;
-        for_actors
+        FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
         {
             if (!*it)
                 continue;
@@ -613,55 +651,42 @@ bool ActorSpriteManager::pickUpAll(const int x1, const int y1,
 }
 
 bool ActorSpriteManager::pickUpNearest(const int x, const int y,
-                                       int maxdist) const
+                                       const int maxdist) const
 {
     if (!player_node)
         return false;
 
-    maxdist = maxdist * maxdist;
-    FloorItem *closestItem = nullptr;
-    int dist = 0;
     const bool allowAll = mPickupItemsSet.find("") != mPickupItemsSet.end();
+    std::vector<ActorSprite*> actors;
+    mGrid.findNearest(actors, x, y, maxdist);
 
-    for_actors
+    FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
     {
-        if (!*it)
+        if (!*it || (*it)->getType() != ActorSprite::FLOOR_ITEM)
             continue;
 
-        if ((*it)->getType() == ActorSprite::FLOOR_ITEM)
+        FloorItem *const item = static_cast<FloorItem*>(*it);
+        if (mTargetOnlyReachable && !player_node->isReachable(
+            item->getTileX(), item->getTileY(), false))
         {
-            FloorItem *const item = static_cast<FloorItem*>(*it);
-
-            const int d = (item->getTileX() - x) * (item->getTileX() - x)
-                + (item->getTileY() - y) * (item->getTileY() - y);
+            continue;
+        }
 
-            if ((d < dist || !closestItem) && (!mTargetOnlyReachable
-                || player_node->isReachable(item->getTileX(),
-                item->getTileY(), false)))
+        if (allowAll)
+        {
+            if (mIgnorePickupItemsSet.find(item->getName())
+                != mIgnorePickupItemsSet.end())
             {
-                if (allowAll)
-                {
-                    if (mIgnorePickupItemsSet.find(item->getName())
-                        == mIgnorePickupItemsSet.end())
-                    {
-                        dist = d;
-                        closestItem = item;
-                    }
-                }
-                else
-                {
-                    if (mPickupItemsSet.find(item->getName())
-                        != mPickupItemsSet.end())
-                    {
-                        dist = d;
-                        closestItem = item;
-                    }
-                }
+                continue;
             }
         }
+        else if (mPickupItemsSet.find(item->getName())
+                 == mPickupItemsSet.end())
+        {
+            continue;
+        }
+        return player_node->pickUp(item);
     }
-    if (closestItem && dist <= maxdist)
-        return player_node->pickUp(closestItem);
 
     return false;
 }
@@ -696,48 +721,45 @@ Being *ActorSpriteManager::findNearestByName(const std::string &name,
     if (!player_node)
         return nullptr;
 
-    int dist = 0;
-    Being* closestBeing = nullptr;
-    int x, y;
+    const int x = player_node->getTileX();
+    const int y = player_node->getTileY();
+    int maxDist = 0;
+    if (mMap)
+        maxDist = std::max(mMap->getWidth(), mMap->getHeight());
 
-    x = player_node->getTileX();
-    y = player_node->getTileY();
-
-    for_actors
+    // search area grows until being found, so usually only near actors
+    // are checked
+    std::vector<ActorSprite*> actors;
+    for (int radius = 8; ; radius *= 2)
     {
-        if (reportTrue(!*it))
-            continue;
-
-        if ((*it)->getType() == ActorSprite::FLOOR_ITEM
-            || (*it)->getType() == ActorSprite::PORTAL)
+        actors.clear();
+        mGrid.findNearest(actors, x, y, radius);
+        FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
         {
-            continue;
-        }
-
-        Being *const being = static_cast<Being*>(*it);
+            if (reportTrue(!*it))
+                continue;
 
-        if (being && being->getName() == name &&
-            (type == Being::UNKNOWN || type == being->getType()))
-        {
-            if (being->getType() == Being::PLAYER)
+            if ((*it)->getType() == ActorSprite::FLOOR_ITEM
+                || (*it)->getType() == ActorSprite::PORTAL)
             {
-                return being;
+                continue;
             }
-            else
-            {
-                const int d = (being->getTileX() - x) * (being->getTileX() - x)
-                    + (being->getTileY() - y) * (being->getTileY() - y);
 
-                if (validateBeing(nullptr, being, type, nullptr, 50)
-                    && (d < dist || closestBeing == nullptr))
-                {
-                    dist = d;
-                    closestBeing = being;
-                }
+            Being *const being = static_cast<Being*>(*it);
+
+            if (being->getName() == name &&
+                (type == Being::UNKNOWN || type == being->getType())
+                && (being->getType() == Being::PLAYER
+                || validateBeing(nullptr, being, type, nullptr, 50)))
+            {
+                return being;
             }
         }
+        // actors outside of map are kept near its borders
+        if (radius > 2 * maxDist)
+            break;
     }
-    return closestBeing;
+    return nullptr;
 }
 
 const ActorSprites &ActorSpriteManager::getAll() const
@@ -787,6 +809,7 @@ void ActorSpriteManager::logic()
     FOR_EACH (ActorSpritesConstIterator, it, mDeleteActors)
     {
         mActors.erase(*it);
+        mGrid.remove(*it);
         delete *it;
     }
 
@@ -813,9 +836,13 @@ void ActorSpriteManager::clear()
     }
     mActors.clear();
     mDeleteActors.clear();
+    mGrid.clear();
 
     if (player_node)
+    {
         mActors.insert(player_node);
+        mGrid.add(player_node);
+    }
 }
 
 Being *ActorSpriteManager::findNearestLivingBeing(const int x, const int y,
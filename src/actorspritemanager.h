@@ -23,6 +23,7 @@
 #ifndef ACTORSPRITEMANAGER_H
 #define ACTORSPRITEMANAGER_H
 
+#include "actorgrid.h"
 #include "being.h"
 #include "flooritem.h"
 
@@ -108,6 +109,20 @@ class ActorSpriteManager final: public ConfigListener
          */
         Being *findPortalByTile(const int x, const int y) const A_WARN_UNUSED;
 
+        /**
+         * Adds to actors vector actors which tiles are inside of rectangle.
+         */
+        void findActorsInRect(std::vector<ActorSprite*> &actors,
+                              const int x1, const int y1,
+                              const int x2, const int y2) const
+        { mGrid.findInRect(actors, x1, y1, x2, y2); }
+
+        /**
+         * Must be called when tile of actor changed.
+         */
+        void updateActorTile(ActorSprite *const actor)
+        { mGrid.update(actor); }
+
         /**
          * Returns a specific FloorItem, by id.
          */
@@ -232,7 +247,8 @@ class ActorSpriteManager final: public ConfigListener
         bool pickUpAll(const int x1, const int y1, const int x2, const int y2,
                        const bool serverBuggy = false);
 
-        bool pickUpNearest(const int x, const int y, int maxdist) const;
+        bool pickUpNearest(const int x, const int y,
+                           const int maxdist) const;
 
         void optionChanged(const std::string &name) override;
 
@@ -316,11 +332,15 @@ class ActorSpriteManager final: public ConfigListener
                                       const Being *const
                                       excluded = nullptr) const A_WARN_UNUSED;
 
+        void findActorsNearPixel(std::vector<ActorSprite*> &actors,
+                                 const int x, const int y) const;
+
         void loadAttackList();
         void storeAttackList() const;
 
         ActorSprites mActors;
         ActorSprites mDeleteActors;
+        ActorGrid mGrid;
         std::set<uint32_t> mBlockedBeings;
         Map *mMap;
         std::string mSpellHeal1;
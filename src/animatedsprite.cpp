@@ -366,15 +366,14 @@ void AnimatedSprite::setAlpha(float alpha)
     }
 }
 
-void *AnimatedSprite::getHash()
+bool AnimatedSprite::getHash(SpriteHash &hash) const
 {
-    if (mFrame)
-        return mFrame;
-//    if (mFrame && mFrame->image)
-//        return mFrame->image;
-//    if (mAnimation)
-//        return mAnimation;
-    return this;
+    // frames are owned by sprite definition, and its id is never reused
+    if (mFrame && mFrame->image && mSprite)
+        hash = SpriteHash(mSprite->getId(), mFrame);
+    else
+        hash = SpriteHash(0, nullptr);
+    return true;
 }
 
 bool AnimatedSprite::updateNumber(const unsigned num)
@@ -92,7 +92,7 @@ class AnimatedSprite final : public Sprite
 
         virtual void setAlpha(float alpha) override;
 
-        virtual void *getHash() override A_WARN_UNUSED;
+        virtual bool getHash(SpriteHash &hash) const override A_WARN_UNUSED;
 
         bool updateNumber(const unsigned num);
 
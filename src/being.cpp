@@ -24,6 +24,7 @@
 
 #include "actorspritemanager.h"
 #include "animatedsprite.h"
+#include "beingcache.h"
 #include "beingcacheentry.h"
 #include "beingequipbackend.h"
 #include "client.h"
@@ -31,6 +32,7 @@
 #include "guild.h"
 #include "particle.h"
 #include "party.h"
+#include "pathsolver.h"
 #include "playerrelations.h"
 #include "soundmanager.h"
 #include "text.h"
@@ -64,7 +66,8 @@
 
 #include "debug.h"
 
-const unsigned int CACHE_SIZE = 50;
+// seconds while cached being info is used instead of asking server
+static const int cacheTime = 120;
 
 int Being::mNumberOfHairstyles = 1;
 int Being::mNumberOfRaces = 1;
@@ -87,7 +90,6 @@ bool Being::mHideErased = false;
 bool Being::mMoveNames = false;
 int Being::mAwayEffect = -1;
 
-std::list<BeingCacheEntry*> beingInfoCache;
 typedef std::map<int, Guild*>::const_iterator GuildsMapCIter;
 typedef std::map<int, int>::const_iterator IntMapCIter;
 
@@ -117,6 +119,7 @@ Being::Being(const int id, const Type type, const uint16_t subtype,
     mShowName(false),
     mEquippedWeapon(nullptr),
     mPath(),
+    mPathGeneration(0),
     mSpeech(),
     mText(nullptr),
     mTextColor(nullptr),
@@ -241,6 +244,7 @@ void Being::setSubtype(const uint16_t subtype)
             setName(mInfo->getName());
             setupSpriteDisplay(mInfo->getDisplay());
             mYDiff = mInfo->getSortOffsetY();
+            mInfo->preloadSounds();
         }
     }
     else if (mType == NPC)
@@ -250,6 +254,7 @@ void Being::setSubtype(const uint16_t subtype)
         {
             setupSpriteDisplay(mInfo->getDisplay(), false);
             mYDiff = mInfo->getSortOffsetY();
+            mInfo->preloadSounds();
         }
     }
     else if (mType == AVATAR)
@@ -310,6 +315,14 @@ void Being::setPosition(const Vector &pos)
     }
 }
 
+void Being::setTileCoords(const int x, const int y)
+{
+    mX = x;
+    mY = y;
+    if (actorSpriteManager)
+        actorSpriteManager->updateActorTile(this);
+}
+
 void Being::setDestination(const int dstX, const int dstY)
 {
     // We can't calculate anything without a map anyway.
@@ -320,6 +333,15 @@ void Being::setDestination(const int dstX, const int dstY)
     if (Net::getNetworkType() != ServerInfo::MANASERV)
 #endif
     {
+        mPathGeneration ++;
+        // paths of other beings are found in background
+        if (pathSolver && this != player_node
+            && pathSolver->addRequest(this, dstX, dstY))
+        {
+            setPath(PathSolver::getFallbackPath(mMap, mX, mY,
+                dstX, dstY, getWalkMask()));
+            return;
+        }
         setPath(mMap->findPath(mX, mY, dstX, dstY, getWalkMask()));
         return;
     }
@@ -364,6 +386,7 @@ void Being::setDestination(const int dstX, const int dstY)
 
 void Being::clearPath()
 {
+    mPathGeneration ++;
     mPath.clear();
 }
 
@@ -1229,6 +1252,8 @@ void Being::nextTile()
 
     mX = pos.x;
     mY = pos.y;
+    if (actorSpriteManager)
+        actorSpriteManager->updateActorTile(this);
     setAction(MOVE);
     mActionTime += static_cast<int>(mWalkSpeed.x / 10);
 }
@@ -1429,7 +1454,7 @@ void Being::logic()
         const int time2 = tick_time;
         if (time2 > mNextSound.time)
         {
-            soundManager.playSfx(sound->sound, mNextSound.x, mNextSound.y);
+            soundManager.playSfx(*sound, mNextSound.x, mNextSound.y);
 
             mNextSound.sound = nullptr;
             mNextSound.time = time2 + sound->delay;
@@ -1911,7 +1936,7 @@ bool Being::updateFromCache()
 {
     const BeingCacheEntry *const entry = Being::getCacheEntry(getId());
 
-    if (entry && entry->getTime() + 120 >= cur_time)
+    if (entry && entry->getTime() + cacheTime >= cur_time)
     {
         if (!entry->getName().empty())
             setName(entry->getName());
@@ -1953,16 +1978,7 @@ void Being::addToCache() const
 
     BeingCacheEntry *entry = Being::getCacheEntry(getId());
     if (!entry)
-    {
-        entry = new BeingCacheEntry(getId());
-        beingInfoCache.push_front(entry);
-
-        if (beingInfoCache.size() >= CACHE_SIZE)
-        {
-            delete beingInfoCache.back();
-            beingInfoCache.pop_back();
-        }
-    }
+        entry = beingInfoCache.add(getId());
     if (!mLowTraffic)
         return;
 
@@ -1993,25 +2009,31 @@ void Being::addToCache() const
 
 BeingCacheEntry* Being::getCacheEntry(const int id)
 {
-    FOR_EACH (std::list<BeingCacheEntry*>::iterator, i, beingInfoCache)
-    {
-        if (!*i)
-            continue;
+    return beingInfoCache.find(id);
+}
 
-        if (id == (*i)->getId())
-        {
-            // Raise priority: move it to front
-            if ((*i)->getTime() + 120 < cur_time)
-            {
-                beingInfoCache.splice(beingInfoCache.begin(),
-                                      beingInfoCache, i);
-            }
-            return *i;
-        }
+static std::string getCacheFileName()
+{
+    return Client::getServerConfigDirectory() + "/beingcache.bin";
+}
+
+void Being::loadCache()
+{
+    if (config.getBoolValue("lowTraffic")
+        && config.getBoolValue("saveBeingCache"))
+    {
+        beingInfoCache.load(getCacheFileName(), cacheTime);
     }
-    return nullptr;
 }
 
+void Being::saveCache()
+{
+    if (config.getBoolValue("lowTraffic")
+        && config.getBoolValue("saveBeingCache"))
+    {
+        beingInfoCache.save(getCacheFileName());
+    }
+}
 
 void Being::setGender(const Gender gender)
 {
@@ -2588,7 +2610,6 @@ void Being::undressItemById(const int id)
 
 void Being::clearCache()
 {
-    delete_all(beingInfoCache);
     beingInfoCache.clear();
 }
 
@@ -2871,14 +2892,14 @@ void Being::playSfx(const SoundInfo &sound, Being *const being,
             being->mNextSound.sound = nullptr;
             being->mNextSound.time = time + sound.delay;
             being->mNextSound.sound = nullptr;
-            soundManager.playSfx(sound.sound, x, y);
+            soundManager.playSfx(sound, x, y);
         }
         else if (mNextSound.time <= time)
         {   // old event sound time is gone. we can play new sound
             being->mNextSound.sound = nullptr;
             being->mNextSound.time = time + sound.delay;
             being->mNextSound.sound = nullptr;
-            soundManager.playSfx(sound.sound, x, y);
+            soundManager.playSfx(sound, x, y);
         }
         else
         {   // old event sound in progress. need save sound and wait
@@ -2889,6 +2910,6 @@ void Being::playSfx(const SoundInfo &sound, Being *const being,
     }
     else
     {
-        soundManager.playSfx(sound.sound, x, y);
+        soundManager.playSfx(sound, x, y);
     }
 }
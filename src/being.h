@@ -93,6 +93,7 @@ class Being : public ActorSprite, public ConfigListener
     public:
         friend class BeingEquipBackend;
         friend class LocalPlayer;
+        friend class PathSolver;
 
         enum FLAGS
         {
@@ -239,8 +240,7 @@ class Being : public ActorSprite, public ConfigListener
         /**
          * Sets the tile x and y coord
          */
-        void setTileCoords(const int x, const int y)
-        { mX = x; mY = y; }
+        void setTileCoords(const int x, const int y);
 
         /**
          * Puts a "speech balloon" above this being for the specified amount
@@ -582,6 +582,13 @@ class Being : public ActorSprite, public ConfigListener
         const Path &getPath() const A_WARN_UNUSED
         { return mPath; }
 
+        /**
+         * Returns counter of destination changes, used to drop outdated
+         * paths from path solver.
+         */
+        int getPathGeneration() const A_WARN_UNUSED
+        { return mPathGeneration; }
+
         int getDistance() const A_WARN_UNUSED
         { return mDistance; }
 
@@ -787,6 +794,13 @@ class Being : public ActorSprite, public ConfigListener
 
         static void clearCache();
 
+        /**
+         * Loads being info saved for current server in previous session.
+         */
+        static void loadCache();
+
+        static void saveCache();
+
         static std::string loadComment(const std::string &name,
                                        const int type) A_WARN_UNUSED;
 
@@ -939,6 +953,7 @@ class Being : public ActorSprite, public ConfigListener
         static int mNumberOfRaces; /** Number of races in use */
 
         Path mPath;
+        int mPathGeneration;
         std::string mSpeech;
         Text *mText;
         const gcn::Color *mTextColor;
@@ -1045,6 +1060,4 @@ class Being : public ActorSprite, public ConfigListener
         Particle *mSpecialParticle;
 };
 
-extern std::list<BeingCacheEntry*> beingInfoCache;
-
 #endif
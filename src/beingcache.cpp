@@ -0,0 +1,209 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "beingcache.h"
+
+#include "beingcacheentry.h"
+#include "client.h"
+#include "logger.h"
+
+#include "utils/dtor.h"
+
+#include <cstdio>
+
+#include "debug.h"
+
+BeingCache beingInfoCache(50);
+
+// 'MPBC', also tells if file was written with other byte order
+static const int beingCacheMagic = 0x4342504d;
+static const int beingCacheVersion = 1;
+// strings longer than this are treated as broken file
+static const int maxStringSize = 1024;
+
+namespace
+{
+    bool writeInt(FILE *const file, const int value)
+    {
+        return fwrite(&value, sizeof(int), 1, file) == 1;
+    }
+
+    bool writeString(FILE *const file, const std::string &str)
+    {
+        const int len = static_cast<int>(str.size());
+        return writeInt(file, len) && (!len
+            || fwrite(str.c_str(), 1, len, file) == static_cast<size_t>(len));
+    }
+
+    bool readInt(FILE *const file, int &value)
+    {
+        return fread(&value, sizeof(int), 1, file) == 1;
+    }
+
+    bool readString(FILE *const file, std::string &str)
+    {
+        int len = 0;
+        if (!readInt(file, len) || len < 0 || len > maxStringSize)
+            return false;
+        str.resize(len);
+        return !len
+            || fread(&str[0], 1, len, file) == static_cast<size_t>(len);
+    }
+}  // namespace
+
+BeingCache::BeingCache(const unsigned int size) :
+    mEntries(),
+    mIndex(),
+    mSize(size)
+{
+}
+
+BeingCache::~BeingCache()
+{
+    clear();
+}
+
+BeingCacheEntry *BeingCache::find(const int id)
+{
+    const EntriesIndexIter it = mIndex.find(id);
+    if (it == mIndex.end())
+        return nullptr;
+
+    // Raise priority: move it to front
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return *it->second;
+}
+
+BeingCacheEntry *BeingCache::add(const int id)
+{
+    if (mIndex.size() >= mSize && !mEntries.empty())
+    {
+        BeingCacheEntry *const oldest = mEntries.back();
+        mIndex.erase(oldest->getId());
+        delete oldest;
+        mEntries.pop_back();
+    }
+
+    BeingCacheEntry *const entry = new BeingCacheEntry(id);
+    mEntries.push_front(entry);
+    mIndex[id] = mEntries.begin();
+    return entry;
+}
+
+void BeingCache::clear()
+{
+    delete_all(mEntries);
+    mEntries.clear();
+    mIndex.clear();
+}
+
+void BeingCache::load(const std::string &fileName, const int maxAge)
+{
+    FILE *const file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return;
+
+    int magic = 0;
+    int version = 0;
+    int count = 0;
+    if (!readInt(file, magic) || magic != beingCacheMagic
+        || !readInt(file, version) || version != beingCacheVersion
+        || !readInt(file, count))
+    {
+        logger->log("Ignoring broken being cache: %s", fileName.c_str());
+        fclose(file);
+        return;
+    }
+
+    // entries are saved from oldest to newest
+    for (int f = 0; f < count; f ++)
+    {
+        int id = 0;
+        int time = 0;
+        int level = 0;
+        int pvpRank = 0;
+        int flags = 0;
+        int advanced = 0;
+        std::string name;
+        std::string partyName;
+        std::string guildName;
+        if (!readInt(file, id) || !readInt(file, time)
+            || !readInt(file, level) || !readInt(file, pvpRank)
+            || !readInt(file, flags) || !readInt(file, advanced)
+            || !readString(file, name) || !readString(file, partyName)
+            || !readString(file, guildName))
+        {
+            logger->log("Ignoring broken being cache: %s", fileName.c_str());
+            break;
+        }
+
+        if (time + maxAge < cur_time)
+            continue;
+
+        BeingCacheEntry *entry = find(id);
+        if (!entry)
+            entry = add(id);
+        entry->setTime(time);
+        entry->setLevel(level);
+        entry->setPvpRank(pvpRank);
+        entry->setFlags(flags);
+        entry->setAdvanced(advanced != 0);
+        entry->setName(name);
+        entry->setPartyName(partyName);
+        entry->setGuildName(guildName);
+    }
+    fclose(file);
+}
+
+void BeingCache::save(const std::string &fileName) const
+{
+    FILE *const file = fopen(fileName.c_str(), "wb");
+    if (!file)
+    {
+        logger->log("Error: cant save being cache: %s", fileName.c_str());
+        return;
+    }
+
+    bool ok = writeInt(file, beingCacheMagic)
+        && writeInt(file, beingCacheVersion)
+        && writeInt(file, static_cast<int>(mEntries.size()));
+
+    for (Entries::const_reverse_iterator it = mEntries.rbegin(),
+         it_end = mEntries.rend(); it != it_end && ok; ++ it)
+    {
+        // ip is not saved, it is known only while being is visible
+        const BeingCacheEntry *const entry = *it;
+        ok = writeInt(file, entry->getId())
+            && writeInt(file, entry->getTime())
+            && writeInt(file, entry->getLevel())
+            && writeInt(file, static_cast<int>(entry->getPvpRank()))
+            && writeInt(file, entry->getFlags())
+            && writeInt(file, entry->isAdvanced() ? 1 : 0)
+            && writeString(file, entry->getName())
+            && writeString(file, entry->getPartyName())
+            && writeString(file, entry->getGuildName());
+    }
+
+    if (fclose(file) || !ok)
+    {
+        logger->log("Error: cant save being cache: %s", fileName.c_str());
+        remove(fileName.c_str());
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BEINGCACHE_H
+#define BEINGCACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "localconsts.h"
+
+class BeingCacheEntry;
+
+/**
+ * Most recently used being info, indexed by being id. Oldest entries are
+ * dropped when cache is full.
+ */
+class BeingCache final
+{
+    public:
+        explicit BeingCache(const unsigned int size);
+
+        A_DELETE_COPY(BeingCache)
+
+        ~BeingCache();
+
+        /**
+         * Returns entry for being and marks it as recently used.
+         */
+        BeingCacheEntry *find(const int id) A_WARN_UNUSED;
+
+        /**
+         * Creates new entry for being. Caller must check that entry for
+         * this being does not exist.
+         */
+        BeingCacheEntry *add(const int id);
+
+        void clear();
+
+        /**
+         * Loads entries saved by save. Entries older than maxAge seconds
+         * are skipped.
+         */
+        void load(const std::string &fileName, const int maxAge);
+
+        void save(const std::string &fileName) const;
+
+        unsigned int size() const A_WARN_UNUSED
+        { return static_cast<unsigned int>(mIndex.size()); }
+
+    private:
+        typedef std::list<BeingCacheEntry*> Entries;
+        typedef Entries::iterator EntriesIter;
+        typedef Entries::const_iterator EntriesCIter;
+        typedef std::map<int, EntriesIter> EntriesIndex;
+        typedef EntriesIndex::iterator EntriesIndexIter;
+
+        Entries mEntries;
+        EntriesIndex mIndex;
+        unsigned int mSize;
+};
+
+extern BeingCache beingInfoCache;
+
+#endif  // BEINGCACHE_H
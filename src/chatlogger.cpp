@@ -22,6 +22,7 @@
 
 #include "chatlogger.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <dirent.h>
@@ -36,50 +37,205 @@
 #include <Carbon/Carbon.h>
 #endif
 
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
 #include "logger.h"
 #include "configuration.h"
 #include "utils/mkdir.h"
 #include "utils/physfstools.h"
+#include "utils/stringutils.h"
 
 #include "debug.h"
 
+static const unsigned int chatLogBatchSize = 32;
+static const unsigned int chatLogFlushTime = 1000;
+static const unsigned int chatLogMaxFiles = 8;
+static const unsigned int chatLogTailSize = 30;
+
 ChatLogger::ChatLogger() :
-    mLogFile(),
+    mQueue(),
+    mFiles(),
+    mFilesOrder(),
+    mTails(),
+    mTailsDir(),
     mLogDir(),
     mBaseLogDir(),
     mServerName(),
-    mLogFileName()
+    mMutex(SDL_CreateMutex()),
+    mCond(SDL_CreateCond()),
+    mThread(nullptr),
+    mRunning(true),
+    mWriting(false),
+    mReset(false)
 {
+    if (mMutex && mCond)
+        mThread = SDL_CreateThread(writerThread, this);
+    if (!mThread)
+        std::cout << "Warning: chat logs will be written synchronously.\n";
 }
 
 ChatLogger::~ChatLogger()
 {
-    if (mLogFile.is_open())
-        mLogFile.close();
+    if (mThread)
+    {
+        SDL_mutexP(mMutex);
+        mRunning = false;
+        SDL_CondSignal(mCond);
+        SDL_mutexV(mMutex);
+        SDL_WaitThread(mThread, nullptr);
+        mThread = nullptr;
+    }
+    closeFiles();
+    if (mCond)
+        SDL_DestroyCond(mCond);
+    if (mMutex)
+        SDL_DestroyMutex(mMutex);
+}
+
+int ChatLogger::writerThread(void *ptr)
+{
+    ChatLogger *const chat = static_cast<ChatLogger*>(ptr);
+    if (!chat)
+        return 0;
+
+    ChatLogEntries entries;
+    SDL_mutexP(chat->mMutex);
+    while (chat->mRunning || !chat->mQueue.empty())
+    {
+        if (chat->mQueue.empty())
+        {
+            SDL_CondWaitTimeout(chat->mCond, chat->mMutex,
+                chatLogFlushTime);
+            continue;
+        }
+
+        entries.swap(chat->mQueue);
+        chat->mWriting = true;
+        SDL_mutexV(chat->mMutex);
+
+        chat->writeEntries(entries);
+        entries.clear();
+
+        SDL_mutexP(chat->mMutex);
+        chat->mWriting = false;
+    }
+    SDL_mutexV(chat->mMutex);
+    return 0;
 }
 
-void ChatLogger::setLogFile(const std::string &logFilename)
+void ChatLogger::writeEntries(const ChatLogEntries &entries)
 {
-    if (mLogFile.is_open())
-        mLogFile.close();
+    SDL_mutexP(mMutex);
+    const bool reset = mReset;
+    mReset = false;
+    const std::string dateStr = getDir();
+    SDL_mutexV(mMutex);
 
-    mLogFile.open(logFilename.c_str(), std::ios_base::app);
-    mLogFileName = logFilename;
+    if (reset)
+    {
+        closeFiles();
+        mLogDir.clear();
+    }
+    if (dateStr != mLogDir)
+    {
+        closeFiles();
+        setLogDir(dateStr);
+    }
 
-    if (!mLogFile.is_open())
+    std::vector<std::string> lines;
+    lines.reserve(entries.size());
+    FOR_EACH (ChatLogEntries::const_iterator, it, entries)
     {
-        std::cout << "Warning: error while opening " << logFilename <<
+        std::string name = (*it).name;
+        secureName(name);
+        const std::string str = removeColors((*it).text);
+        std::ofstream *const file = getFile(name);
+        if (file)
+            writeTo(*file, str);
+        lines.push_back(name);
+        lines.push_back(str);
+    }
+
+    FOR_EACH (ChatLogFilesIter, it, mFiles)
+        (*it).second->flush();
+
+    SDL_mutexP(mMutex);
+    if (mTailsDir != dateStr)
+    {
+        mTails.clear();
+        mTailsDir = dateStr;
+    }
+    const size_t sz = lines.size();
+    for (size_t f = 0; f + 1 < sz; f += 2)
+    {
+        const ChatLogTailsIter it = mTails.find(lines[f]);
+        if (it != mTails.end())
+            addToTail((*it).second, lines[f + 1]);
+    }
+    SDL_mutexV(mMutex);
+}
+
+std::ofstream *ChatLogger::getFile(const std::string &name)
+{
+    const ChatLogFilesIter it = mFiles.find(name);
+    if (it != mFiles.end())
+    {
+        if (mFilesOrder.front() != name)
+        {
+            mFilesOrder.remove(name);
+            mFilesOrder.push_front(name);
+        }
+        return (*it).second;
+    }
+
+    if (mFiles.size() >= chatLogMaxFiles)
+    {
+        const ChatLogFilesIter old = mFiles.find(mFilesOrder.back());
+        if (old != mFiles.end())
+        {
+            delete (*old).second;
+            mFiles.erase(old);
+        }
+        mFilesOrder.pop_back();
+    }
+
+    const std::string logFileName = strprintf("%s/%s.log",
+        mLogDir.c_str(), name.c_str());
+    std::ofstream *const file = new std::ofstream(logFileName.c_str(),
+        std::ios_base::app);
+    if (!file->is_open())
+    {
+        std::cout << "Warning: error while opening " << logFileName <<
             " for writing.\n";
+        delete file;
+        return nullptr;
     }
+    mFiles[name] = file;
+    mFilesOrder.push_front(name);
+    return file;
+}
+
+void ChatLogger::closeFiles()
+{
+    FOR_EACH (ChatLogFilesIter, it, mFiles)
+        delete (*it).second;
+    mFiles.clear();
+    mFilesOrder.clear();
+}
+
+void ChatLogger::addToTail(std::list<std::string> &tail,
+                           const std::string &str) const
+{
+    tail.push_back(str);
+    if (tail.size() > chatLogTailSize)
+        tail.pop_front();
 }
 
 void ChatLogger::setLogDir(const std::string &logDir)
 {
     mLogDir = logDir;
 
-    if (mLogFile.is_open())
-        mLogFile.close();
-
     DIR *const dir = opendir(mLogDir.c_str());
     if (!dir)
         mkdir_r(mLogDir.c_str());
@@ -89,33 +245,43 @@ void ChatLogger::setLogDir(const std::string &logDir)
 
 void ChatLogger::log(std::string str)
 {
-    const std::string &dateStr = getDir();
-    const std::string logFileName = strprintf(
-        "%s/#General.log", dateStr.c_str());
-    if (!mLogFile.is_open() || logFileName != mLogFileName)
+    log("#General", str);
+}
+
+void ChatLogger::log(std::string name, std::string str)
+{
+    if (!mThread)
     {
-        setLogDir(dateStr);
-        setLogFile(logFileName);
+        ChatLogEntries entries;
+        entries.push_back(ChatLogEntry(name, str));
+        writeEntries(entries);
+        return;
     }
 
-    str = removeColors(str);
-    writeTo(mLogFile, str);
+    SDL_mutexP(mMutex);
+    mQueue.push_back(ChatLogEntry(name, str));
+    if (mQueue.size() >= chatLogBatchSize)
+        SDL_CondSignal(mCond);
+    SDL_mutexV(mMutex);
 }
 
-void ChatLogger::log(std::string name, std::string str)
+void ChatLogger::flush()
 {
-    const std::string &dateStr = getDir();
-    const std::string logFileName = strprintf("%s/%s.log",
-        dateStr.c_str(), secureName(name).c_str());
+    if (!mThread)
+        return;
 
-    if (!mLogFile.is_open() || logFileName != mLogFileName)
+    for (;;)
     {
-        setLogDir(dateStr);
-        setLogFile(logFileName);
+        SDL_mutexP(mMutex);
+        if (mQueue.empty() && !mWriting)
+        {
+            SDL_mutexV(mMutex);
+            return;
+        }
+        SDL_CondSignal(mCond);
+        SDL_mutexV(mMutex);
+        SDL_Delay(1);
     }
-
-    str = removeColors(str);
-    writeTo(mLogFile, str);
 }
 
 std::string ChatLogger::getDir() const
@@ -158,19 +324,23 @@ std::string ChatLogger::secureName(std::string &name) const
 
 void ChatLogger::writeTo(std::ofstream &file, const std::string &str) const
 {
-    file << str << std::endl;
+    file << str << '\n';
 }
 
 void ChatLogger::setServerName(const std::string &serverName)
 {
+    flush();
+
+    SDL_mutexP(mMutex);
     mServerName = serverName;
     if (mServerName == "")
         mServerName = config.getStringValue("MostUsedServerName0");
 
-    if (mLogFile.is_open())
-        mLogFile.close();
-
     secureName(mServerName);
+    mReset = true;
+    mTails.clear();
+    SDL_mutexV(mMutex);
+
     if (mLogDir != "")
     {
         const char *const name = (std::string(mLogDir).append(dirSeparator)
@@ -183,23 +353,76 @@ void ChatLogger::setServerName(const std::string &serverName)
     }
 }
 
+void ChatLogger::setBaseLogDir(const std::string &logDir)
+{
+    SDL_mutexP(mMutex);
+    mBaseLogDir = logDir;
+    mReset = true;
+    SDL_mutexV(mMutex);
+}
+
 void ChatLogger::loadLast(std::string name, std::list<std::string> &list,
-                          const unsigned n) const
+                          const unsigned n)
 {
-    std::ifstream logFile;
-    std::string fileName = strprintf("%s/%s.log", getDir().c_str(),
-        secureName(name).c_str());
+    secureName(name);
+    const std::string dateStr = getDir();
 
-    logFile.open(fileName.c_str(), std::ios::in);
+    // lines still in queue must reach file and tail before they read.
+    // Flush returns at once when queue is empty.
+    flush();
 
-    if (!logFile.is_open())
-        return;
+    std::list<std::string> lines;
+    bool found = false;
+    SDL_mutexP(mMutex);
+    if (mTailsDir != dateStr)
+    {
+        mTails.clear();
+        mTailsDir = dateStr;
+    }
+    const ChatLogTailsCIter it = mTails.find(name);
+    if (it != mTails.end() && n <= chatLogTailSize)
+    {
+        lines = (*it).second;
+        found = true;
+    }
+    SDL_mutexV(mMutex);
+
+    if (!found)
+    {
+        std::ifstream logFile;
+        const std::string fileName = strprintf("%s/%s.log",
+            dateStr.c_str(), name.c_str());
+
+        logFile.open(fileName.c_str(), std::ios::in);
+
+        if (logFile.is_open())
+        {
+            const unsigned int maxLines = std::max(n, chatLogTailSize);
+            char line[710];
+            while (logFile.getline(line, 700))
+            {
+                lines.push_back(line);
+                if (lines.size() > maxLines)
+                    lines.pop_front();
+            }
+            logFile.close();
+        }
+
+        SDL_mutexP(mMutex);
+        if (mTailsDir == dateStr)
+        {
+            std::list<std::string> &tail = mTails[name];
+            tail = lines;
+            while (tail.size() > chatLogTailSize)
+                tail.pop_front();
+        }
+        SDL_mutexV(mMutex);
+    }
 
-    char line[710];
     unsigned sz = static_cast<unsigned>(list.size());
-    while (logFile.getline(line, 700))
+    FOR_EACH (std::list<std::string>::const_iterator, it2, lines)
     {
-        list.push_back(line);
+        list.push_back(*it2);
         sz ++;
         if (sz > n)
         {
@@ -207,14 +430,15 @@ void ChatLogger::loadLast(std::string name, std::list<std::string> &list,
             sz --;
         }
     }
-
-    if (logFile.is_open())
-        logFile.close();
 }
 
 void ChatLogger::clear()
 {
-    mLogDir.clear();
+    flush();
+
+    SDL_mutexP(mMutex);
     mServerName.clear();
-    mLogFileName.clear();
+    mReset = true;
+    mTails.clear();
+    SDL_mutexV(mMutex);
 }
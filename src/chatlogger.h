@@ -25,9 +25,43 @@
 
 #include <fstream>
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "localconsts.h"
 
+struct SDL_cond;
+struct SDL_mutex;
+struct SDL_Thread;
+
+struct ChatLogEntry final
+{
+    ChatLogEntry(const std::string &name0, const std::string &text0) :
+        name(name0),
+        text(text0)
+    {
+    }
+
+    std::string name;
+    std::string text;
+};
+
+typedef std::vector<ChatLogEntry> ChatLogEntries;
+typedef std::map<std::string, std::ofstream*> ChatLogFiles;
+typedef ChatLogFiles::iterator ChatLogFilesIter;
+typedef std::map<std::string, std::list<std::string> > ChatLogTails;
+typedef ChatLogTails::iterator ChatLogTailsIter;
+typedef ChatLogTails::const_iterator ChatLogTailsCIter;
+
+/**
+ * Writes chat logs from a background thread.
+ *
+ * Lines are queued by the caller and written in batches by the writer,
+ * which keeps a small pool of open per-channel files and handles date
+ * rollover itself. The last lines of each channel are kept in memory
+ * so loadLast does not need to reread the file.
+ */
 class ChatLogger final
 {
     public:
@@ -39,7 +73,7 @@ class ChatLogger final
         A_DELETE_COPY(ChatLogger)
 
         /**
-         * Destructor, closes log file.
+         * Destructor, writes pending lines and closes log files.
          */
         ~ChatLogger();
 
@@ -51,7 +85,7 @@ class ChatLogger final
         void log(std::string name, std::string str);
 
         void loadLast(std::string name, std::list<std::string> &list,
-                      const unsigned n) const;
+                      const unsigned n);
 
         std::string getDir() const A_WARN_UNUSED;
 
@@ -59,26 +93,45 @@ class ChatLogger final
 
         void setServerName(const std::string &serverName);
 
-        void setBaseLogDir(const std::string &logDir)
-        { mBaseLogDir = logDir; }
+        void setBaseLogDir(const std::string &logDir);
 
         void clear();
 
-    private:
         /**
-         * Sets the file to log to and opens it
+         * Waits until all queued lines are written.
          */
-        void setLogFile(const std::string &logFilename);
+        void flush();
+
+    private:
+        static int writerThread(void *ptr);
+
+        void writeEntries(const ChatLogEntries &entries);
+
+        std::ofstream *getFile(const std::string &name);
+
+        void closeFiles();
+
+        void addToTail(std::list<std::string> &tail,
+                       const std::string &str) const;
 
         void setLogDir(const std::string &logDir);
 
         void writeTo(std::ofstream &file, const std::string &str) const;
 
-        std::ofstream mLogFile;
+        ChatLogEntries mQueue;
+        ChatLogFiles mFiles;
+        std::list<std::string> mFilesOrder;
+        ChatLogTails mTails;
+        std::string mTailsDir;
         std::string mLogDir;
         std::string mBaseLogDir;
         std::string mServerName;
-        std::string mLogFileName;
+        SDL_mutex *mMutex;
+        SDL_cond *mCond;
+        SDL_Thread *mThread;
+        bool mRunning;
+        bool mWriting;
+        bool mReset;
 };
 
 extern ChatLogger *chatLogger;
@@ -26,10 +26,13 @@
 
 #include "auctionmanager.h"
 #include "chatlogger.h"
+#include "compoundsprite.h"
 #include "configuration.h"
 #include "depricatedevent.h"
 #include "dropshortcut.h"
 #include "emoteshortcut.h"
+#include "framebudget.h"
+#include "framescheduler.h"
 #include "game.h"
 #include "guild.h"
 #include "guildmanager.h"
@@ -41,6 +44,7 @@
 #include "keyboardconfig.h"
 #include "party.h"
 #include "playerrelations.h"
+#include "screenshotwriter.h"
 #include "soundmanager.h"
 #include "statuseffect.h"
 #include "units.h"
@@ -96,6 +100,7 @@
 #include "resources/petdb.h"
 #include "resources/resourcemanager.h"
 
+#include "utils/archiveindex.h"
 #include "utils/gettext.h"
 #include "utils/mkdir.h"
 #include "utils/paths.h"
@@ -138,6 +143,8 @@
  * setting it back to zero (and start again).
  */
 static const int MAX_TICK_VALUE = INT_MAX / 2;
+// Logic ticks kept for next frames when logic is behind
+static const int maxLogicBacklog = 40;
 
 std::string errorMessage;
 ErrorListener errorListener;
@@ -343,6 +350,8 @@ void Client::gameInit()
     else
         logger->setLogFile(mLocalDataDir + "/manaplus.log");
 
+    archiveIndex.loadCache(mLocalDataDir + "/archiveindex.bin");
+
     initConfiguration();
     logger->log("init 4");
     logger->setDebugLog(config.getBoolValue("debugLog"));
@@ -798,6 +807,8 @@ void Client::gameClear()
     delete gui;
     gui = nullptr;
 
+    CompoundSprite::clearCache();
+
     if (logger)
         logger->log1("Quitting3");
 
@@ -829,6 +840,7 @@ void Client::gameClear()
     ActorSprite::unload();
 
     touchManager.clear();
+    archiveIndex.saveCache();
     ResourceManager::deleteInstance();
 
     if (logger)
@@ -927,6 +939,7 @@ int Client::gameExec()
     while (mState != STATE_EXIT)
     {
         PROFILER_START();
+        frameScheduler.startFrame();
         BLOCK_START("Client::gameExec 1")
         if (mGame)
         {
@@ -1020,8 +1033,13 @@ int Client::gameExec()
         BLOCK_START("Client::gameExec 4")
         if (gui)
             gui->logic();
+        // Catch up logic ticks while they fit in the frame budget.
+        // Anything left is done in next frames, up to maxLogicBacklog.
+        // This is done because at some point tick_time will wrap.
+        if (tick_time < lastTickTime)
+            lastTickTime = tick_time;
         int k = 0;
-        while (lastTickTime != tick_time && k < 40)
+        while (lastTickTime != tick_time && frameScheduler.canRunLogic(k))
         {
             if (mGame)
                 mGame->logic();
@@ -1031,37 +1049,71 @@ int Client::gameExec()
             ++lastTickTime;
             k ++;
         }
-        soundManager.logic();
-
         logic_count += k;
-        if (gui)
-            gui->slowLogic();
-        if (mGame)
-            mGame->slowLogic();
-        BLOCK_END("Client::gameExec 4")
 
-        // This is done because at some point tick_time will wrap.
-        lastTickTime = tick_time;
+        int backlog = tick_time - lastTickTime;
+        int dropped = 0;
+        if (backlog > maxLogicBacklog)
+        {
+            dropped = backlog - maxLogicBacklog;
+            lastTickTime += dropped;
+            backlog = maxLogicBacklog;
+        }
+        frameScheduler.endLogic(backlog, dropped);
+        frameScheduler.endStage(FrameScheduler::STAGE_LOGIC);
+
+        if (frameScheduler.mustRun(FrameScheduler::TASK_SOUND))
+        {
+            soundManager.logic();
+            frameScheduler.finishTask(FrameScheduler::TASK_SOUND);
+        }
+        if (frameScheduler.mustRun(FrameScheduler::TASK_SLOW_LOGIC))
+        {
+            if (gui)
+                gui->slowLogic();
+            if (mGame)
+                mGame->slowLogic();
+            frameScheduler.finishTask(FrameScheduler::TASK_SLOW_LOGIC);
+        }
+        if (mGame && mainGraphics->getOpenGL()
+            && frameScheduler.mustRun(FrameScheduler::TASK_DELAYED_LOAD))
+        {
+            ResourceManager::delayedLoad();
+            frameScheduler.finishTask(FrameScheduler::TASK_DELAYED_LOAD);
+        }
+        frameScheduler.endStage(FrameScheduler::STAGE_SLOW_LOGIC);
+        BLOCK_END("Client::gameExec 4")
 
         // Update the screen when application is active, delay otherwise.
         if (SDL_GetAppState() & SDL_APPACTIVE)
         {
-            frame_count++;
-            if (gui)
-                gui->draw();
-            mainGraphics->updateScreen();
-//            logger->log("active");
+            // Being positions are computed from tick_time on draw,
+            // so skipped frames do not make movement jump.
+            if (frameScheduler.mustDraw())
+            {
+                frame_count++;
+                if (gui)
+                    gui->draw();
+                if (screenshotWriter)
+                    screenshotWriter->captureFrame();
+                mainGraphics->updateScreen();
+            }
+            frameScheduler.endStage(FrameScheduler::STAGE_DRAW);
         }
         else
         {
-//            logger->log("inactive");
-            SDL_Delay(100);
+            frameScheduler.endStage(FrameScheduler::STAGE_DRAW);
+            // Sleep until sound needs update, but not less than 100 ms.
+            // Network and other tasks are handled after wakeup.
+            SDL_Delay(frameScheduler.getIdleDelay(100, 200));
         }
 
         BLOCK_START("~Client::SDL_framerateDelay")
         if (mLimitFps)
             SDL_framerateDelay(&mFpsManager);
         BLOCK_END("~Client::SDL_framerateDelay")
+        frameScheduler.endFrame();
+        FrameBudget::endFrame();
 
         BLOCK_START("Client::gameExec 6")
         if (mState == STATE_CONNECT_GAME &&
@@ -1908,7 +1960,8 @@ void Client::initLocalDataDir()
             "Exiting."), mLocalDataDir.c_str()));
     }
 #ifdef USE_PROFILER
-    Perfomance::init(mLocalDataDir + "/profiler.log");
+    Perfomance::init(mLocalDataDir + "/profiler.log",
+        mLocalDataDir + "/profiler.json");
 #endif
 }
 
@@ -2683,10 +2736,11 @@ float Client::getGuiAlpha()
 
 void Client::setFramerate(const int fpsLimit)
 {
+    Client *const client = instance();
+    frameScheduler.setFrameRate(client->mLimitFps ? fpsLimit : 0);
     if (!fpsLimit)
         return;
 
-    Client *const client = instance();
     if (!client->mLimitFps)
         return;
 
@@ -32,6 +32,7 @@
 #include "main.h"
 #include "nullopenglgraphics.h"
 #include "party.h"
+#include "screenshotwriter.h"
 
 #include "gui/chatwindow.h"
 #include "gui/helpwindow.h"
@@ -996,37 +997,16 @@ impHandler0(cacheInfo)
     if (!chatWindow || !debugChatTab)
         return;
 
-/*
-    SDLFont *const font = dynamic_cast<SDLFont *const>(chatWindow->getFont());
-    if (!font)
-        return;
-
-    const TextChunkList *const cache = font->getCache();
-    if (!cache)
-        return;
-
-    unsigned int all = 0;
     debugChatTab->chatLog(_("font cache size"));
-    std::string str;
-    for (int f = 0; f < 256; f ++)
-    {
-        if (!cache[f].size)
-        {
-            const unsigned int sz = static_cast<int>(cache[f].size);
-            all += sz;
-            str.append(strprintf("%d: %u, ", f, sz));
-        }
-    }
-    debugChatTab->chatLog(str);
-    debugChatTab->chatLog(strprintf("%s %d", _("Cache size:"), all));
-#ifdef DEBUG_FONT_COUNTERS
-    debugChatTab->chatLog("");
-    debugChatTab->chatLog(strprintf("%s %d",
-        _("Created:"), font->getCreateCounter()));
-    debugChatTab->chatLog(strprintf("%s %d",
-        _("Deleted:"), font->getDeleteCounter()));
-#endif
-*/
+    debugChatTab->chatLog(strprintf("%s %u", _("Cache size:"),
+        textChunkCache.getSize()));
+    debugChatTab->chatLog(strprintf("%s %d / %d KB", _("Memory:"),
+        textChunkCache.getMemory() / 1024,
+        textChunkCache.getBudget() / 1024));
+    debugChatTab->chatLog(strprintf("%s %u, %s %u, %s %u",
+        _("Hits:"), textChunkCache.getHits(),
+        _("Misses:"), textChunkCache.getMisses(),
+        _("Evicted:"), textChunkCache.getEvictions()));
 }
 
 impHandler0(serverIgnoreAll)
@@ -1280,6 +1260,31 @@ impHandler0(dumpOGL)
 #endif
 }
 
+impHandler(capture)
+{
+    if (!screenshotWriter)
+        return;
+
+    // /capture [every N frame] [raw], without arguments stops capture
+    if (args.empty())
+    {
+        screenshotWriter->stopCapture();
+        return;
+    }
+
+    int step = atoi(args.c_str());
+    if (step < 1)
+        step = 1;
+    const bool raw = args.find("raw") != std::string::npos;
+    screenshotWriter->startCapture(step, raw);
+    if (tab)
+    {
+        // TRANSLATORS: frame capture message
+        tab->chatLog(strprintf(_("Capturing every %d frame to %s."),
+            step, Client::getScreenshotDirectory().c_str()), BY_SERVER);
+    }
+}
+
 void replaceVars(std::string &str)
 {
     if (!player_node || !actorSpriteManager)
@@ -111,6 +111,7 @@ namespace Commands
     decHandler(dumpEnvironment);
     decHandler(dumpTests);
     decHandler(dumpOGL);
+    decHandler(capture);
     decHandler(cacheInfo);
     decHandler(execute);
     decHandler(testsdlfont);
@@ -188,6 +189,7 @@ static const CommandInfo commands[] =
     {"dumpe", &Commands::dumpEnvironment},
     {"dumpt", &Commands::dumpTests},
     {"dumpogl", &Commands::dumpOGL},
+    {"capture", &Commands::capture},
     {"url", &Commands::url},
     {"open", &Commands::open},
     {"execute", &Commands::execute},
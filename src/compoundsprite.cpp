@@ -22,6 +22,7 @@
 #include "compoundsprite.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "game.h"
 #include "graphics.h"
 
@@ -44,12 +45,29 @@
 static const int BUFFER_WIDTH = 100;
 static const int BUFFER_HEIGHT = 100;
 
-static const unsigned cache_max_size = 10;
-static const unsigned cache_clean_part = 3;
 bool CompoundSprite::mEnableDelay = true;
 
+static CompoundCache compoundCache;
+
+static void getTileSize(int &tileX, int &tileY)
+{
+    tileX = 32 / 2;
+    tileY = 32;
+
+    const Game *const game = Game::instance();
+    if (game)
+    {
+        const Map *const map = game->getCurrentMap();
+        if (map)
+        {
+            tileX = map->getTileWidth() / 2;
+            tileY = map->getTileWidth();
+        }
+    }
+}
+
 CompoundSprite::CompoundSprite() :
-    imagesCache(),
+    mCacheKey(),
     mCacheItem(nullptr),
     mImage(nullptr),
     mAlphaImage(nullptr),
@@ -264,10 +282,7 @@ void CompoundSprite::clear()
         mSprites.clear();
     }
     mNeedsRedraw = true;
-    delete_all(imagesCache);
-    imagesCache.clear();
-    delete mCacheItem;
-    mCacheItem = nullptr;
+    releaseImages();
 }
 
 void CompoundSprite::ensureSize(size_t layerCount)
@@ -324,6 +339,7 @@ void CompoundSprite::redraw() const
     const int amask = 0xff000000;
 #endif
 
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     SDL_Surface *const surface = SDL_CreateRGBSurface(SDL_HWSURFACE,
         BUFFER_WIDTH, BUFFER_HEIGHT, 32, rmask, gmask, bmask, amask);
 
@@ -335,19 +351,9 @@ void CompoundSprite::redraw() const
     graphics->setTarget(surface);
     graphics->_beginDraw();
 
-    int tileX = 32 / 2;
-    int tileY = 32;
-
-    const Game *const game = Game::instance();
-    if (game)
-    {
-        const Map *const map = game->getCurrentMap();
-        if (map)
-        {
-            tileX = map->getTileWidth() / 2;
-            tileY = map->getTileWidth();
-        }
-    }
+    int tileX = 0;
+    int tileY = 0;
+    getTileSize(tileX, tileY);
 
     const int posX = BUFFER_WIDTH / 2 - tileX;
     const int posY = BUFFER_HEIGHT - tileY;
@@ -360,14 +366,14 @@ void CompoundSprite::redraw() const
     delete graphics;
     graphics = nullptr;
 
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     SDL_Surface *const surfaceA = SDL_CreateRGBSurface(SDL_HWSURFACE,
         BUFFER_WIDTH, BUFFER_HEIGHT, 32, rmask, gmask, bmask, amask);
 
     SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
     SDL_BlitSurface(surface, nullptr, surfaceA, nullptr);
 
-    delete mImage;
-    delete mAlphaImage;
+    releaseImages();
 
     mImage = imageHelper->load(surface);
     SDL_FreeSurface(surface);
@@ -424,7 +430,7 @@ void CompoundSprite::updateImages() const
         if (size() <= 3)
             return;
 
-        if (!mDisableAdvBeingCaching)
+        if (!mDisableAdvBeingCaching && updateCacheKey())
         {
             if (updateFromCache())
                 return;
@@ -441,88 +447,87 @@ void CompoundSprite::updateImages() const
     }
 }
 
+bool CompoundSprite::updateCacheKey() const
+{
+    mCacheKey.data.clear();
+    FOR_EACH (SpriteConstIterator, it, mSprites)
+    {
+        SpriteHash hash(0, nullptr);
+        if (*it && !(*it)->getHash(hash))
+            return false;
+        mCacheKey.data.push_back(hash);
+    }
+    getTileSize(mCacheKey.tileWidth, mCacheKey.tileHeight);
+    // with alpha fix layers are composed with sprite alpha
+    mCacheKey.alpha = mEnableAlphaFix ? static_cast<int>(mAlpha * 255) : 255;
+    mCacheKey.updateHash();
+    return true;
+}
+
 bool CompoundSprite::updateFromCache() const
 {
-//    static int hits = 0;
-//    static int miss = 0;
+    if (mCacheItem && mCacheItem->matches(mCacheKey))
+        return true;
+
+    CompoundItem *const item = compoundCache.get(mCacheKey);
+    releaseImages();
+    if (!item)
+        return false;
+
+    mCacheItem = item;
+    mImage = item->image;
+    mAlphaImage = item->alphaImage;
+    mOffsetX = item->offsetX;
+    mOffsetY = item->offsetY;
+    return true;
+}
+
+void CompoundSprite::initCurrentCacheItem() const
+{
+    CompoundItem *const item = new CompoundItem();
+    item->data = mCacheKey.data;
+    item->hash = mCacheKey.hash;
+    item->tileWidth = mCacheKey.tileWidth;
+    item->tileHeight = mCacheKey.tileHeight;
+    item->alpha = mCacheKey.alpha;
+    item->image = mImage;
+    item->alphaImage = mAlphaImage;
+    item->offsetX = mOffsetX;
+    item->offsetY = mOffsetY;
+    compoundCache.add(item);
+    mCacheItem = item;
+}
 
-    if (mCacheItem && mCacheItem->image)
+void CompoundSprite::releaseImages() const
+{
+    if (mCacheItem)
     {
-        imagesCache.push_front(mCacheItem);
+        // images are owned by cache item
+        compoundCache.release(mCacheItem);
         mCacheItem = nullptr;
-        if (imagesCache.size() > cache_max_size)
-        {
-            for (unsigned f = 0; f < cache_clean_part; f ++)
-            {
-                CompoundItem *item = imagesCache.back();
-                imagesCache.pop_back();
-                delete item;
-            }
-        }
     }
-
-//    logger->log("cache size: %d, hit %d, miss %d",
-//        (int)imagesCache.size(), hits, miss);
-
-    const size_t sz = size();
-    FOR_EACH (ImagesCache::iterator, it, imagesCache)
+    else
     {
-        CompoundItem *const ic = *it;
-        if (ic && ic->data.size() == sz)
-        {
-            bool fail(false);
-            VectorPointers::const_iterator it2 = ic->data.begin();
-            const VectorPointers::const_iterator it2_end = ic->data.end();
-
-            for (SpriteConstIterator it1 = mSprites.begin(),
-                 it1_end = mSprites.end();
-                 it1 != it1_end && it2 != it2_end;
-                 ++ it1, ++ it2)
-            {
-                const void *ptr1 = nullptr;
-                const void *ptr2 = nullptr;
-                if (*it1)
-                    ptr1 = (*it1)->getHash();
-                if (*it2)
-                    ptr2 = *it2;
-                if (ptr1 != ptr2)
-                {
-                    fail = true;
-                    break;
-                }
-            }
-            if (!fail)
-            {
-//                hits ++;
-                mImage = (*it)->image;
-                mAlphaImage = (*it)->alphaImage;
-                imagesCache.erase(it);
-                mCacheItem = ic;
-                return true;
-            }
-        }
+        delete mImage;
+        delete mAlphaImage;
     }
     mImage = nullptr;
     mAlphaImage = nullptr;
-//    miss++;
-    return false;
 }
 
-void CompoundSprite::initCurrentCacheItem() const
+void CompoundSprite::clearCache()
 {
-    delete mCacheItem;
-    mCacheItem = new CompoundItem();
-    mCacheItem->image = mImage;
-    mCacheItem->alphaImage = mAlphaImage;
-//    mCacheItem->alpha = mAlpha;
+    compoundCache.clear();
+}
 
-    FOR_EACH (SpriteConstIterator, it, mSprites)
-    {
-        if (*it)
-            mCacheItem->data.push_back((*it)->getHash());
-        else
-            mCacheItem->data.push_back(nullptr);
-    }
+int CompoundSprite::getCacheSize()
+{
+    return compoundCache.size();
+}
+
+int CompoundSprite::getCacheMemory()
+{
+    return compoundCache.getMemory();
 }
 
 bool CompoundSprite::updateNumber(unsigned num)
@@ -541,8 +546,16 @@ bool CompoundSprite::updateNumber(unsigned num)
 
 CompoundItem::CompoundItem() :
     data(),
+    cacheIter(),
     image(nullptr),
-    alphaImage(nullptr)
+    alphaImage(nullptr),
+    hash(0),
+    tileWidth(0),
+    tileHeight(0),
+    alpha(0),
+    offsetX(0),
+    offsetY(0),
+    refCount(0)
 {
 }
 
@@ -551,3 +564,113 @@ CompoundItem::~CompoundItem()
     delete image;
     delete alphaImage;
 }
+
+bool CompoundItem::matches(const CompoundItem &key) const
+{
+    return hash == key.hash && tileWidth == key.tileWidth
+        && tileHeight == key.tileHeight && alpha == key.alpha
+        && data == key.data;
+}
+
+void CompoundItem::updateHash()
+{
+    // FNV-1a
+    hash = 2166136261U;
+    FOR_EACH (SpriteHashes::const_iterator, it, data)
+    {
+        hash = (hash ^ (*it).first) * 16777619U;
+        const size_t ptr = reinterpret_cast<size_t>((*it).second);
+        for (size_t f = 0; f < sizeof(size_t); f ++)
+            hash = (hash ^ ((ptr >> (f * 8)) & 0xff)) * 16777619U;
+    }
+    hash = (hash ^ static_cast<unsigned int>(tileWidth)) * 16777619U;
+    hash = (hash ^ static_cast<unsigned int>(tileHeight)) * 16777619U;
+    hash = (hash ^ static_cast<unsigned int>(alpha)) * 16777619U;
+}
+
+CompoundCache::CompoundCache() :
+    mItems(),
+    mIndex(),
+    mMemory(0)
+{
+}
+
+CompoundCache::~CompoundCache()
+{
+    clear();
+}
+
+static int getItemMemory(const CompoundItem *const item)
+{
+    int memory = 0;
+    if (item->image)
+        memory += BUFFER_WIDTH * BUFFER_HEIGHT * 4;
+    if (item->alphaImage)
+        memory += BUFFER_WIDTH * BUFFER_HEIGHT * 4;
+    return memory;
+}
+
+CompoundItem *CompoundCache::get(const CompoundItem &key)
+{
+    const std::pair<ItemsIndexIter, ItemsIndexIter> range
+        = mIndex.equal_range(key.hash);
+    for (ItemsIndexIter it = range.first; it != range.second; ++ it)
+    {
+        CompoundItem *const item = it->second;
+        if (item->matches(key))
+        {
+            item->refCount ++;
+            mItems.splice(mItems.begin(), mItems, item->cacheIter);
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+void CompoundCache::add(CompoundItem *const item)
+{
+    item->refCount = 1;
+    mItems.push_front(item);
+    item->cacheIter = mItems.begin();
+    mIndex.insert(std::pair<unsigned int, CompoundItem*>(item->hash, item));
+    mMemory += getItemMemory(item);
+    cleanUp(config.getIntValue("compoundCacheSize") * 1024 * 1024);
+}
+
+void CompoundCache::release(CompoundItem *const item)
+{
+    item->refCount --;
+    if (!item->refCount)
+        cleanUp(config.getIntValue("compoundCacheSize") * 1024 * 1024);
+}
+
+void CompoundCache::clear()
+{
+    cleanUp(0);
+}
+
+void CompoundCache::cleanUp(const int budget)
+{
+    ItemsIter it = mItems.end();
+    while (mMemory > budget && it != mItems.begin())
+    {
+        -- it;
+        CompoundItem *const item = *it;
+        if (item->refCount > 0)
+            continue;
+
+        const std::pair<ItemsIndexIter, ItemsIndexIter> range
+            = mIndex.equal_range(item->hash);
+        for (ItemsIndexIter it2 = range.first; it2 != range.second; ++ it2)
+        {
+            if (it2->second == item)
+            {
+                mIndex.erase(it2);
+                break;
+            }
+        }
+        mMemory -= getItemMemory(item);
+        it = mItems.erase(it);
+        delete item;
+    }
+}
@@ -25,14 +25,19 @@
 #include "sprite.h"
 
 #include <list>
+#include <map>
 #include <vector>
 
 #include "localconsts.h"
 
 class Image;
 
-typedef std::list <void*> VectorPointers;
+typedef std::vector<SpriteHash> SpriteHashes;
 
+/**
+ * Composed image of all sprite layers. Items are shared by all compound
+ * sprites which draw the same frames.
+ */
 class CompoundItem final
 {
     public:
@@ -42,9 +47,78 @@ class CompoundItem final
 
         ~CompoundItem();
 
-        VectorPointers data;
+        /**
+         * Returns true if item was composed from the same frames and
+         * drawing parameters as key.
+         */
+        bool matches(const CompoundItem &key) const A_WARN_UNUSED;
+
+        /**
+         * Updates hash from data and drawing parameters.
+         */
+        void updateHash();
+
+        SpriteHashes data;
+        std::list<CompoundItem*>::iterator cacheIter;
         Image *image;
         Image *alphaImage;
+        unsigned int hash;
+        int tileWidth;
+        int tileHeight;
+        int alpha;
+        int offsetX;
+        int offsetY;
+        int refCount;
+};
+
+/**
+ * Process wide cache of composed images. Items used by sprites are
+ * reference counted and never dropped, unused items are dropped from the
+ * least recently used ones when cache is over its memory budget.
+ */
+class CompoundCache final
+{
+    public:
+        CompoundCache();
+
+        A_DELETE_COPY(CompoundCache)
+
+        ~CompoundCache();
+
+        /**
+         * Returns item matching key and adds reference to it.
+         */
+        CompoundItem *get(const CompoundItem &key) A_WARN_UNUSED;
+
+        /**
+         * Adds new item with one reference.
+         */
+        void add(CompoundItem *const item);
+
+        void release(CompoundItem *const item);
+
+        /**
+         * Deletes all unused items.
+         */
+        void clear();
+
+        int size() const A_WARN_UNUSED
+        { return static_cast<int>(mItems.size()); }
+
+        int getMemory() const A_WARN_UNUSED
+        { return mMemory; }
+
+    private:
+        void cleanUp(const int budget);
+
+        typedef std::list<CompoundItem*> Items;
+        typedef Items::iterator ItemsIter;
+        typedef std::multimap<unsigned int, CompoundItem*> ItemsIndex;
+        typedef ItemsIndex::iterator ItemsIndexIter;
+
+        Items mItems;
+        ItemsIndex mIndex;
+        int mMemory;
 };
 
 class CompoundSprite : public Sprite
@@ -131,17 +205,39 @@ public:
     static void setEnableDelay(bool b)
     { mEnableDelay = b; }
 
+    /**
+     * Deletes composed images not used by any sprite.
+     */
+    static void clearCache();
+
+    /**
+     * Returns count of composed images in cache.
+     */
+    static int getCacheSize() A_WARN_UNUSED;
+
+    /**
+     * Returns memory used by composed images in cache.
+     */
+    static int getCacheMemory() A_WARN_UNUSED;
+
 private:
     void redraw() const;
 
     void updateImages() const;
 
+    bool updateCacheKey() const;
+
     bool updateFromCache() const;
 
     void initCurrentCacheItem() const;
 
-    typedef std::list<CompoundItem*> ImagesCache;
-    mutable ImagesCache imagesCache;
+    /**
+     * Releases cache item or deletes composed images if they are not
+     * cached.
+     */
+    void releaseImages() const;
+
+    mutable CompoundItem mCacheKey;
     mutable CompoundItem *mCacheItem;
 
     mutable Image *mImage;
@@ -0,0 +1,179 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compoundsprite.h"
+
+#include "configuration.h"
+#include "imagesprite.h"
+#include "logger.h"
+
+#include "resources/image.h"
+
+#include "gtest/gtest.h"
+
+#include <SDL.h>
+
+#include "debug.h"
+
+namespace
+{
+    class TestImage final : public Image
+    {
+        public:
+            TestImage() :
+                Image(SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, 32,
+                    0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+            {
+                // sprites must not give it to resource manager
+                incRef();
+            }
+
+            A_DELETE_COPY(TestImage)
+    };
+
+    CompoundItem *createItem(const unsigned int id, const void *const frame)
+    {
+        CompoundItem *const item = new CompoundItem();
+        item->data.push_back(SpriteHash(id, frame));
+        item->tileWidth = 16;
+        item->tileHeight = 32;
+        item->alpha = 255;
+        item->image = new TestImage();
+        item->updateHash();
+        return item;
+    }
+
+    void initKey(CompoundItem &key, const unsigned int id,
+                 const void *const frame)
+    {
+        key.data.clear();
+        key.data.push_back(SpriteHash(id, frame));
+        key.tileWidth = 16;
+        key.tileHeight = 32;
+        key.alpha = 255;
+        key.updateHash();
+    }
+}  // namespace
+
+TEST(compoundsprite, spriteHash)
+{
+    if (!logger)
+        logger = new Logger();
+
+    TestImage *const image1 = new TestImage();
+    ImageSprite *const sprite1 = new ImageSprite(image1);
+    ImageSprite *const sprite2 = new ImageSprite(image1);
+    SpriteHash hash1(0, nullptr);
+    SpriteHash hash2(0, nullptr);
+    EXPECT_TRUE(sprite1->getHash(hash1));
+    EXPECT_TRUE(sprite2->getHash(hash2));
+    // sprites drawing the same image share composed images
+    EXPECT_TRUE(hash1 == hash2);
+    delete sprite1;
+    delete sprite2;
+    delete image1;
+
+    // new image may get address of deleted one, but never its id
+    TestImage *const image2 = new TestImage();
+    ImageSprite *const sprite3 = new ImageSprite(image2);
+    SpriteHash hash3(0, nullptr);
+    EXPECT_TRUE(sprite3->getHash(hash3));
+    EXPECT_NE(hash1.first, hash3.first);
+    EXPECT_FALSE(hash1 == hash3);
+    delete sprite3;
+    delete image2;
+}
+
+TEST(compoundsprite, cacheSharing)
+{
+    if (!logger)
+        logger = new Logger();
+    config.setValue("compoundCacheSize", 1);
+
+    CompoundCache cache;
+    CompoundItem key;
+    initKey(key, 1, &key);
+    EXPECT_EQ(nullptr, cache.get(key));
+
+    CompoundItem *const item = createItem(1, &key);
+    cache.add(item);
+    EXPECT_EQ(1, item->refCount);
+
+    // second sprite with the same layers gets the same item
+    EXPECT_EQ(item, cache.get(key));
+    EXPECT_EQ(2, item->refCount);
+
+    CompoundItem key2;
+    initKey(key2, 2, &key);
+    EXPECT_EQ(nullptr, cache.get(key2));
+
+    cache.release(item);
+    cache.release(item);
+    EXPECT_EQ(0, item->refCount);
+    // unused item stays while cache fits its budget
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(item, cache.get(key));
+    cache.release(item);
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.getMemory());
+}
+
+TEST(compoundsprite, cacheBudget)
+{
+    if (!logger)
+        logger = new Logger();
+    config.setValue("compoundCacheSize", 1);
+
+    CompoundCache cache;
+    const int count = 40;
+    CompoundItem *items[count];
+    for (int f = 0; f < count; f ++)
+    {
+        items[f] = createItem(f + 1, nullptr);
+        cache.add(items[f]);
+    }
+    // used items are never dropped
+    EXPECT_EQ(count, cache.size());
+    const int itemMemory = cache.getMemory() / count;
+    EXPECT_GT(itemMemory, 0);
+    EXPECT_GT(cache.getMemory(), 1024 * 1024);
+
+    for (int f = 0; f < count; f ++)
+        cache.release(items[f]);
+    EXPECT_LE(cache.getMemory(), 1024 * 1024);
+    EXPECT_EQ(1024 * 1024 / itemMemory, cache.size());
+
+    // least recently used items were dropped
+    CompoundItem key;
+    initKey(key, 1, nullptr);
+    EXPECT_EQ(nullptr, cache.get(key));
+    initKey(key, count, nullptr);
+    CompoundItem *const item = cache.get(key);
+    EXPECT_EQ(items[count - 1], item);
+    cache.release(item);
+
+    config.setValue("compoundCacheSize", 0);
+    cache.release(cache.get(key));
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.getMemory());
+    config.setValue("compoundCacheSize", 8);
+}
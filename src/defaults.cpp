@@ -230,6 +230,14 @@ DefaultsData* getConfigDefaults()
     AddDEF("showPlayersStatus", true);
     AddDEF("beingopacity", false);
     AddDEF("adjustPerfomance", true);
+    AddDEF("pathSolverThreads", 1);
+    AddDEF("mapCacheSize", 16);
+    AddDEF("enableCompiledMaps", true);
+    AddDEF("saveBeingCache", true);
+    AddDEF("compoundCacheSize", 8);
+    AddDEF("fontCacheSize", 4);
+    AddDEF("screenshotCompression", 6);
+    AddDEF("updateConnections", 3);
     AddDEF("enableAlphaFix", false);
     AddDEF("disableAdvBeingCaching", false);
     AddDEF("disableBeingCaching", false);
@@ -0,0 +1,130 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framebudget.h"
+
+#include <sys/time.h>
+
+#include "debug.h"
+
+namespace FrameBudget
+{
+    bool enabled = false;
+    unsigned int counters[COUNTER_COUNT];
+}  // namespace FrameBudget
+
+namespace
+{
+    // zone which gets time until next enter or leave, -1 if none
+    int currentZone = -1;
+    long long int lastTime = 0;
+    long long int frameStart = 0;
+    int sums[FrameBudget::ZONE_COUNT];
+    int frameTimes[FrameBudget::historySize];
+    int zoneTimes[FrameBudget::historySize][FrameBudget::ZONE_COUNT];
+    int historyPos = 0;
+    int frames = 0;
+
+    long long int getTime()
+    {
+        timeval tv;
+        gettimeofday(&tv, nullptr);
+        return static_cast<long long int>(tv.tv_sec) * 1000000LL
+            + static_cast<long long int>(tv.tv_usec);
+    }
+
+    long long int addTime()
+    {
+        const long long int now = getTime();
+        if (currentZone >= 0)
+            sums[currentZone] += static_cast<int>(now - lastTime);
+        lastTime = now;
+        return now;
+    }
+}  // namespace
+
+void FrameBudget::setEnabled(const bool b)
+{
+    if (b && !enabled)
+    {
+        currentZone = -1;
+        lastTime = getTime();
+        frameStart = lastTime;
+        for (int f = 0; f < ZONE_COUNT; f ++)
+            sums[f] = 0;
+        historyPos = 0;
+        frames = 0;
+    }
+    enabled = b;
+}
+
+void FrameBudget::endFrame()
+{
+    if (!enabled)
+        return;
+
+    const long long int now = addTime();
+    historyPos = (historyPos + 1) % historySize;
+    frameTimes[historyPos] = static_cast<int>(now - frameStart);
+    int *const zones = zoneTimes[historyPos];
+    for (int f = 0; f < ZONE_COUNT; f ++)
+    {
+        zones[f] = sums[f];
+        sums[f] = 0;
+    }
+    frameStart = now;
+    frames ++;
+}
+
+int FrameBudget::enter(const int zone)
+{
+    addTime();
+    const int parent = currentZone;
+    currentZone = zone;
+    return parent;
+}
+
+void FrameBudget::leave(const int parent)
+{
+    addTime();
+    currentZone = parent;
+}
+
+int FrameBudget::getFrames()
+{
+    return frames;
+}
+
+int FrameBudget::getFrameTime(const int frame)
+{
+    if (frame < 0 || frame >= historySize || frame >= frames)
+        return 0;
+    return frameTimes[(historyPos + historySize - frame) % historySize];
+}
+
+int FrameBudget::getZoneTime(const int frame, const int zone)
+{
+    if (frame < 0 || frame >= historySize || frame >= frames
+        || zone < 0 || zone >= ZONE_COUNT)
+    {
+        return 0;
+    }
+    return zoneTimes[(historyPos + historySize - frame) % historySize][zone];
+}
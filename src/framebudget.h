@@ -0,0 +1,123 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEBUDGET_H
+#define FRAMEBUDGET_H
+
+#include "localconsts.h"
+
+// time spent in the enclosing scope is added to the subsystem
+#define BUDGET_BLOCK(zone) \
+    const FrameBudget::Block frameBudgetBlock(FrameBudget::zone);
+
+/**
+ * Time spent by each subsystem in the last frames, for the performance
+ * overlay.
+ *
+ * Zones are nested, and time of inner zone is not counted in the outer
+ * one. Zones are recorded only while the overlay is shown, and only from
+ * the main thread.
+ */
+namespace FrameBudget
+{
+    enum Zone
+    {
+        ZONE_MAP = 0,
+        ZONE_FRINGE,
+        ZONE_PARTICLES,
+        ZONE_TEXT,
+        ZONE_GUI,
+        ZONE_NETWORK,
+        ZONE_RESOURCES,
+        ZONE_COUNT
+    };
+
+    enum Counter
+    {
+        COUNTER_TEXTURE_BINDS = 0,
+        COUNTER_SURFACES,
+        COUNTER_COUNT
+    };
+
+    // count of frames in history
+    const int historySize = 128;
+
+    extern bool enabled;
+
+    // totals counted while overlay is shown, wrap around in long sessions
+    extern unsigned int counters[COUNTER_COUNT];
+
+    void setEnabled(const bool b);
+
+    /**
+     * Stores times of finished frame in history.
+     */
+    void endFrame();
+
+    /**
+     * Makes zone current and returns previous current zone.
+     */
+    int enter(const int zone) A_WARN_UNUSED;
+
+    void leave(const int parent);
+
+    /**
+     * Returns count of frames stored since overlay was shown.
+     */
+    int getFrames() A_WARN_UNUSED;
+
+    /**
+     * Returns frame time in microseconds. Frame 0 is the last one.
+     */
+    int getFrameTime(const int frame) A_WARN_UNUSED;
+
+    /**
+     * Returns time of zone in microseconds. Frame 0 is the last one.
+     */
+    int getZoneTime(const int frame, const int zone) A_WARN_UNUSED;
+
+    inline void count(const Counter counter)
+    {
+        if (enabled)
+            counters[counter] ++;
+    }
+
+    class Block final
+    {
+        public:
+            explicit Block(const Zone zone) :
+                mParent(enabled ? enter(zone) : -2)
+            {
+            }
+
+            A_DELETE_COPY(Block)
+
+            ~Block()
+            {
+                if (mParent != -2)
+                    leave(mParent);
+            }
+
+        private:
+            int mParent;
+    };
+}  // namespace FrameBudget
+
+#endif  // FRAMEBUDGET_H
@@ -0,0 +1,92 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framebudget.h"
+
+#include "gtest/gtest.h"
+
+#include <SDL_timer.h>
+
+#include "debug.h"
+
+TEST(framebudget, disabled)
+{
+    FrameBudget::setEnabled(false);
+    {
+        BUDGET_BLOCK(ZONE_MAP)
+        SDL_Delay(2);
+    }
+    FrameBudget::endFrame();
+    EXPECT_EQ(0, FrameBudget::getZoneTime(0, FrameBudget::ZONE_MAP));
+}
+
+TEST(framebudget, nested)
+{
+    FrameBudget::setEnabled(true);
+    EXPECT_EQ(0, FrameBudget::getFrames());
+    {
+        BUDGET_BLOCK(ZONE_GUI)
+        SDL_Delay(10);
+        {
+            BUDGET_BLOCK(ZONE_MAP)
+            SDL_Delay(10);
+            {
+                BUDGET_BLOCK(ZONE_TEXT)
+                SDL_Delay(10);
+            }
+        }
+    }
+    SDL_Delay(10);
+    FrameBudget::endFrame();
+    {
+        BUDGET_BLOCK(ZONE_NETWORK)
+        SDL_Delay(5);
+    }
+    FrameBudget::endFrame();
+    FrameBudget::setEnabled(false);
+
+    EXPECT_EQ(2, FrameBudget::getFrames());
+    // frame 1 is the older one
+    const int gui = FrameBudget::getZoneTime(1, FrameBudget::ZONE_GUI);
+    const int map = FrameBudget::getZoneTime(1, FrameBudget::ZONE_MAP);
+    const int text = FrameBudget::getZoneTime(1, FrameBudget::ZONE_TEXT);
+    EXPECT_GE(gui, 9000);
+    EXPECT_GE(map, 9000);
+    EXPECT_GE(text, 9000);
+    EXPECT_GE(FrameBudget::getFrameTime(1), gui + map + text + 9000);
+    EXPECT_EQ(0, FrameBudget::getZoneTime(1, FrameBudget::ZONE_NETWORK));
+
+    EXPECT_GE(FrameBudget::getZoneTime(0, FrameBudget::ZONE_NETWORK), 4000);
+    EXPECT_EQ(0, FrameBudget::getZoneTime(0, FrameBudget::ZONE_GUI));
+    EXPECT_EQ(0, FrameBudget::getFrameTime(2));
+}
+
+TEST(framebudget, history)
+{
+    FrameBudget::setEnabled(true);
+    for (int f = 0; f < FrameBudget::historySize + 10; f ++)
+        FrameBudget::endFrame();
+    FrameBudget::setEnabled(false);
+
+    EXPECT_EQ(FrameBudget::historySize + 10, FrameBudget::getFrames());
+    EXPECT_EQ(0, FrameBudget::getZoneTime(
+        FrameBudget::historySize, FrameBudget::ZONE_MAP));
+    EXPECT_EQ(0, FrameBudget::getZoneTime(0, FrameBudget::ZONE_COUNT));
+}
@@ -0,0 +1,174 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framescheduler.h"
+
+#include <SDL_timer.h>
+
+#include "debug.h"
+
+FrameScheduler frameScheduler;
+
+// Logic budget when frame rate is not limited
+static const int defaultFrameRate = 30;
+static const int minLogicBudget = 10;
+// Frames skipped in a row before one is drawn anyway
+static const int maxSkippedFrames = 3;
+
+// Minimal delay between runs of each task, in milliseconds
+static const int taskIntervals[FrameScheduler::TASK_COUNT] =
+{
+    10,   // TASK_SLOW_LOGIC
+    100,  // TASK_SOUND
+    20    // TASK_DELAYED_LOAD
+};
+
+// Tasks what can wake up client while window is inactive
+static const bool taskIdleWakeup[FrameScheduler::TASK_COUNT] =
+{
+    false,  // TASK_SLOW_LOGIC
+    true,   // TASK_SOUND
+    false   // TASK_DELAYED_LOAD
+};
+
+FrameScheduler::FrameScheduler() :
+    mTimes(),
+    mTaskStart(0),
+    mFrameStart(0),
+    mStageStart(0),
+    mSecondStart(0),
+    mLogicBudget(1000 / defaultFrameRate),
+    mBacklog(0),
+    mFrames(0),
+    mSkipped(0),
+    mSkippedSum(0),
+    mDroppedSum(0)
+{
+    for (int f = 0; f < STAGE_COUNT; f ++)
+        mSum[f] = 0;
+    for (int f = 0; f < TASK_COUNT; f ++)
+        mDeadlines[f] = 0;
+}
+
+void FrameScheduler::setFrameRate(const int fps)
+{
+    mLogicBudget = 1000 / (fps > 0 ? fps : defaultFrameRate);
+    if (mLogicBudget < minLogicBudget)
+        mLogicBudget = minLogicBudget;
+}
+
+void FrameScheduler::startFrame()
+{
+    mFrameStart = SDL_GetTicks();
+    mStageStart = mFrameStart;
+    if (!mSecondStart)
+        mSecondStart = mFrameStart;
+}
+
+void FrameScheduler::endStage(const Stage stage)
+{
+    const unsigned int now = SDL_GetTicks();
+    mSum[stage] += static_cast<int>(now - mStageStart);
+    mStageStart = now;
+}
+
+bool FrameScheduler::canRunLogic(const int ticks) const
+{
+    // always run at least one tick, or game time would stop
+    return !ticks || static_cast<int>(SDL_GetTicks() - mFrameStart)
+        < mLogicBudget;
+}
+
+void FrameScheduler::endLogic(const int backlog, const int dropped)
+{
+    mBacklog = backlog;
+    mDroppedSum += dropped;
+}
+
+bool FrameScheduler::mustDraw()
+{
+    if (mBacklog > 0 && mSkipped < maxSkippedFrames)
+    {
+        mSkipped ++;
+        mSkippedSum ++;
+        return false;
+    }
+    mSkipped = 0;
+    return true;
+}
+
+bool FrameScheduler::mustRun(const Task task)
+{
+    const unsigned int now = SDL_GetTicks();
+    // signed difference keeps working when ticks wrap
+    if (static_cast<int>(now - mDeadlines[task]) < 0)
+        return false;
+    mTaskStart = now;
+    return true;
+}
+
+void FrameScheduler::finishTask(const Task task)
+{
+    const unsigned int now = SDL_GetTicks();
+    mDeadlines[task] = now + taskIntervals[task]
+        + 2 * (now - mTaskStart);
+}
+
+int FrameScheduler::getIdleDelay(const int minDelay,
+                                 const int maxDelay) const
+{
+    const unsigned int now = SDL_GetTicks();
+    int delay = maxDelay;
+    for (int f = 0; f < TASK_COUNT; f ++)
+    {
+        if (!taskIdleWakeup[f])
+            continue;
+        const int left = static_cast<int>(mDeadlines[f] - now);
+        if (left < delay)
+            delay = left;
+    }
+    if (delay < minDelay)
+        delay = minDelay;
+    return delay;
+}
+
+void FrameScheduler::endFrame()
+{
+    endStage(STAGE_IDLE);
+    mFrames ++;
+    const int time = static_cast<int>(mStageStart - mSecondStart);
+    if (time < 1000)
+        return;
+
+    mTimes.logic = mSum[STAGE_LOGIC] / mFrames;
+    mTimes.slowLogic = mSum[STAGE_SLOW_LOGIC] / mFrames;
+    mTimes.draw = mSum[STAGE_DRAW] / mFrames;
+    mTimes.idle = mSum[STAGE_IDLE] / mFrames;
+    mTimes.frames = mFrames;
+    mTimes.skipped = mSkippedSum;
+    mTimes.dropped = mDroppedSum;
+
+    for (int f = 0; f < STAGE_COUNT; f ++)
+        mSum[f] = 0;
+    mFrames = 0;
+    mSkippedSum = 0;
+    mDroppedSum = 0;
+    mSecondStart = mStageStart;
+}
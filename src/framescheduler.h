@@ -0,0 +1,155 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include "localconsts.h"
+
+/**
+ * Average time in milliseconds spent in each part of a frame, measured
+ * over the last second.
+ */
+struct FrameTimes final
+{
+    FrameTimes() :
+        logic(0),
+        slowLogic(0),
+        draw(0),
+        idle(0),
+        frames(0),
+        skipped(0),
+        dropped(0)
+    {
+    }
+
+    int logic;
+    int slowLogic;
+    int draw;
+    int idle;
+    int frames;
+    int skipped;
+    int dropped;
+};
+
+/**
+ * Paces the main loop.
+ *
+ * Logic ticks run at the fixed tick_time rate and are caught up within a
+ * time budget derived from the frame rate, so a slow tick does not starve
+ * drawing. Slow subsystems run at their own rates, drawing is skipped
+ * for a few frames while logic is behind, and the time spent in each
+ * stage is kept for the debug window.
+ */
+class FrameScheduler final
+{
+    public:
+        enum Stage
+        {
+            STAGE_LOGIC = 0,
+            STAGE_SLOW_LOGIC,
+            STAGE_DRAW,
+            STAGE_IDLE,
+            STAGE_COUNT
+        };
+
+        enum Task
+        {
+            TASK_SLOW_LOGIC = 0,
+            TASK_SOUND,
+            TASK_DELAYED_LOAD,
+            TASK_COUNT
+        };
+
+        FrameScheduler();
+
+        A_DELETE_COPY(FrameScheduler)
+
+        /**
+         * Sets target frame rate. Zero means unlimited.
+         */
+        void setFrameRate(const int fps);
+
+        void startFrame();
+
+        /**
+         * Adds time since the previous stage end to the given stage.
+         */
+        void endStage(const Stage stage);
+
+        /**
+         * Returns true if one more logic tick fits in this frame.
+         */
+        bool canRunLogic(const int ticks) const A_WARN_UNUSED;
+
+        /**
+         * Stores logic results for this frame. Backlog is the count of
+         * ticks left behind, dropped is the count thrown away.
+         */
+        void endLogic(const int backlog, const int dropped);
+
+        /**
+         * Returns false if drawing should be skipped this frame.
+         */
+        bool mustDraw() A_WARN_UNUSED;
+
+        /**
+         * Returns true if the task is due. Callers must call finishTask
+         * after running it.
+         */
+        bool mustRun(const Task task) A_WARN_UNUSED;
+
+        /**
+         * Schedules next run of the task. Tasks that took long are
+         * postponed by twice their run time.
+         */
+        void finishTask(const Task task);
+
+        /**
+         * Returns time in milliseconds until the nearest deadline of tasks
+         * needed while window is inactive, clamped to minDelay..maxDelay.
+         */
+        int getIdleDelay(const int minDelay,
+                         const int maxDelay) const A_WARN_UNUSED;
+
+        void endFrame();
+
+        const FrameTimes &getTimes() const A_WARN_UNUSED
+        { return mTimes; }
+
+    private:
+        FrameTimes mTimes;
+        int mSum[STAGE_COUNT];
+        unsigned int mDeadlines[TASK_COUNT];
+        unsigned int mTaskStart;
+        unsigned int mFrameStart;
+        unsigned int mStageStart;
+        unsigned int mSecondStart;
+        int mLogicBudget;
+        int mBacklog;
+        int mFrames;
+        int mSkipped;
+        int mSkippedSum;
+        int mDroppedSum;
+};
+
+extern FrameScheduler frameScheduler;
+
+#endif  // FRAMESCHEDULER_H
@@ -31,14 +31,18 @@
 #include "commandhandler.h"
 #include "effectmanager.h"
 #include "emoteshortcut.h"
+#include "framebudget.h"
 #include "guildmanager.h"
 #include "inputmanager.h"
 #include "itemshortcut.h"
 #include "joystick.h"
 #include "keyboardconfig.h"
 #include "localplayer.h"
+#include "mapcache.h"
 #include "particle.h"
+#include "pathsolver.h"
 #include "playerinfo.h"
+#include "screenshotwriter.h"
 #include "soundmanager.h"
 #include "spellshortcut.h"
 #include "touchmanager.h"
@@ -85,22 +89,17 @@
 #include "net/packetcounters.h"
 #include "net/playerhandler.h"
 
-#include "resources/imagewriter.h"
 #include "resources/mapdb.h"
 #include "resources/mapreader.h"
 #include "resources/resourcemanager.h"
 
 #include "utils/gettext.h"
 #include "utils/langs.h"
-#include "utils/mkdir.h"
-#include "utils/physfstools.h"
 #include "utils/process.h"
 
 #include <guichan/exception.hpp>
 #include <guichan/focushandler.hpp>
 
-#include <fstream>
-#include <sstream>
 #include <string>
 
 #include "mumblemanager.h"
@@ -172,6 +171,9 @@ static void initEngines()
     actorSpriteManager = new ActorSpriteManager;
     commandHandler = new CommandHandler;
     effectManager = new EffectManager;
+    pathSolver = new PathSolver;
+    mapCache = new MapCache;
+    screenshotWriter = new ScreenshotWriter;
     AuctionManager::init();
     GuildManager::init();
 
@@ -424,6 +426,7 @@ Game::Game():
         windowContainer->add(windowMenu);
 
     initEngines();
+    Being::loadCache();
 
     // Initialize beings
     if (actorSpriteManager)
@@ -457,9 +460,12 @@ Game::~Game()
         del_0(player_node)
     del_0(commandHandler)
     del_0(effectManager)
+    del_0(pathSolver)
     del_0(particleEngine)
     del_0(viewport)
     del_0(mCurrentMap)
+    del_0(mapCache)
+    del_0(screenshotWriter)
     del_0(spellManager)
     del_0(spellShortcut)
     del_0(auctionManager)
@@ -468,7 +474,9 @@ Game::~Game()
     del_0(mumbleManager)
 #endif
 
+    Being::saveCache();
     Being::clearCache();
+    CompoundSprite::clearCache();
     mInstance = nullptr;
     PlayerInfo::gameDestroyed();
 }
@@ -498,62 +506,14 @@ bool Game::createScreenshot()
 
 bool Game::saveScreenshot(SDL_Surface *const screenshot)
 {
-    std::string screenshotDirectory = Client::getScreenshotDirectory();
-
-    if (mkdir_r(screenshotDirectory.c_str()) != 0)
-    {
-        logger->log("Directory %s doesn't exist and can't be created! "
-                    "Setting screenshot directory to home.",
-                    screenshotDirectory.c_str());
-        screenshotDirectory = std::string(PhysFs::getUserDir());
-    }
-
-    // Search for an unused screenshot name
-    std::stringstream filenameSuffix;
-    std::stringstream filename;
-    std::fstream testExists;
-    bool found = false;
-    static unsigned int screenshotCount = 0;
-    do
+    if (!screenshotWriter)
     {
-        screenshotCount++;
-        filenameSuffix.str("");
-        filename.str("");
-        filename << screenshotDirectory << "/";
-        filenameSuffix << branding.getValue("appName", "ManaPlus")
-                       << "_Screenshot_" << screenshotCount << ".png";
-        filename << filenameSuffix.str();
-        testExists.open(filename.str().c_str(), std::ios::in);
-        found = !testExists.is_open();
-        testExists.close();
-    }
-    while (!found);
-
-    const bool success = ImageWriter::writePNG(screenshot, filename.str());
-
-    if (success)
-    {
-        std::stringstream chatlogentry;
-        // TRANSLATORS: save file message
-        chatlogentry << strprintf(_("Screenshot saved as %s"),
-            filenameSuffix.str().c_str());
-        if (localChatTab)
-            localChatTab->chatLog(chatlogentry.str(), BY_SERVER);
-    }
-    else
-    {
-        if (localChatTab)
-        {
-            // TRANSLATORS: save file message
-            localChatTab->chatLog(_("Saving screenshot failed!"),
-                                  BY_SERVER);
-        }
-        logger->log1("Error: could not save screenshot.");
+        SDL_FreeSurface(screenshot);
+        return false;
     }
 
-    SDL_FreeSurface(screenshot);
-
-    return success;
+    screenshotWriter->save(screenshot);
+    return true;
 }
 
 void Game::logic()
@@ -565,8 +525,13 @@ void Game::logic()
     ActorSprite::actorLogic();
     if (actorSpriteManager)
         actorSpriteManager->logic();
+    if (pathSolver)
+        pathSolver->logic();
     if (particleEngine)
+    {
+        BUDGET_BLOCK(ZONE_PARTICLES)
         particleEngine->update();
+    }
     if (mCurrentMap)
         mCurrentMap->update();
 
@@ -579,6 +544,8 @@ void Game::slowLogic()
     BLOCK_START("Game::slowLogic")
     if (player_node)
         player_node->slowLogic();
+    if (screenshotWriter)
+        screenshotWriter->logic();
     const int time = cur_time;
     if (mTime <= time)
     {
@@ -600,8 +567,6 @@ void Game::slowLogic()
 
     if (shopWindow)
         shopWindow->updateTimes();
-    if (mainGraphics->getOpenGL())
-        ResourceManager::delayedLoad();
     if (guildManager)
         guildManager->slowLogic();
     PacketCounters::update();
@@ -1045,22 +1010,26 @@ void Game::changeMap(const std::string &mapPath)
 
     mMapName = mapPath;
 
-    std::string fullMap = paths.getValue("maps", "maps/").append(
+    const std::string fullMap = paths.getValue("maps", "maps/").append(
         mMapName).append(".tmx");
-    std::string realFullMap = paths.getValue("maps", "maps/").append(
-        MapDB::getMapName(mMapName)).append(".tmx");
+    const std::string realFullMap = MapCache::getMapFile(mMapName);
 
-    if (!resman->exists(realFullMap))
-        realFullMap.append(".gz");
-
-    // Attempt to load the new map
-    Map *const newMap = MapReader::readMap(fullMap, realFullMap);
+    // Recently visited map is taken from cache with its extra layer
+    Map *newMap = mapCache ? mapCache->take(realFullMap) : nullptr;
+    const bool cached = newMap != nullptr;
+    if (!newMap)
+        newMap = MapReader::readMap(fullMap, realFullMap);
 
     if (mCurrentMap)
         mCurrentMap->saveExtraLayer();
 
     if (newMap)
-        newMap->addExtraLayer();
+    {
+        if (cached)
+            newMap->getTempLayer()->clean();
+        else
+            newMap->addExtraLayer();
+    }
 
     if (socialWindow)
         socialWindow->setMap(newMap);
@@ -1070,6 +1039,8 @@ void Game::changeMap(const std::string &mapPath)
         minimap->setMap(newMap);
     if (actorSpriteManager)
         actorSpriteManager->setMap(newMap);
+    if (pathSolver)
+        pathSolver->setMap(newMap);
     if (particleEngine)
         particleEngine->setMap(newMap);
     if (viewport)
@@ -1094,7 +1065,15 @@ void Game::changeMap(const std::string &mapPath)
     if (mCurrentMap)
         mCurrentMap->saveExtraLayer();
 
-    delete mCurrentMap;
+    if (mapCache)
+    {
+        mapCache->add(mCurrentMap);
+        mapCache->prefetch(newMap);
+    }
+    else
+    {
+        delete mCurrentMap;
+    }
     mCurrentMap = newMap;
 
     if (questsWindow)
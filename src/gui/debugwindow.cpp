@@ -23,11 +23,14 @@
 #include "gui/debugwindow.h"
 
 #include "client.h"
+#include "framescheduler.h"
 #include "game.h"
 #include "localplayer.h"
 #include "main.h"
 #include "particle.h"
+#include "pathsolver.h"
 
+#include "gui/sdlfont.h"
 #include "gui/setup.h"
 #include "gui/setup_video.h"
 #include "gui/viewport.h"
@@ -37,6 +40,7 @@
 #include "gui/widgets/layout.h"
 #include "gui/widgets/layouthelper.h"
 #include "gui/widgets/scrollarea.h"
+#include "gui/widgets/windowcontainer.h"
 
 #include "resources/imagehelper.h"
 
@@ -167,6 +171,23 @@ MapDebugTab::MapDebugTab(const Widget2 *const widget) :
         _("Map actors count:"), 88888))),
     // TRANSLATORS: debug window label
     mXYLabel(new Label(this, strprintf("%s (?,?)", _("Player Position:")))),
+    mWindowsLabel(new Label(this, strprintf(
+        // TRANSLATORS: debug window label
+        _("Windows drawn: %d, culled: %d"), 888, 888))),
+    mFrameTimeLabel(new Label(this, strprintf(
+        // TRANSLATORS: debug window label
+        _("Frame ms: logic %d, slow %d, draw %d, idle %d"), 888, 888, 888,
+        888))),
+    mFrameSkipLabel(new Label(this, strprintf(
+        // TRANSLATORS: debug window label
+        _("Skipped frames: %d, dropped ticks: %d"), 888, 888))),
+    mPathSolverLabel(new Label(this, strprintf(
+        // TRANSLATORS: debug window label
+        _("Paths: %d/s, latency %d ms, queue %d"), 888, 888, 888))),
+    mFontCacheLabel(new Label(this, strprintf(
+        // TRANSLATORS: debug window label
+        _("Font cache: %d KB, hits %u, misses %u, evicted %u"),
+        8888, 88888, 88888, 88888))),
     mTexturesLabel(nullptr),
     mUpdateTime(0),
 #ifdef DEBUG_DRAW_CALLS
@@ -218,9 +239,14 @@ MapDebugTab::MapDebugTab(const Widget2 *const widget) :
     place(0, 6, mTileMouseLabel, 2);
     place(0, 7, mParticleCountLabel, 2);
     place(0, 8, mMapActorCountLabel, 2);
+    place(0, 9, mWindowsLabel, 2);
+    place(0, 10, mFrameTimeLabel, 2);
+    place(0, 11, mFrameSkipLabel, 2);
+    place(0, 12, mPathSolverLabel, 2);
+    place(0, 13, mFontCacheLabel, 2);
 #ifdef USE_OPENGL
 #if defined (DEBUG_OPENGL_LEAKS) || defined(DEBUG_DRAW_CALLS)
-    int n = 9;
+    int n = 14;
 #endif
 #ifdef DEBUG_OPENGL_LEAKS
     mTexturesLabel = new Label(this, strprintf("%s %s",
@@ -286,6 +312,37 @@ void MapDebugTab::logic()
                 // TRANSLATORS: debug window label
                 strprintf("%s %d", _("Map actors count:"),
                 map->getActorsCount()));
+            if (windowContainer)
+            {
+                mWindowsLabel->setCaption(strprintf(
+                    // TRANSLATORS: debug window label
+                    _("Windows drawn: %d, culled: %d"),
+                    windowContainer->getDrawnWindows(),
+                    windowContainer->getCulledWindows()));
+            }
+            const FrameTimes &times = frameScheduler.getTimes();
+            mFrameTimeLabel->setCaption(strprintf(
+                // TRANSLATORS: debug window label
+                _("Frame ms: logic %d, slow %d, draw %d, idle %d"),
+                times.logic, times.slowLogic, times.draw, times.idle));
+            mFrameSkipLabel->setCaption(strprintf(
+                // TRANSLATORS: debug window label
+                _("Skipped frames: %d, dropped ticks: %d"),
+                times.skipped, times.dropped));
+            if (pathSolver)
+            {
+                mPathSolverLabel->setCaption(strprintf(
+                    // TRANSLATORS: debug window label
+                    _("Paths: %d/s, latency %d ms, queue %d"),
+                    pathSolver->getSolvesPerSecond(),
+                    pathSolver->getLatency(),
+                    pathSolver->getQueueSize()));
+            }
+            mFontCacheLabel->setCaption(strprintf(
+                // TRANSLATORS: debug window label
+                _("Font cache: %d KB, hits %u, misses %u, evicted %u"),
+                textChunkCache.getMemory() / 1024, textChunkCache.getHits(),
+                textChunkCache.getMisses(), textChunkCache.getEvictions()));
 #ifdef USE_OPENGL
 #ifdef DEBUG_OPENGL_LEAKS
             mTexturesLabel->setCaption(strprintf("%s %d",
@@ -321,6 +378,7 @@ void MapDebugTab::logic()
 
     mMapActorCountLabel->adjustSize();
     mParticleCountLabel->adjustSize();
+    mWindowsLabel->adjustSize();
 
     mFPSLabel->setCaption(strprintf(mFPSText.c_str(), fps));
     // TRANSLATORS: debug window label, logic per second
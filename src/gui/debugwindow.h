@@ -70,6 +70,11 @@ class MapDebugTab final : public DebugTab
         Label *mParticleCountLabel;
         Label *mMapActorCountLabel;
         Label *mXYLabel;
+        Label *mWindowsLabel;
+        Label *mFrameTimeLabel;
+        Label *mFrameSkipLabel;
+        Label *mPathSolverLabel;
+        Label *mFontCacheLabel;
         Label *mTexturesLabel;
         int mUpdateTime;
 #ifdef DEBUG_DRAW_CALLS
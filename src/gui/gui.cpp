@@ -24,8 +24,10 @@
 
 #include "gui/focushandler.h"
 #include "gui/palette.h"
+#include "gui/perfoverlay.h"
 #include "gui/sdlfont.h"
 #include "gui/sdlinput.h"
+#include "gui/textlayoutcache.h"
 #include "gui/theme.h"
 #include "gui/viewport.h"
 
@@ -33,6 +35,7 @@
 #include "gui/widgets/window.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "keydata.h"
 #include "keyevent.h"
 #include "keyinput.h"
@@ -424,8 +427,13 @@ void Gui::draw()
 {
     BLOCK_START("Gui::draw 1")
     mGraphics->pushClipArea(getTop()->getDimension());
-    getTop()->draw(mGraphics);
+    {
+        BUDGET_BLOCK(ZONE_GUI)
+        getTop()->draw(mGraphics);
+    }
     touchManager.draw();
+    if (perfOverlay.isVisible())
+        perfOverlay.draw(static_cast<Graphics*>(mGraphics), mGuiFont);
 
     int mouseX, mouseY;
     const uint8_t button = SDL_GetMouseState(&mouseX, &mouseY);
@@ -531,6 +539,8 @@ void Gui::updateFonts()
         fontFile = branding.getStringValue("npcFont");
 
     mNpcFont->loadFont(fontFile, npcFontSize);
+
+    textLayoutCache.clear();
 }
 
 void Gui::distributeMouseEvent(gcn::Widget* source, int type, int button,
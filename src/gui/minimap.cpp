@@ -25,6 +25,7 @@
 #include "actorspritemanager.h"
 #include "client.h"
 #include "configuration.h"
+#include "framebudget.h"
 #include "localplayer.h"
 #include "party.h"
 
@@ -124,6 +125,7 @@ void Minimap::setMap(const Map *const map)
     {
         if (config.getBoolValue("showExtMinimaps"))
         {
+            FrameBudget::count(FrameBudget::COUNTER_SURFACES);
             SDL_Surface *const surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
                 map->getWidth(), map->getHeight(), 32,
                 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000);
@@ -148,7 +150,7 @@ void Minimap::setMap(const Map *const map)
                 | Map::BLOCKMASK_WATER);
 
             for (int ptr = 0; ptr < size; ptr ++)
-                *(data ++) = -!(map->mMetaTiles[ptr].blockmask & mask);
+                *(data ++) = -!(map->mBlockmasks[ptr] & mask);
 
             SDL_UnlockSurface(surface);
 
@@ -37,6 +37,7 @@
 
 const gcn::Color Palette::BLACK = gcn::Color(0, 0, 0);
 Palette::Palettes Palette::mInstances;
+Palette::GradientTables Palette::mGradientTables;
 
 const gcn::Color Palette::RAINBOW_COLORS[7] =
 {
@@ -98,116 +99,151 @@ void Palette::advanceGradients()
         (*it)->advanceGradient();
 }
 
+int Palette::getGradientPhase(const gcn::Color *const color)
+{
+    FOR_EACH (Palettes::const_iterator, it, mInstances)
+    {
+        const std::vector<ColorElem*> &grads = (*it)->mGradVector;
+        FOR_EACH (std::vector<ColorElem*>::const_iterator, it2, grads)
+        {
+            const ColorElem *const elem = *it2;
+            if (elem && &elem->color == color)
+                return elem->grad != STATIC ? elem->gradientIndex : -1;
+        }
+    }
+    return -1;
+}
+
+static int getGradientColorsCount(const Palette::GradientType grad)
+{
+    return grad == Palette::SPECTRUM ? 6 : grad == Palette::PULSE ? 127 : 7;
+}
+
+const Palette::GradientTable &Palette::getGradientTable(
+    const GradientType grad, const int delay)
+{
+    const int key = delay * 4 + static_cast<int>(grad);
+    const GradientTables::const_iterator it = mGradientTables.find(key);
+    if (it != mGradientTables.end())
+        return (*it).second;
+
+    GradientTable &table = mGradientTables[key];
+    calcGradientTable(table, grad, delay);
+    return table;
+}
+
+void Palette::calcGradientTable(GradientTable &table,
+                                const GradientType grad,
+                                const int delay)
+{
+    const int numOfColors = getGradientColorsCount(grad);
+    const int size = delay * numOfColors;
+    table.resize(size);
+
+    for (int f = 0; f < size; f ++)
+    {
+        const int pos = f % delay;
+        const int colIndex = f / delay;
+        gcn::Color &color = table[f];
+        int colVal;
+
+        if (grad == PULSE)
+        {
+            // only intensity, it scaled by pulse color later
+            colVal = static_cast<int>(255.0 *
+                sin(M_PI * colIndex / numOfColors));
+            color.r = colVal;
+            color.g = colVal;
+            color.b = colVal;
+        }
+        else if (grad == SPECTRUM)
+        {
+            if (colIndex % 2)
+            {   // falling curve
+                colVal = static_cast<int>(255.0 *
+                     (cos(M_PI * pos / delay) + 1) / 2);
+            }
+            else
+            {   // ascending curve
+                colVal = static_cast<int>(255.0 * (cos(M_PI *
+                    (delay - pos) / delay) + 1) / 2);
+            }
+
+            color.r = (colIndex == 0 || colIndex == 5) ? 255 :
+                (colIndex == 1 || colIndex == 4) ? colVal : 0;
+            color.g = (colIndex == 1 || colIndex == 2) ? 255 :
+                (colIndex == 0 || colIndex == 3) ? colVal : 0;
+            color.b = (colIndex == 3 || colIndex == 4) ? 255 :
+                (colIndex == 2 || colIndex == 5) ? colVal : 0;
+        }
+        else if (grad == RAINBOW)
+        {
+            const gcn::Color &startCol = RAINBOW_COLORS[colIndex];
+            const gcn::Color &destCol =
+                RAINBOW_COLORS[(colIndex + 1) % numOfColors];
+
+            const double startColVal = (cos(M_PI * pos / delay) + 1) / 2;
+            const double destColVal = 1 - startColVal;
+
+            color.r = static_cast<int>(startColVal
+                * startCol.r + destColVal * destCol.r);
+
+            color.g = static_cast<int>(startColVal
+                * startCol.g + destColVal * destCol.g);
+
+            color.b = static_cast<int>(startColVal
+                * startCol.b + destColVal * destCol.b);
+        }
+    }
+}
+
 void Palette::advanceGradient()
 {
     if (get_elapsed_time(mRainbowTime) > 5)
     {
-        int pos, colIndex, colVal, delay, numOfColors;
         // For slower systems, advance can be greater than one (advance > 1
         // skips advance-1 steps). Should make gradient look the same
         // independent of the framerate.
         const int advance = get_elapsed_time(mRainbowTime) / 5;
-        double startColVal, destColVal;
+        if (!advance)
+            return;
 
         for (size_t i = 0, sz = mGradVector.size(); i < sz; i++)
         {
-            if (!mGradVector[i])
+            ColorElem *const elem = mGradVector[i];
+            if (!elem || elem->grad == STATIC)
                 continue;
 
-            delay = mGradVector[i]->delay;
-
-            if (mGradVector[i]->grad == PULSE)
+            int delay = elem->delay;
+            if (elem->grad == PULSE)
                 delay = delay / 20;
+            if (delay < 1)
+                delay = 1;
 
-            numOfColors = (mGradVector[i]->grad == SPECTRUM ? 6 :
-                           mGradVector[i]->grad == PULSE ? 127 :
-                           RAINBOW_COLOR_COUNT);
-
-            mGradVector[i]->gradientIndex =
-                                    (mGradVector[i]->gradientIndex + advance) %
-                                    (delay * numOfColors);
+            const GradientTable &table = getGradientTable(elem->grad, delay);
+            const int size = static_cast<int>(table.size());
+            elem->gradientIndex = (elem->gradientIndex + advance) % size;
 
-            pos = mGradVector[i]->gradientIndex % delay;
-            if (delay)
-                colIndex = mGradVector[i]->gradientIndex / delay;
-            else
-                colIndex = mGradVector[i]->gradientIndex;
-
-            ColorElem *const elem = mGradVector[i];
+            const gcn::Color &tableColor = table[elem->gradientIndex];
             gcn::Color &color = elem->color;
 
             if (elem->grad == PULSE)
             {
-                colVal = static_cast<int>(255.0 *
-                        sin(M_PI * colIndex / numOfColors));
-
+                const int colVal = tableColor.r;
                 const gcn::Color &col = elem->testColor;
 
                 color.r = ((colVal * col.r) / 255) % (col.r + 1);
                 color.g = ((colVal * col.g) / 255) % (col.g + 1);
                 color.b = ((colVal * col.b) / 255) % (col.b + 1);
             }
-            if (elem->grad == SPECTRUM)
-            {
-                if (colIndex % 2)
-                { // falling curve
-                    if (delay)
-                    {
-                        colVal = static_cast<int>(255.0 *
-                             (cos(M_PI * pos / delay) + 1) / 2);
-                    }
-                    else
-                    {
-                        colVal = static_cast<int>(255.0 *
-                             (cos(M_PI * pos) + 1) / 2);
-                    }
-                }
-                else
-                { // ascending curve
-                    if (delay)
-                    {
-                        colVal = static_cast<int>(255.0 * (cos(M_PI *
-                            (delay - pos) / delay) + 1) / 2);
-                    }
-                    else
-                    {
-                        colVal = static_cast<int>(255.0 * (cos(M_PI *
-                            (delay - pos)) + 1) / 2);
-                    }
-                }
-
-                color.r = (colIndex == 0 || colIndex == 5) ? 255 :
-                    (colIndex == 1 || colIndex == 4) ? colVal : 0;
-                color.g = (colIndex == 1 || colIndex == 2) ? 255 :
-                    (colIndex == 0 || colIndex == 3) ? colVal : 0;
-                color.b = (colIndex == 3 || colIndex == 4) ? 255 :
-                    (colIndex == 2 || colIndex == 5) ? colVal : 0;
-            }
-            else if (elem->grad == RAINBOW)
+            else
             {
-                const gcn::Color &startCol = RAINBOW_COLORS[colIndex];
-                const gcn::Color &destCol =
-                        RAINBOW_COLORS[(colIndex + 1) % numOfColors];
-
-                if (delay)
-                    startColVal = (cos(M_PI * pos / delay) + 1) / 2;
-                else
-                    startColVal = 0;
-
-                destColVal = 1 - startColVal;
-
-                color.r = static_cast<int>(startColVal
-                    * startCol.r + destColVal * destCol.r);
-
-                color.g = static_cast<int>(startColVal
-                    * startCol.g + destColVal * destCol.g);
-
-                color.b = static_cast<int>(startColVal
-                    * startCol.b + destColVal * destCol.b);
+                color.r = tableColor.r;
+                color.g = tableColor.g;
+                color.b = tableColor.b;
             }
         }
 
-        if (advance)
-            mRainbowTime = tick_time;
+        mRainbowTime = tick_time;
     }
 }
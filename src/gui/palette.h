@@ -140,6 +140,13 @@ class Palette
         static gcn::Color produceHPColor(int hp, int maxHp,
                                          int alpha = 255) A_WARN_UNUSED;
 
+        /**
+         * Returns current gradient phase of animated palette color, or -1
+         * if color is static. Color must be one returned by getColor.
+         */
+        static int getGradientPhase(const gcn::Color *const color)
+                                    A_WARN_UNUSED;
+
     protected:
         /** Colors used for the rainbow gradient */
         static const gcn::Color RAINBOW_COLORS[];
@@ -151,6 +158,19 @@ class Palette
         typedef std::set<Palette*> Palettes;
         static Palettes mInstances;
 
+        /** Precomputed colors for each gradient type and delay. */
+        typedef std::vector<gcn::Color> GradientTable;
+        typedef std::map<int, GradientTable> GradientTables;
+        static GradientTables mGradientTables;
+
+        static const GradientTable &getGradientTable(const GradientType grad,
+                                                     const int delay)
+                                                     A_WARN_UNUSED;
+
+        static void calcGradientTable(GradientTable &table,
+                                      const GradientType grad,
+                                      const int delay);
+
         /**
          * Constructor
          */
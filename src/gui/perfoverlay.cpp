@@ -0,0 +1,258 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui/perfoverlay.h"
+
+#include "graphics.h"
+
+#include "gui/sdlfont.h"
+
+#include "resources/resourcemanager.h"
+
+#include "utils/gettext.h"
+#include "utils/stringutils.h"
+
+#include <SDL_timer.h>
+
+#include <algorithm>
+
+#include "debug.h"
+
+PerfOverlay perfOverlay;
+
+static const int padding = 4;
+static const int columnWidth = 2;
+static const int graphWidth = FrameBudget::historySize * columnWidth;
+static const int graphHeight = 64;
+// graph height in microseconds, two frames at 60 fps
+static const int graphScale = 33333;
+static const int frameBudget = 16667;
+static const unsigned int updateDelay = 500;
+
+static const gcn::Color zoneColors[FrameBudget::ZONE_COUNT] =
+{
+    gcn::Color(80, 160, 255, 255),   // ZONE_MAP
+    gcn::Color(80, 220, 80, 255),    // ZONE_FRINGE
+    gcn::Color(255, 160, 40, 255),   // ZONE_PARTICLES
+    gcn::Color(240, 240, 80, 255),   // ZONE_TEXT
+    gcn::Color(200, 100, 255, 255),  // ZONE_GUI
+    gcn::Color(255, 80, 80, 255),    // ZONE_NETWORK
+    gcn::Color(80, 230, 230, 255)    // ZONE_RESOURCES
+};
+static const gcn::Color otherColor(128, 128, 128, 255);
+
+PerfOverlay::PerfOverlay() :
+    mLines(),
+    mFontMisses(0),
+    mFrames(0),
+    mUpdateTime(0)
+{
+    for (int f = 0; f < FrameBudget::COUNTER_COUNT; f ++)
+        mCounters[f] = 0;
+}
+
+void PerfOverlay::toggle()
+{
+    FrameBudget::setEnabled(!FrameBudget::enabled);
+    if (!FrameBudget::enabled)
+        return;
+
+    for (int f = 0; f < FrameBudget::COUNTER_COUNT; f ++)
+        mCounters[f] = FrameBudget::counters[f];
+    mFontMisses = textChunkCache.getMisses();
+    mFrames = 0;
+    mUpdateTime = 0;
+    mLines.clear();
+}
+
+void PerfOverlay::updateText()
+{
+    static const char *const zoneNames[FrameBudget::ZONE_COUNT] =
+    {
+        // TRANSLATORS: performance overlay label
+        N_("Map layers"),
+        // TRANSLATORS: performance overlay label
+        N_("Fringe and actors"),
+        // TRANSLATORS: performance overlay label
+        N_("Particles"),
+        // TRANSLATORS: performance overlay label
+        N_("Text"),
+        // TRANSLATORS: performance overlay label
+        N_("GUI"),
+        // TRANSLATORS: performance overlay label
+        N_("Network"),
+        // TRANSLATORS: performance overlay label
+        N_("Resource loading")
+    };
+
+    const int frames = std::min(FrameBudget::getFrames(),
+        FrameBudget::historySize);
+    int zoneSums[FrameBudget::ZONE_COUNT];
+    for (int f = 0; f < FrameBudget::ZONE_COUNT; f ++)
+        zoneSums[f] = 0;
+    int frameSum = 0;
+    int frameMax = 0;
+    for (int f = 0; f < frames; f ++)
+    {
+        const int time = FrameBudget::getFrameTime(f);
+        frameSum += time;
+        if (time > frameMax)
+            frameMax = time;
+        for (int i = 0; i < FrameBudget::ZONE_COUNT; i ++)
+            zoneSums[i] += FrameBudget::getZoneTime(f, i);
+    }
+    const float div = frames ? 1000.0f * frames : 1.0f;
+
+    mLines.clear();
+    mLines.push_back(strprintf(
+        // TRANSLATORS: performance overlay label
+        _("Frame: %.2f ms, max %.2f ms"),
+        static_cast<float>(frameSum) / div,
+        static_cast<float>(frameMax) / 1000.0f));
+    int other = frameSum;
+    for (int f = 0; f < FrameBudget::ZONE_COUNT; f ++)
+    {
+        mLines.push_back(strprintf("%s: %.2f ms", gettext(zoneNames[f]),
+            static_cast<float>(zoneSums[f]) / div));
+        other -= zoneSums[f];
+    }
+    mLines.push_back(strprintf("%s: %.2f ms",
+        // TRANSLATORS: performance overlay label
+        _("Other and idle"), static_cast<float>(other) / div));
+
+    // counters are shown as averages per frame since last update
+    const int newFrames = FrameBudget::getFrames() - mFrames;
+    const float counterDiv = newFrames > 0
+        ? static_cast<float>(newFrames) : 1.0f;
+    mFrames = FrameBudget::getFrames();
+#ifdef DEBUG_DRAW_CALLS
+    if (mainGraphics)
+    {
+        mLines.push_back(strprintf("%s %u",
+            // TRANSLATORS: performance overlay label
+            _("Draw calls:"), mainGraphics->getDrawCalls()));
+    }
+#endif
+    // unsigned difference stays right when counter wraps
+    const unsigned int binds = FrameBudget::counters[
+        FrameBudget::COUNTER_TEXTURE_BINDS]
+        - mCounters[FrameBudget::COUNTER_TEXTURE_BINDS];
+    mLines.push_back(strprintf("%s %.1f",
+        // TRANSLATORS: performance overlay label
+        _("Texture binds:"), static_cast<float>(binds) / counterDiv));
+    const unsigned int surfaces = FrameBudget::counters[
+        FrameBudget::COUNTER_SURFACES]
+        - mCounters[FrameBudget::COUNTER_SURFACES];
+    mLines.push_back(strprintf("%s %.1f",
+        // TRANSLATORS: performance overlay label
+        _("Surfaces allocated:"), static_cast<float>(surfaces) / counterDiv));
+    for (int f = 0; f < FrameBudget::COUNTER_COUNT; f ++)
+        mCounters[f] = FrameBudget::counters[f];
+    const unsigned int misses = textChunkCache.getMisses();
+    mLines.push_back(strprintf("%s %.1f",
+        // TRANSLATORS: performance overlay label
+        _("Font cache misses:"),
+        static_cast<float>(misses - mFontMisses) / counterDiv));
+    mFontMisses = misses;
+    const ResourceManager *const resman = ResourceManager::getInstance();
+    mLines.push_back(strprintf("%s %d",
+        // TRANSLATORS: performance overlay label
+        _("Cached resources:"), resman ? resman->size() : 0));
+}
+
+void PerfOverlay::draw(Graphics *const graphics, gcn::Font *const font)
+{
+    if (!FrameBudget::enabled || !graphics || !font)
+        return;
+
+    const unsigned int now = SDL_GetTicks();
+    if (mLines.empty() || now - mUpdateTime >= updateDelay)
+    {
+        mUpdateTime = now;
+        updateText();
+    }
+
+    const int lineHeight = font->getHeight();
+    const int width = graphWidth + 2 * padding;
+    const int height = graphHeight + 3 * padding
+        + lineHeight * static_cast<int>(mLines.size());
+    const int x = graphics->mWidth - width - padding;
+    const int y = padding;
+
+    graphics->setColor(gcn::Color(0, 0, 0, 160));
+    graphics->fillRectangle(gcn::Rectangle(x, y, width, height));
+
+    // one column per frame, newest on the right
+    const int top = y + padding;
+    const int bottom = top + graphHeight;
+    const int frames = std::min(FrameBudget::getFrames(),
+        FrameBudget::historySize);
+    for (int f = 0; f < frames; f ++)
+    {
+        const int columnX = x + padding + graphWidth - (f + 1) * columnWidth;
+        int columnY = bottom;
+        int used = 0;
+        for (int i = 0; i <= FrameBudget::ZONE_COUNT; i ++)
+        {
+            int time;
+            if (i < FrameBudget::ZONE_COUNT)
+            {
+                time = FrameBudget::getZoneTime(f, i);
+                used += time;
+                graphics->setColor(zoneColors[i]);
+            }
+            else
+            {
+                time = FrameBudget::getFrameTime(f) - used;
+                graphics->setColor(otherColor);
+            }
+            const int h = std::min(time * graphHeight / graphScale,
+                columnY - top);
+            if (h <= 0)
+                continue;
+            columnY -= h;
+            graphics->fillRectangle(gcn::Rectangle(columnX, columnY,
+                columnWidth, h));
+        }
+    }
+    graphics->setColor(gcn::Color(255, 255, 255, 160));
+    graphics->fillRectangle(gcn::Rectangle(x + padding,
+        bottom - frameBudget * graphHeight / graphScale, graphWidth, 1));
+
+    const int boxSize = lineHeight / 2;
+    const int textX = x + padding + boxSize + padding;
+    int textY = bottom + padding;
+    int n = 0;
+    FOR_EACH (std::vector<std::string>::const_iterator, it, mLines)
+    {
+        // zone lines follow frame time line
+        if (n >= 1 && n <= FrameBudget::ZONE_COUNT)
+        {
+            graphics->setColor(zoneColors[n - 1]);
+            graphics->fillRectangle(gcn::Rectangle(x + padding,
+                textY + (lineHeight - boxSize) / 2, boxSize, boxSize));
+        }
+        graphics->setColor(gcn::Color(255, 255, 255, 255));
+        graphics->setColor2(gcn::Color(0, 0, 0, 255));
+        font->drawString(graphics, *it, textX, textY);
+        textY += lineHeight;
+        n ++;
+    }
+}
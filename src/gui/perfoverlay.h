@@ -0,0 +1,69 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GUI_PERFOVERLAY_H
+#define GUI_PERFOVERLAY_H
+
+#include "framebudget.h"
+
+#include <string>
+#include <vector>
+
+#include "localconsts.h"
+
+class Graphics;
+
+namespace gcn
+{
+    class Font;
+}
+
+/**
+ * Performance overlay drawn over all windows. Shows graph of last frame
+ * times split by subsystem, average subsystem times and per frame
+ * counters. Frame budget is recorded only while the overlay is shown.
+ */
+class PerfOverlay final
+{
+    public:
+        PerfOverlay();
+
+        A_DELETE_COPY(PerfOverlay)
+
+        void toggle();
+
+        bool isVisible() const A_WARN_UNUSED
+        { return FrameBudget::enabled; }
+
+        void draw(Graphics *const graphics, gcn::Font *const font);
+
+    private:
+        void updateText();
+
+        std::vector<std::string> mLines;
+        unsigned int mCounters[FrameBudget::COUNTER_COUNT];
+        unsigned int mFontMisses;
+        int mFrames;
+        unsigned int mUpdateTime;
+};
+
+extern PerfOverlay perfOverlay;
+
+#endif  // GUI_PERFOVERLAY_H
@@ -24,11 +24,15 @@
 #include "gui/sdlfont.h"
 
 #include "client.h"
+#include "configuration.h"
+#include "framebudget.h"
 #include "graphics.h"
 #include "logger.h"
 #include "main.h"
 #include "utils/paths.h"
 
+#include "gui/textlayoutcache.h"
+
 #include "resources/image.h"
 #include "resources/imagehelper.h"
 #include "resources/resourcemanager.h"
@@ -37,64 +41,24 @@
 
 #include "debug.h"
 
-const unsigned int CACHE_SIZE = 256;
-const unsigned int CACHE_SIZE_SMALL1 = 2;
-const unsigned int CACHE_SIZE_SMALL2 = 50;
-const unsigned int CACHE_SIZE_SMALL3 = 170;
 const unsigned int CLEAN_TIME = 7;
 const int OUTLINE_SIZE = 1;
+// used when fontCacheSize is not set
+const int DEFAULT_CACHE_BUDGET = 4 * 1024 * 1024;
+const size_t MIN_CACHE_CAPACITY = 1024;
 
 char *strBuf;
 
+TextChunkCache textChunkCache;
+
+// marks deleted slot in hash table
+static char deletedChunk;
+#define DELETED_CHUNK reinterpret_cast<SDLTextChunk*>(&deletedChunk)
+
 #ifdef UNITTESTS
 int sdlTextChunkCnt = 0;
 #endif
 
-SDLTextChunkSmall::SDLTextChunkSmall(const std::string &text0,
-                                     const gcn::Color &color0,
-                                     const gcn::Color &color1) :
-    text(text0),
-    color(color0),
-    color2(color1)
-{
-}
-
-SDLTextChunkSmall::SDLTextChunkSmall(const SDLTextChunkSmall &old) :
-    text(old.text),
-    color(old.color),
-    color2(old.color2)
-{
-}
-
-bool SDLTextChunkSmall::operator==(const SDLTextChunkSmall &chunk) const
-{
-    return (chunk.text == text && chunk.color == color
-            && chunk.color2 == color2);
-}
-
-bool SDLTextChunkSmall::operator<(const SDLTextChunkSmall &chunk) const
-{
-    if (chunk.text != text)
-        return chunk.text > text;
-
-    const gcn::Color &c = chunk.color;
-    if (c.r != color.r)
-        return c.r > color.r;
-    if (c.g != color.g)
-        return c.g > color.g;
-    if (c.b != color.b)
-        return c.b > color.b;
-
-    const gcn::Color &c2 = chunk.color2;
-    if (c2.r != color2.r)
-        return c2.r > color2.r;
-    if (c2.g != color2.g)
-        return c2.g > color2.g;
-    if (c2.b != color2.b)
-        return c2.b > color2.b;
-    return false;
-}
-
 SDLTextChunk::SDLTextChunk(const std::string &text0, const gcn::Color &color0,
                            const gcn::Color &color1) :
     img(nullptr),
@@ -102,7 +66,10 @@ SDLTextChunk::SDLTextChunk(const std::string &text0, const gcn::Color &color0,
     color(color0),
     color2(color1),
     prev(nullptr),
-    next(nullptr)
+    next(nullptr),
+    font(nullptr),
+    hash(0),
+    memory(0)
 {
 #ifdef UNITTESTS
     sdlTextChunkCnt ++;
@@ -135,6 +102,7 @@ void SDLTextChunk::generate(TTF_Font *const font, const float alpha)
 
     getSafeUtf8String(text, strBuf);
 
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     SDL_Surface *surface = TTF_RenderUTF8_Blended(
         font, strBuf, sdlCol);
 
@@ -165,6 +133,7 @@ void SDLTextChunk::generate(TTF_Font *const font, const float alpha)
         sdlCol2.r = static_cast<uint8_t>(color2.r);
         sdlCol2.g = static_cast<uint8_t>(color2.g);
         sdlCol2.unused = 0;
+        FrameBudget::count(FrameBudget::COUNTER_SURFACES);
         SDL_Surface *const surface2 = TTF_RenderUTF8_Blended(
             font, strBuf, sdlCol2);
         if (!surface2)
@@ -206,119 +175,239 @@ void SDLTextChunk::generate(TTF_Font *const font, const float alpha)
 }
 
 
-TextChunkList::TextChunkList() :
-    start(nullptr),
-    end(nullptr),
-    size(0),
-    search(),
-    searchWidth()
+static bool sameColor(const gcn::Color &c1, const gcn::Color &c2)
 {
+    return c1.r == c2.r && c1.g == c2.g && c1.b == c2.b;
 }
 
-void TextChunkList::insertFirst(SDLTextChunk *const item)
+TextChunkCache::TextChunkCache() :
+    mTable(),
+    mStart(nullptr),
+    mEnd(nullptr),
+    mSize(0),
+    mUsed(0),
+    mMemory(0),
+    mBudget(DEFAULT_CACHE_BUDGET),
+    mHits(0),
+    mMisses(0),
+    mEvictions(0)
 {
-    SDLTextChunk *const oldFirst = start;
-    if (start)
-        start->prev = item;
-    item->prev = nullptr;
-    if (oldFirst)
-        item->next = oldFirst;
-    else
-        end = item;
-    start = item;
-    size ++;
-    search[SDLTextChunkSmall(item->text, item->color, item->color2)] = item;
-    searchWidth[item->text] = item;
 }
 
-void TextChunkList::moveToFirst(SDLTextChunk *item)
+TextChunkCache::~TextChunkCache()
 {
-    if (item == start)
-        return;
+    clear();
+}
 
-    SDLTextChunk *oldPrev = item->prev;
-    if (oldPrev)
-        oldPrev->next = item->next;
-    SDLTextChunk *oldNext = item->next;
-    if (oldNext)
-        oldNext->prev = item->prev;
-    else
-        end = oldPrev;
-    SDLTextChunk *const oldFirst = start;
-    if (start)
-        start->prev = item;
-    item->prev = nullptr;
-    item->next = oldFirst;
-    start = item;
+unsigned int TextChunkCache::getHash(const SDLFont *const font,
+                                     const std::string &text)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261U
+        ^ static_cast<unsigned int>(reinterpret_cast<size_t>(font) >> 4);
+    const size_t sz = text.size();
+    for (size_t f = 0; f < sz; f ++)
+    {
+        hash ^= static_cast<unsigned char>(text[f]);
+        hash *= 16777619U;
+    }
+    return hash;
 }
 
-void TextChunkList::removeBack()
+SDLTextChunk *TextChunkCache::findSlot(const SDLFont *const font,
+                                       const std::string &text,
+                                       const gcn::Color *const color,
+                                       const gcn::Color *const color2) const
 {
-    SDLTextChunk *oldEnd = end;
-    if (oldEnd)
+    if (!mSize)
+        return nullptr;
+
+    const unsigned int hash = getHash(font, text);
+    const size_t mask = mTable.size() - 1;
+    for (size_t pos = hash & mask; ; pos = (pos + 1) & mask)
     {
-        end = oldEnd->prev;
-        if (end)
-            end->next = nullptr;
-        else
-            start = nullptr;
-        search.erase(SDLTextChunkSmall(oldEnd->text,
-            oldEnd->color, oldEnd->color2));
-        searchWidth.erase(oldEnd->text);
-        delete oldEnd;
-        size --;
+        SDLTextChunk *const chunk = mTable[pos];
+        if (!chunk)
+            return nullptr;
+        if (chunk != DELETED_CHUNK && chunk->hash == hash
+            && chunk->font == font && chunk->text == text
+            && (!color || (sameColor(chunk->color, *color)
+            && sameColor(chunk->color2, *color2))))
+        {
+            return chunk;
+        }
+    }
+}
+
+SDLTextChunk *TextChunkCache::find(const SDLFont *const font,
+                                   const std::string &text,
+                                   const gcn::Color &color,
+                                   const gcn::Color &color2)
+{
+    SDLTextChunk *const chunk = findSlot(font, text, &color, &color2);
+    if (!chunk)
+    {
+        mMisses ++;
+        return nullptr;
     }
+    mHits ++;
+    moveToFirst(chunk);
+    return chunk;
 }
 
-void TextChunkList::removeBack(int n)
+SDLTextChunk *TextChunkCache::findText(const SDLFont *const font,
+                                       const std::string &text)
 {
-    SDLTextChunk *item = end;
-    while (n && item)
+    SDLTextChunk *const chunk = findSlot(font, text, nullptr, nullptr);
+    if (chunk)
+        moveToFirst(chunk);
+    return chunk;
+}
+
+void TextChunkCache::insert(SDLTextChunk *const chunk,
+                            const SDLFont *const font)
+{
+    // load factor is kept under one half for short probe sequences
+    if ((mUsed + 1) * 2 > mTable.size())
     {
-        n --;
-        SDLTextChunk *oldEnd = item;
-        item = item->prev;
-        search.erase(SDLTextChunkSmall(oldEnd->text,
-            oldEnd->color, oldEnd->color2));
-        searchWidth.erase(oldEnd->text);
-        delete oldEnd;
-        size --;
+        size_t capacity = MIN_CACHE_CAPACITY;
+        while (capacity < (mSize + 1) * 4)
+            capacity *= 2;
+        rehash(capacity);
     }
-    if (item)
+
+    chunk->font = font;
+    chunk->hash = getHash(font, chunk->text);
+    chunk->memory = static_cast<int>(sizeof(SDLTextChunk)
+        + chunk->text.size());
+    if (chunk->img)
     {
-        item->next = nullptr;
-        end = item;
+        chunk->memory += chunk->img->getWidth()
+            * chunk->img->getHeight() * 4;
     }
+
+    const size_t mask = mTable.size() - 1;
+    size_t pos = chunk->hash & mask;
+    while (mTable[pos] && mTable[pos] != DELETED_CHUNK)
+        pos = (pos + 1) & mask;
+    if (!mTable[pos])
+        mUsed ++;
+    mTable[pos] = chunk;
+
+    chunk->prev = nullptr;
+    chunk->next = mStart;
+    if (mStart)
+        mStart->prev = chunk;
+    else
+        mEnd = chunk;
+    mStart = chunk;
+    mSize ++;
+    mMemory += chunk->memory;
+
+    while (mMemory > mBudget && mEnd != chunk)
+    {
+        mEvictions ++;
+        remove(mEnd);
+    }
+}
+
+void TextChunkCache::moveToFirst(SDLTextChunk *const chunk)
+{
+    if (chunk == mStart)
+        return;
+
+    chunk->prev->next = chunk->next;
+    if (chunk->next)
+        chunk->next->prev = chunk->prev;
     else
+        mEnd = chunk->prev;
+    chunk->prev = nullptr;
+    chunk->next = mStart;
+    mStart->prev = chunk;
+    mStart = chunk;
+}
+
+void TextChunkCache::remove(SDLTextChunk *const chunk)
+{
+    const size_t mask = mTable.size() - 1;
+    size_t pos = chunk->hash & mask;
+    while (mTable[pos] != chunk)
+        pos = (pos + 1) & mask;
+    mTable[pos] = DELETED_CHUNK;
+
+    if (chunk->prev)
+        chunk->prev->next = chunk->next;
+    else
+        mStart = chunk->next;
+    if (chunk->next)
+        chunk->next->prev = chunk->prev;
+    else
+        mEnd = chunk->prev;
+
+    mSize --;
+    mMemory -= chunk->memory;
+    delete chunk;
+}
+
+void TextChunkCache::rehash(const size_t capacity)
+{
+    mTable.assign(capacity, nullptr);
+    const size_t mask = capacity - 1;
+    for (SDLTextChunk *chunk = mStart; chunk; chunk = chunk->next)
+    {
+        size_t pos = chunk->hash & mask;
+        while (mTable[pos])
+            pos = (pos + 1) & mask;
+        mTable[pos] = chunk;
+    }
+    mUsed = mSize;
+}
+
+void TextChunkCache::removeFont(const SDLFont *const font)
+{
+    SDLTextChunk *chunk = mStart;
+    while (chunk)
+    {
+        SDLTextChunk *const next = chunk->next;
+        if (chunk->font == font)
+            remove(chunk);
+        chunk = next;
+    }
+}
+
+void TextChunkCache::clear()
+{
+    SDLTextChunk *chunk = mStart;
+    while (chunk)
     {
-        start = nullptr;
-        end = nullptr;
+        SDLTextChunk *const next = chunk->next;
+        delete chunk;
+        chunk = next;
     }
+    mTable.clear();
+    mStart = nullptr;
+    mEnd = nullptr;
+    mSize = 0;
+    mUsed = 0;
+    mMemory = 0;
 }
 
-void TextChunkList::clear()
+void TextChunkCache::setBudget(const int budget)
 {
-    search.clear();
-    searchWidth.clear();
-    SDLTextChunk *item = start;
-    while (item)
+    mBudget = budget;
+    while (mMemory > mBudget && mEnd)
     {
-        SDLTextChunk *item2 = item->next;
-        delete item;
-        item = item2;
+        mEvictions ++;
+        remove(mEnd);
     }
-    start = nullptr;
-    end = nullptr;
-    size = 0;
 }
 
 static int fontCounter;
 
 SDLFont::SDLFont(std::string filename, const int size, const int style) :
     mFont(nullptr),
-    mCreateCounter(0),
-    mDeleteCounter(0),
-    mCleanTime(cur_time + CLEAN_TIME)
+    mCleanTime(cur_time + CLEAN_TIME),
+    mGradientCache()
 {
     const ResourceManager *const resman = ResourceManager::getInstance();
 
@@ -332,6 +421,9 @@ SDLFont::SDLFont(std::string filename, const int size, const int style) :
     {
         strBuf = new char[65535];
         memset(strBuf, 0, 65535);
+        const int budget = config.getIntValue("fontCacheSize");
+        if (budget > 0)
+            textChunkCache.setBudget(budget * 1024 * 1024);
     }
 
     ++fontCounter;
@@ -361,6 +453,8 @@ SDLFont::~SDLFont()
     mFont = nullptr;
     --fontCounter;
     clear();
+    // other font can be created at same address
+    textLayoutCache.clear();
 
     if (fontCounter == 0)
     {
@@ -401,8 +495,62 @@ void SDLFont::loadFont(std::string filename, const int size, const int style)
 
 void SDLFont::clear()
 {
-    for (size_t f = 0; f < CACHES_NUMBER; f ++)
-        mCache[f].clear();
+    textChunkCache.removeFont(this);
+    clearGradientCache();
+}
+
+void SDLFont::clearGradientCache()
+{
+    FOR_EACH (GradientChunks::iterator, it, mGradientCache)
+        delete (*it).second.second;
+    mGradientCache.clear();
+}
+
+void SDLFont::drawGradientString(Graphics *const graphics,
+                                 const std::string &text,
+                                 const int x, const int y,
+                                 const gcn::Color *const slot,
+                                 const int phase)
+{
+    BLOCK_START("SDLFont::drawGradientString")
+    BUDGET_BLOCK(ZONE_TEXT)
+    if (text.empty() || !graphics)
+    {
+        BLOCK_END("SDLFont::drawGradientString")
+        return;
+    }
+
+    gcn::Color col = graphics->getColor();
+    const gcn::Color &col2 = graphics->getColor2();
+    const float alpha = static_cast<float>(col.a) / 255.0f;
+    col.a = 255;
+
+    GradientChunk &entry = mGradientCache[std::pair<const gcn::Color*,
+        std::string>(slot, text)];
+    SDLTextChunk *&chunk = entry.second;
+    if (!chunk)
+    {
+        chunk = new SDLTextChunk(text, col, col2);
+        chunk->generate(mFont, alpha);
+    }
+    else if (entry.first != phase || chunk->color2 != col2)
+    {
+        // gradient moved to other phase
+        delete chunk->img;
+        chunk->img = nullptr;
+        chunk->color = col;
+        chunk->color2 = col2;
+        chunk->generate(mFont, alpha);
+    }
+    entry.first = phase;
+
+    Image *const image = chunk->img;
+    if (image)
+    {
+        image->setAlpha(alpha);
+        graphics->drawImage(image, x, y);
+    }
+    BLOCK_END("SDLFont::drawGradientString")
 }
 
 void SDLFont::drawString(gcn::Graphics *const graphics,
@@ -410,6 +558,7 @@ void SDLFont::drawString(gcn::Graphics *const graphics,
                          const int x, const int y)
 {
     BLOCK_START("SDLFont::drawString")
+    BUDGET_BLOCK(ZONE_TEXT)
     if (text.empty())
     {
         BLOCK_END("SDLFont::drawString")
@@ -429,43 +578,19 @@ void SDLFont::drawString(gcn::Graphics *const graphics,
      */
     col.a = 255;
 
-    const unsigned char chr = text[0];
-    TextChunkList *const cache = &mCache[chr];
-
-    std::map<SDLTextChunkSmall, SDLTextChunk*> &search = cache->search;
-    std::map<SDLTextChunkSmall, SDLTextChunk*>::iterator i
-        = search.find(SDLTextChunkSmall(text, col, col2));
-    if (i != search.end())
+    SDLTextChunk *chunk = textChunkCache.find(this, text, col, col2);
+    if (!chunk)
     {
-        SDLTextChunk *const chunk2 = (*i).second;
-        cache->moveToFirst(chunk2);
-        Image *const image = chunk2->img;
-        if (image)
-        {
-            image->setAlpha(alpha);
-            g->drawImage(image, x, y);
-        }
+        chunk = new SDLTextChunk(text, col, col2);
+        chunk->generate(mFont, alpha);
+        textChunkCache.insert(chunk, this);
     }
-    else
-    {
-        if (cache->size >= CACHE_SIZE)
-        {
-#ifdef DEBUG_FONT_COUNTERS
-            mDeleteCounter ++;
-#endif
-            cache->removeBack();
-        }
-#ifdef DEBUG_FONT_COUNTERS
-        mCreateCounter ++;
-#endif
-        SDLTextChunk *chunk2 = new SDLTextChunk(text, col, col2);
 
-        chunk2->generate(mFont, alpha);
-        cache->insertFirst(chunk2);
-
-        const Image *const image = chunk2->img;
-        if (image)
-            g->drawImage(image, x, y);
+    Image *const image = chunk->img;
+    if (image)
+    {
+        image->setAlpha(alpha);
+        g->drawImage(image, x, y);
     }
     BLOCK_END("SDLFont::drawString")
 }
@@ -490,15 +615,9 @@ int SDLFont::getWidth(const std::string &text) const
     if (text.empty())
         return 0;
 
-    const unsigned char chr = text[0];
-    TextChunkList *const cache = &mCache[chr];
-
-    std::map<std::string, SDLTextChunk*> &search = cache->searchWidth;
-    std::map<std::string, SDLTextChunk*>::iterator i = search.find(text);
-    if (i != search.end())
+    const SDLTextChunk *const chunk = textChunkCache.findText(this, text);
+    if (chunk)
     {
-        SDLTextChunk *const chunk = (*i).second;
-        cache->moveToFirst(chunk);
         const Image *const image = chunk->img;
         if (image)
             return image->getWidth();
@@ -506,37 +625,6 @@ int SDLFont::getWidth(const std::string &text) const
             return 0;
     }
 
-/*
-#ifdef DEBUG_FONT
-    int cnt = 0;
-#endif
-
-    SDLTextChunk *i = cache->start;
-    while (i)
-    {
-        if (i->text == text)
-        {
-            // Raise priority: move it to front
-            // Assumption is that TTF::draw will be called next
-            cache->moveToFirst(i);
-            const Image *const image = i->img;
-            if (image)
-                return image->getWidth();
-            else
-                return 0;
-        }
-        i = i->next;
-#ifdef DEBUG_FONT
-        cnt ++;
-#endif
-    }
-
-#ifdef DEBUG_FONT
-    logger->log(std::string("getWidth: ").append(text).append(
-        ", iterations: ").append(toString(cnt)));
-#endif
-*/
-
     // if string was not drawed
     int w, h;
     getSafeUtf8String(text, strBuf);
@@ -551,47 +639,6 @@ int SDLFont::getHeight() const
 
 void SDLFont::doClean()
 {
-    for (unsigned int f = 0; f < CACHES_NUMBER; f ++)
-    {
-        TextChunkList *const cache = &mCache[f];
-        const size_t size = cache->size;
-#ifdef DEBUG_FONT_COUNTERS
-        logger->log("ptr: %d, size: %d", f, size);
-#endif
-        if (size > CACHE_SIZE_SMALL3)
-        {
-#ifdef DEBUG_FONT_COUNTERS
-            mDeleteCounter += 100;
-#endif
-            cache->removeBack(100);
-#ifdef DEBUG_FONT_COUNTERS
-            logger->log("delete3");
-#endif
-        }
-        else if (size > CACHE_SIZE_SMALL2)
-        {
-#ifdef DEBUG_FONT_COUNTERS
-            mDeleteCounter += 20;
-#endif
-            cache->removeBack(20);
-#ifdef DEBUG_FONT_COUNTERS
-            logger->log("delete2");
-#endif
-        }
-        else if (size > CACHE_SIZE_SMALL1)
-        {
-#ifdef DEBUG_FONT_COUNTERS
-            mDeleteCounter ++;
-#endif
-            cache->removeBack();
-#ifdef DEBUG_FONT_COUNTERS
-            logger->log("delete1");
-#endif
-        }
-    }
-}
-
-TextChunkList *SDLFont::getCache()
-{
-    return mCache;
+    // main cache is limited by memory budget
+    clearGradientCache();
 }
@@ -33,31 +33,16 @@
 #include <SDL_ttf.h>
 #endif
 
-#include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "localconsts.h"
 
+class Graphics;
 class Image;
 
-const unsigned int CACHES_NUMBER = 256;
-
-class SDLTextChunkSmall
-{
-    public:
-        SDLTextChunkSmall(const std::string &text0, const gcn::Color &color0,
-                          const gcn::Color &color1);
-
-        SDLTextChunkSmall(const SDLTextChunkSmall &old);
-
-        bool operator==(const SDLTextChunkSmall &chunk) const;
-        bool operator<(const SDLTextChunkSmall &chunk) const;
-
-        std::string text;
-        gcn::Color color;
-        gcn::Color color2;
-};
+class SDLFont;
 
 class SDLTextChunk final
 {
@@ -79,33 +64,109 @@ class SDLTextChunk final
         gcn::Color color2;
         SDLTextChunk *prev;
         SDLTextChunk *next;
+        const SDLFont *font;
+        unsigned int hash;
+        int memory;
 };
 
-
-class TextChunkList final
+/**
+ * Rendered text chunks of all fonts. Chunks are found by open addressing
+ * hash table and evicted in least recently used order when they take more
+ * memory than allowed.
+ *
+ * Hash is made from font and text only, so all colours of one text are on
+ * the same probe sequence and width can be taken from any of them.
+ */
+class TextChunkCache final
 {
     public:
-        TextChunkList();
+        TextChunkCache();
 
-        A_DELETE_COPY(TextChunkList)
+        A_DELETE_COPY(TextChunkCache)
 
-        void insertFirst(SDLTextChunk *const item);
+        ~TextChunkCache();
 
-        void moveToFirst(SDLTextChunk *item);
+        static unsigned int getHash(const SDLFont *const font,
+                                    const std::string &text) A_WARN_UNUSED;
+
+        /**
+         * Returns chunk drawn with the given colours and makes it most
+         * recently used.
+         */
+        SDLTextChunk *find(const SDLFont *const font, const std::string &text,
+                           const gcn::Color &color,
+                           const gcn::Color &color2) A_WARN_UNUSED;
 
-        void removeBack();
+        /**
+         * Returns chunk with the given text in any colours.
+         */
+        SDLTextChunk *findText(const SDLFont *const font,
+                               const std::string &text) A_WARN_UNUSED;
+
+        /**
+         * Takes ownership of generated chunk and evicts old chunks if
+         * budget is exceeded.
+         */
+        void insert(SDLTextChunk *const chunk, const SDLFont *const font);
 
-        void removeBack(int n);
+        void removeFont(const SDLFont *const font);
 
         void clear();
 
-        SDLTextChunk *start;
-        SDLTextChunk *end;
-        uint32_t size;
-        std::map<SDLTextChunkSmall, SDLTextChunk*> search;
-        std::map<std::string, SDLTextChunk*> searchWidth;
+        void setBudget(const int budget);
+
+        SDLTextChunk *getFirst() const A_WARN_UNUSED
+        { return mStart; }
+
+        SDLTextChunk *getLast() const A_WARN_UNUSED
+        { return mEnd; }
+
+        unsigned int getSize() const A_WARN_UNUSED
+        { return mSize; }
+
+        int getMemory() const A_WARN_UNUSED
+        { return mMemory; }
+
+        int getBudget() const A_WARN_UNUSED
+        { return mBudget; }
+
+        unsigned int getHits() const A_WARN_UNUSED
+        { return mHits; }
+
+        unsigned int getMisses() const A_WARN_UNUSED
+        { return mMisses; }
+
+        unsigned int getEvictions() const A_WARN_UNUSED
+        { return mEvictions; }
+
+    private:
+        SDLTextChunk *findSlot(const SDLFont *const font,
+                               const std::string &text,
+                               const gcn::Color *const color,
+                               const gcn::Color *const color2)
+                               const A_WARN_UNUSED;
+
+        void moveToFirst(SDLTextChunk *const chunk);
+
+        void remove(SDLTextChunk *const chunk);
+
+        void rehash(const size_t capacity);
+
+        std::vector<SDLTextChunk*> mTable;
+        SDLTextChunk *mStart;
+        SDLTextChunk *mEnd;
+        unsigned int mSize;
+        // used and deleted slots
+        unsigned int mUsed;
+        int mMemory;
+        int mBudget;
+        unsigned int mHits;
+        unsigned int mMisses;
+        unsigned int mEvictions;
 };
 
+extern TextChunkCache textChunkCache;
+
 /**
  * A wrapper around SDL_ttf for allowing the use of TrueType fonts.
  *
@@ -136,8 +197,6 @@ class SDLFont final : public gcn::Font
 
         virtual int getHeight() const A_WARN_UNUSED;
 
-        TextChunkList *getCache() A_WARN_UNUSED;
-
         /**
          * @see Font::drawString
          */
@@ -145,26 +204,36 @@ class SDLFont final : public gcn::Font
                         const std::string &text,
                         const int x, const int y);
 
+        /**
+         * Draws text in animated palette color. Keeps one chunk per color
+         * slot and text, and generates it again only when phase changed.
+         *
+         * @param slot   Palette color, as returned by Palette::getColor.
+         * @param phase  Gradient phase from Palette::getGradientPhase.
+         */
+        void drawGradientString(Graphics *const graphics,
+                                const std::string &text,
+                                const int x, const int y,
+                                const gcn::Color *const slot,
+                                const int phase);
+
         void clear();
 
         void doClean();
 
         void slowLogic(const int rnd);
 
-        int getCreateCounter() const A_WARN_UNUSED
-        { return mCreateCounter; }
-
-        int getDeleteCounter() const A_WARN_UNUSED
-        { return mDeleteCounter; }
-
     private:
-        TTF_Font *mFont;
-        unsigned mCreateCounter;
-        unsigned mDeleteCounter;
+        void clearGradientCache();
 
-        // Word surfaces cache
+        TTF_Font *mFont;
         int mCleanTime;
-        mutable TextChunkList mCache[CACHES_NUMBER];
+
+        // Animated colors cache. One chunk and its phase per slot and text.
+        typedef std::pair<int, SDLTextChunk*> GradientChunk;
+        typedef std::map<std::pair<const gcn::Color*, std::string>,
+            GradientChunk> GradientChunks;
+        GradientChunks mGradientCache;
 };
 
 #ifdef UNITTESTS
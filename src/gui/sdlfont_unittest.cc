@@ -23,437 +23,225 @@
 #include "gui/sdlfont.h"
 #include "gui/theme.h"
 
+#include "utils/stringutils.h"
+
 #include "gtest/gtest.h"
 
 #include "debug.h"
 
-TEST(TextChunkList, empty)
-{
-    TextChunkList list;
-
-    EXPECT_EQ(0, list.size);
-    EXPECT_EQ(nullptr, list.start);
-    EXPECT_EQ(nullptr, list.end);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-}
-
-TEST(TextChunkList, add1)
-{
-    TextChunkList list;
-
-    SDLTextChunk *chunk = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 3, 4));
-
-    list.insertFirst(chunk);
-
-    EXPECT_EQ(1, list.size);
-    EXPECT_EQ(chunk, list.start);
-    EXPECT_EQ(chunk, list.end);
-    EXPECT_EQ(nullptr, chunk->prev);
-    EXPECT_EQ(nullptr, chunk->next);
-
-    EXPECT_EQ(1, list.search.size());
-    EXPECT_EQ(chunk, (*list.search.find(SDLTextChunkSmall(
-        chunk->text, chunk->color, chunk->color2))).second);
-
-    EXPECT_EQ(1, list.searchWidth.size());
-    EXPECT_EQ(chunk, (*list.searchWidth.find(chunk->text)).second);
-}
-
-TEST(TextChunkList, add2)
-{
-    TextChunkList list;
-
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(3, 4, 5));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(2, 3, 4), gcn::Color(4, 5, 6));
-
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk1);
-
-    EXPECT_EQ(2, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk2, list.end);
-    EXPECT_EQ(nullptr, chunk1->prev);
-    EXPECT_EQ(chunk2, chunk1->next);
-    EXPECT_EQ(chunk1, chunk2->prev);
-    EXPECT_EQ(nullptr, chunk2->next);
-
-    EXPECT_EQ(2, list.search.size());
-    EXPECT_EQ(chunk1, (*list.search.find(SDLTextChunkSmall(
-        chunk1->text, chunk1->color, chunk1->color2))).second);
-    EXPECT_EQ(chunk2, (*list.search.find(SDLTextChunkSmall(
-        chunk2->text, chunk2->color, chunk2->color2))).second);
-
-    EXPECT_EQ(1, list.searchWidth.size());
-    EXPECT_EQ(chunk1, (*list.searchWidth.find(chunk1->text)).second);
-}
+static const SDLFont *const font1 = reinterpret_cast<const SDLFont*>(16);
+static const SDLFont *const font2 = reinterpret_cast<const SDLFont*>(32);
 
-TEST(TextChunkList, addRemoveBack1)
+static int getChunkMemory(const std::string &text)
 {
-    TextChunkList list;
-
-    SDLTextChunk *chunk = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-
-    list.insertFirst(chunk);
-    list.removeBack();
-
-    EXPECT_EQ(0, list.size);
-    EXPECT_EQ(nullptr, list.start);
-    EXPECT_EQ(nullptr, list.end);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
+    return static_cast<int>(sizeof(SDLTextChunk) + text.size());
 }
 
-TEST(TextChunkList, addRemoveBack2)
+TEST(TextChunkCache, empty)
 {
-    TextChunkList list;
-
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test2",
-        gcn::Color(1, 2, 4), gcn::Color(1, 2, 5));
+    TextChunkCache cache;
 
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk1);
-    list.removeBack();
-
-    EXPECT_EQ(1, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk1, list.end);
-    EXPECT_EQ(nullptr, chunk1->prev);
-    EXPECT_EQ(nullptr, chunk1->next);
-
-    EXPECT_EQ(1, list.search.size());
-    EXPECT_EQ(chunk1, (*list.search.find(SDLTextChunkSmall(
-        chunk1->text, chunk1->color, chunk1->color2))).second);
-
-    EXPECT_EQ(1, list.searchWidth.size());
-    EXPECT_EQ(chunk1, (*list.searchWidth.find(chunk1->text)).second);
+    EXPECT_EQ(0, cache.getSize());
+    EXPECT_EQ(0, cache.getMemory());
+    EXPECT_EQ(nullptr, cache.getFirst());
+    EXPECT_EQ(nullptr, cache.getLast());
+    EXPECT_EQ(nullptr, cache.find(font1, "test",
+        gcn::Color(1, 2, 3), gcn::Color(2, 3, 4)));
+    EXPECT_EQ(nullptr, cache.findText(font1, "test"));
+    EXPECT_EQ(1U, cache.getMisses());
 }
 
-TEST(TextChunkList, addRemoveBack3)
+TEST(TextChunkCache, add1)
 {
-    TextChunkList list;
-
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test2",
-        gcn::Color(2, 3, 4), gcn::Color(2, 3, 4));
-
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk1);
-    list.removeBack(2);
-
-    EXPECT_EQ(0, list.size);
-    EXPECT_EQ(nullptr, list.start);
-    EXPECT_EQ(nullptr, list.end);
-
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-}
-
-TEST(TextChunkList, addRemoveBack4)
-{
-    TextChunkList list;
-
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test2",
-        gcn::Color(2, 3, 4), gcn::Color(2, 3, 4));
-    SDLTextChunk *chunk3 = new SDLTextChunk("test",
-        gcn::Color(3, 4, 5), gcn::Color(3, 4, 5));
-
-    list.insertFirst(chunk3);
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk1);
-    list.removeBack();
-    list.removeBack();
-
-    EXPECT_EQ(1, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk1, list.end);
-    EXPECT_EQ(nullptr, chunk1->prev);
-    EXPECT_EQ(nullptr, chunk1->next);
-
-    EXPECT_EQ(1, list.search.size());
-    EXPECT_EQ(chunk1, (*list.search.find(SDLTextChunkSmall(
-        chunk1->text, chunk1->color, chunk1->color2))).second);
-
-    EXPECT_EQ(0, list.searchWidth.size());
-}
-
-TEST(TextChunkList, moveToFirst1)
-{
-    TextChunkList list;
+    TextChunkCache cache;
 
     SDLTextChunk *chunk = new SDLTextChunk("test",
         gcn::Color(1, 2, 3), gcn::Color(2, 3, 4));
 
-    list.insertFirst(chunk);
-    list.moveToFirst(chunk);
+    cache.insert(chunk, font1);
 
-    EXPECT_EQ(1, list.size);
-    EXPECT_EQ(chunk, list.start);
-    EXPECT_EQ(chunk, list.end);
+    EXPECT_EQ(1, cache.getSize());
+    EXPECT_EQ(getChunkMemory("test"), cache.getMemory());
+    EXPECT_EQ(chunk, cache.getFirst());
+    EXPECT_EQ(chunk, cache.getLast());
     EXPECT_EQ(nullptr, chunk->prev);
     EXPECT_EQ(nullptr, chunk->next);
+    EXPECT_EQ(font1, chunk->font);
+
+    EXPECT_EQ(chunk, cache.find(font1, "test",
+        gcn::Color(1, 2, 3), gcn::Color(2, 3, 4)));
+    EXPECT_EQ(nullptr, cache.find(font1, "test",
+        gcn::Color(1, 2, 3), gcn::Color(2, 3, 5)));
+    EXPECT_EQ(nullptr, cache.find(font2, "test",
+        gcn::Color(1, 2, 3), gcn::Color(2, 3, 4)));
+    EXPECT_EQ(nullptr, cache.find(font1, "test2",
+        gcn::Color(1, 2, 3), gcn::Color(2, 3, 4)));
+    EXPECT_EQ(chunk, cache.findText(font1, "test"));
+    EXPECT_EQ(1U, cache.getHits());
+    EXPECT_EQ(3U, cache.getMisses());
 }
 
-TEST(TextChunkList, moveToFirst2)
+TEST(TextChunkCache, add2)
 {
-    TextChunkList list;
+    TextChunkCache cache;
 
     SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
+        gcn::Color(1, 2, 3), gcn::Color(3, 4, 5));
     SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(2, 3, 4), gcn::Color(1, 2, 3));
+        gcn::Color(2, 3, 4), gcn::Color(4, 5, 6));
 
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk2);
-    list.moveToFirst(chunk1);
+    cache.insert(chunk2, font1);
+    cache.insert(chunk1, font1);
 
-    EXPECT_EQ(2, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk2, list.end);
+    EXPECT_EQ(2, cache.getSize());
+    EXPECT_EQ(chunk1, cache.getFirst());
+    EXPECT_EQ(chunk2, cache.getLast());
     EXPECT_EQ(nullptr, chunk1->prev);
     EXPECT_EQ(chunk2, chunk1->next);
     EXPECT_EQ(chunk1, chunk2->prev);
     EXPECT_EQ(nullptr, chunk2->next);
-}
-
-TEST(TextChunkList, moveToFirst3)
-{
-    TextChunkList list;
 
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 4), gcn::Color(1, 2, 3));
-    SDLTextChunk *chunk3 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 5), gcn::Color(1, 2, 3));
-
-    list.insertFirst(chunk3);
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk2);
-    list.moveToFirst(chunk1);
-
-    EXPECT_EQ(3, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk3, list.end);
-    EXPECT_EQ(nullptr, chunk1->prev);
-    EXPECT_EQ(chunk2, chunk1->next);
-    EXPECT_EQ(chunk1, chunk2->prev);
-    EXPECT_EQ(chunk3, chunk2->next);
-    EXPECT_EQ(chunk2, chunk3->prev);
-    EXPECT_EQ(nullptr, chunk3->next);
+    EXPECT_EQ(chunk1, cache.find(font1, "test",
+        gcn::Color(1, 2, 3), gcn::Color(3, 4, 5)));
+    EXPECT_EQ(chunk2, cache.find(font1, "test",
+        gcn::Color(2, 3, 4), gcn::Color(4, 5, 6)));
+    EXPECT_TRUE(cache.findText(font1, "test") != nullptr);
 }
 
-TEST(TextChunkList, moveToFirst4)
+TEST(TextChunkCache, moveToFirst)
 {
-    TextChunkList list;
+    TextChunkCache cache;
 
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
+    SDLTextChunk *chunk1 = new SDLTextChunk("test1",
         gcn::Color(), gcn::Color());
     SDLTextChunk *chunk2 = new SDLTextChunk("test2",
         gcn::Color(), gcn::Color());
     SDLTextChunk *chunk3 = new SDLTextChunk("test3",
         gcn::Color(), gcn::Color());
 
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk3);
-    list.insertFirst(chunk2);
-    list.moveToFirst(chunk1);
+    cache.insert(chunk1, font1);
+    cache.insert(chunk2, font1);
+    cache.insert(chunk3, font1);
+    EXPECT_EQ(chunk3, cache.getFirst());
+    EXPECT_EQ(chunk1, cache.getLast());
 
-    EXPECT_EQ(3, list.size);
-    EXPECT_EQ(chunk1, list.start);
-    EXPECT_EQ(chunk3, list.end);
-    EXPECT_EQ(nullptr, chunk1->prev);
-    EXPECT_EQ(chunk2, chunk1->next);
-    EXPECT_EQ(chunk1, chunk2->prev);
+    EXPECT_EQ(chunk2, cache.find(font1, "test2",
+        gcn::Color(), gcn::Color()));
+    EXPECT_EQ(chunk2, cache.getFirst());
     EXPECT_EQ(chunk3, chunk2->next);
-    EXPECT_EQ(chunk2, chunk3->prev);
-    EXPECT_EQ(nullptr, chunk3->next);
-}
-
-TEST(TextChunkList, clear1)
-{
-    TextChunkList list;
-    int chunksLeft = sdlTextChunkCnt;
+    EXPECT_EQ(chunk1, chunk3->next);
+    EXPECT_EQ(chunk1, cache.getLast());
 
-    SDLTextChunk *chunk = new SDLTextChunk("test", gcn::Color(), gcn::Color());
-
-    list.insertFirst(chunk);
-    list.clear();
-
-    EXPECT_EQ(0, list.size);
-    EXPECT_EQ(nullptr, list.start);
-    EXPECT_EQ(nullptr, list.end);
-    EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
+    EXPECT_EQ(chunk1, cache.findText(font1, "test1"));
+    EXPECT_EQ(chunk1, cache.getFirst());
+    EXPECT_EQ(chunk3, cache.getLast());
+    EXPECT_EQ(nullptr, chunk3->next);
 }
 
-TEST(TextChunkList, clear2)
+TEST(TextChunkCache, budget)
 {
-    TextChunkList list;
-    int chunksLeft = sdlTextChunkCnt;
+    TextChunkCache cache;
+    const int chunksLeft = sdlTextChunkCnt;
+    cache.setBudget(getChunkMemory("test1") * 2);
 
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 0));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 1));
-    SDLTextChunk *chunk3 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 2));
-
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk3);
-    list.clear();
-
-    EXPECT_EQ(0, list.size);
-    EXPECT_EQ(nullptr, list.start);
-    EXPECT_EQ(nullptr, list.end);
-    EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-}
+    SDLTextChunk *chunk1 = new SDLTextChunk("test1",
+        gcn::Color(), gcn::Color());
+    SDLTextChunk *chunk2 = new SDLTextChunk("test2",
+        gcn::Color(), gcn::Color());
+    SDLTextChunk *chunk3 = new SDLTextChunk("test3",
+        gcn::Color(), gcn::Color());
 
-TEST(TextChunkList, clear3)
-{
-    TextChunkList list;
-    int chunksLeft = sdlTextChunkCnt;
+    cache.insert(chunk1, font1);
+    cache.insert(chunk2, font1);
+    EXPECT_EQ(chunk1, cache.findText(font1, "test1"));
+    cache.insert(chunk3, font1);
 
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 0));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 1));
-    SDLTextChunk *chunk3 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 2));
-
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk3);
-    list.moveToFirst(chunk1);
-    EXPECT_EQ(chunksLeft + 3, sdlTextChunkCnt);
-    EXPECT_EQ(3, list.search.size());
-    EXPECT_EQ(1, list.searchWidth.size());
-
-    list.removeBack();
+    // least recently used chunk is evicted
+    EXPECT_EQ(2, cache.getSize());
+    EXPECT_EQ(1U, cache.getEvictions());
     EXPECT_EQ(chunksLeft + 2, sdlTextChunkCnt);
-    EXPECT_EQ(2, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-
-    list.clear();
+    EXPECT_EQ(nullptr, cache.findText(font1, "test2"));
+    EXPECT_EQ(chunk1, cache.findText(font1, "test1"));
+    EXPECT_EQ(chunk3, cache.findText(font1, "test3"));
+
+    cache.setBudget(0);
+    EXPECT_EQ(0, cache.getSize());
+    EXPECT_EQ(0, cache.getMemory());
+    EXPECT_EQ(3U, cache.getEvictions());
     EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
 }
 
-TEST(TextChunkList, clear4)
+TEST(TextChunkCache, removeFont)
 {
-    TextChunkList list;
-    int chunksLeft = sdlTextChunkCnt;
+    TextChunkCache cache;
+    const int chunksLeft = sdlTextChunkCnt;
 
-    SDLTextChunk *chunk1 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 0));
-    SDLTextChunk *chunk2 = new SDLTextChunk("test",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 1));
-    SDLTextChunk *chunk3 = new SDLTextChunk("test3",
-        gcn::Color(1, 2, 3), gcn::Color(2, 0, 2));
-
-    list.insertFirst(chunk1);
-    list.insertFirst(chunk2);
-    list.insertFirst(chunk3);
-    list.moveToFirst(chunk2);
-    EXPECT_EQ(chunksLeft + 3, sdlTextChunkCnt);
-    EXPECT_EQ(3, list.search.size());
-    EXPECT_EQ(2, list.searchWidth.size());
+    cache.insert(new SDLTextChunk("test1", gcn::Color(), gcn::Color()),
+        font1);
+    cache.insert(new SDLTextChunk("test1", gcn::Color(), gcn::Color()),
+        font2);
+    cache.insert(new SDLTextChunk("test2", gcn::Color(), gcn::Color()),
+        font1);
 
-    list.removeBack(2);
+    cache.removeFont(font1);
+    EXPECT_EQ(1, cache.getSize());
     EXPECT_EQ(chunksLeft + 1, sdlTextChunkCnt);
-    EXPECT_EQ(1, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-
-    list.clear();
-    EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
-    EXPECT_EQ(0, list.search.size());
-    EXPECT_EQ(0, list.searchWidth.size());
-}
-
-TEST(TextChunkList, sort1)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item3("test line2",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    EXPECT_EQ(false, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-    EXPECT_EQ(true, item1 < item3);
-    EXPECT_EQ(false, item3 < item1);
+    EXPECT_EQ(getChunkMemory("test1"), cache.getMemory());
+    EXPECT_EQ(nullptr, cache.findText(font1, "test1"));
+    EXPECT_EQ(nullptr, cache.findText(font1, "test2"));
+    EXPECT_TRUE(cache.findText(font2, "test1") != nullptr);
 }
 
-TEST(TextChunkList, sort2)
+TEST(TextChunkCache, clear)
 {
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(2, 3, 4), gcn::Color(1, 2, 3));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-}
-
-TEST(TextChunkList, sort3)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 3, 4), gcn::Color(1, 2, 3));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-}
+    TextChunkCache cache;
+    const int chunksLeft = sdlTextChunkCnt;
 
-TEST(TextChunkList, sort4)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 2, 4), gcn::Color(1, 2, 3));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-}
+    cache.insert(new SDLTextChunk("test", gcn::Color(1, 2, 3),
+        gcn::Color(2, 0, 0)), font1);
+    cache.insert(new SDLTextChunk("test", gcn::Color(1, 2, 3),
+        gcn::Color(2, 0, 1)), font1);
+    cache.clear();
 
-TEST(TextChunkList, sort5)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(2, 2, 3));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-}
-
-TEST(TextChunkList, sort6)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 3, 3));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
-}
-
-TEST(TextChunkList, sort7)
-{
-    SDLTextChunkSmall item1("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 3));
-    SDLTextChunkSmall item2("test line1",
-        gcn::Color(1, 2, 3), gcn::Color(1, 2, 4));
-    EXPECT_EQ(true, item1 < item2);
-    EXPECT_EQ(false, item2 < item1);
+    EXPECT_EQ(0, cache.getSize());
+    EXPECT_EQ(0, cache.getMemory());
+    EXPECT_EQ(nullptr, cache.getFirst());
+    EXPECT_EQ(nullptr, cache.getLast());
+    EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
+    EXPECT_EQ(nullptr, cache.findText(font1, "test"));
+}
+
+TEST(TextChunkCache, many)
+{
+    TextChunkCache cache;
+    const int chunksLeft = sdlTextChunkCnt;
+    const int count = 5000;
+    cache.setBudget(getChunkMemory("test 0000") * count);
+
+    for (int f = 0; f < count; f ++)
+    {
+        cache.insert(new SDLTextChunk(strprintf("test %04d", f),
+            gcn::Color(), gcn::Color()), font1);
+    }
+    EXPECT_EQ(count, cache.getSize());
+    for (int f = 0; f < count; f ++)
+    {
+        EXPECT_TRUE(cache.find(font1, strprintf("test %04d", f),
+            gcn::Color(), gcn::Color()) != nullptr);
+    }
+
+    // deleted slots are reused by new chunks
+    for (int f = 0; f < count; f ++)
+    {
+        cache.insert(new SDLTextChunk(strprintf("text %04d", f),
+            gcn::Color(), gcn::Color()), font1);
+    }
+    EXPECT_EQ(count, cache.getSize());
+    EXPECT_EQ(static_cast<unsigned int>(count), cache.getEvictions());
+    EXPECT_EQ(nullptr, cache.findText(font1, "test 0000"));
+    EXPECT_TRUE(cache.findText(font1, "text 0000") != nullptr);
+    EXPECT_TRUE(cache.findText(font1, "text 4999") != nullptr);
+
+    cache.clear();
+    EXPECT_EQ(chunksLeft, sdlTextChunkCnt);
 }
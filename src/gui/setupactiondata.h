@@ -484,6 +484,12 @@ static SetupActionData setupActionData2[] =
         Input::KEY_WINDOW_QUESTS,
         "",
     },
+    {
+        // TRANSLATORS: input action name
+        N_("Performance Overlay"),
+        Input::KEY_PERF_OVERLAY,
+        "",
+    },
     {
         // TRANSLATORS: input action name
         N_("Previous Social Tab"),
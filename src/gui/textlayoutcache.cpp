@@ -0,0 +1,96 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui/textlayoutcache.h"
+
+#include <guichan/font.hpp>
+
+#include "debug.h"
+
+TextLayoutCache textLayoutCache;
+
+// caches are dropped when full, most texts are measured again soon
+static const unsigned int maxCachedWidths = 8192;
+static const unsigned int maxCachedWraps = 256;
+
+TextLayoutCache::TextLayoutCache() :
+    mWidths(),
+    mWraps(),
+    mHits(0),
+    mMisses(0)
+{
+}
+
+int TextLayoutCache::getWidth(const gcn::Font *const font,
+                              const std::string &text)
+{
+    if (!font || text.empty())
+        return 0;
+
+    const WidthKey key(font, text);
+    const Widths::const_iterator it = mWidths.find(key);
+    if (it != mWidths.end())
+    {
+        mHits ++;
+        return it->second;
+    }
+
+    mMisses ++;
+    if (mWidths.size() >= maxCachedWidths)
+        mWidths.clear();
+    const int width = font->getWidth(text);
+    mWidths[key] = width;
+    return width;
+}
+
+bool TextLayoutCache::findWrap(const gcn::Font *const font,
+                               const std::string &text, const int width,
+                               std::string &wrapped, int &wrappedWidth)
+{
+    const Wraps::const_iterator it = mWraps.find(WrapKey(
+        std::pair<const gcn::Font*, int>(font, width), text));
+    if (it == mWraps.end())
+    {
+        mMisses ++;
+        return false;
+    }
+
+    mHits ++;
+    wrapped = it->second.first;
+    wrappedWidth = it->second.second;
+    return true;
+}
+
+void TextLayoutCache::addWrap(const gcn::Font *const font,
+                              const std::string &text, const int width,
+                              const std::string &wrapped,
+                              const int wrappedWidth)
+{
+    if (mWraps.size() >= maxCachedWraps)
+        mWraps.clear();
+    mWraps[WrapKey(std::pair<const gcn::Font*, int>(font, width), text)]
+        = std::pair<std::string, int>(wrapped, wrappedWidth);
+}
+
+void TextLayoutCache::clear()
+{
+    mWidths.clear();
+    mWraps.clear();
+}
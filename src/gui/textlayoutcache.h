@@ -0,0 +1,84 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GUI_TEXTLAYOUTCACHE_H
+#define GUI_TEXTLAYOUTCACHE_H
+
+#include <map>
+#include <string>
+
+#include "localconsts.h"
+
+namespace gcn
+{
+    class Font;
+}
+
+/**
+ * Text measurements shared by widgets: widths of strings and texts
+ * wrapped to some width. Fonts only render the strings they draw, so
+ * widths of measured strings are kept here. Must be cleared when fonts
+ * are changed.
+ */
+class TextLayoutCache final
+{
+    public:
+        TextLayoutCache();
+
+        A_DELETE_COPY(TextLayoutCache)
+
+        int getWidth(const gcn::Font *const font,
+                     const std::string &text) A_WARN_UNUSED;
+
+        /**
+         * Returns text wrapped for width, and width it really takes.
+         */
+        bool findWrap(const gcn::Font *const font, const std::string &text,
+                      const int width, std::string &wrapped,
+                      int &wrappedWidth) A_WARN_UNUSED;
+
+        void addWrap(const gcn::Font *const font, const std::string &text,
+                     const int width, const std::string &wrapped,
+                     const int wrappedWidth);
+
+        void clear();
+
+        unsigned int getHits() const A_WARN_UNUSED
+        { return mHits; }
+
+        unsigned int getMisses() const A_WARN_UNUSED
+        { return mMisses; }
+
+    private:
+        typedef std::pair<const gcn::Font*, std::string> WidthKey;
+        typedef std::map<WidthKey, int> Widths;
+        typedef std::pair<std::pair<const gcn::Font*, int>, std::string>
+            WrapKey;
+        typedef std::map<WrapKey, std::pair<std::string, int> > Wraps;
+
+        Widths mWidths;
+        Wraps mWraps;
+        unsigned int mHits;
+        unsigned int mMisses;
+};
+
+extern TextLayoutCache textLayoutCache;
+
+#endif  // GUI_TEXTLAYOUTCACHE_H
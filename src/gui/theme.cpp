@@ -30,6 +30,7 @@
 
 #include "resources/dye.h"
 #include "resources/image.h"
+#include "resources/imagehelper.h"
 #include "resources/imageset.h"
 #include "resources/resourcemanager.h"
 
@@ -444,7 +445,8 @@ struct SkinHelper final
         rect(),
         node(),
         image(),
-        resman()
+        resman(),
+        index(0)
     {
     }
 
@@ -459,6 +461,7 @@ struct SkinHelper final
     XmlNodePtr *node;
     Image *image;
     ResourceManager *resman;
+    int index;
 
     bool loadList(const SkinParameter *const params, const size_t size)
     {
@@ -468,7 +471,8 @@ struct SkinHelper final
             {
 //                rect->grid[params[f].index] = image->getSubImage(
 //                    xPos, yPos, width, height);
-                rect->grid[params[f].index] = resman->getSubImage(
+                index = params[f].index;
+                rect->grid[index] = resman->getSubImage(
                     image, xPos, yPos, width, height);
                 return true;
             }
@@ -477,6 +481,30 @@ struct SkinHelper final
     }
 };
 
+// Returns distance from skin edges to area fully covered by opaque parts,
+// or -1 if skin edges or background have transparent pixels.
+static int getOpaqueInset(const ImageRect *const border, const int opaqueParts)
+{
+    // all parts
+    if (opaqueParts == 0x1FF)
+        return 0;
+    // edges and background
+    if ((opaqueParts & 0xBA) != 0xBA)
+        return -1;
+
+    static const int corners[] = {0, 2, 6, 8};
+    int inset = 0;
+    for (int f = 0; f < 4; f ++)
+    {
+        const Image *const image = border->grid[corners[f]];
+        if (!image)
+            return -1;
+        inset = std::max(inset, std::max(image->getWidth(),
+            image->getHeight()));
+    }
+    return inset;
+}
+
 Skin *Theme::readSkin(const std::string &filename, const bool full)
 {
     if (filename.empty())
@@ -513,6 +541,18 @@ Skin *Theme::readSkin(const std::string &filename, const bool full)
     int resizePadding = 2;
     std::map<std::string, int> *const mOptions
         = new std::map<std::string, int>();
+    SDL_Surface *surface = nullptr;
+    int opaqueParts = 0;
+    if (full)
+    {
+        SDL_Surface *const tmpImage = ResourceManager::getInstance()
+            ->loadSDLSurface(resolveThemePath(skinSetImage));
+        if (tmpImage)
+        {
+            surface = ImageHelper::convertTo32Bit(tmpImage);
+            SDL_FreeSurface(tmpImage);
+        }
+    }
 
     // iterate <widget>'s
     for_each_xml_child_node(widgetNode, rootNode)
@@ -543,8 +583,16 @@ Skin *Theme::readSkin(const std::string &filename, const bool full)
                     helper.image = dBorders;
 
                     helper.rect = border;
-                    if (!helper.loadList(skinParam,
+                    if (helper.loadList(skinParam,
                         sizeof(skinParam) / sizeof(SkinParameter)))
+                    {
+                        if (isOpaqueArea(surface, helper.xPos, helper.yPos,
+                            helper.width, helper.height))
+                        {
+                            opaqueParts |= 1 << helper.index;
+                        }
+                    }
+                    else
                     {
                         helper.rect = images;
                         helper.loadList(imageParam,
@@ -608,6 +656,14 @@ Skin *Theme::readSkin(const std::string &filename, const bool full)
     if (dBorders)
         dBorders->decRef();
 
+    if (surface)
+    {
+        // skin option overrides opacity found from image
+        if (mOptions->find("opaqueInset") == mOptions->end())
+            (*mOptions)["opaqueInset"] = getOpaqueInset(border, opaqueParts);
+        SDL_FreeSurface(surface);
+    }
+
     (*mOptions)["closePadding"] = closePadding;
     (*mOptions)["stickyPadding"] = stickyPadding;
     (*mOptions)["stickySpacing"] = stickySpacing;
@@ -765,6 +821,42 @@ ImageSet *Theme::getImageSetFromTheme(const std::string &path,
     return resman->getImageSet(resolveThemePath(path), w, h);
 }
 
+bool Theme::isOpaqueArea(SDL_Surface *const surface,
+                         const int x, const int y,
+                         const int width, const int height)
+{
+    if (!surface || surface->format->BytesPerPixel != 4
+        || x < 0 || y < 0 || width <= 0 || height <= 0
+        || x + width > surface->w || y + height > surface->h)
+    {
+        return false;
+    }
+    const uint32_t amask = surface->format->Amask;
+    if (!amask)
+        return true;
+
+    if (SDL_MUSTLOCK(surface))
+        SDL_LockSurface(surface);
+    bool opaque = true;
+    for (int y1 = y; y1 < y + height && opaque; y1 ++)
+    {
+        const uint32_t *const row = reinterpret_cast<const uint32_t*>(
+            static_cast<const uint8_t*>(surface->pixels)
+            + y1 * surface->pitch);
+        for (int x1 = x; x1 < x + width; x1 ++)
+        {
+            if ((row[x1] & amask) != amask)
+            {
+                opaque = false;
+                break;
+            }
+        }
+    }
+    if (SDL_MUSTLOCK(surface))
+        SDL_UnlockSurface(surface);
+    return opaque;
+}
+
 static int readColorType(const std::string &type)
 {
     static const std::string colors[] =
@@ -203,6 +203,15 @@ class Theme final : public Palette, public ConfigListener
                                               const int w,
                                               const int h) A_WARN_UNUSED;
 
+        /**
+         * Returns true if all pixels in given area of 32 bit surface are
+         * fully opaque.
+         */
+        static bool isOpaqueArea(SDL_Surface *const surface,
+                                 const int x, const int y,
+                                 const int width, const int height)
+                                 A_WARN_UNUSED;
+
         ImageSet *getImageSetFromThemeXml(const std::string &name,
                                           const std::string &name2,
                                           const int w,
@@ -47,12 +47,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include <sys/stat.h>
 
 #include "debug.h"
 
 const std::string xmlUpdateFile = "resources.xml";
+const std::string manifestFile = "manifest.txt";
 const std::string txtUpdateFile = "resources2.txt";
 const std::string updateServer2
     = "http://download.evolonline.org/manaplus/updates/";
@@ -171,6 +173,11 @@ UpdaterWindow::UpdaterWindow(const std::string &updateHost,
     mDownloadedBytes(0),
     mMemoryBuffer(nullptr),
     mDownload(nullptr),
+    mResourceDownloads(),
+    mManifest(),
+    mMaxDownloads(config.getIntValue("updateConnections") > 1
+        ? config.getIntValue("updateConnections") : 1),
+    mManifestChanged(false),
     mUpdateFiles(),
     mTempUpdateFiles(),
     mUpdateIndex(0),
@@ -218,6 +225,7 @@ UpdaterWindow::UpdaterWindow(const std::string &updateHost,
     mCancelButton->requestFocus();
 
     removeProtocol(mUpdateServerPath);
+    loadManifest();
 
     // Try to download the updates list
     download();
@@ -228,6 +236,9 @@ UpdaterWindow::~UpdaterWindow()
     if (mLoadUpdates)
         loadUpdates();
 
+    cancelResourceDownloads();
+    saveManifest();
+
     if (mDownload)
     {
         mDownload->cancel();
@@ -675,7 +686,8 @@ void UpdaterWindow::logic()
             // TRANSLATORS: Begins "It is strongly recommended that".
             mBrowserBox->addRow(_("##1  you try again later."));
 
-            mBrowserBox->addRow(mDownload->getError());
+            if (mDownload)
+                mBrowserBox->addRow(mDownload->getError());
             mScrollArea->setVerticalScrollAmount(
                     mScrollArea->getVerticalMaxScroll());
             mDownloadStatus = UPDATE_COMPLETE;
@@ -741,60 +753,14 @@ void UpdaterWindow::logic()
             }
             break;
         case UPDATE_RESOURCES:
-            if (mDownloadComplete)
+            if (mDownloadComplete && downloadResources(mUpdateFiles, true))
             {
-                if (mUpdateIndex < mUpdateFiles.size())
-                {
-                    UpdateFile thisFile = mUpdateFiles[mUpdateIndex];
-                    if (!thisFile.required)
-                    {
-                        // This statement checks to see if the file type
-                        // is music, and if download-music is true
-                        // If it fails, this statement returns true,
-                        // and results in not downloading the file
-                        // Else it will ignore the break,
-                        // and download the file.
-
-                        if (!(thisFile.type == "music"
-                            && config.getBoolValue("download-music")))
-                        {
-                            mUpdateIndex++;
-                            break;
-                        }
-                    }
-                    mCurrentFile = thisFile.name;
-                    std::string checksum;
-                    checksum = thisFile.hash;
-                    std::stringstream ss(checksum);
-                    ss >> std::hex >> mCurrentChecksum;
-
-                    std::ifstream temp((std::string(mUpdatesDir).append(
-                        "/").append(mCurrentFile)).c_str());
-
-                    if (!temp.is_open() || !validateFile(std::string(
-                        mUpdatesDir).append("/").append(mCurrentFile),
-                        mCurrentChecksum))
-                    {
-                        temp.close();
-                        download();
-                    }
-                    else
-                    {
-                        temp.close();
-                        logger->log("%s already here", mCurrentFile.c_str());
-                    }
-                    mUpdateIndex++;
-                }
-                else
-                {
-                    // Download of updates completed
-//                    mDownloadStatus = UPDATE_COMPLETE;
-                    mCurrentFile = "latest.txt";
-                    mStoreInMemory = true;
-                    mDownloadStatus = UPDATE_PATCH;
-                    download();  // download() changes
-                                 // mDownloadComplete to false
-                }
+                // Download of updates completed
+                mCurrentFile = "latest.txt";
+                mStoreInMemory = true;
+                mDownloadStatus = UPDATE_PATCH;
+                download();  // download() changes
+                             // mDownloadComplete to false
             }
             break;
         case UPDATE_LIST2:
@@ -809,47 +775,19 @@ void UpdaterWindow::logic()
                 mUpdateIndex = 0;
                 mStoreInMemory = false;
                 mDownloadStatus = UPDATE_RESOURCES2;
-                download();
             }
             break;
         case UPDATE_RESOURCES2:
-            if (mDownloadComplete)
+            if (mDownloadComplete
+                && downloadResources(mTempUpdateFiles, false))
             {
-                if (mUpdateIndex < mTempUpdateFiles.size())
-                {
-                    UpdateFile thisFile = mTempUpdateFiles[mUpdateIndex];
-                    mCurrentFile = thisFile.name;
-                    std::string checksum;
-                    checksum = thisFile.hash;
-                    std::stringstream ss(checksum);
-                    ss >> std::hex >> mCurrentChecksum;
-
-                    std::ifstream temp((std::string(mUpdatesDir).append(
-                        "/").append(mCurrentFile)).c_str());
-
-                    if (!temp.is_open() || !validateFile(std::string(
-                        mUpdatesDir).append("/").append(mCurrentFile),
-                        mCurrentChecksum))
-                    {
-                        temp.close();
-                        download();
-                    }
-                    else
-                    {
-                        temp.close();
-                        logger->log("%s already here", mCurrentFile.c_str());
-                    }
-                    mUpdateIndex++;
-                }
-                else
-                {
-                    mUpdatesDir = mUpdatesDirReal;
-                    mDownloadStatus = UPDATE_COMPLETE;
-                }
+                mUpdatesDir = mUpdatesDirReal;
+                mDownloadStatus = UPDATE_COMPLETE;
             }
             break;
         case UPDATE_COMPLETE:
             mUpdatesDir = mUpdatesDirReal;
+            saveManifest();
             enable();
             // TRANSLATORS: updater window label
             setLabel(_("Completed"));
@@ -876,6 +814,249 @@ bool UpdaterWindow::validateFile(const std::string &filePath,
     return adler == hash;
 }
 
+int UpdaterWindow::resourceProgress(void *ptr, DownloadStatus status,
+                                    size_t dt, size_t dn)
+{
+    UpdateDownload *const dl = static_cast<UpdateDownload*>(ptr);
+    if (!dl || !dl->window)
+        return -1;
+
+    UpdaterWindow *const uw = dl->window;
+    {
+        MutexLocker lock(&uw->mDownloadMutex);
+        dl->status = status;
+        if (status == DOWNLOAD_STATUS_IDLE)
+        {
+            dl->total = dt;
+            dl->done = dn;
+        }
+    }
+
+    if (Client::getState() != STATE_UPDATE
+        || uw->mDownloadStatus == UPDATE_ERROR)
+    {
+        // If the action was canceled return an error code to stop the mThread
+        return -1;
+    }
+    return 0;
+}
+
+bool UpdaterWindow::downloadResources(const std::vector<UpdateFile> &files,
+                                      const bool checkOptional)
+{
+    // handle finished downloads
+    std::list<UpdateDownload*>::iterator it = mResourceDownloads.begin();
+    while (it != mResourceDownloads.end())
+    {
+        UpdateDownload *const dl = *it;
+        DownloadStatus status;
+        {
+            MutexLocker lock(&mDownloadMutex);
+            status = dl->status;
+        }
+        if (status == DOWNLOAD_STATUS_COMPLETE)
+        {
+            addToManifest(dl->name, dl->checksum);
+            delete dl->download;
+            delete dl;
+            it = mResourceDownloads.erase(it);
+        }
+        else if (status == DOWNLOAD_STATUS_ERROR
+                 || status == DOWNLOAD_STATUS_CANCELLED
+                 || status == DOWNLOAD_STATUS_THREAD_ERROR)
+        {
+            // failed download is kept to show its error
+            mResourceDownloads.erase(it);
+            mDownloadStatus = UPDATE_ERROR;
+            cancelResourceDownloads();
+            dl->download->cancel();
+            delete mDownload;
+            mDownload = dl->download;
+            delete dl;
+            return false;
+        }
+        else
+        {
+            ++ it;
+        }
+    }
+
+    // start new downloads
+    bool fileRead = false;
+    const unsigned int sz = static_cast<unsigned int>(files.size());
+    while (mResourceDownloads.size() < mMaxDownloads && mUpdateIndex < sz
+           && !fileRead)
+    {
+        const UpdateFile &thisFile = files[mUpdateIndex];
+        if (checkOptional && !thisFile.required)
+        {
+            // Optional files are only music, downloaded if download-music
+            // is set.
+            if (!(thisFile.type == "music"
+                && config.getBoolValue("download-music")))
+            {
+                mUpdateIndex++;
+                continue;
+            }
+        }
+
+        unsigned long checksum = 0;
+        std::stringstream ss(thisFile.hash);
+        ss >> std::hex >> checksum;
+
+        mUpdateIndex++;
+        if (isFileValid(thisFile.name, checksum, fileRead))
+        {
+            logger->log("%s already here", thisFile.name.c_str());
+            continue;
+        }
+
+        UpdateDownload *const dl = new UpdateDownload(this,
+            thisFile.name, checksum);
+        dl->download = new Net::Download(dl, std::string(mUpdateHost)
+            .append("/").append(thisFile.name), resourceProgress);
+        dl->download->setFile(std::string(mUpdatesDir).append("/").append(
+            thisFile.name), checksum);
+        mResourceDownloads.push_back(dl);
+        dl->download->start();
+    }
+
+    if (mResourceDownloads.empty())
+        return mUpdateIndex >= sz;
+
+    // show first file and progress of all active downloads
+    size_t total = 0;
+    size_t done = 0;
+    {
+        MutexLocker lock(&mDownloadMutex);
+        FOR_EACH (std::list<UpdateDownload*>::const_iterator, it2,
+                  mResourceDownloads)
+        {
+            total += (*it2)->total;
+            done += (*it2)->done;
+        }
+    }
+    float progress = total ? static_cast<float>(done)
+        / static_cast<float>(total) : 0.0f;
+    if (progress > 1.0f)
+        progress = 1.0f;
+    mCurrentFile = mResourceDownloads.front()->name;
+    setLabel(std::string(mCurrentFile).append(" (").append(
+        toString(static_cast<int>(progress * 100))).append("%)"));
+    setProgress(progress);
+    return false;
+}
+
+void UpdaterWindow::cancelResourceDownloads()
+{
+    FOR_EACH (std::list<UpdateDownload*>::iterator, it, mResourceDownloads)
+    {
+        UpdateDownload *const dl = *it;
+        dl->download->cancel();
+        delete dl->download;
+        delete dl;
+    }
+    mResourceDownloads.clear();
+}
+
+std::string UpdaterWindow::getManifestKey(const std::string &name) const
+{
+    // files from fix directory are stored with its name
+    if (mUpdatesDir.size() > mUpdatesDirReal.size())
+    {
+        return mUpdatesDir.substr(mUpdatesDirReal.size() + 1)
+            .append("/").append(name);
+    }
+    return name;
+}
+
+bool UpdaterWindow::isFileValid(const std::string &name,
+                                const unsigned long checksum,
+                                bool &fileRead)
+{
+    const std::string path = std::string(mUpdatesDir).append("/").append(
+        name);
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf))
+        return false;
+
+    const UpdateManifest::const_iterator it
+        = mManifest.find(getManifestKey(name));
+    if (it != mManifest.end()
+        && it->second.size == static_cast<long>(statbuf.st_size)
+        && it->second.time == static_cast<long>(statbuf.st_mtime))
+    {
+        return it->second.checksum == checksum;
+    }
+
+    fileRead = true;
+    if (!validateFile(path, checksum))
+        return false;
+    addToManifest(name, checksum);
+    return true;
+}
+
+void UpdaterWindow::addToManifest(const std::string &name,
+                                  const unsigned long checksum)
+{
+    const std::string path = std::string(mUpdatesDir).append("/").append(
+        name);
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf))
+        return;
+
+    UpdateManifestEntry &entry = mManifest[getManifestKey(name)];
+    entry.size = static_cast<long>(statbuf.st_size);
+    entry.time = static_cast<long>(statbuf.st_mtime);
+    entry.checksum = checksum;
+    mManifestChanged = true;
+}
+
+void UpdaterWindow::loadManifest()
+{
+    std::ifstream file((std::string(mUpdatesDirReal).append("/").append(
+        manifestFile)).c_str(), std::ios::in);
+    if (!file.is_open())
+        return;
+
+    // each line is size, time, checksum and file name
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::stringstream ss(line);
+        UpdateManifestEntry entry;
+        std::string name;
+        ss >> entry.size >> entry.time >> std::hex >> entry.checksum;
+        ss.ignore(1);
+        std::getline(ss, name);
+        if (!ss.fail() && !name.empty())
+            mManifest[name] = entry;
+    }
+}
+
+void UpdaterWindow::saveManifest()
+{
+    if (!mManifestChanged)
+        return;
+
+    std::ofstream file((std::string(mUpdatesDirReal).append("/").append(
+        manifestFile)).c_str(), std::ios::out);
+    if (!file.is_open())
+    {
+        logger->log("Error: cant write update manifest in %s",
+            mUpdatesDirReal.c_str());
+        return;
+    }
+
+    FOR_EACH (UpdateManifest::const_iterator, it, mManifest)
+    {
+        const UpdateManifestEntry &entry = it->second;
+        file << entry.size << " " << entry.time << " " << std::hex
+            << entry.checksum << std::dec << " " << it->first << std::endl;
+    }
+    mManifestChanged = false;
+}
+
 void UpdaterWindow::handleLink(const std::string &link,
                                gcn::MouseEvent *event A_UNUSED)
 {
@@ -33,6 +33,8 @@
 #include <guichan/actionlistener.hpp>
 #include <guichan/keylistener.hpp>
 
+#include <list>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -61,6 +63,59 @@ struct UpdateFile final
         bool required;
 };
 
+class UpdaterWindow;
+
+/**
+ * Update archive downloaded in parallel with others.
+ */
+struct UpdateDownload final
+{
+    public:
+        UpdateDownload(UpdaterWindow *const window0,
+                       const std::string &name0,
+                       const unsigned long checksum0) :
+            window(window0),
+            download(nullptr),
+            name(name0),
+            checksum(checksum0),
+            total(0),
+            done(0),
+            status(DOWNLOAD_STATUS_STARTING)
+        {
+        }
+
+        A_DELETE_COPY(UpdateDownload)
+
+        UpdaterWindow *window;
+        Net::Download *download;
+        std::string name;
+        unsigned long checksum;
+        size_t total;
+        size_t done;
+        DownloadStatus status;
+};
+
+/**
+ * Size, time and checksum of valid update archive, so it is not read
+ * again on next start.
+ */
+struct UpdateManifestEntry final
+{
+    public:
+        UpdateManifestEntry() :
+            size(0),
+            time(0),
+            checksum(0)
+        {
+        }
+
+        long size;
+        long time;
+        unsigned long checksum;
+};
+
+typedef std::map<std::string, UpdateManifestEntry> UpdateManifest;
+
 /**
  * Update progress window GUI
  *
@@ -159,6 +214,40 @@ private:
     static bool validateFile(const std::string &filePath,
                              const unsigned long hash) A_WARN_UNUSED;
 
+    /**
+     * A download callback for update archives downloaded in parallel.
+     */
+    static int resourceProgress(void *ptr, DownloadStatus status,
+                                size_t dt, size_t dn);
+
+    /**
+     * Starts downloads of archives from list until connection limit is
+     * reached and handles finished ones.
+     *
+     * @returns true when all files are here.
+     */
+    bool downloadResources(const std::vector<UpdateFile> &files,
+                           const bool checkOptional);
+
+    void cancelResourceDownloads();
+
+    /**
+     * Checks file using manifest, or its contents if file is changed.
+     * In last case fileRead is set.
+     */
+    bool isFileValid(const std::string &name, const unsigned long checksum,
+                     bool &fileRead);
+
+    std::string getManifestKey(const std::string &name) const
+                               A_WARN_UNUSED;
+
+    void addToManifest(const std::string &name,
+                       const unsigned long checksum);
+
+    void loadManifest();
+
+    void saveManifest();
+
     enum UpdateDownloadStatus
     {
         UPDATE_ERROR = 0,
@@ -217,6 +306,17 @@ private:
     /** Download handle. */
     Net::Download *mDownload;
 
+    /** Update archives downloading now. */
+    std::list<UpdateDownload*> mResourceDownloads;
+
+    /** Valid archives by path relative to updates directory. */
+    UpdateManifest mManifest;
+
+    /** Max update archives downloaded at once. */
+    unsigned int mMaxDownloads;
+
+    bool mManifestChanged;
+
     /** List of files to download. */
     std::vector<UpdateFile> mUpdateFiles;
 
@@ -389,12 +389,14 @@ void Viewport::_drawPath(Graphics *const graphics, const Path &path,
 
             graphics->fillRectangle(gcn::Rectangle(squareX - 4, squareY - 4,
                                                    8, 8));
-            if (mMap)
+            const PathNode *const node = mMap
+                ? mMap->getSearchContext().getNode(i->x / 32, i->y / 32)
+                : nullptr;
+            if (node)
             {
-                const std::string str = toString(mMap->getMetaTile(
-                    i->x / 32, i->y / 32)->Gcost);
+                const std::string str = toString(node->Gcost);
                 font->drawString(graphics, str,
-                    squareX + 4 - font->getWidth(text) / 2, squareY + 12);
+                    squareX + 4 - font->getWidth(str) / 2, squareY + 12);
             }
         }
     }
@@ -27,6 +27,7 @@
 
 #include "gui/gui.h"
 #include "gui/sdlfont.h"
+#include "gui/textlayoutcache.h"
 
 #include "gui/widgets/linkhandler.h"
 
@@ -50,15 +51,18 @@ BrowserBox::BrowserBox(const Widget2 *const widget, const unsigned int mode,
     Widget2(widget),
     gcn::MouseListener(),
     mTextRows(),
-    mTextRowLinksCount(),
-    mLineParts(),
-    mLinks(),
+    mRows(),
     mLinkHandler(nullptr),
+    mLayoutFont(nullptr),
     mMode(mode),
     mHighMode(UNDERLINE | BACKGROUND),
     mOpaque(opaque),
     mUseLinksAndUserColors(true),
+    mSelectedRow(-1),
     mSelectedLink(-1),
+    mRowsTop(0),
+    mRowsHeight(0),
+    mLayoutWidth(-1),
     mMaxRows(0),
     mHeight(0),
     mWidth(0),
@@ -144,7 +148,7 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
     std::string newRow;
     size_t idx1;
     const gcn::Font *const font = getFont();
-    int linksCount = 0;
+    BrowserRow browserRow;
 
     if (getWidth() < 0)
         return;
@@ -156,7 +160,6 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
 
         // Check for links in format "@@link|Caption@@"
         idx1 = tmp.find("@@");
-        const int sz = static_cast<int>(mTextRows.size());
         while (idx1 != std::string::npos)
         {
             const size_t idx2 = tmp.find("|", idx1);
@@ -166,26 +169,11 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
                 break;
             bLink.link = tmp.substr(idx1 + 2, idx2 - (idx1 + 2));
             bLink.caption = tmp.substr(idx2 + 1, idx3 - (idx2 + 1));
-            bLink.y1 = sz * font->getHeight();
-            bLink.y2 = bLink.y1 + font->getHeight();
 
             newRow.append(tmp.substr(0, idx1));
 
-            std::string tmp2 = newRow;
-            idx1 = tmp2.find("##");
-            while (idx1 != std::string::npos)
-            {
-                tmp2.erase(idx1, 3);
-                idx1 = tmp2.find("##");
-            }
-            bLink.x1 = font->getWidth(tmp2) - 1;
-            bLink.x2 = bLink.x1 + font->getWidth(bLink.caption) + 1;
-
-            if (atTop)
-                mLinks.insert(mLinks.begin(), bLink);
-            else
-                mLinks.push_back(bLink);
-            linksCount ++;
+            // position will be set by row layout
+            browserRow.links.push_back(bLink);
 
             newRow.append("##<").append(bLink.caption);
 
@@ -210,12 +198,14 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
     if (atTop)
     {
         mTextRows.push_front(newRow);
-        mTextRowLinksCount.push_front(linksCount);
+        mRows.push_front(browserRow);
+        if (mSelectedRow >= 0)
+            mSelectedRow ++;
     }
     else
     {
         mTextRows.push_back(newRow);
-        mTextRowLinksCount.push_back(linksCount);
+        mRows.push_back(browserRow);
     }
 
     // discard older rows when a row limit has been set
@@ -224,13 +214,18 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
         while (mTextRows.size() > mMaxRows)
         {
             mTextRows.pop_front();
-            int cnt = mTextRowLinksCount.front();
-            mTextRowLinksCount.pop_front();
-
-            while (cnt && !mLinks.empty())
+            const BrowserRow &front = mRows.front();
+            if (front.laidOut)
+                mRowsHeight -= front.sizeHeight;
+            mRows.pop_front();
+            if (!mRows.empty() && mRows.front().laidOut)
+                mRowsTop = mRows.front().y - mPadding;
+
+            if (mSelectedRow >= 0)
             {
-                mLinks.erase(mLinks.begin());
-                cnt --;
+                mSelectedRow --;
+                if (mSelectedRow < 0)
+                    mSelectedLink = -1;
             }
         }
     }
@@ -252,61 +247,6 @@ void BrowserBox::addRow(const std::string &row, const bool atTop)
             setWidth(w);
     }
 
-    if (mMode == AUTO_WRAP)
-    {
-        unsigned int y = 0;
-        unsigned int nextChar;
-        const char *const hyphen = "~";
-        const int hyphenWidth = font->getWidth(hyphen);
-        unsigned x = 0;
-
-        FOR_EACH (TextRowCIter, i, mTextRows)
-        {
-            std::string tempRow = *i;
-            for (unsigned int j = 0, sz = static_cast<unsigned int>(
-                 tempRow.size()); j < sz; j++)
-            {
-                std::string character = tempRow.substr(j, 1);
-                x += font->getWidth(character);
-                nextChar = j + 1;
-
-                // Wraping between words (at blank spaces)
-                if (nextChar < sz && tempRow.at(nextChar) == ' ')
-                {
-                    int nextSpacePos = static_cast<int>(
-                        tempRow.find(" ", (nextChar + 1)));
-                    if (nextSpacePos <= 0)
-                        nextSpacePos = static_cast<int>(sz) - 1;
-
-                    const unsigned nextWordWidth = font->getWidth(
-                        tempRow.substr(nextChar,
-                        (nextSpacePos - nextChar)));
-
-                    if ((x + nextWordWidth + 10)
-                        > static_cast<unsigned>(getWidth()))
-                    {
-                        x = mNewLinePadding;  // Ident in new line
-                        y += 1;
-                        j ++;
-                    }
-                }
-                // Wrapping looong lines (brutal force)
-                else if ((x + 2 * hyphenWidth)
-                         > static_cast<unsigned>(getWidth()))
-                {
-                    x = mNewLinePadding;  // Ident in new line
-                    y += 1;
-                }
-            }
-        }
-
-        setHeight(font->getHeight() * (static_cast<int>(
-            mTextRows.size()) + y));
-    }
-    else
-    {
-        setHeight(font->getHeight() * static_cast<int>(mTextRows.size()));
-    }
     mUpdateTime = 0;
     updateHeight();
 }
@@ -323,16 +263,18 @@ void BrowserBox::addImage(const std::string &path)
         return;
 
     mTextRows.push_back("~~~" + path);
-    mTextRowLinksCount.push_back(0);
+    mRows.push_back(BrowserRow());
 }
 
 void BrowserBox::clearRows()
 {
     mTextRows.clear();
-    mTextRowLinksCount.clear();
-    mLinks.clear();
+    mRows.clear();
+    mRowsTop = 0;
+    mRowsHeight = 0;
     setWidth(0);
     setHeight(0);
+    mSelectedRow = -1;
     mSelectedLink = -1;
     mUpdateTime = 0;
     updateHeight();
@@ -352,28 +294,76 @@ struct MouseOverLink
     int mX, mY;
 };
 
+struct RowAboveY
+{
+    bool operator() (const int y, const BrowserRow &row) const
+    {
+        return y < row.y;
+    }
+};
+
+int BrowserBox::findRow(const int y) const
+{
+    // not laid out rows can be only at top or bottom
+    RowCIter first = mRows.begin();
+    RowCIter last = mRows.end();
+    while (first != last && !(*first).laidOut)
+        ++ first;
+    while (last != first && !(*(last - 1)).laidOut)
+        -- last;
+    if (first == last)
+        return -1;
+
+    // rows y is stored with mRowsTop offset
+    const RowCIter it = std::upper_bound(first, last,
+        y + mRowsTop, RowAboveY());
+    if (it == first)
+        return static_cast<int>(first - mRows.begin());
+    return static_cast<int>(it - mRows.begin()) - 1;
+}
+
+bool BrowserBox::findLink(const int x, const int y,
+                          int &row, int &link) const
+{
+    const int rowIdx = findRow(y);
+    if (rowIdx < 0)
+        return false;
+
+    const BrowserRow &browserRow = mRows[rowIdx];
+    if (!browserRow.laidOut)
+        return false;
+    const Links &links = browserRow.links;
+    const LinkCIter i = std::find_if(links.begin(), links.end(),
+        MouseOverLink(x, y + mRowsTop - browserRow.y));
+    if (i == links.end())
+        return false;
+
+    row = rowIdx;
+    link = static_cast<int>(i - links.begin());
+    return true;
+}
+
 void BrowserBox::mousePressed(gcn::MouseEvent &event)
 {
     if (!mLinkHandler)
         return;
 
-    const LinkIterator i = std::find_if(mLinks.begin(), mLinks.end(),
-        MouseOverLink(event.getX(), event.getY()));
-
-    if (i != mLinks.end())
+    int row = -1;
+    int link = -1;
+    if (findLink(event.getX(), event.getY(), row, link))
     {
-        mLinkHandler->handleLink(i->link, &event);
+        mLinkHandler->handleLink(mRows[row].links[link].link, &event);
         event.consume();
     }
 }
 
 void BrowserBox::mouseMoved(gcn::MouseEvent &event)
 {
-    const LinkIterator i = std::find_if(mLinks.begin(), mLinks.end(),
-        MouseOverLink(event.getX(), event.getY()));
-
-    mSelectedLink = (i != mLinks.end())
-        ? static_cast<int>(i - mLinks.begin()) : -1;
+    if (!findLink(event.getX(), event.getY(), mSelectedRow, mSelectedLink))
+    {
+        mSelectedRow = -1;
+        mSelectedLink = -1;
+    }
 }
 
 void BrowserBox::draw(gcn::Graphics *graphics)
@@ -395,336 +385,445 @@ void BrowserBox::draw(gcn::Graphics *graphics)
         graphics->fillRectangle(gcn::Rectangle(0, 0, getWidth(), getHeight()));
     }
 
-    if (mSelectedLink >= 0 && mSelectedLink
-        < static_cast<signed>(mLinks.size()))
+    if (mSelectedRow >= 0 && mSelectedRow
+        < static_cast<signed>(mRows.size()) && mSelectedLink >= 0
+        && mSelectedLink < static_cast<signed>(
+        mRows[mSelectedRow].links.size()))
     {
+        const BrowserRow &row = mRows[mSelectedRow];
+        const BrowserLink &link = row.links[mSelectedLink];
+        const int y1 = row.y - mRowsTop + link.y1;
+        const int y2 = row.y - mRowsTop + link.y2;
         if ((mHighMode & BACKGROUND))
         {
             graphics->setColor(mHighlightColor);
             graphics->fillRectangle(gcn::Rectangle(
-                mLinks[mSelectedLink].x1,
-                mLinks[mSelectedLink].y1,
-                mLinks[mSelectedLink].x2 - mLinks[mSelectedLink].x1,
-                mLinks[mSelectedLink].y2 - mLinks[mSelectedLink].y1));
+                link.x1, y1, link.x2 - link.x1, y2 - y1));
         }
 
         if ((mHighMode & UNDERLINE))
         {
             graphics->setColor(mHyperLinkColor);
-            graphics->drawLine(
-                mLinks[mSelectedLink].x1,
-                mLinks[mSelectedLink].y2,
-                mLinks[mSelectedLink].x2,
-                mLinks[mSelectedLink].y2);
+            graphics->drawLine(link.x1, y2, link.x2, y2);
         }
     }
 
     gcn::Font *const font = getFont();
 
-    FOR_EACH (LinePartCIter, i, mLineParts)
+    const int startRow = findRow(mYStart - 50);
+    const int sz = static_cast<int>(mRows.size());
+    for (int f = startRow >= 0 ? startRow : sz; f < sz; f ++)
     {
-        const LinePart &part = *i;
-        if (part.mY + 50 < mYStart)
+        const BrowserRow &row = mRows[f];
+        if (!row.laidOut)
             continue;
-        if (part.mY > yEnd)
+        const int rowY = row.y - mRowsTop;
+        if (rowY > yEnd)
             break;
-        if (!part.mType)
-        {
-            graphics2->setColorAll(part.mColor, part.mColor2);
-            if (part.mBold)
-                boldFont->drawString(graphics, part.mText, part.mX, part.mY);
-            else
-                font->drawString(graphics, part.mText, part.mX, part.mY);
-        }
-        else if (part.mImage)
+
+        FOR_EACH (LinePartCIter, i, row.parts)
         {
-            graphics2->drawImage(part.mImage, part.mX, part.mY);
+            const LinePart &part = *i;
+            const int y = rowY + part.mY;
+            if (!part.mType)
+            {
+                graphics2->setColorAll(part.mColor, part.mColor2);
+                if (part.mBold)
+                    boldFont->drawString(graphics, part.mText, part.mX, y);
+                else
+                    font->drawString(graphics, part.mText, part.mX, y);
+            }
+            else if (part.mImage)
+            {
+                graphics2->drawImage(part.mImage, part.mX, y);
+            }
         }
     }
 
     BLOCK_END("BrowserBox::draw")
 }
 
-int BrowserBox::calcHeight()
+void BrowserBox::layoutRow(BrowserRow &row, const std::string &text,
+                           const gcn::Color *const startColor,
+                           const unsigned int wWidth, int &maxWidth)
 {
-    unsigned int y = mPadding;
+    unsigned int y = 0;
     int wrappedLines = 0;
-    int moreHeight = 0;
-    int maxWidth = getWidth() - mPadding;
     int link = 0;
     bool bold = false;
-    unsigned int wWidth = maxWidth;
-
-    if (maxWidth < 0)
-        return 1;
+    unsigned int x = mPadding;
+    bool wrapped = false;
 
     const gcn::Font *const font = getFont();
 
     const int fontHeight = font->getHeight();
-    const int fontWidthMinus = font->getWidth("-");
     const char *const hyphen = "~";
-    const int hyphenWidth = font->getWidth(hyphen);
+    const int hyphenWidth = textLayoutCache.getWidth(font, hyphen);
 
-    gcn::Color selColor[2] = {mForegroundColor, mForegroundColor2};
+    gcn::Color selColor[2] = {startColor[0], startColor[1]};
     const gcn::Color textColor[2] = {mForegroundColor, mForegroundColor2};
-    ResourceManager *const resman = ResourceManager::getInstance();
 
-    mLineParts.clear();
+    row.parts.clear();
+    row.textWidth = 0;
+    row.wrapped = false;
+    row.widthDepend = false;
+    row.image = false;
+    row.laidOut = true;
 
-    FOR_EACH (TextRowCIter, i, mTextRows)
+    // Check for separator lines
+    if (text.find("---", 0) == 0)
     {
-        unsigned int x = mPadding;
-        const std::string row = *(i);
-        bool wrapped = false;
-
-        // Check for separator lines
-        if (row.find("---", 0) == 0)
+        const int dashWidth = textLayoutCache.getWidth(font, "-");
+        for (x = mPadding; x < wWidth; x ++)
         {
-            const int dashWidth = fontWidthMinus;
-            for (x = mPadding; x < wWidth; x ++)
-            {
-                mLineParts.push_back(LinePart(x, y,
-                    selColor[0], selColor[1], "-", false));
-                x += dashWidth - 2;
-            }
-
-            y += fontHeight;
-            continue;
+            row.parts.push_back(LinePart(x, y,
+                selColor[0], selColor[1], "-", false));
+            x += dashWidth - 2;
         }
-        else if (mEnableImages && row.find("~~~", 0) == 0)
+
+        row.height = fontHeight;
+        row.sizeHeight = fontHeight;
+        row.widthDepend = true;
+        row.endColor[0] = selColor[0];
+        row.endColor[1] = selColor[1];
+        return;
+    }
+    else if (mEnableImages && text.find("~~~", 0) == 0)
+    {
+        std::string str = text.substr(3);
+        if (str.size() > 2 && str.substr(str.size() - 1) == "~")
+            str = str.substr(0, str.size() - 1);
+        Image *const img = ResourceManager::getInstance()->getImage(str);
+        row.height = 0;
+        row.sizeHeight = fontHeight;
+        row.image = true;
+        if (img)
         {
-            std::string str = row.substr(3);
-            if (str.size() > 2 && str.substr(str.size() - 1) == "~")
-                str = str.substr(0, str.size() - 1);
-            Image *const img = resman->getImage(str);
-            if (img)
-            {
-                img->incRef();
-                mLineParts.push_back(LinePart(x, y,
-                    selColor[0], selColor[1], img));
-                y += img->getHeight() + 2;
-                moreHeight += img->getHeight();
-                if (img->getWidth() > maxWidth)
-                    maxWidth = img->getWidth() + 2;
-            }
-            continue;
+            img->incRef();
+            row.parts.push_back(LinePart(x, y,
+                selColor[0], selColor[1], img));
+            row.height = img->getHeight() + 2;
+            row.sizeHeight += img->getHeight();
+            if (img->getWidth() > maxWidth)
+                maxWidth = img->getWidth() + 2;
+            row.textWidth = img->getWidth();
         }
+        row.endColor[0] = selColor[0];
+        row.endColor[1] = selColor[1];
+        return;
+    }
 
-        gcn::Color prevColor[2];
-        prevColor[0] = selColor[0];
-        prevColor[1] = selColor[1];
-        bold = false;
+    gcn::Color prevColor[2];
+    prevColor[0] = selColor[0];
+    prevColor[1] = selColor[1];
 
-        for (size_t start = 0, end = std::string::npos;
-             start != std::string::npos;
-             start = end, end = std::string::npos)
+    for (size_t start = 0, end = std::string::npos;
+         start != std::string::npos;
+         start = end, end = std::string::npos)
+    {
+        // Wrapped line continuation shall be indented
+        if (wrapped)
         {
-            // Wrapped line continuation shall be indented
-            if (wrapped)
-            {
-                y += fontHeight;
-                x = mNewLinePadding + mPadding;
-                wrapped = false;
-            }
+            y += fontHeight;
+            x = mNewLinePadding + mPadding;
+            wrapped = false;
+        }
 
-            // "Tokenize" the string at control sequences
-            if (mUseLinksAndUserColors)
-                end = row.find("##", start + 1);
+        // "Tokenize" the string at control sequences
+        if (mUseLinksAndUserColors)
+            end = text.find("##", start + 1);
 
-            if (mUseLinksAndUserColors ||
-                (!mUseLinksAndUserColors && (start == 0)))
+        if (mUseLinksAndUserColors ||
+            (!mUseLinksAndUserColors && (start == 0)))
+        {
+            // Check for color change in format "##x", x = [L,P,0..9]
+            if (text.find("##", start) == start && text.size() > start + 2)
             {
-                // Check for color change in format "##x", x = [L,P,0..9]
-                if (row.find("##", start) == start && row.size() > start + 2)
-                {
-                    const signed char c = row.at(start + 2);
+                const signed char c = text.at(start + 2);
 
-                    bool valid(false);
-                    const gcn::Color col[2] =
-                    {
-                        getThemeCharColor(c, valid),
-                        getThemeCharColor(c | 0x80, valid)
-                    };
-
-                    if (c == '>')
-                    {
-                        selColor[0] = prevColor[0];
-                        selColor[1] = prevColor[1];
-                    }
-                    else if (c == '<')
-                    {
-                        prevColor[0] = selColor[0];
-                        prevColor[1] = selColor[1];
-                        selColor[0] = col[0];
-                        selColor[1] = col[1];
-                    }
-                    else if (c == 'B')
-                    {
-                        bold = true;
-                    }
-                    else if (c == 'b')
-                    {
-                        bold = false;
-                    }
-                    else if (valid)
-                    {
-                        selColor[0] = col[0];
-                        selColor[1] = col[1];
-                    }
-                    else
-                    {
-                        switch (c)
-                        {
-                            case '1':
-                                selColor[0] = mColors[0][RED];
-                                selColor[1] = mColors[1][RED];
-                                break;
-                            case '2':
-                                selColor[0] = mColors[0][GREEN];
-                                selColor[1] = mColors[1][GREEN];
-                                break;
-                            case '3':
-                                selColor[0] = mColors[0][BLUE];
-                                selColor[1] = mColors[1][BLUE];
-                                break;
-                            case '4':
-                                selColor[0] = mColors[0][ORANGE];
-                                selColor[1] = mColors[1][ORANGE];
-                                break;
-                            case '5':
-                                selColor[0] = mColors[0][YELLOW];
-                                selColor[1] = mColors[1][YELLOW];
-                                break;
-                            case '6':
-                                selColor[0] = mColors[0][PINK];
-                                selColor[1] = mColors[1][PINK];
-                                break;
-                            case '7':
-                                selColor[0] = mColors[0][PURPLE];
-                                selColor[1] = mColors[1][PURPLE];
-                                break;
-                            case '8':
-                                selColor[0] = mColors[0][GRAY];
-                                selColor[1] = mColors[1][GRAY];
-                                break;
-                            case '9':
-                                selColor[0] = mColors[0][BROWN];
-                                selColor[1] = mColors[1][BROWN];
-                                break;
-                            case '0':
-                            default:
-                                selColor[0] = textColor[0];
-                                selColor[1] = textColor[1];
-                        }
-                    }
+                bool valid(false);
+                const gcn::Color col[2] =
+                {
+                    getThemeCharColor(c, valid),
+                    getThemeCharColor(c | 0x80, valid)
+                };
 
-                    if (c == '<' && link < static_cast<signed>(mLinks.size()))
+                if (c == '>')
+                {
+                    selColor[0] = prevColor[0];
+                    selColor[1] = prevColor[1];
+                }
+                else if (c == '<')
+                {
+                    prevColor[0] = selColor[0];
+                    prevColor[1] = selColor[1];
+                    selColor[0] = col[0];
+                    selColor[1] = col[1];
+                }
+                else if (c == 'B')
+                {
+                    bold = true;
+                }
+                else if (c == 'b')
+                {
+                    bold = false;
+                }
+                else if (valid)
+                {
+                    selColor[0] = col[0];
+                    selColor[1] = col[1];
+                }
+                else
+                {
+                    switch (c)
                     {
-                        const int size =
-                            font->getWidth(mLinks[link].caption) + 1;
-
-                        mLinks[link].x1 = x;
-                        mLinks[link].y1 = y;
-                        mLinks[link].x2 = mLinks[link].x1 + size;
-                        mLinks[link].y2 = y + fontHeight - 1;
-                        link++;
+                        case '1':
+                            selColor[0] = mColors[0][RED];
+                            selColor[1] = mColors[1][RED];
+                            break;
+                        case '2':
+                            selColor[0] = mColors[0][GREEN];
+                            selColor[1] = mColors[1][GREEN];
+                            break;
+                        case '3':
+                            selColor[0] = mColors[0][BLUE];
+                            selColor[1] = mColors[1][BLUE];
+                            break;
+                        case '4':
+                            selColor[0] = mColors[0][ORANGE];
+                            selColor[1] = mColors[1][ORANGE];
+                            break;
+                        case '5':
+                            selColor[0] = mColors[0][YELLOW];
+                            selColor[1] = mColors[1][YELLOW];
+                            break;
+                        case '6':
+                            selColor[0] = mColors[0][PINK];
+                            selColor[1] = mColors[1][PINK];
+                            break;
+                        case '7':
+                            selColor[0] = mColors[0][PURPLE];
+                            selColor[1] = mColors[1][PURPLE];
+                            break;
+                        case '8':
+                            selColor[0] = mColors[0][GRAY];
+                            selColor[1] = mColors[1][GRAY];
+                            break;
+                        case '9':
+                            selColor[0] = mColors[0][BROWN];
+                            selColor[1] = mColors[1][BROWN];
+                            break;
+                        case '0':
+                        default:
+                            selColor[0] = textColor[0];
+                            selColor[1] = textColor[1];
                     }
-                    start += 3;
+                }
 
-                    if (start == row.size())
-                        break;
+                if (c == '<' && link < static_cast<signed>(row.links.size()))
+                {
+                    BrowserLink &bLink = row.links[link];
+                    const int size = textLayoutCache.getWidth(font,
+                        bLink.caption) + 1;
+
+                    bLink.x1 = x;
+                    bLink.y1 = y;
+                    bLink.x2 = bLink.x1 + size;
+                    bLink.y2 = y + fontHeight - 1;
+                    link++;
                 }
+                start += 3;
+
+                if (start == text.size())
+                    break;
             }
+        }
 
-            const size_t len = (end == std::string::npos) ? end : end - start;
+        const size_t len = (end == std::string::npos) ? end : end - start;
 
-            if (start >= row.length())
-                break;
+        if (start >= text.length())
+            break;
 
-            std::string part = row.substr(start, len);
+        std::string part = text.substr(start, len);
 
-            int width = 0;
-            if (bold)
-                width = boldFont->getWidth(part);
-            else
-                width = font->getWidth(part);
+        int width = textLayoutCache.getWidth(bold ? boldFont : font, part);
+
+        if (static_cast<int>(x) + width > row.textWidth)
+            row.textWidth = x + width;
 
-            // Auto wrap mode
-            if (mMode == AUTO_WRAP && wWidth > 0 && width > 0
-                && (x + width + 10) > wWidth)
+        // Auto wrap mode
+        if (mMode == AUTO_WRAP && wWidth > 0 && width > 0
+            && (x + width + 10) > wWidth)
+        {
+            bool forced = false;
+
+            /* FIXME: This code layout makes it easy to crash remote
+               clients by talking garbage. Forged long utf-8 characters
+               will cause either a buffer underflow in substr or an
+               infinite loop in the main loop. */
+            do
             {
-                bool forced = false;
+                if (!forced)
+                    end = text.rfind(' ', end);
 
-                /* FIXME: This code layout makes it easy to crash remote
-                   clients by talking garbage. Forged long utf-8 characters
-                   will cause either a buffer underflow in substr or an
-                   infinite loop in the main loop. */
-                do
+                // Check if we have to (stupidly) force-wrap
+                if (end == std::string::npos || end <= start)
                 {
-                    if (!forced)
-                        end = row.rfind(' ', end);
+                    forced = true;
+                    end = text.size();
+                    x += hyphenWidth;  // Account for the wrap-notifier
+                    continue;
+                }
 
-                    // Check if we have to (stupidly) force-wrap
-                    if (end == std::string::npos || end <= start)
-                    {
-                        forced = true;
-                        end = row.size();
-                        x += hyphenWidth;  // Account for the wrap-notifier
-                        continue;
-                    }
+                // Skip to the start of the current character
+                while ((text[end] & 192) == 128)
+                    end--;
+                end--;  // And then to the last byte of the previous one
 
-                    // Skip to the start of the current character
-                    while ((row[end] & 192) == 128)
-                        end--;
-                    end--;  // And then to the last byte of the previous one
+                part = text.substr(start, end - start + 1);
+                width = textLayoutCache.getWidth(bold ? boldFont : font,
+                    part);
+            }
+            while (end > start && width > 0 && (x + width + 10) > wWidth);
 
-                    part = row.substr(start, end - start + 1);
-                    if (bold)
-                        width = boldFont->getWidth(part);
-                    else
-                        width = font->getWidth(part);
-                }
-                while (end > start && width > 0 && (x + width + 10) > wWidth);
+            if (forced)
+            {
+                x -= hyphenWidth;  // Remove the wrap-notifier accounting
+                row.parts.push_back(LinePart(wWidth - hyphenWidth,
+                    y, selColor[0], selColor[1], hyphen, bold));
+                end++;  // Skip to the next character
+            }
+            else
+            {
+                end += 2;  // Skip to after the space
+            }
 
-                if (forced)
-                {
-                    x -= hyphenWidth;  // Remove the wrap-notifier accounting
-                    mLineParts.push_back(LinePart(wWidth - hyphenWidth,
-                        y, selColor[0], selColor[1], hyphen, bold));
-                    end++;  // Skip to the next character
-                }
-                else
-                {
-                    end += 2;  // Skip to after the space
-                }
+            wrapped = true;
+            wrappedLines++;
+        }
 
-                wrapped = true;
-                wrappedLines++;
-            }
+        row.parts.push_back(LinePart(x, y, selColor[0], selColor[1],
+            part.c_str(), bold));
 
-            mLineParts.push_back(LinePart(x, y, selColor[0], selColor[1],
-                part.c_str(), bold));
+        width = textLayoutCache.getWidth(bold ? boldFont : font, part);
 
-            if (bold)
-                width = boldFont->getWidth(part);
-            else
-                width = font->getWidth(part);
+        if (mMode == AUTO_WRAP && width == 0)
+            break;
+
+        x += width;
+    }
+
+    row.height = y + fontHeight;
+    row.sizeHeight = (1 + wrappedLines) * fontHeight;
+    row.wrapped = wrappedLines > 0;
+    row.widthDepend = mMode == AUTO_WRAP
+        && (row.wrapped || row.textWidth + 10 > static_cast<int>(wWidth));
+    row.endColor[0] = selColor[0];
+    row.endColor[1] = selColor[1];
+}
+
+int BrowserBox::calcHeight()
+{
+    int maxWidth = getWidth() - mPadding;
+    const unsigned int wWidth = maxWidth;
+
+    if (maxWidth < 0)
+        return 1;
+
+    const gcn::Font *const font = getFont();
+    const gcn::Color textColor[2] = {mForegroundColor, mForegroundColor2};
 
-            if (mMode == AUTO_WRAP && width == 0)
+    if (font != mLayoutFont)
+    {
+        mLayoutFont = font;
+        FOR_EACH (RowIterator, it, mRows)
+            (*it).laidOut = false;
+    }
+
+    if (mLayoutWidth != maxWidth)
+    {
+        // width changed. update only rows what depend on width.
+        const bool wrapMode = mMode == AUTO_WRAP;
+        const gcn::Color *color = textColor;
+        int y = mPadding;
+        mRowsTop = 0;
+        mRowsHeight = 0;
+        TextRowCIter text = mTextRows.begin();
+        FOR_EACH (RowIterator, it, mRows)
+        {
+            BrowserRow &row = *it;
+            if (!row.laidOut || row.widthDepend || (wrapMode
+                && row.textWidth + 10 > static_cast<int>(wWidth)))
+            {
+                layoutRow(row, *text, color, wWidth, maxWidth);
+            }
+            else if (row.image && row.textWidth > maxWidth)
+            {
+                maxWidth = row.textWidth + 2;
+            }
+            row.y = y;
+            y += row.height;
+            mRowsHeight += row.sizeHeight;
+            color = row.endColor;
+            ++ text;
+        }
+        mLayoutWidth = static_cast<int>(wWidth);
+    }
+    else
+    {
+        // rows can be added only to top or bottom
+        RowIterator it = mRows.end();
+        TextRowCIter text = mTextRows.end();
+        while (it != mRows.begin())
+        {
+            -- it;
+            -- text;
+            if ((*it).laidOut)
+            {
+                ++ it;
+                ++ text;
                 break;
+            }
+        }
+        for (; it != mRows.end(); ++ it, ++ text)
+        {
+            BrowserRow &row = *it;
+            const BrowserRow *const prev = it != mRows.begin()
+                ? &*(it - 1) : nullptr;
+            layoutRow(row, *text, prev ? prev->endColor : textColor,
+                wWidth, maxWidth);
+            row.y = prev ? prev->y + prev->height : mRowsTop + mPadding;
+            mRowsHeight += row.sizeHeight;
+        }
 
-            x += width;
+        // rows added to top
+        RowIterator next = mRows.begin();
+        while (next != mRows.end() && !(*next).laidOut)
+            ++ next;
+        if (next != mRows.begin())
+        {
+            it = next;
+            text = mTextRows.begin();
+            std::advance(text, next - mRows.begin());
+            while (it != mRows.begin())
+            {
+                -- it;
+                -- text;
+                BrowserRow &row = *it;
+                layoutRow(row, *text, textColor, wWidth, maxWidth);
+                row.y = next != mRows.end()
+                    ? (*next).y - row.height : mPadding;
+                mRowsHeight += row.sizeHeight;
+                next = it;
+            }
+            mRowsTop = mRows.front().y - mPadding;
         }
-        y += fontHeight;
     }
+
     if (static_cast<signed>(wWidth) != maxWidth)
-    {
-//        wWidth = maxWidth;
         setWidth(maxWidth);
-    }
 
-    return (static_cast<int>(mTextRows.size()) + wrappedLines)
-        * fontHeight + moreHeight + 2 * mPadding;
+    return mRowsHeight + 2 * mPadding;
 }
 
 void BrowserBox::updateHeight()
@@ -752,18 +851,23 @@ std::string BrowserBox::getTextAtPos(const int x, const int y) const
     std::string str;
     int lastY = 0;
 
-    FOR_EACH (LinePartCIter, i, mLineParts)
+    const int rowIdx = findRow(textY);
+    if (rowIdx < 0)
+        return str;
+
+    const BrowserRow &row = mRows[rowIdx];
+    const int rowY = row.y - mRowsTop;
+    FOR_EACH (LinePartCIter, i, row.parts)
     {
         const LinePart &part = *i;
-        if (part.mY + 50 < mYStart)
-            continue;
-        if (part.mY > textY)
+        const int partY = rowY + part.mY;
+        if (partY > textY)
             break;
 
-        if (part.mY > lastY)
+        if (partY > lastY)
         {
             str = part.mText;
-            lastY = part.mY;
+            lastY = partY;
         }
         else
         {
@@ -29,6 +29,7 @@
 #include <guichan/mouselistener.hpp>
 #include <guichan/widget.hpp>
 
+#include <deque>
 #include <list>
 #include <vector>
 
@@ -99,6 +100,39 @@ class LinePart final
         bool mBold;
 };
 
+/**
+ * Layout of one text row. Part and link positions are relative to the row
+ * top, so rows can be added or removed without touching other rows.
+ */
+struct BrowserRow final
+{
+    BrowserRow() :
+        parts(),
+        links(),
+        y(0),
+        height(0),
+        sizeHeight(0),
+        textWidth(0),
+        wrapped(false),
+        widthDepend(false),
+        image(false),
+        laidOut(false)
+    {
+    }
+
+    std::vector<LinePart> parts;
+    std::vector<BrowserLink> links;
+    int y;
+    int height;
+    int sizeHeight;
+    int textWidth;
+    gcn::Color endColor[2];
+    bool wrapped;
+    bool widthDepend;
+    bool image;
+    bool laidOut;
+};
+
 /**
  * A simple browser box able to handle links and forward events to the
  * parent conteiner.
@@ -230,28 +264,48 @@ class BrowserBox final : public gcn::Widget,
         { return mPadding; }
 
     private:
+        typedef std::vector<BrowserLink> Links;
+        typedef Links::iterator LinkIterator;
+        typedef Links::const_iterator LinkCIter;
+
+        typedef std::deque<BrowserRow> Rows;
+        typedef Rows::iterator RowIterator;
+        typedef Rows::const_iterator RowCIter;
+
         int calcHeight() A_WARN_UNUSED;
 
+        void layoutRow(BrowserRow &row, const std::string &text,
+                       const gcn::Color *const startColor,
+                       const unsigned int wWidth, int &maxWidth);
+
+        /**
+         * Returns index of the row at given widget y position, or -1.
+         */
+        int findRow(const int y) const A_WARN_UNUSED;
+
+        bool findLink(const int x, const int y,
+                      int &row, int &link) const A_WARN_UNUSED;
+
         typedef TextRows::iterator TextRowIterator;
         typedef TextRows::const_iterator TextRowCIter;
         TextRows mTextRows;
-        std::list<int> mTextRowLinksCount;
+        Rows mRows;
 
         typedef std::vector<LinePart> LinePartList;
         typedef LinePartList::iterator LinePartIterator;
         typedef LinePartList::const_iterator LinePartCIter;
-        LinePartList mLineParts;
-
-        typedef std::vector<BrowserLink> Links;
-        typedef Links::iterator LinkIterator;
-        Links mLinks;
 
         LinkHandler *mLinkHandler;
+        const gcn::Font *mLayoutFont;
         unsigned int mMode;
         unsigned int mHighMode;
         bool mOpaque;
         bool mUseLinksAndUserColors;
+        int mSelectedRow;
         int mSelectedLink;
+        int mRowsTop;
+        int mRowsHeight;
+        int mLayoutWidth;
         unsigned int mMaxRows;
         int mHeight;
         int mWidth;
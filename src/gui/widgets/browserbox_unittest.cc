@@ -23,14 +23,19 @@
 #include "client.h"
 
 #include "gui/sdlfont.h"
+#include "gui/textlayoutcache.h"
 #include "gui/theme.h"
 
 #include "gui/widgets/browserbox.h"
 
+#include "utils/stringutils.h"
+
 #include "gtest/gtest.h"
 
 #include <physfs.h>
 
+#include <SDL_timer.h>
+
 #include <list>
 #include <string>
 #include <vector>
@@ -118,3 +123,101 @@ TEST(browserbox, test1)
     box->addRow(row);
     row = "11|22##><##";
 }
+
+TEST(browserbox, incrementalLayout)
+{
+    PHYSFS_init("manaplus");
+    dirSeparator = "/";
+    Client::Options options;
+    Client client(options);
+
+    logger = new Logger();
+    Theme::instance();
+    gcn::Widget::setGlobalFont(new SDLFont("/usr/share/fonts/truetype/"
+        "ttf-dejavu/DejaVuSans-Oblique.ttf", 18));
+    BrowserBox *box = new BrowserBox(nullptr, BrowserBox::AUTO_WRAP);
+    box->setWidth(100);
+    box->setMaxRow(5);
+    for (int f = 0; f < 20; f ++)
+    {
+        box->addRow(strprintf("##1row %d with some long text to wrap", f));
+        box->addRow("short");
+    }
+    const int height = box->getHeight();
+    EXPECT_EQ(5U, box->getRows().size());
+
+    box->setWidth(300);
+    box->updateHeight();
+    EXPECT_GT(height, box->getHeight());
+    box->setWidth(100);
+    box->updateHeight();
+    EXPECT_EQ(height, box->getHeight());
+
+    const BrowserBox::TextRows rows = box->getRows();
+    box->clearRows();
+    box->setWidth(100);
+    FOR_EACH (BrowserBox::TextRows::const_iterator, it, rows)
+        box->addRow(*it);
+    EXPECT_EQ(height, box->getHeight());
+    delete box;
+}
+
+TEST(browserbox, layoutBenchmark)
+{
+    PHYSFS_init("manaplus");
+    dirSeparator = "/";
+    Client::Options options;
+    Client client(options);
+
+    logger = new Logger();
+    Theme::instance();
+    gcn::Widget::setGlobalFont(new SDLFont("/usr/share/fonts/truetype/"
+        "ttf-dejavu/DejaVuSans-Oblique.ttf", 18));
+
+    std::vector<std::string> menu;
+    for (int f = 0; f < 100; f ++)
+        menu.push_back(strprintf("@@item %d|##3Menu item number %d@@", f, f));
+    std::vector<std::string> chat;
+    for (int f = 0; f < 300; f ++)
+    {
+        chat.push_back(strprintf("##1Player %d: ##0some long chat line "
+            "which is wrapped in chat window %d", f % 10, f % 20));
+    }
+
+    int heights[2] = {0, 0};
+    unsigned int times[2] = {0, 0};
+    for (int cached = 0; cached < 2; cached ++)
+    {
+        textLayoutCache.clear();
+        const unsigned int startTime = SDL_GetTicks();
+        for (int k = 0; k < 10; k ++)
+        {
+            // popup menu is filled again each time it is shown
+            BrowserBox *const popup = new BrowserBox(nullptr,
+                BrowserBox::AUTO_SIZE);
+            FOR_EACH (std::vector<std::string>::const_iterator, it, menu)
+                popup->addRow(*it);
+            delete popup;
+
+            BrowserBox *const box = new BrowserBox(nullptr,
+                BrowserBox::AUTO_WRAP);
+            box->setWidth(200);
+            FOR_EACH (std::vector<std::string>::const_iterator, it, chat)
+                box->addRow(*it);
+            box->setWidth(350);
+            box->updateHeight();
+            box->setWidth(200);
+            box->updateHeight();
+            heights[cached] = box->getHeight();
+            delete box;
+            if (!cached)
+                textLayoutCache.clear();
+        }
+        times[cached] = SDL_GetTicks() - startTime;
+    }
+    EXPECT_EQ(heights[0], heights[1]);
+    EXPECT_GT(textLayoutCache.getHits(), 0U);
+
+    RecordProperty("uncachedTime", times[0]);
+    RecordProperty("cachedTime", times[1]);
+}
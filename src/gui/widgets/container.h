@@ -30,6 +30,8 @@
 
 #if !defined USE_INTERNALGUICHAN
 typedef std::list<gcn::Widget *>::const_iterator WidgetListConstIterator;
+typedef std::list<gcn::Widget *>::const_reverse_iterator
+    WidgetListCReverseIterator;
 #endif
 
 /**
@@ -34,6 +34,7 @@
 #include "gui/shopwindow.h"
 #include "gui/shortcutwindow.h"
 #include "gui/sdlinput.h"
+#include "gui/textlayoutcache.h"
 #include "gui/viewport.h"
 
 #include "net/net.h"
@@ -323,7 +324,8 @@ void ItemContainer::draw(gcn::Graphics *graphics)
                 g->setColorAll(mUnEquipedColor, mUnEquipedColor2);
 
             font->drawString(g, caption,
-                itemX + (mBoxWidth - font->getWidth(caption)) / 2,
+                itemX + (mBoxWidth - textLayoutCache.getWidth(font,
+                caption)) / 2,
                 itemY + mEquippedTextPadding);
         }
     }
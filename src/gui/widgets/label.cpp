@@ -21,6 +21,8 @@
 
 #include "gui/widgets/label.h"
 
+#include "gui/textlayoutcache.h"
+
 #include <guichan/font.hpp>
 
 #include "debug.h"
@@ -85,11 +87,13 @@ void Label::draw(gcn::Graphics* graphics)
             textX = mPadding;
             break;
         case Graphics::CENTER:
-            textX = (getWidth() - font->getWidth(mCaption)) / 2;
+            textX = (getWidth() - textLayoutCache.getWidth(font,
+                mCaption)) / 2;
             break;
         case Graphics::RIGHT:
             if (getWidth() > mPadding)
-                textX = getWidth() - mPadding - font->getWidth(mCaption);
+                textX = getWidth() - mPadding
+                    - textLayoutCache.getWidth(font, mCaption);
             else
                 textX = 0;
             break;
@@ -103,7 +107,8 @@ void Label::draw(gcn::Graphics* graphics)
 
 void Label::adjustSize()
 {
-    setWidth(getFont()->getWidth(getCaption()) + 2 * mPadding);
+    setWidth(textLayoutCache.getWidth(getFont(), getCaption())
+        + 2 * mPadding);
     setHeight(getFont()->getHeight() + 2 * mPadding);
 }
 
@@ -25,6 +25,8 @@
 #include "keydata.h"
 #include "keyevent.h"
 
+#include "gui/textlayoutcache.h"
+
 #include <guichan/font.hpp>
 
 #include <sstream>
@@ -53,6 +55,16 @@ void TextBox::setTextWrapped(const std::string &text, const int minDimension)
     if (getParent())
         getParent()->logic();
 
+    // popups wrap the same texts each time they are shown
+    const gcn::Font *const font = getFont();
+    std::string cachedText;
+    if (textLayoutCache.findWrap(font, text, minDimension,
+        cachedText, mMinWidth))
+    {
+        gcn::TextBox::setText(cachedText);
+        return;
+    }
+
     // Take the supplied minimum dimension as a starting
     // point and try to beat it
     mMinWidth = minDimension;
@@ -62,13 +74,14 @@ void TextBox::setTextWrapped(const std::string &text, const int minDimension)
     size_t lastNewlinePos = 0;
     int minWidth = 0;
     int xpos;
+    const int spaceWidth = textLayoutCache.getWidth(font, " ");
 
     size_t spacePos = text.rfind(" ", text.size());
 
     if (spacePos != std::string::npos)
     {
         const std::string word = text.substr(spacePos + 1);
-        const int length = getFont()->getWidth(word);
+        const int length = textLayoutCache.getWidth(font, word);
 
         if (length > mMinWidth)
             mMinWidth = length;
@@ -97,7 +110,7 @@ void TextBox::setTextWrapped(const std::string &text, const int minDimension)
             std::string word =
                 line.substr(lastSpacePos, spacePos - lastSpacePos);
 
-            const int width = getFont()->getWidth(word);
+            const int width = textLayoutCache.getWidth(font, word);
 
             if (xpos == 0 && width > mMinWidth)
             {
@@ -105,10 +118,9 @@ void TextBox::setTextWrapped(const std::string &text, const int minDimension)
                 xpos = width;
                 wrappedStream << word;
             }
-            else if (xpos != 0 && xpos + getFont()->getWidth(" ") + width <=
-                     mMinWidth)
+            else if (xpos != 0 && xpos + spaceWidth + width <= mMinWidth)
             {
-                xpos += getFont()->getWidth(" ") + width;
+                xpos += spaceWidth + width;
                 wrappedStream << " " << word;
             }
             else if (lastSpacePos == 0)
@@ -159,7 +171,9 @@ void TextBox::setTextWrapped(const std::string &text, const int minDimension)
 
     mMinWidth = minWidth;
 
-    gcn::TextBox::setText(wrappedStream.str());
+    const std::string wrappedText = wrappedStream.str();
+    textLayoutCache.addWrap(font, text, minDimension, wrappedText, minWidth);
+    gcn::TextBox::setText(wrappedText);
 }
 
 void TextBox::keyPressed(gcn::KeyEvent& keyEvent)
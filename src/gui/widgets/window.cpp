@@ -1082,6 +1082,16 @@ int Window::getGuiAlpha()
     return static_cast<int>(alpha * 255.0f);
 }
 
+int Window::getOpaqueInset() const
+{
+    if (!mSkin || std::max(Client::getGuiAlpha(),
+        Theme::instance()->getMinimumOpacity()) < 1.0f)
+    {
+        return -1;
+    }
+    return mSkin->getOption("opaqueInset", -1);
+}
+
 Layout &Window::getLayout()
 {
     if (!mLayout)
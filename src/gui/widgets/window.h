@@ -404,6 +404,12 @@ class Window : public gcn::Window,
          */
         int getGuiAlpha() A_WARN_UNUSED;
 
+        /**
+         * Returns distance from window edges to area where window fully
+         * hides everything under it, or -1 if window is not opaque.
+         */
+        virtual int getOpaqueInset() const A_WARN_UNUSED;
+
         gcn::Rectangle getWindowArea() const A_WARN_UNUSED;
 
         bool isResizeAllowed(const gcn::MouseEvent &event) const A_WARN_UNUSED;
@@ -32,7 +32,11 @@ WindowContainer *windowContainer = nullptr;
 
 WindowContainer::WindowContainer(const Widget2 *const widget) :
     Container(widget),
-    mDeathList()
+    mDeathList(),
+    mOccluders(),
+    mCulled(),
+    mDrawnWindows(0),
+    mCulledWindows(0)
 {
 }
 
@@ -58,6 +62,107 @@ void WindowContainer::adjustAfterResize(const int oldScreenWidth,
     }
 }
 
+static gcn::Rectangle getFrameRect(const gcn::Widget *const widget)
+{
+    gcn::Rectangle rec = widget->getDimension();
+    const int frame = widget->getFrameSize();
+    if (frame > 0)
+    {
+        const int frame2 = frame * 2;
+        rec.x -= frame;
+        rec.y -= frame;
+        rec.width += frame2;
+        rec.height += frame2;
+    }
+    return rec;
+}
+
+bool WindowContainer::isCovered(const gcn::Rectangle &rect) const
+{
+    FOR_EACH (std::vector<gcn::Rectangle>::const_iterator, it, mOccluders)
+    {
+        const gcn::Rectangle &cover = *it;
+        if (rect.x >= cover.x && rect.y >= cover.y
+            && rect.x + rect.width <= cover.x + cover.width
+            && rect.y + rect.height <= cover.y + cover.height)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WindowContainer::drawChildren(gcn::Graphics* graphics)
+{
+    BLOCK_START("WindowContainer::drawChildren")
+    mDrawnWindows = 0;
+    mCulledWindows = 0;
+    mOccluders.clear();
+    mCulled.clear();
+
+    // collect covered windows from top to bottom
+    for (WidgetListCReverseIterator it = mWidgets.rbegin(),
+         it_end = mWidgets.rend(); it != it_end; ++ it)
+    {
+        const gcn::Widget *const widget = *it;
+        if (!widget->isVisible())
+        {
+            mCulled.push_back(false);
+            continue;
+        }
+        const gcn::Rectangle rec = getFrameRect(widget);
+        const bool covered = isCovered(rec);
+        mCulled.push_back(covered);
+        if (covered)
+            continue;
+
+        const Window *const window = dynamic_cast<const Window*>(widget);
+        if (!window)
+            continue;
+        const int inset = window->getOpaqueInset();
+        const int inset2 = inset * 2;
+        if (inset >= 0 && rec.width > inset2 && rec.height > inset2)
+        {
+            mOccluders.push_back(gcn::Rectangle(rec.x + inset,
+                rec.y + inset, rec.width - inset2, rec.height - inset2));
+        }
+    }
+
+    graphics->pushClipArea(getChildrenArea());
+
+    std::vector<bool>::const_reverse_iterator culled = mCulled.rbegin();
+    for (WidgetListConstIterator it = mWidgets.begin(),
+         it_end = mWidgets.end(); it != it_end; ++ it, ++ culled)
+    {
+        gcn::Widget *const widget = *it;
+        if (!widget->isVisible())
+            continue;
+
+        if (*culled)
+        {
+            mCulledWindows ++;
+            continue;
+        }
+        mDrawnWindows ++;
+
+        // If the widget has a frame,
+        // draw it before drawing the widget
+        if (widget->getFrameSize() > 0)
+        {
+            graphics->pushClipArea(getFrameRect(widget));
+            widget->drawFrame(graphics);
+            graphics->popClipArea();
+        }
+
+        graphics->pushClipArea(widget->getDimension());
+        widget->draw(graphics);
+        graphics->popClipArea();
+    }
+
+    graphics->popClipArea();
+    BLOCK_END("WindowContainer::drawChildren")
+}
+
 #ifdef USE_PROFILER
 void WindowContainer::draw(gcn::Graphics* graphics)
 {
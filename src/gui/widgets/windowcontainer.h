@@ -25,6 +25,8 @@
 
 #include "gui/widgets/container.h"
 
+#include <guichan/rectangle.hpp>
+
 #include <vector>
 
 /**
@@ -57,13 +59,32 @@ class WindowContainer : public Container
         void draw(gcn::Graphics* graphics);
 #endif
 
+        /**
+         * Draws visible windows, skipping windows fully covered by opaque
+         * windows above them.
+         */
+        void drawChildren(gcn::Graphics* graphics) override;
+
+        int getDrawnWindows() const A_WARN_UNUSED
+        { return mDrawnWindows; }
+
+        int getCulledWindows() const A_WARN_UNUSED
+        { return mCulledWindows; }
+
     private:
+        bool isCovered(const gcn::Rectangle &rect) const A_WARN_UNUSED;
+
         /**
          * List of widgets that are scheduled to be deleted.
          */
         typedef std::vector<gcn::Widget*> Widgets;
         typedef Widgets::iterator WidgetIterator;
         Widgets mDeathList;
+
+        std::vector<gcn::Rectangle> mOccluders;
+        std::vector<bool> mCulled;
+        int mDrawnWindows;
+        int mCulledWindows;
 };
 
 extern WindowContainer *windowContainer;
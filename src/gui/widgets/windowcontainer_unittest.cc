@@ -0,0 +1,116 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client.h"
+#include "graphics.h"
+#include "logger.h"
+
+#include "gui/theme.h"
+
+#include "gui/widgets/window.h"
+#include "gui/widgets/windowcontainer.h"
+
+#include "gtest/gtest.h"
+
+#include <physfs.h>
+
+#include <SDL.h>
+
+#include "debug.h"
+
+namespace
+{
+    class TestWindow final : public Window
+    {
+        public:
+            TestWindow(const int x, const int y,
+                       const int width, const int height,
+                       const int inset) :
+                Window("test"),
+                mInset(inset)
+            {
+                setDimension(gcn::Rectangle(x, y, width, height));
+                setVisible(true);
+            }
+
+            A_DELETE_COPY(TestWindow)
+
+            int getOpaqueInset() const override
+            { return mInset; }
+
+        private:
+            int mInset;
+    };
+}  // namespace
+
+TEST(windowcontainer, opaqueArea)
+{
+    SDL_Surface *const surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
+        8, 8, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+    SDL_FillRect(surface, nullptr, 0xff000000);
+    EXPECT_TRUE(Theme::isOpaqueArea(surface, 0, 0, 8, 8));
+
+    // transparent corner pixel
+    static_cast<uint32_t*>(surface->pixels)[0] = 0x80ffffff;
+    EXPECT_FALSE(Theme::isOpaqueArea(surface, 0, 0, 8, 8));
+    EXPECT_FALSE(Theme::isOpaqueArea(surface, 0, 0, 1, 1));
+    EXPECT_TRUE(Theme::isOpaqueArea(surface, 1, 0, 7, 8));
+    EXPECT_TRUE(Theme::isOpaqueArea(surface, 0, 1, 8, 7));
+
+    // area outside of surface
+    EXPECT_FALSE(Theme::isOpaqueArea(surface, 4, 4, 8, 8));
+    EXPECT_FALSE(Theme::isOpaqueArea(nullptr, 0, 0, 1, 1));
+    SDL_FreeSurface(surface);
+}
+
+TEST(windowcontainer, culling)
+{
+    PHYSFS_init("manaplus");
+    Client::Options options;
+    Client client(options);
+
+    if (!logger)
+        logger = new Logger();
+    Theme::instance();
+    mainGraphics = new Graphics();
+    mainGraphics->mWidth = 640;
+    mainGraphics->mHeight = 480;
+    windowContainer = new WindowContainer(nullptr);
+    windowContainer->setDimension(gcn::Rectangle(0, 0, 640, 480));
+
+    // windows are added from bottom to top
+    new TestWindow(110, 110, 80, 80, -1);
+    new TestWindow(10, 10, 100, 100, -1);
+    new TestWindow(300, 300, 100, 100, -1);
+    new TestWindow(297, 297, 106, 106, 4);
+    new TestWindow(100, 100, 100, 100, 4);
+
+    Graphics graphics;
+    windowContainer->drawChildren(&graphics);
+    // first window is under opaque area of last one, second one is only
+    // partially covered and third one is under its transparent corners
+    EXPECT_EQ(1, windowContainer->getCulledWindows());
+    EXPECT_EQ(4, windowContainer->getDrawnWindows());
+
+    delete windowContainer;
+    windowContainer = nullptr;
+    delete mainGraphics;
+    mainGraphics = nullptr;
+}
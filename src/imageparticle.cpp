@@ -22,6 +22,7 @@
 
 #include "imageparticle.h"
 
+#include "framebudget.h"
 #include "graphics.h"
 #include "logger.h"
 
@@ -73,6 +74,7 @@ bool ImageParticle::draw(Graphics *const graphics,
                          const int offsetX, const int offsetY) const
 {
     FUNC_BLOCK("ImageParticle::draw", 1)
+    BUDGET_BLOCK(ZONE_PARTICLES)
     if (mAlive != ALIVE || !mImage)
         return false;
 
@@ -74,6 +74,13 @@ public:
     bool updateNumber(const unsigned num A_UNUSED) override
     { return false; }
 
+    bool getHash(SpriteHash &hash) const override A_WARN_UNUSED
+    {
+        hash = mImage ? SpriteHash(mImage->getId(), mImage)
+            : SpriteHash(0, nullptr);
+        return true;
+    }
+
 private:
     Image *mImage;
 };
@@ -509,6 +509,13 @@ static const KeyData keyData[Input::KEY_TOTAL] = {
         &ActionManager::questsWindowShow,
         Input::KEY_NO_VALUE, 50,
         COND_GAME | COND_NOTARGET},
+    {"keyPerfOverlay",
+        INPUT_UNKNOWN, Input::KEY_NO_VALUE,
+        INPUT_UNKNOWN, Input::KEY_NO_VALUE,
+        Input::GRP_DEFAULT | Input::GRP_GUI,
+        &ActionManager::perfOverlayShow,
+        Input::KEY_NO_VALUE, 50,
+        COND_GAME | COND_NOTARGET},
     {"keySocialPrevTab",
         INPUT_UNKNOWN, Input::KEY_NO_VALUE,
         INPUT_UNKNOWN, Input::KEY_NO_VALUE,
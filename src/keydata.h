@@ -135,6 +135,7 @@ namespace Input
         KEY_WINDOW_ONLINE,
         KEY_WINDOW_DIDYOUKNOW,
         KEY_WINDOW_QUESTS,
+        KEY_PERF_OVERLAY,
         KEY_PREV_SOCIAL_TAB,
         KEY_NEXT_SOCIAL_TAB,
         KEY_EMOTE,
@@ -84,7 +84,6 @@ typedef std::map<int, Guild*>::const_iterator GuildMapCIter;
 
 LocalPlayer *player_node = nullptr;
 
-extern std::list<BeingCacheEntry*> beingInfoCache;
 extern OkDialog *weightNotice;
 extern int weightNoticeTime;
 extern MiniStatusWindow *miniStatusWindow;
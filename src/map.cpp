@@ -22,10 +22,13 @@
 
 #include "map.h"
 
+#include "actorspritemanager.h"
 #include "client.h"
 #include "configuration.h"
+#include "framebudget.h"
 #include "localplayer.h"
 #include "maplayer.h"
+#include "navigationmanager.h"
 #include "notifymanager.h"
 #include "particle.h"
 #include "simpleanimation.h"
@@ -43,6 +46,7 @@
 #include "utils/mkdir.h"
 #include "utils/physfstools.h"
 
+#include <algorithm>
 #include <limits.h>
 #include <queue>
 
@@ -58,20 +62,22 @@ struct Location final
     /**
      * Constructor.
      */
-    Location(const int px, const int py, MetaTile *const ptile):
-        x(px), y(py), tile(ptile)
+    Location(const int px, const int py, PathNode *const ptile):
+        x(px), y(py), Fcost(ptile->Fcost), tile(ptile)
     {}
 
     /**
-     * Comparison operator.
+     * Comparison operator. Uses F cost from time of adding to open list,
+     * because tile cost can be lowered while location is in the list.
      */
     bool operator< (const Location &loc) const
     {
-        return tile->Fcost > loc.tile->Fcost;
+        return Fcost > loc.Fcost;
     }
 
     int x, y;
-    MetaTile *tile;
+    int Fcost;
+    PathNode *tile;
 };
 
 class ActorFunctuator final
@@ -127,21 +133,23 @@ Map::Map(const int width, const int height,
     mWidth(width), mHeight(height),
     mTileWidth(tileWidth), mTileHeight(tileHeight),
     mMaxTileHeight(height),
-    mMetaTiles(new MetaTile[mWidth * mHeight]),
+    mBlockmasks(new unsigned char[mWidth * mHeight]),
+    mCollisionVersion(0),
+    mNonWallMask(0),
     mWalkLayer(nullptr),
     mLayers(),
     mTilesets(),
     mActors(),
     mHasWarps(false),
     mDebugFlags(MAP_NORMAL),
-    mOnClosedList(1),
-    mOnOpenList(2),
+    mSearchContext(),
     mBackgrounds(),
     mForegrounds(),
     mLastAScrollX(0.0f),
     mLastAScrollY(0.0f),
     mParticleEffects(),
     mMapPortals(),
+    mWarpMaps(),
     mTileAnimations(),
     mOverlayDetail(config.getIntValue("OverlayDetail")),
     mOpacity(config.getFloatValue("guialpha")),
@@ -153,6 +161,8 @@ Map::Map(const int width, const int height,
     mPvp(0),
     mTilesetsIndexed(false),
     mIndexedTilesets(nullptr),
+    mIndexedImages(nullptr),
+    mAnimatedGids(),
     mIndexedTilesetsSize(0),
     mActorFixX(0),
     mActorFixY(0),
@@ -175,6 +185,7 @@ Map::Map(const int width, const int height,
     mAtlas(nullptr)
 {
     const int size = mWidth * mHeight;
+    memset(mBlockmasks, 0, size);
     for (int i = 0; i < NB_BLOCKTYPES; i++)
     {
         mOccupation[i] = new unsigned[size];
@@ -196,7 +207,7 @@ Map::~Map()
     config.removeListeners(this);
 
     // delete metadata, layers, tilesets and overlays
-    delete [] mMetaTiles;
+    delete [] mBlockmasks;
     for (int i = 0; i < NB_BLOCKTYPES; i++)
         delete [] mOccupation[i];
 
@@ -344,6 +355,7 @@ void Map::draw(Graphics *const graphics, int scrollX, int scrollY)
         return;
 
     BLOCK_START("Map::draw")
+    BUDGET_BLOCK(ZONE_MAP)
     // Calculate range of tiles which are on-screen
     const int endPixelY = graphics->mHeight + scrollY + mTileHeight - 1
         + mMaxTileHeight - mTileHeight;
@@ -472,31 +484,19 @@ void Map::draw(Graphics *const graphics, int scrollX, int scrollY)
     {
         // Draws beings with a lower opacity to make them visible
         // even when covered by a wall or some other elements...
-        ActorsCIter ai = mActors.begin();
-        const ActorsCIter ai_end = mActors.end();
-        while (ai != ai_end)
+        if (!mOpenGL && actorSpriteManager)
         {
-            if (Actor *const actor = *ai)
-            {
-                if (!mOpenGL)
-                {
-                    const int x = actor->getTileX();
-                    const int y = actor->getTileY();
-                    if (x < startX || x > endX || y < startY || y > endY)
-                    {
-                        ++ai;
-                        continue;
-                    }
-                }
-                // For now, just draw actors with only one layer.
-                if (actor->getNumberOfLayers() == 1)
-                {
-                    actor->setAlpha(0.3f);
-                    actor->draw(graphics, -scrollX, -scrollY);
-                    actor->setAlpha(1.0f);
-                }
-            }
-            ++ai;
+            std::vector<ActorSprite*> actors;
+            actorSpriteManager->findActorsInRect(actors,
+                startX, startY, endX, endY);
+            std::sort(actors.begin(), actors.end(), actorCompare);
+            FOR_EACH (std::vector<ActorSprite*>::const_iterator, it, actors)
+                drawActorWithOpacity(graphics, *it, scrollX, scrollY);
+        }
+        else
+        {
+            FOR_EACH (ActorsCIter, it, mActors)
+                drawActorWithOpacity(graphics, *it, scrollX, scrollY);
         }
     }
 
@@ -504,13 +504,25 @@ void Map::draw(Graphics *const graphics, int scrollX, int scrollY)
     BLOCK_END("Map::draw")
 }
 
+void Map::drawActorWithOpacity(Graphics *const graphics, Actor *const actor,
+                               const int scrollX, const int scrollY) const
+{
+    // For now, just draw actors with only one layer.
+    if (actor && actor->getNumberOfLayers() == 1)
+    {
+        actor->setAlpha(0.3f);
+        actor->draw(graphics, -scrollX, -scrollY);
+        actor->setAlpha(1.0f);
+    }
+}
+
 #define fillCollision(collision, color) \
-    if (x < endX && mMetaTiles[tilePtr].blockmask & collision)\
+    if (x < endX && mBlockmasks[tilePtr] & collision)\
     {\
         width = 32;\
         for (int x2 = tilePtr + 1; x < endX; x2 ++)\
         {\
-            if (!(mMetaTiles[x2].blockmask & collision))\
+            if (!(mBlockmasks[x2] & collision))\
                 break;\
             width += 32;\
             x ++;\
@@ -649,6 +661,31 @@ Tileset *Map::getTilesetWithGid(const int gid) const
         return nullptr;
 }
 
+static unsigned char getBlockmask(const Map::BlockType type)
+{
+    switch (type)
+    {
+        case Map::BLOCKTYPE_WALL:
+            return Map::BLOCKMASK_WALL;
+        case Map::BLOCKTYPE_CHARACTER:
+            return Map::BLOCKMASK_CHARACTER;
+        case Map::BLOCKTYPE_MONSTER:
+            return Map::BLOCKMASK_MONSTER;
+        case Map::BLOCKTYPE_AIR:
+            return Map::BLOCKMASK_AIR;
+        case Map::BLOCKTYPE_WATER:
+            return Map::BLOCKMASK_WATER;
+        case Map::BLOCKTYPE_GROUND:
+            return Map::BLOCKMASK_GROUND;
+        case Map::BLOCKTYPE_GROUNDTOP:
+            return Map::BLOCKMASK_GROUNDTOP;
+        default:
+        case Map::BLOCKTYPE_NONE:
+        case Map::NB_BLOCKTYPES:
+            return 0;
+    }
+}
+
 void Map::blockTile(const int x, const int y, const BlockType type)
 {
     if (type == BLOCKTYPE_NONE || !contains(x, y))
@@ -659,34 +696,15 @@ void Map::blockTile(const int x, const int y, const BlockType type)
     if (mOccupation[type][tileNum] < UINT_MAX &&
         (++mOccupation[type][tileNum]) > 0)
     {
-        switch (type)
+        mCollisionVersion ++;
+        mBlockmasks[tileNum] |= getBlockmask(type);
+        // tiles do not lose bits, so mask may only include more than needed
+        if (!(mBlockmasks[tileNum] & BLOCKMASK_WALL))
+            mNonWallMask |= mBlockmasks[tileNum];
+        if (mWalkLayer)
         {
-            case BLOCKTYPE_WALL:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_WALL;
-                break;
-            case BLOCKTYPE_CHARACTER:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_CHARACTER;
-                break;
-            case BLOCKTYPE_MONSTER:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_MONSTER;
-                break;
-            case BLOCKTYPE_AIR:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_AIR;
-                break;
-            case BLOCKTYPE_WATER:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_WATER;
-                break;
-            case BLOCKTYPE_GROUND:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_GROUND;
-                break;
-            case BLOCKTYPE_GROUNDTOP:
-                mMetaTiles[tileNum].blockmask |= BLOCKMASK_GROUNDTOP;
-                break;
-            default:
-            case BLOCKTYPE_NONE:
-            case NB_BLOCKTYPES:
-                // Do nothing.
-                break;
+            NavigationManager::updateWalkLayer(mWalkLayer, mBlockmasks,
+                mWidth, mHeight, x, y);
         }
     }
 }
@@ -698,7 +716,7 @@ bool Map::getWalk(const int x, const int y, const unsigned char walkmask) const
         return false;
 
     // Check if the tile is walkable
-    return !(mMetaTiles[x + y * mWidth].blockmask & walkmask);
+    return !(mBlockmasks[x + y * mWidth] & walkmask);
 }
 
 void Map::setWalk(const int x, const int y, const bool walkable A_UNUSED)
@@ -711,11 +729,6 @@ bool Map::contains(const int x, const int y) const
     return x >= 0 && y >= 0 && x < mWidth && y < mHeight;
 }
 
-MetaTile *Map::getMetaTile(const int x, const int y) const
-{
-    return &mMetaTiles[x + y * mWidth];
-}
-
 Actors::iterator Map::addActor(Actor *const actor)
 {
     mActors.push_front(actor);
@@ -734,6 +747,24 @@ const std::string Map::getMusicFile() const
     return getProperty("music");
 }
 
+int Map::getMemoryUsage() const
+{
+    const int size = mWidth * mHeight;
+    // tiles of layers, special layers, occupation, collision and nodes
+    int usage = size * static_cast<int>(2 * sizeof(MapItem*)
+        + NB_BLOCKTYPES * sizeof(unsigned) + 1 + sizeof(PathNode));
+    FOR_EACH (Layers::const_iterator, it, mLayers)
+    {
+        const MapLayer *const layer = *it;
+        if (layer)
+        {
+            usage += layer->getWidth() * layer->getHeight()
+                * static_cast<int>(sizeof(Image*));
+        }
+    }
+    return usage;
+}
+
 const std::string Map::getName() const
 {
     if (hasProperty("name"))
@@ -869,9 +900,305 @@ Path Map::findPixelPath(const int startPixelX, const int startPixelY,
 }
 #endif
 
+namespace
+{
+    /**
+     * Grid view used by jump point search.
+     */
+    struct JumpGrid final
+    {
+        JumpGrid(const unsigned char *const blockmasks0,
+                 const int width0, const int height0,
+                 const unsigned char mask0,
+                 const int destX0, const int destY0) :
+            blockmasks(blockmasks0),
+            width(width0),
+            height(height0),
+            mask(mask0),
+            destX(destX0),
+            destY(destY0)
+        {
+        }
+
+        bool walkable(const int x, const int y) const A_WARN_UNUSED
+        {
+            return x >= 0 && y >= 0 && x < width && y < height
+                && !(blockmasks[x + y * width] & mask);
+        }
+
+        /**
+         * Moves along row or column until tile with forced neighbour
+         * or destination is found.
+         */
+        bool jumpStraight(int &x, int &y,
+                          const int dx, const int dy) const A_WARN_UNUSED
+        {
+            for (;;)
+            {
+                x += dx;
+                y += dy;
+                if (!walkable(x, y))
+                    return false;
+                if (x == destX && y == destY)
+                    return true;
+                if (dx)
+                {
+                    if ((walkable(x, y - 1) && !walkable(x - dx, y - 1))
+                        || (walkable(x, y + 1) && !walkable(x - dx, y + 1)))
+                    {
+                        return true;
+                    }
+                }
+                else
+                {
+                    if ((walkable(x - 1, y) && !walkable(x - 1, y - dy))
+                        || (walkable(x + 1, y) && !walkable(x + 1, y - dy)))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Moves diagonally until a straight jump from current tile finds
+         * something, or destination is found.
+         */
+        bool jumpDiagonal(int &x, int &y,
+                          const int dx, const int dy) const A_WARN_UNUSED
+        {
+            for (;;)
+            {
+                // diagonal steps can not cut corners
+                if (!walkable(x + dx, y) || !walkable(x, y + dy))
+                    return false;
+                x += dx;
+                y += dy;
+                if (!walkable(x, y))
+                    return false;
+                if (x == destX && y == destY)
+                    return true;
+                int x1 = x;
+                int y1 = y;
+                if (jumpStraight(x1, y1, dx, 0))
+                    return true;
+                x1 = x;
+                y1 = y;
+                if (jumpStraight(x1, y1, 0, dy))
+                    return true;
+            }
+        }
+
+        const unsigned char *blockmasks;
+        int width;
+        int height;
+        unsigned char mask;
+        int destX;
+        int destY;
+    };
+
+    int sign(const int n)
+    {
+        return n > 0 ? 1 : (n < 0 ? -1 : 0);
+    }
+}  // namespace
+
+/**
+ * Jump point search for grids where only walls block walking. Costs and
+ * heuristic are same as in A* from Map::findGridPath.
+ */
+static Path findJumpPath(const unsigned char *const blockmasks,
+                         const int width, const int height,
+                         PathSearchContext &context,
+                         const int startX, const int startY,
+                         const int destX, const int destY,
+                         const unsigned char walkmask, const int maxCost)
+{
+    static const int basicCost = 100;
+    const int basicCost2 = 100 * 362 / 256;
+    const float basicCostF = 100 * 362 / 256;
+    // straight steps cost one more, same as in A*
+    const int straightCost = basicCost + 1;
+
+    Path path;
+
+    const JumpGrid grid(blockmasks, width, height,
+        walkmask | Map::BLOCKMASK_WALL, destX, destY);
+
+    context.startSearch(width, height);
+    PathNode *const nodes = context.getNodes();
+    const unsigned int onClosedList = context.getClosedList();
+    const unsigned int onOpenList = context.getOpenList();
+
+    PathNode *const startTile = &nodes[startX + startY * width];
+    startTile->Gcost = 0;
+    startTile->parentX = startX;
+    startTile->parentY = startY;
+
+    std::priority_queue<Location> openList;
+    openList.push(Location(startX, startY, startTile));
+
+    bool foundPath = false;
+
+    while (!openList.empty())
+    {
+        const Location curr = openList.top();
+        openList.pop();
+
+        PathNode *const tile = curr.tile;
+        if (tile->whichList == onClosedList)
+            continue;
+        tile->whichList = onClosedList;
+        context.addExpandedNode();
+
+        if (curr.x == destX && curr.y == destY)
+        {
+            foundPath = true;
+            break;
+        }
+
+        // Directions to jump to. Tiles behind the move direction are
+        // reached as well or better through the parent.
+        int dirs[8][2];
+        int dirsSize = 0;
+        const int px = sign(curr.x - tile->parentX);
+        const int py = sign(curr.y - tile->parentY);
+        if (!px && !py)
+        {
+            for (int dy = -1; dy <= 1; dy ++)
+            {
+                for (int dx = -1; dx <= 1; dx ++)
+                {
+                    if (!dx && !dy)
+                        continue;
+                    dirs[dirsSize][0] = dx;
+                    dirs[dirsSize][1] = dy;
+                    dirsSize ++;
+                }
+            }
+        }
+        else if (px && py)
+        {
+            dirs[0][0] = px;
+            dirs[0][1] = py;
+            dirs[1][0] = px;
+            dirs[1][1] = 0;
+            dirs[2][0] = 0;
+            dirs[2][1] = py;
+            dirsSize = 3;
+        }
+        else
+        {
+            // straight move, side tiles may be forced neighbours
+            const int sx = py;
+            const int sy = px;
+            dirs[0][0] = px;
+            dirs[0][1] = py;
+            dirs[1][0] = px + sx;
+            dirs[1][1] = py + sy;
+            dirs[2][0] = px - sx;
+            dirs[2][1] = py - sy;
+            dirs[3][0] = sx;
+            dirs[3][1] = sy;
+            dirs[4][0] = -sx;
+            dirs[4][1] = -sy;
+            dirsSize = 5;
+        }
+
+        for (int f = 0; f < dirsSize; f ++)
+        {
+            const int dx = dirs[f][0];
+            const int dy = dirs[f][1];
+            int x = curr.x;
+            int y = curr.y;
+            if (dx && dy)
+            {
+                if (!grid.jumpDiagonal(x, y, dx, dy))
+                    continue;
+            }
+            else if (!grid.jumpStraight(x, y, dx, dy))
+            {
+                continue;
+            }
+
+            PathNode *const newTile = &nodes[x + y * width];
+            if (newTile->whichList == onClosedList)
+                continue;
+
+            const int steps = std::max(std::abs(x - curr.x),
+                std::abs(y - curr.y));
+            const int Gcost = tile->Gcost + steps
+                * (dx && dy ? basicCost2 : straightCost);
+
+            if (maxCost > 0 && Gcost > maxCost * basicCost)
+                continue;
+
+            if (newTile->whichList != onOpenList || Gcost < newTile->Gcost)
+            {
+                if (newTile->whichList != onOpenList)
+                {
+                    const int dx1 = std::abs(x - destX);
+                    const int dy1 = std::abs(y - destY);
+                    newTile->Hcost = std::abs(dx1 - dy1) * basicCost +
+                        std::min(dx1, dy1) * (basicCostF);
+                    newTile->whichList = onOpenList;
+                }
+                newTile->parentX = curr.x;
+                newTile->parentY = curr.y;
+                newTile->Gcost = Gcost;
+                newTile->Fcost = Gcost + newTile->Hcost;
+                openList.push(Location(x, y, newTile));
+            }
+        }
+    }
+
+    if (foundPath)
+    {
+        // jump points are joined by straight or diagonal lines
+        int pathX = destX;
+        int pathY = destY;
+        while (pathX != startX || pathY != startY)
+        {
+            const PathNode *const tile = &nodes[pathX + pathY * width];
+            const int dx = sign(tile->parentX - pathX);
+            const int dy = sign(tile->parentY - pathY);
+            while (pathX != tile->parentX || pathY != tile->parentY)
+            {
+                path.push_back(Position(pathX, pathY));
+                pathX += dx;
+                pathY += dy;
+            }
+        }
+        path.reverse();
+    }
+
+    return path;
+}
+
 Path Map::findPath(const int startX, const int startY,
                    const int destX, const int destY,
                    const unsigned char walkmask, const int maxCost)
+{
+    return findPath(mSearchContext, startX, startY, destX, destY,
+        walkmask, maxCost);
+}
+
+Path Map::findPath(PathSearchContext &context,
+                   const int startX, const int startY,
+                   const int destX, const int destY,
+                   const unsigned char walkmask, const int maxCost) const
+{
+    return findGridPath(mBlockmasks, mWidth, mHeight, mNonWallMask, context,
+        startX, startY, destX, destY, walkmask, maxCost);
+}
+
+Path Map::findGridPath(const unsigned char *const blockmasks,
+                       const int width, const int height,
+                       const unsigned char nonWallMask,
+                       PathSearchContext &context,
+                       const int startX, const int startY,
+                       const int destX, const int destY,
+                       const unsigned char walkmask, const int maxCost)
 {
     // The basic walking cost of a tile.
     static const int basicCost = 100;
@@ -881,17 +1208,32 @@ Path Map::findPath(const int startX, const int startY,
     // Path to be built up (empty by default)
     Path path;
 
-    if (startX >= mWidth || startY >= mHeight || startX < 0 || startY < 0)
+    if (startX >= width || startY >= height || startX < 0 || startY < 0)
         return path;
 
     // Return when destination not walkable
-    if (!getWalk(destX, destY, walkmask))
+    if (destX >= width || destY >= height || destX < 0 || destY < 0
+        || (blockmasks[destX + destY * width] & walkmask))
+    {
         return path;
+    }
+
+    // Walls block walking and corner cutting, other blocks only walking.
+    // If only walls block this walkmask, all steps of same kind have same
+    // cost and jump point search finds paths as short as A*.
+    if (!(nonWallMask & walkmask))
+    {
+        return findJumpPath(blockmasks, width, height, context,
+            startX, startY, destX, destY, walkmask, maxCost);
+    }
+
+    context.startSearch(width, height);
+    PathNode *const nodes = context.getNodes();
+    const unsigned int onClosedList = context.getClosedList();
+    const unsigned int onOpenList = context.getOpenList();
 
     // Reset starting tile's G cost to 0
-    MetaTile *const startTile = &mMetaTiles[startX + startY * mWidth];
-    if (!startTile)
-        return path;
+    PathNode *const startTile = &nodes[startX + startY * width];
 
     startTile->Gcost = 0;
 
@@ -910,27 +1252,28 @@ Path Map::findPath(const int startX, const int startY,
         const Location curr = openList.top();
         openList.pop();
 
-        const MetaTile *const tile = curr.tile;
+        const PathNode *const tile = curr.tile;
 
         // If the tile is already on the closed list, this means it has already
         // been processed with a shorter path to the start point (lower G cost)
-        if (tile->whichList == mOnClosedList)
+        if (tile->whichList == onClosedList)
             continue;
 
         // Put the current tile on the closed list
-        curr.tile->whichList = mOnClosedList;
+        curr.tile->whichList = onClosedList;
+        context.addExpandedNode();
 
-        const int curWidth = curr.y * mWidth;
+        const int curWidth = curr.y * width;
         const int tileGcost = tile->Gcost;
 
         // Check the adjacent tiles
         for (int dy = -1; dy <= 1; dy++)
         {
             const int y = curr.y + dy;
-            if (y < 0 || y >= mHeight)
+            if (y < 0 || y >= height)
                 continue;
 
-            const int yWidth = y * mWidth;
+            const int yWidth = y * width;
             const int dy1 = std::abs(y - destY);
 
             for (int dx = -1; dx <= 1; dx++)
@@ -940,18 +1283,20 @@ Path Map::findPath(const int startX, const int startY,
 
                 // Skip if if we're checking the same tile we're leaving from,
                 // or if the new location falls outside of the map boundaries
-                if ((dx == 0 && dy == 0) || x < 0 || x >= mWidth)
+                if ((dx == 0 && dy == 0) || x < 0 || x >= width)
                     continue;
 
-                MetaTile *const newTile = &mMetaTiles[x + yWidth];
+                const int newPtr = x + yWidth;
+                PathNode *const newTile = &nodes[newPtr];
+                const unsigned char blockmask = blockmasks[newPtr];
 
                 // Skip if the tile is on the closed list or is not walkable
                 // unless its the destination tile
                 // +++ here need check block must depend on player abilities.
-                if (newTile->whichList == mOnClosedList ||
-                    ((newTile->blockmask & walkmask)
+                if (newTile->whichList == onClosedList ||
+                    ((blockmask & walkmask)
                     && !(x == destX && y == destY))
-                    || (newTile->blockmask & BLOCKMASK_WALL))
+                    || (blockmask & BLOCKMASK_WALL))
                 {
                     continue;
                 }
@@ -960,14 +1305,14 @@ Path Map::findPath(const int startX, const int startY,
                 // corner.
                 if (dx != 0 && dy != 0)
                 {
-                    const MetaTile *const t1 = &mMetaTiles[curr.x +
-                        (curr.y + dy) * mWidth];
-                    const MetaTile *const t2 = &mMetaTiles[curr.x +
+                    const unsigned char t1 = blockmasks[curr.x +
+                        (curr.y + dy) * width];
+                    const unsigned char t2 = blockmasks[curr.x +
                         dx + curWidth];
 
                     // +++ here need check block must depend
                     // on player abilities.
-                    if (((t1->blockmask | t2->blockmask) & BLOCKMASK_WALL))
+                    if (((t1 | t2) & BLOCKMASK_WALL))
                         continue;
                 }
 
@@ -1001,7 +1346,7 @@ Path Map::findPath(const int startX, const int startY,
                 if (maxCost > 0 && Gcost > maxCost * basicCost)
                     continue;
 
-                if (newTile->whichList != mOnOpenList)
+                if (newTile->whichList != onOpenList)
                 {
                     // Found a new tile (not on open nor on closed list)
 
@@ -1024,7 +1369,7 @@ Path Map::findPath(const int startX, const int startY,
                     if (x != destX || y != destY)
                     {
                         // Add this tile to the open list
-                        newTile->whichList = mOnOpenList;
+                        newTile->whichList = onOpenList;
                         openList.push(Location(x, y, newTile));
                     }
                     else
@@ -1052,25 +1397,6 @@ Path Map::findPath(const int startX, const int startY,
         }
     }
 
-    // Two new values to indicate whether a tile is on the open or closed list,
-    // this way we don't have to clear all the values between each pathfinding.
-    if (mOnOpenList > UINT_MAX - 2)
-    {
-        // We reset the list memebers value.
-        mOnClosedList = 1;
-        mOnOpenList = 2;
-
-        // Clean up the metaTiles
-        const int size = mWidth * mHeight;
-        for (int i = 0; i < size; ++i)
-            mMetaTiles[i].whichList = 0;
-    }
-    else
-    {
-        mOnClosedList += 2;
-        mOnOpenList += 2;
-    }
-
     // If a path has been found, iterate backwards using the parent locations
     // to extract it.
     if (foundPath)
@@ -1080,14 +1406,15 @@ Path Map::findPath(const int startX, const int startY,
 
         while (pathX != startX || pathY != startY)
         {
-            // Add the new path node to the start of the path list
-            path.push_front(Position(pathX, pathY));
+            // Add the new path node, path is reversed below
+            path.push_back(Position(pathX, pathY));
 
             // Find out the next parent
-            const MetaTile *const tile = &mMetaTiles[pathX + pathY * mWidth];
+            const PathNode *const tile = &nodes[pathX + pathY * width];
             pathX = tile->parentX;
             pathY = tile->parentY;
         }
+        path.reverse();
     }
 
     return path;
@@ -1270,6 +1597,18 @@ void Map::addPortalTile(const std::string &name, const int type,
     mMapPortals.push_back(new MapItem(type, name, x, y));
 }
 
+void Map::addWarpMap(const std::string &name)
+{
+    if (name.empty())
+        return;
+    FOR_EACH (std::vector<std::string>::const_iterator, it, mWarpMaps)
+    {
+        if (*it == name)
+            return;
+    }
+    mWarpMaps.push_back(name);
+}
+
 void Map::updatePortalTile(const std::string &name, const int type,
                            const int x, const int y, const bool addNew)
 {
@@ -1389,6 +1728,7 @@ void Map::indexTilesets()
     {
         mIndexedTilesetsSize = 0;
         mIndexedTilesets = nullptr;
+        mIndexedImages = nullptr;
         return;
     }
 
@@ -1397,6 +1737,9 @@ void Map::indexTilesets()
     mIndexedTilesetsSize = size;
     mIndexedTilesets = new Tileset*[size];
     std::fill_n(mIndexedTilesets, size, static_cast<Tileset*>(nullptr));
+    mIndexedImages = new Image*[size];
+    std::fill_n(mIndexedImages, size, static_cast<Image*>(nullptr));
+    mAnimatedGids.assign(size, false);
 
     FOR_EACH (Tilesets::const_iterator, it, mTilesets)
     {
@@ -1408,10 +1751,20 @@ void Map::indexTilesets()
             for (int f = start; f < end; f ++)
             {
                 if (f < size)
+                {
                     mIndexedTilesets[f] = s2;
+                    mIndexedImages[f] = s2->get(f - start);
+                }
             }
         }
     }
+
+    FOR_EACH (TileAnimationMapCIter, it, mTileAnimations)
+    {
+        const int gid = it->first;
+        if (gid >= 0 && gid < size && it->second)
+            mAnimatedGids[gid] = true;
+    }
 }
 
 void Map::clearIndexedTilesets()
@@ -1421,6 +1774,10 @@ void Map::clearIndexedTilesets()
 
     mTilesetsIndexed = false;
     delete [] mIndexedTilesets;
+    mIndexedTilesets = nullptr;
+    delete [] mIndexedImages;
+    mIndexedImages = nullptr;
+    mAnimatedGids.clear();
     mIndexedTilesetsSize = 0;
 }
 
@@ -25,6 +25,7 @@
 
 #include "actor.h"
 #include "configlistener.h"
+#include "pathsearchcontext.h"
 #include "position.h"
 #include "properties.h"
 
@@ -53,32 +54,6 @@ typedef TilePairVector::const_iterator TilePairVectorCIter;
 typedef std::vector<AmbientLayer*> AmbientLayerVector;
 typedef AmbientLayerVector::const_iterator AmbientLayerVectorCIter;
 
-/**
- * A meta tile stores additional information about a location on a tile map.
- * This is information that doesn't need to be repeated for each tile in each
- * layer of the map.
- */
-struct MetaTile final
-{
-    /**
-     * Constructor.
-     */
-    MetaTile() : Fcost(0), Gcost(0), Hcost(0), whichList(0),
-        parentX(0), parentY(0), blockmask(0)
-    {}
-
-    A_DELETE_COPY(MetaTile)
-
-    // Pathfinding members
-    int Fcost;               /**< Estimation of total path cost */
-    int Gcost;               /**< Cost from start to this location */
-    int Hcost;               /**< Estimated cost to goal */
-    unsigned whichList;      /**< No list, open list or closed list */
-    int parentX;             /**< X coordinate of parent tile */
-    int parentY;             /**< Y coordinate of parent tile */
-    unsigned char blockmask; /**< Blocking properties of this tile */
-};
-
 /**
  * Animation cycle of a tile image which changes the map accordingly.
  */
@@ -212,9 +187,24 @@ class Map final : public Properties, public ConfigListener
         Tileset *getTilesetWithGid(const int gid) const A_WARN_UNUSED;
 
         /**
-         * Get tile reference.
+         * Returns image of tile with the given global id. Valid only while
+         * tilesets are indexed.
          */
-        MetaTile *getMetaTile(const int x, const int y) const A_WARN_UNUSED;
+        Image *getImageWithGid(const int gid) const A_WARN_UNUSED
+        {
+            return gid >= 0 && gid < mIndexedTilesetsSize
+                ? mIndexedImages[gid] : nullptr;
+        }
+
+        /**
+         * Returns true if tile with the given global id has animation.
+         * Valid only while tilesets are indexed.
+         */
+        bool isAnimatedGid(const int gid) const A_WARN_UNUSED
+        {
+            return gid >= 0 && gid < mIndexedTilesetsSize
+                && mAnimatedGids[gid];
+        }
 
         /**
          * Marks a tile as occupied.
@@ -257,6 +247,12 @@ class Map final : public Properties, public ConfigListener
 
         const std::string getMusicFile() const A_WARN_UNUSED;
 
+        /**
+         * Returns estimated memory used by this map, without images shared
+         * with other maps.
+         */
+        int getMemoryUsage() const A_WARN_UNUSED;
+
         const std::string getName() const A_WARN_UNUSED;
 
         /**
@@ -295,6 +291,29 @@ class Map final : public Properties, public ConfigListener
                       const unsigned char walkmask,
                       const int maxCost = 20) A_WARN_UNUSED;
 
+        /**
+         * Find a path using given search context. Does not change the map,
+         * so searches with different contexts can run at same time.
+         */
+        Path findPath(PathSearchContext &context,
+                      const int startX, const int startY,
+                      const int destX, const int destY,
+                      const unsigned char walkmask,
+                      const int maxCost = 20) const A_WARN_UNUSED;
+
+        /**
+         * Find a path on blockmask grid. Used for searches on grid copies.
+         * If no walkmask bit is in nonWallMask, jump point search is used.
+         */
+        static Path findGridPath(const unsigned char *const blockmasks,
+                                 const int width, const int height,
+                                 const unsigned char nonWallMask,
+                                 PathSearchContext &context,
+                                 const int startX, const int startY,
+                                 const int destX, const int destY,
+                                 const unsigned char walkmask,
+                                 const int maxCost = 20) A_WARN_UNUSED;
+
         /**
          * Adds a particle effect
          */
@@ -353,6 +372,14 @@ class Map final : public Properties, public ConfigListener
         const std::vector<MapItem*> &getPortals() const A_WARN_UNUSED
         { return mMapPortals; }
 
+        /**
+         * Remembers name of map reachable through a warp.
+         */
+        void addWarpMap(const std::string &name);
+
+        const std::vector<std::string> &getWarpMaps() const A_WARN_UNUSED
+        { return mWarpMaps; }
+
         /**
          * Gets the tile animation for a specific gid
          */
@@ -405,8 +432,29 @@ class Map final : public Properties, public ConfigListener
         void setAtlas(Resource *const atlas)
         { mAtlas = atlas; }
 
-        const MetaTile *getMetaTiles() const
-        { return mMetaTiles; }
+        /**
+         * Returns blockmask grid, one byte per tile.
+         */
+        const unsigned char *getBlockmasks() const A_WARN_UNUSED
+        { return mBlockmasks; }
+
+        /**
+         * Returns number of blockmask changes, to detect outdated copies.
+         */
+        int getCollisionVersion() const A_WARN_UNUSED
+        { return mCollisionVersion; }
+
+        /**
+         * Returns blockmask bits of tiles without wall bit.
+         */
+        unsigned char getNonWallMask() const A_WARN_UNUSED
+        { return mNonWallMask; }
+
+        /**
+         * Returns context used by findPath without context.
+         */
+        const PathSearchContext &getSearchContext() const A_WARN_UNUSED
+        { return mSearchContext; }
 
         WalkLayer *getWalkLayer()
         { return mWalkLayer; }
@@ -446,6 +494,10 @@ class Map final : public Properties, public ConfigListener
         void drawAmbientLayers(Graphics *const graphics, const LayerType type,
                                const int detail);
 
+        void drawActorWithOpacity(Graphics *const graphics,
+                                  Actor *const actor,
+                                  const int scrollX, const int scrollY) const;
+
         /**
          * Tells whether the given coordinates fall within the map boundaries.
          */
@@ -460,7 +512,9 @@ class Map final : public Properties, public ConfigListener
         int mHeight;
         int mTileWidth, mTileHeight;
         int mMaxTileHeight;
-        MetaTile *mMetaTiles;
+        unsigned char *mBlockmasks;
+        int mCollisionVersion;
+        unsigned char mNonWallMask;
         WalkLayer *mWalkLayer;
         Layers mLayers;
         Tilesets mTilesets;
@@ -471,8 +525,7 @@ class Map final : public Properties, public ConfigListener
         int mDebugFlags;
 
         // Pathfinding members
-        unsigned int mOnClosedList;
-        unsigned int mOnOpenList;
+        PathSearchContext mSearchContext;
 
         // Overlay data
         AmbientLayerVector mBackgrounds;
@@ -501,6 +554,7 @@ class Map final : public Properties, public ConfigListener
         std::vector<ParticleEffectData> mParticleEffects;
 
         std::vector<MapItem*> mMapPortals;
+        std::vector<std::string> mWarpMaps;
 
         std::map<int, TileAnimation*> mTileAnimations;
 
@@ -510,6 +564,8 @@ class Map final : public Properties, public ConfigListener
         int mPvp;
         bool mTilesetsIndexed;
         Tileset** mIndexedTilesets;
+        Image** mIndexedImages;
+        std::vector<bool> mAnimatedGids;
         int mIndexedTilesetsSize;
         int mActorFixX;
         int mActorFixY;
@@ -0,0 +1,303 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+#include "map.h"
+#include "navigationmanager.h"
+#include "walklayer.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "debug.h"
+
+static const unsigned char walkMask = Map::BLOCKMASK_WALL
+    | Map::BLOCKMASK_AIR | Map::BLOCKMASK_WATER;
+// nonWallMask values forcing A* or allowing jump point search
+static const unsigned char useAStar = 0xff;
+static const unsigned char useJump = 0;
+
+static int getPathCost(const std::vector<unsigned char> &grid,
+                       const int width, int x, int y, const Path &path)
+{
+    int cost = 0;
+    for (Path::const_iterator it = path.begin(), it_end = path.end();
+         it != it_end; ++ it)
+    {
+        const int dx = it->x - x;
+        const int dy = it->y - y;
+        EXPECT_TRUE(std::abs(dx) <= 1 && std::abs(dy) <= 1 && (dx || dy));
+        EXPECT_FALSE(grid[it->x + it->y * width] & walkMask);
+        if (dx && dy)
+        {
+            EXPECT_FALSE(grid[x + dx + y * width] & Map::BLOCKMASK_WALL);
+            EXPECT_FALSE(grid[x + (y + dy) * width] & Map::BLOCKMASK_WALL);
+            cost += 141;
+        }
+        else
+        {
+            cost += 101;
+        }
+        x = it->x;
+        y = it->y;
+    }
+    return cost;
+}
+
+// Checks that labels updated in place split tiles into same components
+// as full relabel, and returns number of components.
+static int checkWalkLayer(WalkLayer &walkLayer,
+                          const unsigned char *const tiles,
+                          const int width, const int height)
+{
+    WalkLayer fullLayer(width, height);
+    NavigationManager::labelWalkLayer(&fullLayer, tiles, width, height);
+    const int *const data = walkLayer.getData();
+    const int *const fullData = fullLayer.getData();
+
+    std::map<int, int> toFull;
+    std::map<int, int> fromFull;
+    for (int y = 0; y < height; y ++)
+    {
+        for (int x = 0; x < width; x ++)
+        {
+            const int ptr = x + y * width;
+            const int num = data[ptr];
+            const int fullNum = fullData[ptr];
+            if (tiles[ptr] & walkMask)
+            {
+                EXPECT_LE(fullNum, 0);
+                EXPECT_LE(num, 0);
+                EXPECT_EQ(num == 0, fullNum == 0);
+                continue;
+            }
+            EXPECT_GT(num, 0);
+            EXPECT_GT(fullNum, 0);
+            if (toFull.find(num) == toFull.end())
+                toFull[num] = fullNum;
+            if (fromFull.find(fullNum) == fromFull.end())
+                fromFull[fullNum] = num;
+            EXPECT_EQ(fullNum, toFull[num]);
+            EXPECT_EQ(num, fromFull[fullNum]);
+        }
+    }
+
+    // blocked tiles keep lowest number of components around them
+    for (int y = 0; y < height; y ++)
+    {
+        for (int x = 0; x < width; x ++)
+        {
+            if (!(tiles[x + y * width] & walkMask))
+                continue;
+            int num = 0;
+            const int dx[4] = {-1, 1, 0, 0};
+            const int dy[4] = {0, 0, -1, 1};
+            for (int f = 0; f < 4; f ++)
+            {
+                const int x2 = x + dx[f];
+                const int y2 = y + dy[f];
+                if (x2 < 0 || y2 < 0 || x2 >= width || y2 >= height)
+                    continue;
+                const int num2 = data[x2 + y2 * width];
+                if (num2 > 0 && (!num || num2 < num))
+                    num = num2;
+            }
+            EXPECT_EQ(-num, data[x + y * width]);
+        }
+    }
+    return static_cast<int>(toFull.size());
+}
+
+TEST(map, jumpPointSearch)
+{
+    srand(1);
+    PathSearchContext context1;
+    PathSearchContext context2;
+    for (int f = 0; f < 2000; f ++)
+    {
+        const int width = 5 + rand() % 60;
+        const int height = 5 + rand() % 60;
+        const int density = rand() % 40;
+        std::vector<unsigned char> grid(width * height);
+        for (int i = 0; i < width * height; i ++)
+        {
+            if (rand() % 100 < density)
+                grid[i] = Map::BLOCKMASK_WALL;
+        }
+        const int startX = rand() % width;
+        const int startY = rand() % height;
+        const int destX = rand() % width;
+        const int destY = rand() % height;
+        grid[startX + startY * width] = 0;
+        const int maxCost = f % 3 ? 0 : 20;
+
+        const Path path1 = Map::findGridPath(&grid[0], width, height,
+            useAStar, context1, startX, startY, destX, destY,
+            walkMask, maxCost);
+        const Path path2 = Map::findGridPath(&grid[0], width, height,
+            useJump, context2, startX, startY, destX, destY,
+            walkMask, maxCost);
+
+        ASSERT_EQ(path1.empty(), path2.empty());
+        if (path2.empty())
+            continue;
+        EXPECT_EQ(destX, path2.back().x);
+        EXPECT_EQ(destY, path2.back().y);
+        EXPECT_EQ(getPathCost(grid, width, startX, startY, path1),
+            getPathCost(grid, width, startX, startY, path2));
+    }
+}
+
+TEST(map, jumpPointSearchExpanded)
+{
+    logger = new Logger();
+    srand(2);
+    const int width = 200;
+    const int height = 200;
+    std::vector<unsigned char> grid(width * height);
+    for (int f = 0; f < 400; f ++)
+        grid[rand() % (width * height)] = Map::BLOCKMASK_WALL;
+
+    PathSearchContext context;
+    int expanded1 = 0;
+    int expanded2 = 0;
+    for (int f = 0; f < 50; f ++)
+    {
+        const int startX = rand() % width;
+        const int startY = rand() % height;
+        const int destX = rand() % width;
+        const int destY = rand() % height;
+        grid[startX + startY * width] = 0;
+        grid[destX + destY * width] = 0;
+
+        const Path path1 = Map::findGridPath(&grid[0], width, height,
+            useAStar, context, startX, startY, destX, destY, walkMask, 0);
+        expanded1 += context.getExpandedNodes();
+        const Path path2 = Map::findGridPath(&grid[0], width, height,
+            useJump, context, startX, startY, destX, destY, walkMask, 0);
+        expanded2 += context.getExpandedNodes();
+        EXPECT_EQ(getPathCost(grid, width, startX, startY, path1),
+            getPathCost(grid, width, startX, startY, path2));
+    }
+    logger->log("expanded nodes, A*: %d, jump point search: %d",
+        expanded1, expanded2);
+    EXPECT_LT(expanded2, expanded1);
+    delete logger;
+    logger = nullptr;
+}
+
+TEST(map, walkLayerBlockTile)
+{
+    logger = new Logger();
+    // corridor between two rooms
+    const int width = 7;
+    const int height = 3;
+    Map *const map = new Map(width, height, 32, 32);
+    for (int x = 0; x < width; x ++)
+    {
+        if (x != 3)
+        {
+            map->blockTile(x, 0, Map::BLOCKTYPE_WALL);
+            map->blockTile(x, 2, Map::BLOCKTYPE_WALL);
+        }
+    }
+    WalkLayer *const walkLayer = new WalkLayer(width, height);
+    NavigationManager::labelWalkLayer(walkLayer, map->getBlockmasks(),
+        width, height);
+    map->setWalkLayer(walkLayer);
+    EXPECT_EQ(1, checkWalkLayer(*walkLayer, map->getBlockmasks(),
+        width, height));
+
+    // blocking middle of corridor splits it
+    map->blockTile(3, 1, Map::BLOCKTYPE_WALL);
+    EXPECT_EQ(4, checkWalkLayer(*walkLayer, map->getBlockmasks(),
+        width, height));
+    EXPECT_NE(walkLayer->getDataAt(2, 1), walkLayer->getDataAt(4, 1));
+    EXPECT_NE(walkLayer->getDataAt(3, 0), walkLayer->getDataAt(3, 2));
+
+    // tiles blocked not by walls keep components
+    map->blockTile(1, 1, Map::BLOCKTYPE_MONSTER);
+    EXPECT_EQ(4, checkWalkLayer(*walkLayer, map->getBlockmasks(),
+        width, height));
+
+    map->blockTile(3, 0, Map::BLOCKTYPE_WALL);
+    EXPECT_EQ(3, checkWalkLayer(*walkLayer, map->getBlockmasks(),
+        width, height));
+
+    map->setWalkLayer(nullptr);
+    delete walkLayer;
+    delete map;
+    delete logger;
+    logger = nullptr;
+}
+
+TEST(map, walkLayerUpdate)
+{
+    srand(3);
+    int splits = 0;
+    int merges = 0;
+    for (int f = 0; f < 50; f ++)
+    {
+        const int width = 2 + rand() % 20;
+        const int height = 2 + rand() % 20;
+        const int density = 20 + rand() % 40;
+        std::vector<unsigned char> grid(width * height);
+        for (int i = 0; i < width * height; i ++)
+        {
+            if (rand() % 100 < density)
+                grid[i] = Map::BLOCKMASK_WALL;
+        }
+        WalkLayer walkLayer(width, height);
+        NavigationManager::labelWalkLayer(&walkLayer, &grid[0],
+            width, height);
+        int components = checkWalkLayer(walkLayer, &grid[0], width, height);
+
+        for (int i = 0; i < 100; i ++)
+        {
+            const int x = rand() % width;
+            const int y = rand() % height;
+            const bool block = !(grid[x + y * width] & walkMask);
+            if (block)
+            {
+                grid[x + y * width] = rand() % 2
+                    ? Map::BLOCKMASK_WALL : Map::BLOCKMASK_WATER;
+            }
+            else
+            {
+                grid[x + y * width] = 0;
+            }
+            NavigationManager::updateWalkLayer(&walkLayer, &grid[0],
+                width, height, x, y);
+            const int newComponents = checkWalkLayer(walkLayer, &grid[0],
+                width, height);
+            if (block && newComponents > components)
+                splits ++;
+            else if (!block && newComponents < components)
+                merges ++;
+            components = newComponents;
+        }
+    }
+    EXPECT_GT(splits, 0);
+    EXPECT_GT(merges, 0);
+}
@@ -0,0 +1,299 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapcache.h"
+
+#include "configuration.h"
+#include "logger.h"
+#include "map.h"
+#include "maplayer.h"
+
+#include "resources/mapdb.h"
+#include "resources/resourcemanager.h"
+
+#include "utils/physfstools.h"
+
+#include <SDL_thread.h>
+
+#include <algorithm>
+
+#include "debug.h"
+
+MapCache *mapCache = nullptr;
+
+static const int maxCachedMaps = 8;
+static const int maxPrefetchedFiles = 8;
+
+MapCache::MapCache() :
+    mMaps(),
+    mQueue(),
+    mFiles(),
+    mThread(nullptr),
+    mMutex(nullptr),
+    mCond(nullptr),
+    mBudget(config.getIntValue("mapCacheSize") * 1024 * 1024),
+    mMemory(0),
+    mHits(0),
+    mMisses(0),
+    mRunning(true)
+{
+    if (mBudget <= 0)
+        return;
+
+    mMutex = SDL_CreateMutex();
+    mCond = SDL_CreateCond();
+    if (mMutex && mCond)
+        mThread = SDL_CreateThread(prefetchThread, this);
+    if (!mThread)
+        logger->log1("Warning: cant start map prefetch thread");
+}
+
+MapCache::~MapCache()
+{
+    if (mThread)
+    {
+        SDL_mutexP(mMutex);
+        mRunning = false;
+        SDL_CondSignal(mCond);
+        SDL_mutexV(mMutex);
+        SDL_WaitThread(mThread, nullptr);
+        mThread = nullptr;
+    }
+    clear();
+    if (mCond)
+    {
+        SDL_DestroyCond(mCond);
+        mCond = nullptr;
+    }
+    if (mMutex)
+    {
+        SDL_DestroyMutex(mMutex);
+        mMutex = nullptr;
+    }
+}
+
+std::string MapCache::getMapFile(const std::string &name)
+{
+    std::string fileName = paths.getValue("maps", "maps/").append(
+        MapDB::getMapName(name)).append(".tmx");
+    if (!ResourceManager::getInstance()->exists(fileName))
+        fileName.append(".gz");
+    return fileName;
+}
+
+int MapCache::prefetchThread(void *ptr)
+{
+    MapCache *const cache = static_cast<MapCache*>(ptr);
+    if (!cache)
+        return 0;
+
+    SDL_mutexP(cache->mMutex);
+    while (cache->mRunning)
+    {
+        if (cache->mQueue.empty())
+        {
+            SDL_CondWait(cache->mCond, cache->mMutex);
+            continue;
+        }
+
+        const std::string fileName = cache->mQueue.back();
+        cache->mQueue.pop_back();
+        SDL_mutexV(cache->mMutex);
+
+        // logger is not thread safe, so file is read without resman
+        PrefetchedFile file;
+        PHYSFS_file *const handle = PhysFs::openRead(fileName.c_str());
+        if (handle)
+        {
+            file.size = static_cast<int>(PHYSFS_fileLength(handle));
+            file.data = calloc(file.size, 1);
+            if (file.data && static_cast<int>(PHYSFS_read(handle,
+                file.data, 1, file.size)) != file.size)
+            {
+                free(file.data);
+                file.data = nullptr;
+            }
+            PHYSFS_close(handle);
+        }
+
+        SDL_mutexP(cache->mMutex);
+        // file is stored only if it is still wanted
+        const PrefetchedFilesIter it = cache->mFiles.find(fileName);
+        if (it != cache->mFiles.end() && !it->second.data)
+            it->second = file;
+        else
+            free(file.data);
+    }
+    SDL_mutexV(cache->mMutex);
+    return 0;
+}
+
+Map *MapCache::take(const std::string &fileName)
+{
+    FOR_EACH (CachedMapsIter, it, mMaps)
+    {
+        if ((*it).fileName == fileName)
+        {
+            Map *const map = (*it).map;
+            mMemory -= (*it).memory;
+            mMaps.erase(it);
+            mHits ++;
+            logger->log("Map taken from cache: %s", fileName.c_str());
+            return map;
+        }
+    }
+    mMisses ++;
+    return nullptr;
+}
+
+void MapCache::add(Map *const map)
+{
+    if (!map)
+        return;
+
+    const int memory = map->getMemoryUsage();
+    if (map->isCustom() || memory > mBudget)
+    {
+        delete map;
+        return;
+    }
+
+    mMaps.push_front(CachedMap(map->getProperty("_filename"), map, memory));
+    mMemory += memory;
+    while (!mMaps.empty() && (mMemory > mBudget
+           || static_cast<int>(mMaps.size()) > maxCachedMaps))
+    {
+        CachedMap &cached = mMaps.back();
+        mMemory -= cached.memory;
+        delete cached.map;
+        mMaps.pop_back();
+    }
+}
+
+void MapCache::prefetch(const Map *const map)
+{
+    if (!mThread || !map)
+        return;
+
+    // Neighbour maps are named by warp destinations or by portals
+    std::vector<std::string> names = map->getWarpMaps();
+    const std::vector<MapItem*> &portals = map->getPortals();
+    FOR_EACH (std::vector<MapItem*>::const_iterator, it, portals)
+    {
+        if (*it)
+            names.push_back((*it)->getComment());
+    }
+
+    const ResourceManager *const resman = ResourceManager::getInstance();
+    const std::string current = map->getProperty("_filename");
+    std::vector<std::string> files;
+    FOR_EACH (std::vector<std::string>::const_iterator, it, names)
+    {
+        if ((*it).empty()
+            || static_cast<int>(files.size()) >= maxPrefetchedFiles)
+        {
+            continue;
+        }
+        const std::string fileName = getMapFile(*it);
+        if (fileName == current || !resman->exists(fileName)
+            || std::find(files.begin(), files.end(), fileName)
+            != files.end())
+        {
+            continue;
+        }
+        bool cached = false;
+        FOR_EACH (CachedMapsIter, it2, mMaps)
+        {
+            if ((*it2).fileName == fileName)
+            {
+                cached = true;
+                break;
+            }
+        }
+        if (!cached)
+            files.push_back(fileName);
+    }
+
+    SDL_mutexP(mMutex);
+    // drop files of old neighbours
+    PrefetchedFilesIter it = mFiles.begin();
+    while (it != mFiles.end())
+    {
+        if (std::find(files.begin(), files.end(), it->first) == files.end())
+        {
+            free(it->second.data);
+            mFiles.erase(it ++);
+        }
+        else
+        {
+            ++ it;
+        }
+    }
+    mQueue.clear();
+    FOR_EACH (std::vector<std::string>::const_iterator, it2, files)
+    {
+        // files not read yet are queued again
+        const PrefetchedFilesIter it3 = mFiles.find(*it2);
+        if (it3 == mFiles.end())
+            mFiles[*it2] = PrefetchedFile();
+        else if (it3->second.data)
+            continue;
+        mQueue.push_back(*it2);
+    }
+    SDL_CondSignal(mCond);
+    SDL_mutexV(mMutex);
+}
+
+void *MapCache::takeFile(const std::string &fileName, int &fileSize)
+{
+    if (!mThread)
+        return nullptr;
+
+    SDL_mutexP(mMutex);
+    void *data = nullptr;
+    const PrefetchedFilesIter it = mFiles.find(fileName);
+    if (it != mFiles.end())
+    {
+        data = it->second.data;
+        fileSize = it->second.size;
+        mFiles.erase(it);
+    }
+    SDL_mutexV(mMutex);
+    if (data)
+        logger->log("Using prefetched map file: %s", fileName.c_str());
+    return data;
+}
+
+void MapCache::clear()
+{
+    FOR_EACH (CachedMapsIter, it, mMaps)
+        delete (*it).map;
+    mMaps.clear();
+    mMemory = 0;
+
+    if (mMutex)
+        SDL_mutexP(mMutex);
+    FOR_EACH (PrefetchedFilesIter, it, mFiles)
+        free(it->second.data);
+    mFiles.clear();
+    mQueue.clear();
+    if (mMutex)
+        SDL_mutexV(mMutex);
+}
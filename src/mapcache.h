@@ -0,0 +1,142 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "localconsts.h"
+
+class Map;
+
+struct SDL_cond;
+struct SDL_mutex;
+struct SDL_Thread;
+
+struct CachedMap final
+{
+    CachedMap(const std::string &fileName0, Map *const map0,
+              const int memory0) :
+        fileName(fileName0),
+        map(map0),
+        memory(memory0)
+    {
+    }
+
+    std::string fileName;
+    Map *map;
+    int memory;
+};
+
+struct PrefetchedFile final
+{
+    PrefetchedFile() :
+        data(nullptr),
+        size(0)
+    {
+    }
+
+    void *data;
+    int size;
+};
+
+typedef std::list<CachedMap> CachedMaps;
+typedef CachedMaps::iterator CachedMapsIter;
+typedef std::map<std::string, PrefetchedFile> PrefetchedFiles;
+typedef PrefetchedFiles::iterator PrefetchedFilesIter;
+
+/**
+ * Keeps recently visited maps and files of maps reachable through warps.
+ *
+ * Maps left by player are kept while they fit in the memory budget, so
+ * going back is only a pointer swap. Files of neighbour maps are read in a
+ * background thread, because images and other resources can be created
+ * only in the main thread.
+ */
+class MapCache final
+{
+    public:
+        MapCache();
+
+        A_DELETE_COPY(MapCache)
+
+        ~MapCache();
+
+        /**
+         * Returns file name of map with the given name.
+         */
+        static std::string getMapFile(const std::string &name)
+                                      A_WARN_UNUSED;
+
+        /**
+         * Removes map from cache and returns it, or returns nullptr if map
+         * is not cached.
+         */
+        Map *take(const std::string &fileName) A_WARN_UNUSED;
+
+        /**
+         * Stores map left by player. Least recently used maps are deleted
+         * if cache gets over budget. Takes ownership of the map.
+         */
+        void add(Map *const map);
+
+        /**
+         * Starts reading files of maps reachable through warps.
+         */
+        void prefetch(const Map *const map);
+
+        /**
+         * Returns prefetched file data, or nullptr if file was not read yet.
+         * Caller must free returned data.
+         */
+        void *takeFile(const std::string &fileName,
+                       int &fileSize) A_WARN_UNUSED;
+
+        void clear();
+
+        int getHits() const A_WARN_UNUSED
+        { return mHits; }
+
+        int getMisses() const A_WARN_UNUSED
+        { return mMisses; }
+
+    private:
+        static int prefetchThread(void *ptr);
+
+        CachedMaps mMaps;
+        std::vector<std::string> mQueue;
+        PrefetchedFiles mFiles;
+        SDL_Thread *mThread;
+        SDL_mutex *mMutex;
+        SDL_cond *mCond;
+        int mBudget;
+        int mMemory;
+        int mHits;
+        int mMisses;
+        bool mRunning;
+};
+
+extern MapCache *mapCache;
+
+#endif  // MAPCACHE_H
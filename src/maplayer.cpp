@@ -23,6 +23,7 @@
 #include "maplayer.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "graphicsvertexes.h"
 #ifndef USE_OPENGL
 #include "graphics.h"
@@ -345,6 +346,7 @@ void MapLayer::drawFringe(Graphics *const graphics, int startX, int startY,
                           const int debugFlags, const int yFix) const
 {
     BLOCK_START("MapLayer::drawFringe")
+    BUDGET_BLOCK(ZONE_FRINGE)
     if (!player_node || !mSpecialLayer || !mTempLayer)
     {
         BLOCK_END("MapLayer::drawFringe")
@@ -27,6 +27,7 @@
 #include "mobileopenglgraphics.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "graphicsmanager.h"
 #include "graphicsvertexes.h"
 #include "logger.h"
@@ -1181,6 +1182,7 @@ void MobileOpenGLGraphics::bindTexture(const GLenum target,
     if (mLastImage != texture)
     {
         mLastImage = texture;
+        FrameBudget::count(FrameBudget::COUNTER_TEXTURE_BINDS);
         glBindTexture(target, texture);
     }
 }
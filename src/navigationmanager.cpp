@@ -23,6 +23,8 @@
 #include "map.h"
 #include "walklayer.h"
 
+#include <vector>
+
 static const int walkMask = (Map::BLOCKMASK_WALL | Map::BLOCKMASK_AIR
     | Map::BLOCKMASK_WATER);
 
@@ -59,101 +61,245 @@ Resource *NavigationManager::loadWalkLayer(const Map *const map)
     if (width < 2 || height < 2)
         return nullptr;
     WalkLayer *const walkLayer = new WalkLayer(width, height);
+    labelWalkLayer(walkLayer, map->getBlockmasks(), width, height);
+    return walkLayer;
+}
 
-    const MetaTile *const tiles = map->getMetaTiles();
-    int *const data = walkLayer->getData();
-
-    int x = 0;
-    int y = 0;
-    int num = 1;
-    while (findWalkableTile(x, y, width, height, tiles, data))
+static int findRoot(std::vector<int> &parents, int ptr)
+{
+    while (parents[ptr] != ptr)
     {
-        fillNum(x, y, width, height, num, tiles, data);
-        num ++;
+        parents[ptr] = parents[parents[ptr]];
+        ptr = parents[ptr];
     }
+    return ptr;
+}
 
-    return walkLayer;
+static void unite(std::vector<int> &parents, const int ptr1, const int ptr2)
+{
+    const int root1 = findRoot(parents, ptr1);
+    const int root2 = findRoot(parents, ptr2);
+    // lower root wins, so roots are first tiles of components
+    if (root1 < root2)
+        parents[root2] = root1;
+    else if (root2 < root1)
+        parents[root1] = root2;
 }
 
-bool NavigationManager::findWalkableTile(int &x1, int &y1,
-                                         const int width, const int height,
-                                         const MetaTile *const tiles,
-                                         const int *const data)
+void NavigationManager::labelWalkLayer(WalkLayer *const walkLayer,
+                                       const unsigned char *const tiles,
+                                       const int width, const int height)
 {
+    const int size = width * height;
+    int *const data = walkLayer->getData();
+
+    // join walkable tiles with left and top neighbours
+    std::vector<int> parents(size);
     for (int y = 0; y < height; y ++)
     {
         const int y2 = y * width;
         for (int x = 0; x < width; x ++)
         {
             const int ptr = x + y2;
-            if (!(tiles[ptr].blockmask & walkMask) && !data[ptr])
+            parents[ptr] = ptr;
+            if (tiles[ptr] & walkMask)
+                continue;
+            if (x > 0 && !(tiles[ptr - 1] & walkMask))
+                unite(parents, ptr, ptr - 1);
+            if (y > 0 && !(tiles[ptr - width] & walkMask))
+                unite(parents, ptr, ptr - width);
+        }
+    }
+
+    // components are numbered in order of their first tiles
+    int num = 0;
+    for (int ptr = 0; ptr < size; ptr ++)
+    {
+        if (tiles[ptr] & walkMask)
+            continue;
+        const int root = findRoot(parents, ptr);
+        if (root == ptr)
+            data[ptr] = ++ num;
+        else
+            data[ptr] = data[root];
+    }
+    walkLayer->setComponents(num);
+
+    for (int y = 0; y < height; y ++)
+    {
+        const int y2 = y * width;
+        for (int x = 0; x < width; x ++)
+        {
+            if (tiles[x + y2] & walkMask)
+                data[x + y2] = getBorderNum(x, y, width, height, data);
+        }
+    }
+}
+
+void NavigationManager::updateWalkLayer(WalkLayer *const walkLayer,
+                                        const unsigned char *const tiles,
+                                        const int width, const int height,
+                                        const int x, const int y)
+{
+    if (!walkLayer || x < 0 || y < 0 || x >= width || y >= height)
+        return;
+
+    int *const data = walkLayer->getData();
+    const int ptr = x + y * width;
+    const bool walkable = !(tiles[ptr] & walkMask);
+    if (walkable == (data[ptr] > 0))
+        return;
+
+    const int dx[4] = {-1, 1, 0, 0};
+    const int dy[4] = {0, 0, -1, 1};
+    if (walkable)
+    {
+        // Unblocked tile joins all neighbour components into one
+        int num = 0;
+        for (int f = 0; f < 4; f ++)
+        {
+            const int x2 = x + dx[f];
+            const int y2 = y + dy[f];
+            if (x2 < 0 || y2 < 0 || x2 >= width || y2 >= height)
+                continue;
+            const int num2 = data[x2 + y2 * width];
+            if (num2 > 0 && (!num || num2 < num))
+                num = num2;
+        }
+        if (!num)
+            num = walkLayer->addComponent();
+        fillNum(x, y, width, height, num, tiles, data);
+    }
+    else
+    {
+        // Blocked tile can split its component. Neighbours not reached
+        // from first one get new components.
+        const int oldNum = data[ptr];
+        data[ptr] = 0;
+        int neighbours = 0;
+        for (int f = 0; f < 4; f ++)
+        {
+            const int x2 = x + dx[f];
+            const int y2 = y + dy[f];
+            if (x2 >= 0 && y2 >= 0 && x2 < width && y2 < height
+                && !(tiles[x2 + y2 * width] & walkMask))
+            {
+                neighbours ++;
+            }
+        }
+        if (neighbours > 1)
+        {
+            bool first = true;
+            for (int f = 0; f < 4; f ++)
+            {
+                const int x2 = x + dx[f];
+                const int y2 = y + dy[f];
+                if (x2 < 0 || y2 < 0 || x2 >= width || y2 >= height)
+                    continue;
+                const int ptr2 = x2 + y2 * width;
+                if (tiles[ptr2] & walkMask || data[ptr2] != oldNum)
+                    continue;
+                if (first)
+                {
+                    // reached tiles are marked, then get old number back
+                    fillNum(x2, y2, width, height, -1, tiles, data);
+                    first = false;
+                }
+                else
+                {
+                    fillNum(x2, y2, width, height,
+                        walkLayer->addComponent(), tiles, data);
+                }
+            }
+            for (int f = 0; f < 4; f ++)
+            {
+                const int x2 = x + dx[f];
+                const int y2 = y + dy[f];
+                if (x2 >= 0 && y2 >= 0 && x2 < width && y2 < height
+                    && !(tiles[x2 + y2 * width] & walkMask)
+                    && data[x2 + y2 * width] == -1)
+                {
+                    fillNum(x2, y2, width, height, oldNum, tiles, data);
+                    break;
+                }
+            }
+        }
+
+        // blocked neighbours could touch component only through this tile
+        data[ptr] = getBorderNum(x, y, width, height, data);
+        for (int f = 0; f < 4; f ++)
+        {
+            const int x2 = x + dx[f];
+            const int y2 = y + dy[f];
+            if (x2 >= 0 && y2 >= 0 && x2 < width && y2 < height
+                && tiles[x2 + y2 * width] & walkMask)
             {
-                x1 = x;
-                y1 = y;
-                return true;
+                data[x2 + y2 * width] = getBorderNum(x2, y2,
+                    width, height, data);
             }
         }
     }
-    return false;
+}
+
+int NavigationManager::getBorderNum(const int x, const int y,
+                                    const int width, const int height,
+                                    const int *const data)
+{
+    int num = 0;
+    if (x > 0 && data[x - 1 + y * width] > 0)
+        num = data[x - 1 + y * width];
+    if (x < width - 1)
+    {
+        const int num2 = data[x + 1 + y * width];
+        if (num2 > 0 && (!num || num2 < num))
+            num = num2;
+    }
+    if (y > 0)
+    {
+        const int num2 = data[x + (y - 1) * width];
+        if (num2 > 0 && (!num || num2 < num))
+            num = num2;
+    }
+    if (y < height - 1)
+    {
+        const int num2 = data[x + (y + 1) * width];
+        if (num2 > 0 && (!num || num2 < num))
+            num = num2;
+    }
+    return -num;
 }
 
 void NavigationManager::fillNum(int x, int y,
                                 const int width, const int height,
-                                const int num, const MetaTile *const tiles,
+                                const int num, const unsigned char *const tiles,
                                 int *const data)
 {
     std::vector<Cell> cells;
     cells.push_back(Cell(x, y));
+    data[x + width * y] = num;
     while (!cells.empty())
     {
         const Cell cell = cells.back();
         cells.pop_back();
-        int ptr;
         x = cell.x;
         y = cell.y;
-        data[x + width * y] = num;
-        if (x > 0)
-        {
-            ptr = (x - 1) + width * y;
-            if (!data[ptr])
-            {
-                if (!(tiles[ptr].blockmask & walkMask))
-                    cells.push_back(Cell(x - 1, y));
-                else
-                    data[ptr] = -num;
-            }
-        }
-        if (x < width - 1)
+        for (int f = 0; f < 4; f ++)
         {
-            ptr = (x + 1) + width * y;
-            if (!data[ptr])
+            const int x2 = x + (f == 0 ? -1 : (f == 1 ? 1 : 0));
+            const int y2 = y + (f == 2 ? -1 : (f == 3 ? 1 : 0));
+            if (x2 < 0 || y2 < 0 || x2 >= width || y2 >= height)
+                continue;
+            const int ptr = x2 + width * y2;
+            if (tiles[ptr] & walkMask)
             {
-                if (!(tiles[ptr].blockmask & walkMask))
-                    cells.push_back(Cell(x + 1, y));
-                else
-                    data[ptr] = -num;
+                // border numbers are set after fill with temporary mark
+                if (num > 0)
+                    data[ptr] = getBorderNum(x2, y2, width, height, data);
             }
-        }
-        if (y > 0)
-        {
-            ptr = x + width * (y - 1);
-            if (!data[ptr])
+            else if (data[ptr] != num)
             {
-                if (!(tiles[ptr].blockmask & walkMask))
-                    cells.push_back(Cell(x, y - 1));
-                else
-                    data[ptr] = -num;
-            }
-        }
-        if (y < height - 1)
-        {
-            ptr = x + width * (y + 1);
-            if (!data[ptr])
-            {
-                if (!(tiles[ptr].blockmask & walkMask))
-                    cells.push_back(Cell(x, y + 1));
-                else
-                    data[ptr] = -num;
+                data[ptr] = num;
+                cells.push_back(Cell(x2, y2));
             }
         }
     }
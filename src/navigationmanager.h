@@ -23,9 +23,9 @@
 
 #include "localconsts.h"
 
-class MetaTile;
 class Map;
 class Resource;
+class WalkLayer;
 
 class NavigationManager final
 {
@@ -38,15 +38,36 @@ class NavigationManager final
 
         static Resource *loadWalkLayer(const Map *const map);
 
+        /**
+         * Numbers components of walkable tiles in one pass. Walkable tiles
+         * get number of their component, blocked tiles get negative number
+         * of lowest adjacent component, or zero.
+         */
+        static void labelWalkLayer(WalkLayer *const walkLayer,
+                                   const unsigned char *const tiles,
+                                   const int width, const int height);
+
+        /**
+         * Updates walk layer after collision of tile changed. Only
+         * components touching the tile are renumbered.
+         */
+        static void updateWalkLayer(WalkLayer *const walkLayer,
+                                    const unsigned char *const tiles,
+                                    const int width, const int height,
+                                    const int x, const int y);
+
     private:
-        static bool findWalkableTile(int &x1, int &y1,
-                                     const int width, const int height,
-                                     const MetaTile *const tiles,
-                                     const int *const data);
+        static int getBorderNum(const int x, const int y,
+                                const int width, const int height,
+                                const int *const data) A_WARN_UNUSED;
 
+        /**
+         * Sets number to walkable tiles connected to given tile and
+         * updates numbers of blocked tiles around them.
+         */
         static void fillNum(int x, int y,
                             const int width, const int height,
-                            const int num, const MetaTile *const tiles,
+                            const int num, const unsigned char *const tiles,
                             int *const data);
 };
 
@@ -60,6 +60,9 @@ Download::Download(void *const ptr, const std::string &url,
     mFileName(""),
     mWriteFunction(nullptr),
     mAdler(0),
+    mFileAdler(0),
+    mResumeFrom(0),
+    mFile(nullptr),
     mUpdateFunction(updateFunction),
     mThread(nullptr),
     mCurl(nullptr),
@@ -87,30 +90,16 @@ Download::~Download()
     free(mError);
 }
 
-/**
- * Calculates the Alder-32 checksum for the given file.
- */
 unsigned long Download::fadler32(FILE *const file)
 {
+    unsigned long adler = adler32(0L, Z_NULL, 0);
     if (!file)
-        return 0;
+        return adler;
 
-    // Obtain file size
-    fseek(file, 0, SEEK_END);
-    const long fileSize = ftell(file);
-    if (fileSize < 0)
-    {   // file size error
-        return 0;
-    }
-    rewind(file);
-
-    // Calculate Adler-32 checksum
-    char *const buffer = static_cast<char*>(malloc(fileSize));
-    const uInt read = static_cast<uInt>(fread(buffer, 1, fileSize, file));
-    unsigned long adler = adler32(0L, Z_NULL, 0);
-    adler = adler32(static_cast<uInt>(adler),
-        reinterpret_cast<Bytef*>(buffer), read);
-    free(buffer);
+    Bytef buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        adler = adler32(adler, buffer, static_cast<uInt>(read));
 
     return adler;
 }
@@ -189,6 +178,13 @@ int Download::downloadProgress(void *clientp, double dltotal, double dlnow,
     if (!d)
         return -5;
 
+    // curl counts only bytes of resumed part
+    if (dltotal > 0)
+    {
+        dltotal += d->mResumeFrom;
+        dlnow += d->mResumeFrom;
+    }
+
     if (d->mOptions.cancel)
     {
         return d->mUpdateFunction(d->mPtr, DOWNLOAD_STATUS_CANCELLED,
@@ -201,6 +197,44 @@ int Download::downloadProgress(void *clientp, double dltotal, double dlnow,
                               static_cast<size_t>(dlnow));
 }
 
+size_t Download::writeFile(void *ptr, size_t size, size_t nmemb,
+                           void *stream)
+{
+    Download *const d = static_cast<Download*>(stream);
+    if (!d || !d->mFile)
+        return 0;
+
+    const size_t written = fwrite(ptr, size, nmemb, d->mFile) * size;
+    d->mFileAdler = adler32(d->mFileAdler, static_cast<const Bytef*>(ptr),
+        static_cast<uInt>(written));
+    return written;
+}
+
+FILE *Download::openPartFile(const std::string &partName)
+{
+    mFileAdler = adler32(0L, Z_NULL, 0);
+    mResumeFrom = 0;
+
+    // without checksum continued file can not be validated
+    if (mOptions.checkAdler)
+    {
+        FILE *const file = fopen(partName.c_str(), "r+b");
+        if (file)
+        {
+            mFileAdler = fadler32(file);
+            const long size = ftell(file);
+            if (size > 0 && !fseek(file, 0, SEEK_END))
+            {
+                mResumeFrom = size;
+                return file;
+            }
+            fclose(file);
+            mFileAdler = adler32(0L, Z_NULL, 0);
+        }
+    }
+    return fopen(partName.c_str(), "w+b");
+}
+
 int Download::downloadThread(void *ptr)
 {
     int attempts = 0;
@@ -225,13 +259,26 @@ int Download::downloadThread(void *ptr)
             return 0;
         }
 
+        if (!d->mOptions.memoryWrite)
+        {
+            d->mFile = d->openPartFile(outFilename);
+            if (d->mResumeFrom > 0 && d->mFileAdler == d->mAdler)
+            {
+                // previous attempt got whole file, but was not renamed
+                logger->log("Using downloaded part: %s",
+                    outFilename.c_str());
+                fclose(d->mFile);
+                d->mFile = nullptr;
+                complete = d->renamePartFile(outFilename);
+                break;
+            }
+        }
+
         d->mCurl = curl_easy_init();
 
-        if (d->mCurl && !d->mOptions.cancel)
+        if (d->mCurl && !d->mOptions.cancel
+            && (d->mOptions.memoryWrite || d->mFile))
         {
-            FILE *file = nullptr;
-            logger->log("Downloading: %s", d->mUrl.c_str());
-
             curl_easy_setopt(d->mCurl, CURLOPT_FOLLOWLOCATION, 1);
             curl_easy_setopt(d->mCurl, CURLOPT_HTTPHEADER, d->mHeaders);
 
@@ -244,8 +291,15 @@ int Download::downloadThread(void *ptr)
             }
             else
             {
-                file = fopen(outFilename.c_str(), "w+b");
-                curl_easy_setopt(d->mCurl, CURLOPT_WRITEDATA, file);
+                curl_easy_setopt(d->mCurl, CURLOPT_WRITEFUNCTION, writeFile);
+                curl_easy_setopt(d->mCurl, CURLOPT_WRITEDATA, d);
+                if (d->mResumeFrom > 0)
+                {
+                    logger->log("Resuming %s from %ld bytes",
+                        d->mUrl.c_str(), d->mResumeFrom);
+                    curl_easy_setopt(d->mCurl, CURLOPT_RESUME_FROM_LARGE,
+                        static_cast<curl_off_t>(d->mResumeFrom));
+                }
             }
 
             curl_easy_setopt(d->mCurl, CURLOPT_USERAGENT,
@@ -278,20 +332,30 @@ int Download::downloadThread(void *ptr)
                         break;
                 }
 
+                curl_easy_cleanup(d->mCurl);
+                d->mCurl = nullptr;
+                if (d->mFile)
+                {
+                    fclose(d->mFile);
+                    d->mFile = nullptr;
+                }
+
                 if (d->mOptions.cancel)
                     break;
 
-                d->mUpdateFunction(d->mPtr, DOWNLOAD_STATUS_ERROR, 0, 0);
-
-                if (!d->mOptions.memoryWrite)
+                if (res == CURLE_RANGE_ERROR)
                 {
-                    if (file)
-                    {
-                        fclose(file);
-                        file = nullptr;
-                    }
+                    // server can not continue file, start it again
                     ::remove(outFilename.c_str());
+                    attempts++;
+                    continue;
                 }
+
+                // error is reported only after last attempt, so caller
+                // does not cancel download while it can be retried.
+                // part with known checksum is continued by next attempt
+                if (!d->mOptions.memoryWrite && !d->mOptions.checkAdler)
+                    ::remove(outFilename.c_str());
                 attempts++;
                 continue;
             }
@@ -301,51 +365,24 @@ int Download::downloadThread(void *ptr)
 
             if (!d->mOptions.memoryWrite)
             {
+                const bool written = !fclose(d->mFile);
+                d->mFile = nullptr;
+
                 // Don't check resources.xml checksum
-                if (d->mOptions.checkAdler)
-                {
-                    const unsigned long adler = fadler32(file);
-
-                    if (d->mAdler != adler)
-                    {
-                        if (file)
-                        {
-                            fclose(file);
-                            file = nullptr;
-                        }
-
-                        // Remove the corrupted file
-                        ::remove(d->mFileName.c_str());
-                        logger->log("Checksum for file %s failed: (%lx/%lx)",
-                            d->mFileName.c_str(),
-                            adler, d->mAdler);
-                        attempts++;
-                        continue;  // Bail out here to avoid the renaming
-                    }
-                }
-                if (file)
+                if (!written || (d->mOptions.checkAdler
+                    && d->mAdler != d->mFileAdler))
                 {
-                    fclose(file);
-                    file = nullptr;
+                    // Remove the corrupted file
+                    ::remove(outFilename.c_str());
+                    logger->log("Checksum for file %s failed: (%lx/%lx)",
+                        d->mFileName.c_str(),
+                        d->mFileAdler, d->mAdler);
+                    attempts++;
+                    continue;  // Bail out here to avoid the renaming
                 }
 
-                // Any existing file with this name is deleted first, otherwise
-                // the rename will fail on Windows.
                 if (!d->mOptions.cancel)
-                {
-                    ::remove(d->mFileName.c_str());
-                    ::rename(outFilename.c_str(), d->mFileName.c_str());
-
-                    // Check if we can open it and no errors were encountered
-                    // during renaming
-                    file = fopen(d->mFileName.c_str(), "rb");
-                    if (file)
-                    {
-                        fclose(file);
-                        file = nullptr;
-                        complete = true;
-                    }
-                }
+                    complete = d->renamePartFile(outFilename);
             }
             else
             {
@@ -359,6 +396,11 @@ int Download::downloadThread(void *ptr)
             curl_easy_cleanup(d->mCurl);
             d->mCurl = nullptr;
         }
+        if (d->mFile)
+        {
+            fclose(d->mFile);
+            d->mFile = nullptr;
+        }
 
         if (d->mOptions.cancel)
         {
@@ -369,6 +411,12 @@ int Download::downloadThread(void *ptr)
         attempts++;
     }
 
+    if (d->mCurl)
+    {
+        curl_easy_cleanup(d->mCurl);
+        d->mCurl = nullptr;
+    }
+
     if (d->mOptions.cancel)
     {
         // Nothing to do...
@@ -386,6 +434,22 @@ int Download::downloadThread(void *ptr)
     return 0;
 }
 
+bool Download::renamePartFile(const std::string &partName) const
+{
+    // Any existing file with this name is deleted first, otherwise
+    // the rename will fail on Windows.
+    ::remove(mFileName.c_str());
+    ::rename(partName.c_str(), mFileName.c_str());
+
+    // Check if we can open it and no errors were encountered
+    // during renaming
+    FILE *const file = fopen(mFileName.c_str(), "rb");
+    if (!file)
+        return false;
+    fclose(file);
+    return true;
+}
+
 void Download::addProxy(CURL *const curl)
 {
     const int mode = config.getIntValue("downloadProxyType");
@@ -94,6 +94,10 @@ class Download final
         void setIgnoreError(const bool n)
         { mIgnoreError = n; }
 
+        /**
+         * Calculates Adler-32 checksum of file from current position to its
+         * end, reading it by small blocks.
+         */
         static unsigned long fadler32(FILE *const file) A_WARN_UNUSED;
 
         static void addProxy(CURL *const curl);
@@ -105,6 +109,21 @@ class Download final
         static int downloadProgress(void *clientp, double dltotal,
                                     double dlnow, double ultotal,
                                     double ulnow);
+
+        /**
+         * Writes received data to file and updates checksum, so file is
+         * not read again after download.
+         */
+        static size_t writeFile(void *ptr, size_t size, size_t nmemb,
+                                void *stream);
+
+        /**
+         * Opens part file. Part left by previous attempt is continued if
+         * checksum is known.
+         */
+        FILE *openPartFile(const std::string &partName);
+
+        bool renamePartFile(const std::string &partName) const;
         void *mPtr;
         std::string mUrl;
         struct
@@ -116,6 +135,9 @@ class Download final
         std::string mFileName;
         WriteFunction mWriteFunction;
         unsigned long mAdler;
+        unsigned long mFileAdler;
+        long mResumeFrom;
+        FILE *mFile;
         DownloadUpdate mUpdateFunction;
         SDL_Thread *mThread;
         CURL *mCurl;
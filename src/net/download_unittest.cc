@@ -0,0 +1,331 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+
+#include "client.h"
+
+#include "net/download.h"
+
+#include "utils/stringutils.h"
+
+#include "gtest/gtest.h"
+
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+#include <zlib.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "debug.h"
+
+namespace
+{
+    // minimal http server, enough for curl and range requests
+    struct TestServer final
+    {
+        TestServer() :
+            data(),
+            listenSocket(-1),
+            port(0),
+            requests(0),
+            rangeRequests(0),
+            brokenRequests(0),
+            thread(nullptr)
+        {
+        }
+
+        A_DELETE_COPY(TestServer)
+
+        std::string data;
+        int listenSocket;
+        int port;
+        int requests;
+        int rangeRequests;
+        int brokenRequests;
+        SDL_Thread *thread;
+    };
+
+    void sendAll(const int sock, const std::string &str)
+    {
+        size_t pos = 0;
+        while (pos < str.size())
+        {
+            const ssize_t sent = send(sock, str.c_str() + pos,
+                str.size() - pos, 0);
+            if (sent <= 0)
+                return;
+            pos += sent;
+        }
+    }
+
+    int serverThread(void *ptr)
+    {
+        TestServer *const server = static_cast<TestServer*>(ptr);
+        for (;;)
+        {
+            const int sock = accept(server->listenSocket, nullptr, nullptr);
+            if (sock < 0)
+                break;
+
+            std::string request;
+            char buf[1024];
+            while (request.find("\r\n\r\n") == std::string::npos)
+            {
+                const ssize_t sz = recv(sock, buf, sizeof(buf), 0);
+                if (sz <= 0)
+                    break;
+                request.append(buf, sz);
+            }
+            server->requests ++;
+
+            const size_t size = server->data.size();
+            size_t from = 0;
+            const size_t rangePos = request.find("Range: bytes=");
+            if (rangePos != std::string::npos)
+            {
+                from = atoi(request.c_str() + rangePos + 13);
+                server->rangeRequests ++;
+            }
+
+            std::string answer;
+            if (from)
+            {
+                answer = strprintf("HTTP/1.1 206 Partial Content\r\n"
+                    "Content-Range: bytes %u-%u/%u\r\n",
+                    static_cast<unsigned>(from),
+                    static_cast<unsigned>(size - 1),
+                    static_cast<unsigned>(size));
+            }
+            else
+            {
+                answer = "HTTP/1.1 200 OK\r\n";
+            }
+            answer.append(strprintf("Content-Length: %u\r\n"
+                "Connection: close\r\n\r\n",
+                static_cast<unsigned>(size - from)));
+            // connection is closed in middle of file
+            if (server->brokenRequests > 0)
+            {
+                server->brokenRequests --;
+                answer.append(server->data.substr(from, (size - from) / 2));
+            }
+            else
+            {
+                answer.append(server->data.substr(from));
+            }
+            sendAll(sock, answer);
+            close(sock);
+        }
+        return 0;
+    }
+
+    void startServer(TestServer &server)
+    {
+        server.data.clear();
+        srand(1);
+        for (int f = 0; f < 300000; f ++)
+            server.data.push_back(static_cast<char>(rand()));
+
+        server.listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(server.listenSocket, reinterpret_cast<sockaddr*>(&addr),
+            sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(server.listenSocket, reinterpret_cast<sockaddr*>(&addr),
+            &len);
+        server.port = ntohs(addr.sin_port);
+        listen(server.listenSocket, 8);
+        server.thread = SDL_CreateThread(serverThread, &server);
+    }
+
+    void stopServer(TestServer &server)
+    {
+        shutdown(server.listenSocket, SHUT_RDWR);
+        close(server.listenSocket);
+        SDL_WaitThread(server.thread, nullptr);
+    }
+
+    DownloadStatus lastStatus = DOWNLOAD_STATUS_IDLE;
+    int errorsCount = 0;
+
+    int downloadUpdate(void *ptr A_UNUSED, DownloadStatus status,
+                       size_t total A_UNUSED, size_t remaining A_UNUSED)
+    {
+        if (status != DOWNLOAD_STATUS_IDLE)
+            lastStatus = status;
+        if (status == DOWNLOAD_STATUS_ERROR)
+            errorsCount ++;
+        return 0;
+    }
+
+    void download(const TestServer &server, const std::string &fileName,
+                  const unsigned long adler)
+    {
+        lastStatus = DOWNLOAD_STATUS_IDLE;
+        errorsCount = 0;
+        Net::Download *const d = new Net::Download(nullptr,
+            strprintf("http://127.0.0.1:%d/test.zip", server.port),
+            downloadUpdate);
+        d->setFile(fileName, adler);
+        d->start();
+        // destructor waits for download thread
+        delete d;
+    }
+
+    std::string readFile(const std::string &fileName)
+    {
+        std::string str;
+        FILE *const file = fopen(fileName.c_str(), "rb");
+        if (!file)
+            return str;
+        char buf[4096];
+        size_t sz;
+        while ((sz = fread(buf, 1, sizeof(buf), file)) > 0)
+            str.append(buf, sz);
+        fclose(file);
+        return str;
+    }
+
+    unsigned long getAdler(const std::string &str)
+    {
+        return adler32(adler32(0L, Z_NULL, 0),
+            reinterpret_cast<const Bytef*>(str.c_str()),
+            static_cast<uInt>(str.size()));
+    }
+}  // namespace
+
+static const std::string testFile = "/tmp/manaplus_download_test.zip";
+
+TEST(download, checksum)
+{
+    Client::Options options;
+    Client client(options);
+    if (!logger)
+        logger = new Logger();
+    TestServer server;
+    startServer(server);
+    remove(testFile.c_str());
+    remove((testFile + ".part").c_str());
+
+    download(server, testFile, getAdler(server.data));
+    EXPECT_EQ(DOWNLOAD_STATUS_COMPLETE, lastStatus);
+    EXPECT_TRUE(readFile(testFile) == server.data);
+    EXPECT_TRUE(readFile(testFile + ".part").empty());
+
+    unsigned long adler = 0;
+    FILE *const file = fopen(testFile.c_str(), "rb");
+    adler = Net::Download::fadler32(file);
+    fclose(file);
+    EXPECT_EQ(getAdler(server.data), adler);
+
+    // wrong checksum, file is not kept
+    remove(testFile.c_str());
+    download(server, testFile, getAdler(server.data) + 1);
+    EXPECT_EQ(DOWNLOAD_STATUS_ERROR, lastStatus);
+    EXPECT_EQ(1, errorsCount);
+    EXPECT_TRUE(readFile(testFile).empty());
+    EXPECT_EQ(0, server.rangeRequests);
+
+    stopServer(server);
+    remove(testFile.c_str());
+}
+
+TEST(download, resume)
+{
+    Client::Options options;
+    Client client(options);
+    if (!logger)
+        logger = new Logger();
+    TestServer server;
+    startServer(server);
+    remove(testFile.c_str());
+
+    // part left by interrupted download
+    const std::string partName = testFile + ".part";
+    FILE *const file = fopen(partName.c_str(), "wb");
+    fwrite(server.data.c_str(), 1, 100000, file);
+    fclose(file);
+
+    download(server, testFile, getAdler(server.data));
+    EXPECT_EQ(DOWNLOAD_STATUS_COMPLETE, lastStatus);
+    EXPECT_EQ(1, server.requests);
+    EXPECT_EQ(1, server.rangeRequests);
+    EXPECT_TRUE(readFile(testFile) == server.data);
+
+    // whole part is only renamed
+    rename(testFile.c_str(), partName.c_str());
+    download(server, testFile, getAdler(server.data));
+    EXPECT_EQ(DOWNLOAD_STATUS_COMPLETE, lastStatus);
+    EXPECT_EQ(1, server.requests);
+    EXPECT_TRUE(readFile(testFile) == server.data);
+
+    stopServer(server);
+    remove(testFile.c_str());
+}
+
+TEST(download, retry)
+{
+    Client::Options options;
+    Client client(options);
+    if (!logger)
+        logger = new Logger();
+    TestServer server;
+    startServer(server);
+    remove(testFile.c_str());
+    remove((testFile + ".part").c_str());
+
+    // broken transfer is continued by next attempt without error
+    server.brokenRequests = 1;
+    download(server, testFile, getAdler(server.data));
+    EXPECT_EQ(DOWNLOAD_STATUS_COMPLETE, lastStatus);
+    EXPECT_EQ(0, errorsCount);
+    EXPECT_EQ(2, server.requests);
+    EXPECT_EQ(1, server.rangeRequests);
+    EXPECT_TRUE(readFile(testFile) == server.data);
+
+    // error is reported once, after all attempts failed
+    remove(testFile.c_str());
+    remove((testFile + ".part").c_str());
+    server.requests = 0;
+    server.brokenRequests = 3;
+    download(server, testFile, getAdler(server.data));
+    EXPECT_EQ(DOWNLOAD_STATUS_ERROR, lastStatus);
+    EXPECT_EQ(1, errorsCount);
+    EXPECT_EQ(3, server.requests);
+    EXPECT_TRUE(readFile(testFile).empty());
+
+    stopServer(server);
+    remove(testFile.c_str());
+    remove((testFile + ".part").c_str());
+}
@@ -84,8 +84,9 @@ Being *BeingHandler::createBeing(const int id, const int16_t job) const
 
     if (type == ActorSprite::PLAYER || type == ActorSprite::NPC)
     {
-        being->updateFromCache();
-        requestNameById(id);
+        // fresh cached name need not be requested again
+        if (!being->updateFromCache() || being->getName().empty())
+            requestNameById(id);
         if (player_node)
             player_node->checkNewName(being);
     }
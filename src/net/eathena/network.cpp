@@ -23,6 +23,7 @@
 #include "net/eathena/network.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "logger.h"
 
 #include "net/eathena/protocol.h"
@@ -165,6 +166,7 @@ void Network::clearHandlers()
 
 void Network::dispatchMessages()
 {
+    BUDGET_BLOCK(ZONE_NETWORK)
     while (messageReady())
     {
         SDL_mutexP(mMutex);
@@ -23,6 +23,7 @@
 #include "net/tmwa/network.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "logger.h"
 
 #include "net/tmwa/protocol.h"
@@ -144,6 +145,7 @@ void Network::clearHandlers()
 void Network::dispatchMessages()
 {
     BLOCK_START("Network::dispatchMessages")
+    BUDGET_BLOCK(ZONE_NETWORK)
     while (messageReady())
     {
         SDL_mutexP(mMutex);
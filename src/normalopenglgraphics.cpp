@@ -26,6 +26,7 @@
 #include "normalopenglgraphics.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "graphicsmanager.h"
 #include "graphicsvertexes.h"
 #include "logger.h"
@@ -1360,6 +1361,7 @@ void NormalOpenGLGraphics::bindTexture(const GLenum target,
     if (mLastImage != texture)
     {
         mLastImage = texture;
+        FrameBudget::count(FrameBudget::COUNTER_TEXTURE_BINDS);
         glBindTexture(target, texture);
     }
 }
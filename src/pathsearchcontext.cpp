@@ -0,0 +1,77 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2004-2009  The Mana World Development Team
+ *  Copyright (C) 2009-2010  The Mana Developers
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathsearchcontext.h"
+
+#include <limits.h>
+
+#include "debug.h"
+
+PathSearchContext::PathSearchContext() :
+    mNodes(),
+    mWidth(0),
+    mHeight(0),
+    mOnClosedList(1),
+    mOnOpenList(2),
+    mExpandedNodes(0)
+{
+}
+
+void PathSearchContext::startSearch(const int width, const int height)
+{
+    mExpandedNodes = 0;
+    if (width != mWidth || height != mHeight)
+    {
+        mWidth = width;
+        mHeight = height;
+        mNodes.clear();
+        mNodes.resize(width * height);
+        mOnClosedList = 1;
+        mOnOpenList = 2;
+        return;
+    }
+
+    // Two new values to indicate whether a tile is on the open or closed list,
+    // this way we don't have to clear all the values between each pathfinding.
+    if (mOnOpenList > UINT_MAX - 2)
+    {
+        // We reset the list memebers value.
+        mOnClosedList = 1;
+        mOnOpenList = 2;
+
+        const int size = mWidth * mHeight;
+        for (int i = 0; i < size; ++i)
+            mNodes[i].whichList = 0;
+    }
+    else
+    {
+        mOnClosedList += 2;
+        mOnOpenList += 2;
+    }
+}
+
+const PathNode *PathSearchContext::getNode(const int x, const int y) const
+{
+    if (x < 0 || y < 0 || x >= mWidth || y >= mHeight)
+        return nullptr;
+    return &mNodes[x + y * mWidth];
+}
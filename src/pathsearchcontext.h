@@ -0,0 +1,104 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2004-2009  The Mana World Development Team
+ *  Copyright (C) 2009-2010  The Mana Developers
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHSEARCHCONTEXT_H
+#define PATHSEARCHCONTEXT_H
+
+#include <vector>
+
+#include "localconsts.h"
+
+/**
+ * Pathfinding state of one map location.
+ */
+struct PathNode final
+{
+    PathNode() :
+        Fcost(0),
+        Gcost(0),
+        Hcost(0),
+        whichList(0),
+        parentX(0),
+        parentY(0)
+    {
+    }
+
+    int Fcost;               /**< Estimation of total path cost */
+    int Gcost;               /**< Cost from start to this location */
+    int Hcost;               /**< Estimated cost to goal */
+    unsigned whichList;      /**< No list, open list or closed list */
+    int parentX;             /**< X coordinate of parent tile */
+    int parentY;             /**< Y coordinate of parent tile */
+};
+
+/**
+ * Scratch memory for path searches on a map.
+ *
+ * Kept apart from map collision data, so each thread can own a context
+ * and run searches on same map at same time. Nodes are allocated on
+ * first search and reused by next searches on maps of same size.
+ */
+class PathSearchContext final
+{
+    public:
+        PathSearchContext();
+
+        A_DELETE_COPY(PathSearchContext)
+
+        /**
+         * Prepares context for new search on map with given size.
+         */
+        void startSearch(const int width, const int height);
+
+        PathNode *getNodes() A_WARN_UNUSED
+        { return &mNodes[0]; }
+
+        /**
+         * Returns node from last search or nullptr.
+         */
+        const PathNode *getNode(const int x, const int y) const A_WARN_UNUSED;
+
+        unsigned int getOpenList() const A_WARN_UNUSED
+        { return mOnOpenList; }
+
+        unsigned int getClosedList() const A_WARN_UNUSED
+        { return mOnClosedList; }
+
+        /**
+         * Counts tiles taken from open list in last search.
+         */
+        void addExpandedNode()
+        { mExpandedNodes ++; }
+
+        int getExpandedNodes() const A_WARN_UNUSED
+        { return mExpandedNodes; }
+
+    private:
+        std::vector<PathNode> mNodes;
+        int mWidth;
+        int mHeight;
+        unsigned int mOnClosedList;
+        unsigned int mOnOpenList;
+        int mExpandedNodes;
+};
+
+#endif  // PATHSEARCHCONTEXT_H
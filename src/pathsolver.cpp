@@ -0,0 +1,333 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathsolver.h"
+
+#include "actorspritemanager.h"
+#include "being.h"
+#include "client.h"
+#include "configuration.h"
+#include "logger.h"
+#include "map.h"
+
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+#include "debug.h"
+
+PathSolver *pathSolver = nullptr;
+
+static const int maxSolverThreads = 4;
+// Straight steps done while request is pending
+static const int fallbackSteps = 1;
+
+PathGrid::PathGrid(const Map *const map) :
+    blockmasks(map->getBlockmasks(),
+        map->getBlockmasks() + map->getWidth() * map->getHeight()),
+    width(map->getWidth()),
+    height(map->getHeight()),
+    version(map->getCollisionVersion()),
+    refs(1),
+    nonWallMask(map->getNonWallMask())
+{
+}
+
+PathSolver::PathSolver() :
+    mQueue(),
+    mResults(),
+    mThreads(),
+    mMap(nullptr),
+    mGrid(nullptr),
+    mMutex(SDL_CreateMutex()),
+    mCond(SDL_CreateCond()),
+    mEpoch(0),
+    mTime(cur_time),
+    mSolves(0),
+    mLatencySum(0),
+    mSolvesPerSecond(0),
+    mLatency(0),
+    mQueueSize(0),
+    mRunning(true)
+{
+    int threads = config.getIntValue("pathSolverThreads");
+    if (threads > maxSolverThreads)
+        threads = maxSolverThreads;
+    if (!mMutex || !mCond)
+        threads = 0;
+    for (int f = 0; f < threads; f ++)
+    {
+        SDL_Thread *const thread = SDL_CreateThread(solverThread, this);
+        if (!thread)
+        {
+            logger->log1("Warning: cant start path solver thread");
+            break;
+        }
+        mThreads.push_back(thread);
+    }
+}
+
+PathSolver::~PathSolver()
+{
+    if (mMutex)
+    {
+        SDL_mutexP(mMutex);
+        mRunning = false;
+        SDL_CondBroadcast(mCond);
+        SDL_mutexV(mMutex);
+    }
+    FOR_EACH (std::vector<SDL_Thread*>::const_iterator, it, mThreads)
+        SDL_WaitThread(*it, nullptr);
+    mThreads.clear();
+
+    FOR_EACH (PathRequestsIter, it, mQueue)
+        releaseGrid((*it).grid);
+    FOR_EACH (PathRequestsIter, it, mResults)
+        releaseGrid((*it).grid);
+    releaseGrid(mGrid);
+    mGrid = nullptr;
+
+    if (mCond)
+    {
+        SDL_DestroyCond(mCond);
+        mCond = nullptr;
+    }
+    if (mMutex)
+    {
+        SDL_DestroyMutex(mMutex);
+        mMutex = nullptr;
+    }
+}
+
+int PathSolver::solverThread(void *ptr)
+{
+    PathSolver *const solver = static_cast<PathSolver*>(ptr);
+    if (!solver)
+        return 0;
+
+    PathSearchContext context;
+    SDL_mutexP(solver->mMutex);
+    while (solver->mRunning)
+    {
+        if (solver->mQueue.empty())
+        {
+            SDL_CondWait(solver->mCond, solver->mMutex);
+            continue;
+        }
+
+        PathRequests request;
+        request.splice(request.begin(), solver->mQueue,
+            solver->mQueue.begin());
+        SDL_mutexV(solver->mMutex);
+
+        PathRequest &req = request.front();
+        const PathGrid *const grid = req.grid;
+        req.path = Map::findGridPath(&grid->blockmasks[0],
+            grid->width, grid->height, grid->nonWallMask, context,
+            req.startX, req.startY, req.destX, req.destY, req.walkMask);
+
+        SDL_mutexP(solver->mMutex);
+        solver->mResults.splice(solver->mResults.end(), request);
+    }
+    SDL_mutexV(solver->mMutex);
+    return 0;
+}
+
+bool PathSolver::addRequest(const Being *const being,
+                            const int dstX, const int dstY)
+{
+    if (mThreads.empty() || !being)
+        return false;
+
+    const Map *const map = being->getMap();
+    if (!map || map != mMap)
+        return false;
+
+    PathRequest request;
+    request.beingId = being->getId();
+    request.generation = being->getPathGeneration();
+    request.startX = being->getTileX();
+    request.startY = being->getTileY();
+    request.destX = dstX;
+    request.destY = dstY;
+    request.walkMask = being->getWalkMask();
+    request.time = SDL_GetTicks();
+    addRequest(request);
+    return true;
+}
+
+void PathSolver::addRequest(PathRequest &request)
+{
+    // collision copy is replaced on first request after map changes
+    if (!mGrid || mGrid->version != mMap->getCollisionVersion())
+    {
+        releaseGrid(mGrid);
+        mGrid = new PathGrid(mMap);
+    }
+
+    request.epoch = mEpoch;
+    request.grid = mGrid;
+
+    SDL_mutexP(mMutex);
+    mGrid->refs ++;
+    mQueue.push_back(request);
+    SDL_CondSignal(mCond);
+    SDL_mutexV(mMutex);
+}
+
+void PathSolver::releaseGrid(PathGrid *const grid)
+{
+    if (!grid)
+        return;
+
+    if (mMutex)
+        SDL_mutexP(mMutex);
+    grid->refs --;
+    const bool unused = grid->refs <= 0;
+    if (mMutex)
+        SDL_mutexV(mMutex);
+    if (unused)
+        delete grid;
+}
+
+void PathSolver::logic()
+{
+    BLOCK_START("PathSolver::logic")
+    PathRequests results;
+    SDL_mutexP(mMutex);
+    results.swap(mResults);
+    mQueueSize = static_cast<int>(mQueue.size());
+    SDL_mutexV(mMutex);
+
+    const unsigned int now = SDL_GetTicks();
+    FOR_EACH (PathRequestsIter, it, results)
+    {
+        PathRequest &request = *it;
+        releaseGrid(request.grid);
+        request.grid = nullptr;
+        mSolves ++;
+        mLatencySum += static_cast<int>(now - request.time);
+        if (request.epoch == mEpoch)
+            applyResult(request);
+    }
+
+    if (mTime != cur_time)
+    {
+        mTime = cur_time;
+        mSolvesPerSecond = mSolves;
+        mLatency = mSolves ? mLatencySum / mSolves : 0;
+        mSolves = 0;
+        mLatencySum = 0;
+    }
+    BLOCK_END("PathSolver::logic")
+}
+
+void PathSolver::applyResult(PathRequest &request)
+{
+    if (!actorSpriteManager)
+        return;
+
+    Being *const being = actorSpriteManager->findBeing(request.beingId);
+    // being got new destination or was removed
+    if (!being || being->getMap() != mMap
+        || being->getPathGeneration() != request.generation)
+    {
+        return;
+    }
+
+    Path &path = request.path;
+    const int x = being->getTileX();
+    const int y = being->getTileY();
+    if (x != request.startX || y != request.startY)
+    {
+        // being already did fallback steps, continue from its position
+        PathIterator it = path.begin();
+        const PathIterator it_end = path.end();
+        while (it != it_end && (it->x != x || it->y != y))
+            ++ it;
+        if (it == it_end)
+        {
+            if (request.retry)
+            {
+                being->setPath(Path());
+                return;
+            }
+            PathRequest retry;
+            retry.beingId = request.beingId;
+            retry.generation = request.generation;
+            retry.startX = x;
+            retry.startY = y;
+            retry.destX = request.destX;
+            retry.destY = request.destY;
+            retry.walkMask = request.walkMask;
+            retry.time = request.time;
+            retry.retry = true;
+            addRequest(retry);
+            return;
+        }
+        path.erase(path.begin(), ++ it);
+    }
+    being->setPath(path);
+}
+
+void PathSolver::setMap(const Map *const map)
+{
+    mEpoch ++;
+    mMap = map;
+    SDL_mutexP(mMutex);
+    PathRequests queue;
+    queue.swap(mQueue);
+    SDL_mutexV(mMutex);
+    FOR_EACH (PathRequestsIter, it, queue)
+        releaseGrid((*it).grid);
+    releaseGrid(mGrid);
+    mGrid = nullptr;
+}
+
+Path PathSolver::getFallbackPath(const Map *const map,
+                                 const int startX, const int startY,
+                                 const int dstX, const int dstY,
+                                 const unsigned char walkMask)
+{
+    Path path;
+    if (!map)
+        return path;
+
+    int x = startX;
+    int y = startY;
+    for (int f = 0; f < fallbackSteps; f ++)
+    {
+        const int dx = dstX > x ? 1 : (dstX < x ? -1 : 0);
+        const int dy = dstY > y ? 1 : (dstY < y ? -1 : 0);
+        if (!dx && !dy)
+            break;
+        if (!map->getWalk(x + dx, y + dy, walkMask))
+            break;
+        // same corner rule as in path finding
+        if (dx && dy && (!map->getWalk(x + dx, y, Map::BLOCKMASK_WALL)
+            || !map->getWalk(x, y + dy, Map::BLOCKMASK_WALL)))
+        {
+            break;
+        }
+        x += dx;
+        y += dy;
+        path.push_back(Position(x, y));
+    }
+    return path;
+}
@@ -0,0 +1,170 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2011-2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHSOLVER_H
+#define PATHSOLVER_H
+
+#include "position.h"
+
+#include <list>
+#include <vector>
+
+#include "localconsts.h"
+
+class Being;
+class Map;
+
+struct SDL_cond;
+struct SDL_mutex;
+struct SDL_Thread;
+
+/**
+ * Copy of map collision used by solver threads.
+ */
+struct PathGrid final
+{
+    explicit PathGrid(const Map *const map);
+
+    A_DELETE_COPY(PathGrid)
+
+    std::vector<unsigned char> blockmasks;
+    int width;
+    int height;
+    int version;
+    int refs;
+    unsigned char nonWallMask;
+};
+
+struct PathRequest final
+{
+    PathRequest() :
+        path(),
+        grid(nullptr),
+        beingId(0),
+        generation(0),
+        epoch(0),
+        startX(0),
+        startY(0),
+        destX(0),
+        destY(0),
+        walkMask(0),
+        time(0),
+        retry(false)
+    {
+    }
+
+    Path path;
+    PathGrid *grid;
+    int beingId;
+    int generation;
+    int epoch;
+    int startX;
+    int startY;
+    int destX;
+    int destY;
+    unsigned char walkMask;
+    unsigned int time;
+    bool retry;
+};
+
+typedef std::list<PathRequest> PathRequests;
+typedef PathRequests::iterator PathRequestsIter;
+
+/**
+ * Finds paths for remote beings in worker threads.
+ *
+ * Requests are solved on a copy of map collision and applied to beings
+ * from logic, if being did not get new destination meanwhile. While a
+ * request is pending, being walks straight toward destination.
+ */
+class PathSolver final
+{
+    public:
+        PathSolver();
+
+        A_DELETE_COPY(PathSolver)
+
+        ~PathSolver();
+
+        /**
+         * Queues path search for being. Returns false if solver threads
+         * are not running and path must be found by caller.
+         */
+        bool addRequest(const Being *const being,
+                        const int dstX, const int dstY);
+
+        /**
+         * Applies solved paths. Must be called from logic.
+         */
+        void logic();
+
+        /**
+         * Drops pending requests and collision copy of old map.
+         */
+        void setMap(const Map *const map);
+
+        /**
+         * Returns first steps of straight line to destination, while they
+         * are walkable.
+         */
+        static Path getFallbackPath(const Map *const map,
+                                    const int startX, const int startY,
+                                    const int dstX, const int dstY,
+                                    const unsigned char walkMask)
+                                    A_WARN_UNUSED;
+
+        int getSolvesPerSecond() const A_WARN_UNUSED
+        { return mSolvesPerSecond; }
+
+        int getLatency() const A_WARN_UNUSED
+        { return mLatency; }
+
+        int getQueueSize() const A_WARN_UNUSED
+        { return mQueueSize; }
+
+    private:
+        static int solverThread(void *ptr);
+
+        void addRequest(PathRequest &request);
+
+        void applyResult(PathRequest &request);
+
+        void releaseGrid(PathGrid *const grid);
+
+        PathRequests mQueue;
+        PathRequests mResults;
+        std::vector<SDL_Thread*> mThreads;
+        const Map *mMap;
+        PathGrid *mGrid;
+        SDL_mutex *mMutex;
+        SDL_cond *mCond;
+        int mEpoch;
+        int mTime;
+        int mSolves;
+        int mLatencySum;
+        int mSolvesPerSecond;
+        int mLatency;
+        int mQueueSize;
+        bool mRunning;
+};
+
+extern PathSolver *pathSolver;
+
+#endif  // PATHSOLVER_H
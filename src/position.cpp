@@ -22,8 +22,90 @@
 
 #include "position.h"
 
+#include <algorithm>
+
 #include "debug.h"
 
+Path::Path() :
+    mData(mBuffer),
+    mStart(0),
+    mEnd(0),
+    mCapacity(bufferSize)
+{
+}
+
+Path::Path(const Path &path) :
+    mData(mBuffer),
+    mStart(0),
+    mEnd(0),
+    mCapacity(bufferSize)
+{
+    *this = path;
+}
+
+Path::~Path()
+{
+    if (mData != mBuffer)
+        delete [] mData;
+}
+
+Path &Path::operator=(const Path &path)
+{
+    if (&path == this)
+        return *this;
+
+    const unsigned int sz = path.size();
+    mStart = 0;
+    mEnd = 0;
+    if (sz > mCapacity)
+        grow(sz);
+    std::copy(path.begin(), path.end(), mData);
+    mEnd = sz;
+    return *this;
+}
+
+void Path::grow(const unsigned int sz)
+{
+    const unsigned int used = size();
+    if (sz <= mCapacity)
+    {
+        std::copy(mData + mStart, mData + mEnd, mData);
+    }
+    else
+    {
+        unsigned int capacity = mCapacity * 2;
+        if (capacity < sz)
+            capacity = sz;
+        Position *const data = new Position[capacity];
+        std::copy(mData + mStart, mData + mEnd, data);
+        if (mData != mBuffer)
+            delete [] mData;
+        mData = data;
+        mCapacity = capacity;
+    }
+    mStart = 0;
+    mEnd = used;
+}
+
+Path::iterator Path::erase(iterator first, iterator last)
+{
+    if (first == begin())
+    {
+        mStart += static_cast<unsigned int>(last - first);
+        if (mStart == mEnd)
+            clear();
+        return begin();
+    }
+    iterator it = std::copy(last, end(), first);
+    mEnd = static_cast<unsigned int>(it - mData);
+    return first;
+}
+
+void Path::reverse()
+{
+    std::reverse(begin(), end());
+}
+
 std::ostream& operator <<(std::ostream &os, const Position &p)
 {
     os << "(" << p.x << ", " << p.y << ")";
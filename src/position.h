@@ -24,7 +24,6 @@
 #define POSITION_H
 
 #include <iostream>
-#include <list>
 
 #include "localconsts.h"
 
@@ -33,6 +32,10 @@
  */
 struct Position final
 {
+    Position() :
+        x(0), y(0)
+    { }
+
     Position(const int x0, const int y0) :
         x(x0), y(y0)
     { }
@@ -41,7 +44,100 @@ struct Position final
     int y;
 };
 
-typedef std::list<Position> Path;
+/**
+ * Path of positions in contiguous memory.
+ *
+ * Short paths are kept inside the object, longer ones in heap memory.
+ * Removing first position only moves start index, so walking along path
+ * does not move the rest of it.
+ */
+class Path final
+{
+    public:
+        typedef Position *iterator;
+        typedef const Position *const_iterator;
+
+        Path();
+
+        Path(const Path &path);
+
+        ~Path();
+
+        Path &operator=(const Path &path);
+
+        bool empty() const A_WARN_UNUSED
+        { return mStart == mEnd; }
+
+        unsigned int size() const A_WARN_UNUSED
+        { return mEnd - mStart; }
+
+        void clear()
+        { mStart = 0; mEnd = 0; }
+
+        iterator begin() A_WARN_UNUSED
+        { return mData + mStart; }
+
+        iterator end() A_WARN_UNUSED
+        { return mData + mEnd; }
+
+        const_iterator begin() const A_WARN_UNUSED
+        { return mData + mStart; }
+
+        const_iterator end() const A_WARN_UNUSED
+        { return mData + mEnd; }
+
+        Position &front() A_WARN_UNUSED
+        { return mData[mStart]; }
+
+        const Position &front() const A_WARN_UNUSED
+        { return mData[mStart]; }
+
+        Position &back() A_WARN_UNUSED
+        { return mData[mEnd - 1]; }
+
+        const Position &back() const A_WARN_UNUSED
+        { return mData[mEnd - 1]; }
+
+        void push_back(const Position &pos)
+        {
+            if (mEnd == mCapacity)
+                grow(size() + 1);
+            mData[mEnd ++] = pos;
+        }
+
+        void pop_front()
+        {
+            mStart ++;
+            if (mStart == mEnd)
+                clear();
+        }
+
+        void pop_back()
+        {
+            mEnd --;
+            if (mStart == mEnd)
+                clear();
+        }
+
+        iterator erase(iterator first, iterator last);
+
+        void reverse();
+
+    private:
+        /**
+         * Moves positions to start of memory, making room for given size.
+         */
+        void grow(const unsigned int sz);
+
+        static const unsigned int bufferSize = 16;
+
+        Position *mData;
+        unsigned int mStart;
+        unsigned int mEnd;
+        unsigned int mCapacity;
+        Position mBuffer[bufferSize];
+};
+
 typedef Path::iterator PathIterator;
 
 /**
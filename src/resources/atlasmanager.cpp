@@ -25,6 +25,7 @@
 #include "resources/atlasmanager.h"
 
 #include "client.h"
+#include "framebudget.h"
 #include "graphics.h"
 #include "graphicsmanager.h"
 #include "logger.h"
@@ -221,6 +222,7 @@ SDL_Surface *AtlasManager::createSDLAtlas(TextureAtlas *const atlas)
     atlas->height = powerOfTwo(atlas->height);
 
     // temp SDL surface for atlas
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     SDL_Surface *const surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
         atlas->width, atlas->height, 32, rmask, gmask, bmask, amask);
 
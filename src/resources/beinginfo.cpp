@@ -24,6 +24,7 @@
 
 #include "configuration.h"
 #include "logger.h"
+#include "soundmanager.h"
 
 #include "utils/dtor.h"
 #include "utils/gettext.h"
@@ -115,6 +116,18 @@ const SoundInfo &BeingInfo::getSound(const SoundEvent event) const
             i->second->at(rand() % i->second->size());
 }
 
+void BeingInfo::preloadSounds() const
+{
+    FOR_EACH (SoundEvents::const_iterator, it, mSounds)
+    {
+        const SoundInfoVect *const sounds = it->second;
+        if (!sounds)
+            continue;
+        FOR_EACHP (SoundInfoVect::const_iterator, it2, sounds)
+            soundManager.loadSfx(*it2);
+    }
+}
+
 const Attack *BeingInfo::getAttack(const int id) const
 {
     const Attacks::const_iterator i = mAttacks.find(id);
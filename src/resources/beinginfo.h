@@ -125,6 +125,11 @@ class BeingInfo final
         const SoundInfo &getSound(const SoundEvent event)
                                   const A_WARN_UNUSED;
 
+        /**
+         * Loads all sounds of being, so first hit does not wait for disk.
+         */
+        void preloadSounds() const;
+
         void addAttack(const int id, std::string action, const int effectId,
                        const int hitEffectId, const int criticalHitEffectId,
                        const int missEffectId,
@@ -37,19 +37,27 @@
 
 bool ImageWriter::writePNG(SDL_Surface *const surface,
                            const std::string &filename)
+{
+    std::string error;
+    const bool ok = writePNG(surface, filename, -1, error);
+    if (!ok && !error.empty())
+        logger->log1(error.c_str());
+    return ok;
+}
+
+bool ImageWriter::writePNG(SDL_Surface *const surface,
+                           const std::string &filename,
+                           const int compression,
+                           std::string &error)
 {
     if (!surface)
         return false;
 
-
-    if (SDL_MUSTLOCK(surface))
-        SDL_LockSurface(surface);
-
     png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
         nullptr, nullptr, nullptr);
     if (!png_ptr)
     {
-        logger->log1("Had trouble creating png_structp");
+        error = "Had trouble creating png_structp";
         return false;
     }
 
@@ -57,25 +65,37 @@ bool ImageWriter::writePNG(SDL_Surface *const surface,
     if (!info_ptr)
     {
         png_destroy_write_struct(&png_ptr, static_cast<png_infopp>(nullptr));
-        logger->log1("Could not create png_info");
+        error = "Could not create png_info";
         return false;
     }
 
-    if (setjmp(png_jmpbuf(png_ptr)))
+    FILE *const fp = fopen(filename.c_str(), "wb");
+    if (!fp)
     {
         png_destroy_write_struct(&png_ptr, static_cast<png_infopp>(nullptr));
-        logger->log("problem writing to %s", filename.c_str());
+        error = "could not open file " + filename + " for writing";
         return false;
     }
 
-    FILE *const fp = fopen(filename.c_str(), "wb");
-    if (!fp)
+    png_bytep *const row_pointers = new png_bytep[surface->h];
+
+    if (SDL_MUSTLOCK(surface))
+        SDL_LockSurface(surface);
+
+    if (setjmp(png_jmpbuf(png_ptr)))
     {
-        logger->log("could not open file %s for writing", filename.c_str());
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+        delete [] row_pointers;
+        fclose(fp);
+        png_destroy_write_struct(&png_ptr, static_cast<png_infopp>(nullptr));
+        error = "problem writing to " + filename;
         return false;
     }
 
     png_init_io(png_ptr, fp);
+    if (compression >= 0 && compression <= 9)
+        png_set_compression_level(png_ptr, compression);
 
     const int colortype = (surface->format->BitsPerPixel == 24) ?
         PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA;
@@ -88,14 +108,6 @@ bool ImageWriter::writePNG(SDL_Surface *const surface,
 
     png_set_packing(png_ptr);
 
-    png_bytep *const row_pointers = new png_bytep[surface->h];
-    if (!row_pointers)
-    {
-        logger->log1("Had trouble converting surface to row pointers");
-        fclose(fp);
-        return false;
-    }
-
     for (int i = 0; i < surface->h; i++)
     {
         row_pointers[i] = static_cast<png_bytep>(static_cast<uint8_t *>(
@@ -105,14 +117,52 @@ bool ImageWriter::writePNG(SDL_Surface *const surface,
     png_write_image(png_ptr, row_pointers);
     png_write_end(png_ptr, info_ptr);
 
-    fclose(fp);
+    if (SDL_MUSTLOCK(surface))
+        SDL_UnlockSurface(surface);
 
     delete [] row_pointers;
 
     png_destroy_write_struct(&png_ptr, static_cast<png_infopp>(nullptr));
 
+    if (fclose(fp))
+    {
+        error = "problem writing to " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool ImageWriter::writePPM(SDL_Surface *const surface,
+                           const std::string &filename,
+                           std::string &error)
+{
+    if (!surface || surface->format->BitsPerPixel != 24)
+        return false;
+
+    FILE *const fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+    {
+        error = "could not open file " + filename + " for writing";
+        return false;
+    }
+
+    if (SDL_MUSTLOCK(surface))
+        SDL_LockSurface(surface);
+
+    bool ok = fprintf(fp, "P6\n%d %d\n255\n", surface->w, surface->h) > 0;
+    const size_t lineSize = surface->w * 3;
+    for (int i = 0; i < surface->h && ok; i++)
+    {
+        ok = fwrite(static_cast<uint8_t *>(surface->pixels)
+            + i * surface->pitch, 1, lineSize, fp) == lineSize;
+    }
+
     if (SDL_MUSTLOCK(surface))
         SDL_UnlockSurface(surface);
 
-    return true;
+    if (fclose(fp))
+        ok = false;
+    if (!ok)
+        error = "problem writing to " + filename;
+    return ok;
 }
@@ -33,4 +33,23 @@ class ImageWriter final
     public:
         static bool writePNG(SDL_Surface *const surface,
                              const std::string &filename);
+
+        /**
+         * Writes surface to png file without logging, so it can be used
+         * from other threads. On fail error is set.
+         *
+         * @param compression zlib level 0-9, or -1 for default.
+         */
+        static bool writePNG(SDL_Surface *const surface,
+                             const std::string &filename,
+                             const int compression,
+                             std::string &error);
+
+        /**
+         * Writes 24 bit surface to binary ppm file. Much faster than png,
+         * used for frame capture.
+         */
+        static bool writePPM(SDL_Surface *const surface,
+                             const std::string &filename,
+                             std::string &error);
 };
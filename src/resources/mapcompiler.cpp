@@ -0,0 +1,337 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resources/mapcompiler.h"
+
+#include "client.h"
+#include "logger.h"
+#include "main.h"
+
+#include "resources/resourcemanager.h"
+
+#include "utils/mkdir.h"
+#include "utils/stringutils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
+
+#include "debug.h"
+
+// 'MPCM', also tells if file was written with other byte order
+static const int compiledMapMagic = 0x4d43504d;
+static const int compiledMapVersion = 1;
+
+static int getIntsCount(const int bytes)
+{
+    return (bytes + static_cast<int>(sizeof(int)) - 1)
+        / static_cast<int>(sizeof(int));
+}
+
+MapCompiler::MapCompiler(const int width, const int height,
+                         const int tileWidth, const int tileHeight) :
+    mDependencies(),
+    mProperties(),
+    mTilesets(),
+    mLayers(),
+    mObjects(),
+    mWarpMaps(),
+    mWidth(width),
+    mHeight(height),
+    mTileWidth(tileWidth),
+    mTileHeight(tileHeight),
+    mDependenciesCount(0),
+    mPropertiesCount(0),
+    mTilesetsCount(0),
+    mLayersCount(0),
+    mObjectsCount(0),
+    mWarpMapsCount(0),
+    mLayerType(LAYER_TILES),
+    mLayerStart(0),
+    mLayerWidth(0),
+    mLayerHeight(0)
+{
+}
+
+std::string MapCompiler::getFileName(const std::string &mapFile,
+                                     const unsigned int crc)
+{
+    std::string name = mapFile;
+    const size_t pos = name.rfind("/");
+    if (pos != std::string::npos)
+        name = name.substr(pos + 1);
+    return strprintf("%s/compiledmaps/%s_%08x.bin",
+        Client::getLocalDataDirectory().c_str(), name.c_str(), crc);
+}
+
+unsigned int MapCompiler::getFileCrc(const std::string &fileName)
+{
+    int size = 0;
+    void *const buffer = ResourceManager::loadFile(fileName, size);
+    if (!buffer)
+        return 0;
+    const unsigned int crc = static_cast<unsigned int>(crc32(0,
+        static_cast<const Bytef*>(buffer), size));
+    free(buffer);
+    return crc;
+}
+
+void MapCompiler::addString(std::vector<int> &data, const std::string &str)
+{
+    const int len = static_cast<int>(str.size());
+    data.push_back(len);
+    const size_t start = data.size();
+    data.resize(start + getIntsCount(len), 0);
+    if (len)
+        memcpy(&data[start], str.c_str(), len);
+}
+
+void MapCompiler::addDependency(const std::string &fileName)
+{
+    addString(mDependencies, fileName);
+    mDependencies.push_back(static_cast<int>(getFileCrc(fileName)));
+    mDependenciesCount ++;
+}
+
+void MapCompiler::addProperty(const std::string &name,
+                              const std::string &value)
+{
+    addString(mProperties, name);
+    addString(mProperties, value);
+    mPropertiesCount ++;
+}
+
+void MapCompiler::addTileset(const int firstGid, const std::string &image,
+                             const int tileWidth, const int tileHeight,
+                             const int margin, const int spacing,
+                             const std::map<std::string, std::string> &props,
+                             const TileAnimationFrames &animations)
+{
+    mTilesets.push_back(firstGid);
+    addString(mTilesets, image);
+    mTilesets.push_back(tileWidth);
+    mTilesets.push_back(tileHeight);
+    mTilesets.push_back(margin);
+    mTilesets.push_back(spacing);
+
+    mTilesets.push_back(static_cast<int>(props.size()));
+    for (std::map<std::string, std::string>::const_iterator
+         it = props.begin(), it_end = props.end(); it != it_end; ++ it)
+    {
+        addString(mTilesets, it->first);
+        addString(mTilesets, it->second);
+    }
+
+    mTilesets.push_back(static_cast<int>(animations.size()));
+    FOR_EACH (TileAnimationFramesCIter, it, animations)
+    {
+        const AnimationFrames &frames = it->second;
+        mTilesets.push_back(it->first);
+        mTilesets.push_back(static_cast<int>(frames.size()));
+        FOR_EACH (AnimationFrames::const_iterator, it2, frames)
+        {
+            mTilesets.push_back(it2->first);
+            mTilesets.push_back(it2->second);
+        }
+    }
+    mTilesetsCount ++;
+}
+
+void MapCompiler::addLayer(const LayerType type,
+                           const int offsetX, const int offsetY,
+                           const int width, const int height,
+                           const bool isFringe)
+{
+    mLayers.push_back(type);
+    mLayers.push_back(offsetX);
+    mLayers.push_back(offsetY);
+    mLayers.push_back(width);
+    mLayers.push_back(height);
+    mLayers.push_back(isFringe ? 1 : 0);
+    mLayerType = type;
+    mLayerStart = static_cast<int>(mLayers.size());
+    mLayerWidth = width;
+    mLayerHeight = height;
+    // collision layers store one byte per tile
+    const int size = width * height;
+    mLayers.resize(mLayerStart + (type == LAYER_COLLISION
+        ? getIntsCount(size) : size), 0);
+    mLayersCount ++;
+}
+
+void MapCompiler::setTile(const int x, const int y, const int value)
+{
+    if (!mLayersCount || x < 0 || y < 0
+        || x >= mLayerWidth || y >= mLayerHeight)
+    {
+        return;
+    }
+
+    const int index = x + y * mLayerWidth;
+    if (mLayerType == LAYER_COLLISION)
+    {
+        reinterpret_cast<unsigned char*>(&mLayers[mLayerStart])[index]
+            = static_cast<unsigned char>(value);
+    }
+    else
+    {
+        mLayers[mLayerStart + index] = value;
+    }
+}
+
+void MapCompiler::addObject(const ObjectType type, const std::string &name,
+                            const int x, const int y,
+                            const int width, const int height)
+{
+    mObjects.push_back(type);
+    addString(mObjects, name);
+    mObjects.push_back(x);
+    mObjects.push_back(y);
+    mObjects.push_back(width);
+    mObjects.push_back(height);
+    mObjectsCount ++;
+}
+
+void MapCompiler::addWarpMap(const std::string &name)
+{
+    addString(mWarpMaps, name);
+    mWarpMapsCount ++;
+}
+
+bool MapCompiler::save(const std::string &fileName,
+                       const unsigned int crc) const
+{
+    std::vector<int> header;
+    header.push_back(compiledMapMagic);
+    header.push_back(compiledMapVersion);
+    header.push_back(static_cast<int>(crc));
+    addString(header, CHECK_VERSION);
+    header.push_back(mWidth);
+    header.push_back(mHeight);
+    header.push_back(mTileWidth);
+    header.push_back(mTileHeight);
+
+    const std::string dir = fileName.substr(0, fileName.rfind("/"));
+    if (mkdir_r(dir.c_str()))
+    {
+        logger->log("Error: cant create directory %s", dir.c_str());
+        return false;
+    }
+
+    // written to temporary file, so broken file is never loaded
+    const std::string tempName = fileName + ".tmp";
+    FILE *const file = fopen(tempName.c_str(), "wb");
+    if (!file)
+        return false;
+
+    const std::vector<int> *const sections[] =
+    {
+        &header, &mDependencies, &mProperties, &mTilesets,
+        &mLayers, &mObjects, &mWarpMaps
+    };
+    const int counts[] =
+    {
+        -1, mDependenciesCount, mPropertiesCount, mTilesetsCount,
+        mLayersCount, mObjectsCount, mWarpMapsCount
+    };
+
+    bool ok = true;
+    for (size_t f = 0; f < sizeof(counts) / sizeof(int) && ok; f ++)
+    {
+        const std::vector<int> &data = *sections[f];
+        if (counts[f] >= 0)
+            ok = fwrite(&counts[f], sizeof(int), 1, file) == 1;
+        if (ok && !data.empty())
+        {
+            ok = fwrite(&data[0], sizeof(int), data.size(), file)
+                == data.size();
+        }
+    }
+    if (fclose(file))
+        ok = false;
+
+#ifdef WIN32
+    // rename does not replace existing files here
+    if (ok)
+        remove(fileName.c_str());
+#endif
+    if (!ok || rename(tempName.c_str(), fileName.c_str()))
+    {
+        remove(tempName.c_str());
+        logger->log("Error: cant write compiled map %s", fileName.c_str());
+        return false;
+    }
+    return true;
+}
+
+CompiledMapData::CompiledMapData(const void *const data, const int size) :
+    mPtr(static_cast<const int*>(data)),
+    mEnd(static_cast<const int*>(data) + size / sizeof(int)),
+    mValid(data != nullptr)
+{
+}
+
+bool CompiledMapData::readHeader(const unsigned int crc)
+{
+    return readInt() == compiledMapMagic
+        && readInt() == compiledMapVersion
+        && static_cast<unsigned int>(readInt()) == crc
+        && readString() == CHECK_VERSION
+        && mValid;
+}
+
+int CompiledMapData::readInt()
+{
+    if (mPtr >= mEnd)
+    {
+        mValid = false;
+        return 0;
+    }
+    return *mPtr ++;
+}
+
+std::string CompiledMapData::readString()
+{
+    const int len = readInt();
+    const char *const str = reinterpret_cast<const char*>(
+        readInts(getIntsCount(len)));
+    if (!str)
+        return std::string();
+    return std::string(str, len);
+}
+
+const int *CompiledMapData::readInts(const int count)
+{
+    if (count < 0 || count > mEnd - mPtr)
+    {
+        mValid = false;
+        mPtr = mEnd;
+        return nullptr;
+    }
+    const int *const ptr = mPtr;
+    mPtr += count;
+    return ptr;
+}
+
+const unsigned char *CompiledMapData::readBytes(const int count)
+{
+    return reinterpret_cast<const unsigned char*>(
+        readInts(getIntsCount(count)));
+}
@@ -0,0 +1,179 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOURCES_MAPCOMPILER_H
+#define RESOURCES_MAPCOMPILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "localconsts.h"
+
+// frame index in tileset and delay
+typedef std::vector<std::pair<int, int> > AnimationFrames;
+typedef std::map<int, AnimationFrames> TileAnimationFrames;
+typedef TileAnimationFrames::const_iterator TileAnimationFramesCIter;
+
+/**
+ * Writes compiled map, a binary copy of everything MapReader takes from
+ * TMX file and its tilesets.
+ *
+ * Compiled map is an array of ints: header, external tilesets with their
+ * checksums, properties, tilesets with animations, layers with gid arrays,
+ * collision layers with block types, objects and warp destinations.
+ * Strings are stored as length followed by characters padded to int size.
+ */
+class MapCompiler final
+{
+    public:
+        enum LayerType
+        {
+            LAYER_TILES = 0,
+            LAYER_COLLISION
+        };
+
+        enum ObjectType
+        {
+            OBJECT_PARTICLE = 0,
+            OBJECT_WARP,
+            OBJECT_MUSIC
+        };
+
+        MapCompiler(const int width, const int height,
+                    const int tileWidth, const int tileHeight);
+
+        A_DELETE_COPY(MapCompiler)
+
+        /**
+         * Returns name of compiled map file for the given map file.
+         */
+        static std::string getFileName(const std::string &mapFile,
+                                       const unsigned int crc)
+                                       A_WARN_UNUSED;
+
+        /**
+         * Returns checksum of file from game data, or 0 if it is missing.
+         */
+        static unsigned int getFileCrc(const std::string &fileName)
+                                       A_WARN_UNUSED;
+
+        /**
+         * Adds external file. Compiled map is dropped if it changes.
+         */
+        void addDependency(const std::string &fileName);
+
+        void addProperty(const std::string &name, const std::string &value);
+
+        void addTileset(const int firstGid, const std::string &image,
+                        const int tileWidth, const int tileHeight,
+                        const int margin, const int spacing,
+                        const std::map<std::string, std::string> &props,
+                        const TileAnimationFrames &animations);
+
+        void addLayer(const LayerType type,
+                      const int offsetX, const int offsetY,
+                      const int width, const int height,
+                      const bool isFringe);
+
+        /**
+         * Sets tile of last added layer. Value is gid for tile layers and
+         * block type plus one for collision layers.
+         */
+        void setTile(const int x, const int y, const int value);
+
+        void addObject(const ObjectType type, const std::string &name,
+                       const int x, const int y,
+                       const int width, const int height);
+
+        void addWarpMap(const std::string &name);
+
+        bool save(const std::string &fileName,
+                  const unsigned int crc) const A_WARN_UNUSED;
+
+    private:
+        static void addString(std::vector<int> &data,
+                              const std::string &str);
+
+        std::vector<int> mDependencies;
+        std::vector<int> mProperties;
+        std::vector<int> mTilesets;
+        std::vector<int> mLayers;
+        std::vector<int> mObjects;
+        std::vector<int> mWarpMaps;
+        int mWidth;
+        int mHeight;
+        int mTileWidth;
+        int mTileHeight;
+        int mDependenciesCount;
+        int mPropertiesCount;
+        int mTilesetsCount;
+        int mLayersCount;
+        int mObjectsCount;
+        int mWarpMapsCount;
+        int mLayerType;
+        int mLayerStart;
+        int mLayerWidth;
+        int mLayerHeight;
+};
+
+/**
+ * Reads values from compiled map in order they were written.
+ */
+class CompiledMapData final
+{
+    public:
+        CompiledMapData(const void *const data, const int size);
+
+        A_DELETE_COPY(CompiledMapData)
+
+        /**
+         * Returns true if compiled map was made from the given map file
+         * contents by this client version.
+         */
+        bool readHeader(const unsigned int crc) A_WARN_UNUSED;
+
+        int readInt() A_WARN_UNUSED;
+
+        std::string readString() A_WARN_UNUSED;
+
+        /**
+         * Returns pointer to array of ints and skips it.
+         */
+        const int *readInts(const int count) A_WARN_UNUSED;
+
+        /**
+         * Returns pointer to array of bytes and skips it.
+         */
+        const unsigned char *readBytes(const int count) A_WARN_UNUSED;
+
+        /**
+         * Returns false if data ended before all values were read.
+         */
+        bool isValid() const A_WARN_UNUSED
+        { return mValid; }
+
+    private:
+        const int *mPtr;
+        const int *mEnd;
+        bool mValid;
+};
+
+#endif  // RESOURCES_MAPCOMPILER_H
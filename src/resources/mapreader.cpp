@@ -28,20 +28,24 @@
 #include "logger.h"
 #include "main.h"
 #include "map.h"
+#include "mapcache.h"
 #include "maplayer.h"
 #include "tileset.h"
 
 #include "resources/animation.h"
 #include "resources/image.h"
+#include "resources/mapcompiler.h"
 #include "resources/mapdb.h"
 #include "resources/resourcemanager.h"
 
-#include "utils/base64.h"
 #include "utils/gettext.h"
+#include "utils/mappedfile.h"
 
 #include <iostream>
 #include <zlib.h>
 
+#include <SDL_timer.h>
+
 #include "debug.h"
 
 static int inflateMemory(unsigned char *const in, const unsigned int inLength,
@@ -50,6 +54,19 @@ static int inflateMemory(unsigned char *const in, const unsigned int inLength,
 static int inflateMemory(unsigned char *const in, const unsigned int inLength,
                          unsigned char *&out);
 
+/**
+ * Time in milliseconds spent in each stage of the last map load.
+ */
+static struct MapLoadTimes final
+{
+    int file;
+    int xml;
+    int tilesets;
+    int layers;
+    int objects;
+    int finish;
+} loadTimes;
+
 static std::string resolveRelativePath(std::string base, std::string relative)
 {
     // Remove trailing "/", if present
@@ -182,56 +199,99 @@ Map *MapReader::readMap(const std::string &filename,
                         const std::string &realFilename)
 {
     logger->log("Attempting to read map %s", realFilename.c_str());
+    const unsigned int startTime = SDL_GetTicks();
+    memset(&loadTimes, 0, sizeof(loadTimes));
     // Load the file through resource manager
-    const ResourceManager *const resman = ResourceManager::getInstance();
-    int fileSize;
-    void *buffer = resman->loadFile(realFilename, fileSize);
+    int fileSize = 0;
+    void *buffer = mapCache
+        ? mapCache->takeFile(realFilename, fileSize) : nullptr;
+    if (!buffer)
+        buffer = ResourceManager::loadFile(realFilename, fileSize);
     Map *map = nullptr;
 
     if (!buffer)
         return createEmptyMap(filename, realFilename);
 
-    unsigned char *inflated;
-    unsigned int inflatedSize;
+    // Compiled map is named by checksum of map file
+    std::string compiledName;
+    unsigned int crc = 0;
+    if (config.getBoolValue("enableCompiledMaps"))
+    {
+        crc = static_cast<unsigned int>(crc32(0,
+            static_cast<const Bytef*>(buffer), fileSize));
+        compiledName = MapCompiler::getFileName(realFilename, crc);
+        map = readCompiledMap(compiledName, realFilename, crc);
+    }
 
-    if (realFilename.find(".gz", realFilename.length() - 3)
-        != std::string::npos)
+    if (map)
     {
-        // Inflate the gzipped map data
-        inflatedSize = inflateMemory(static_cast<unsigned char*>(buffer),
-            fileSize, inflated);
         free(buffer);
-
-        if (!inflated)
-        {
-            logger->log("Could not decompress map file (%s)",
-                        realFilename.c_str());
-            return nullptr;
-        }
     }
     else
     {
-        inflated = static_cast<unsigned char*>(buffer);
-        inflatedSize = fileSize;
-    }
+        unsigned char *inflated;
+        unsigned int inflatedSize;
 
-    XML::Document doc(reinterpret_cast<char*>(inflated), inflatedSize);
-    free(inflated);
-
-    XmlNodePtr node = doc.rootNode();
+        if (realFilename.find(".gz", realFilename.length() - 3)
+            != std::string::npos)
+        {
+            // Inflate the gzipped map data
+            inflatedSize = inflateMemory(static_cast<unsigned char*>(buffer),
+                fileSize, inflated);
+            free(buffer);
 
-    // Parse the inflated map data
-    if (node)
-    {
-        if (!xmlNameEqual(node, "map"))
-            logger->log("Error: Not a map file (%s)!", realFilename.c_str());
+            if (!inflated)
+            {
+                logger->log("Could not decompress map file (%s)",
+                            realFilename.c_str());
+                return nullptr;
+            }
+        }
         else
-            map = readMap(node, realFilename);
-    }
-    else
-    {
-        logger->log("Error while parsing map file (%s)!",
+        {
+            inflated = static_cast<unsigned char*>(buffer);
+            inflatedSize = fileSize;
+        }
+
+        unsigned int time = SDL_GetTicks();
+        loadTimes.file = static_cast<int>(time - startTime);
+        XML::Document doc(reinterpret_cast<char*>(inflated), inflatedSize);
+        free(inflated);
+        loadTimes.xml = static_cast<int>(SDL_GetTicks() - time);
+
+        XmlNodePtr node = doc.rootNode();
+
+        // Parse the inflated map data
+        if (node)
+        {
+            if (!xmlNameEqual(node, "map"))
+            {
+                logger->log("Error: Not a map file (%s)!",
                     realFilename.c_str());
+            }
+            else if (!compiledName.empty())
+            {
+                MapCompiler compiler(XML::getProperty(node, "width", 0),
+                    XML::getProperty(node, "height", 0),
+                    XML::getProperty(node, "tilewidth", -1),
+                    XML::getProperty(node, "tileheight", -1));
+                map = readMap(node, realFilename, &compiler);
+                if (map && compiler.save(compiledName, crc))
+                {
+                    logger->log("Compiled map saved: %s",
+                        compiledName.c_str());
+                }
+            }
+            else
+            {
+                map = readMap(node, realFilename);
+            }
+        }
+        else
+        {
+            logger->log("Error while parsing map file (%s)!",
+                        realFilename.c_str());
+        }
     }
 
     if (map)
@@ -241,12 +301,24 @@ Map *MapReader::readMap(const std::string &filename,
 
         if (map->getProperty("music").empty())
             updateMusic(map);
+
+        logger->log("Map loaded in %d ms (file: %d, xml: %d, tilesets: %d,"
+            " layers: %d, objects: %d, finish: %d)",
+            static_cast<int>(SDL_GetTicks() - startTime),
+            loadTimes.file, loadTimes.xml, loadTimes.tilesets,
+            loadTimes.layers, loadTimes.objects, loadTimes.finish);
     }
 
     return map;
 }
 
 Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
+{
+    return readMap(node, path, nullptr);
+}
+
+Map *MapReader::readMap(XmlNodePtr node, const std::string &path,
+                        MapCompiler *const compiler)
 {
     if (!node)
         return nullptr;
@@ -259,10 +331,6 @@ Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
     const int tilew = XML::getProperty(node, "tilewidth", -1);
     const int tileh = XML::getProperty(node, "tileheight", -1);
 
-    const bool showWarps = config.getBoolValue("warpParticle");
-    const std::string warpPath = paths.getStringValue("particles")
-        .append(paths.getStringValue("portalEffectFile"));
-
     if (tilew < 0 || tileh < 0)
     {
         logger->log("MapReader: Warning: "
@@ -271,39 +339,31 @@ Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
         return nullptr;
     }
 
-    Map *const map = new Map(w, h, tilew, tileh);
-
-    const std::string fileName = path.substr(path.rfind("/") + 1);
-    map->setProperty("shortName", fileName);
-    ResourceManager *const resman = ResourceManager::getInstance();
-
-#ifdef USE_OPENGL
-    if (graphicsManager.getUseAtlases())
-    {
-        const MapDB::MapInfo *const info = MapDB::getMapAtlas(fileName);
-        if (info)
-        {
-            map->setAtlas(resman->getAtlas(
-                info->atlas, *info->files));
-        }
-    }
-#endif
+    Map *const map = createMap(w, h, tilew, tileh, path);
 
+    unsigned int time = SDL_GetTicks();
     for_each_xml_child_node(childNode, node)
     {
         if (xmlNameEqual(childNode, "tileset"))
         {
-            Tileset *const tileset = readTileset(childNode, pathDir, map);
+            Tileset *const tileset = readTileset(childNode, pathDir, map,
+                compiler);
             if (tileset)
                 map->addTileset(tileset);
+            const unsigned int now = SDL_GetTicks();
+            loadTimes.tilesets += static_cast<int>(now - time);
+            time = now;
         }
         else if (xmlNameEqual(childNode, "layer"))
         {
-            readLayer(childNode, map);
+            readLayer(childNode, map, compiler);
+            const unsigned int now = SDL_GetTicks();
+            loadTimes.layers += static_cast<int>(now - time);
+            time = now;
         }
         else if (xmlNameEqual(childNode, "properties"))
         {
-            readProperties(childNode, map);
+            readProperties(childNode, map, compiler);
             map->setVersion(atoi(map->getProperty(
                 "manaplus version").c_str()));
         }
@@ -353,20 +413,26 @@ Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
                             continue;
                         }
 
-                        map->addParticleEffect(objName,
-                                               objX + offsetX,
-                                               objY + offsetY,
-                                               objW, objH);
+                        addObject(map, compiler, MapCompiler::OBJECT_PARTICLE,
+                            objName, objX + offsetX, objY + offsetY,
+                            objW, objH);
                     }
                     else if (objType == "WARP")
                     {
-                        if (showWarps)
+                        addObject(map, compiler, MapCompiler::OBJECT_WARP,
+                            objName, objX, objY, objW, objH);
+                        for_each_xml_child_node(propsNode, objectNode)
                         {
-                            map->addParticleEffect(warpPath,
-                                objX, objY, objW, objH);
+                            if (!xmlNameEqual(propsNode, "properties"))
+                                continue;
+                            Properties props;
+                            readProperties(propsNode, &props, nullptr);
+                            const std::string destMap
+                                = props.getProperty("dest_map");
+                            map->addWarpMap(destMap);
+                            if (compiler && !destMap.empty())
+                                compiler->addWarpMap(destMap);
                         }
-                        map->addPortal(objName, MapItem::PORTAL,
-                                       objX, objY, objW, objH);
                     }
                     else if (objType == "SPAWN")
                     {
@@ -375,8 +441,8 @@ Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
                     }
                     else if (objType == "MUSIC")
                     {
-                        map->addRange(objName, MapItem::MUSIC,
-                            objX, objY, objW, objH);
+                        addObject(map, compiler, MapCompiler::OBJECT_MUSIC,
+                            objName, objX, objY, objW, objH);
                     }
                     else
                     {
@@ -384,18 +450,85 @@ Map *MapReader::readMap(XmlNodePtr node, const std::string &path)
                     }
                 }
             }
+            const unsigned int now = SDL_GetTicks();
+            loadTimes.objects += static_cast<int>(now - time);
+            time = now;
+        }
+    }
+
+    finishMap(map);
+    loadTimes.finish = static_cast<int>(SDL_GetTicks() - time);
+    return map;
+}
+
+Map *MapReader::createMap(const int width, const int height,
+                          const int tileWidth, const int tileHeight,
+                          const std::string &path)
+{
+    Map *const map = new Map(width, height, tileWidth, tileHeight);
+
+    const std::string fileName = path.substr(path.rfind("/") + 1);
+    map->setProperty("shortName", fileName);
+
+#ifdef USE_OPENGL
+    if (graphicsManager.getUseAtlases())
+    {
+        const MapDB::MapInfo *const info = MapDB::getMapAtlas(fileName);
+        if (info)
+        {
+            map->setAtlas(ResourceManager::getInstance()->getAtlas(
+                info->atlas, *info->files));
         }
     }
+#endif
 
+    return map;
+}
+
+void MapReader::finishMap(Map *const map)
+{
     map->initializeAmbientLayers();
     map->clearIndexedTilesets();
     map->setActorsFix(0, atoi(map->getProperty("actorsfix").c_str()));
     map->reduce();
-    map->setWalkLayer(resman->getWalkLayer(fileName, map));
-    return map;
+    map->setWalkLayer(ResourceManager::getInstance()->getWalkLayer(
+        map->getProperty("shortName"), map));
 }
 
-void MapReader::readProperties(const XmlNodePtr node, Properties *const props)
+void MapReader::addObject(Map *const map, MapCompiler *const compiler,
+                          const int type, const std::string &name,
+                          const int x, const int y,
+                          const int width, const int height)
+{
+    switch (type)
+    {
+        case MapCompiler::OBJECT_PARTICLE:
+            map->addParticleEffect(name, x, y, width, height);
+            break;
+        case MapCompiler::OBJECT_WARP:
+            if (config.getBoolValue("warpParticle"))
+            {
+                map->addParticleEffect(paths.getStringValue("particles")
+                    .append(paths.getStringValue("portalEffectFile")),
+                    x, y, width, height);
+            }
+            map->addPortal(name, MapItem::PORTAL, x, y, width, height);
+            break;
+        case MapCompiler::OBJECT_MUSIC:
+            map->addRange(name, MapItem::MUSIC, x, y, width, height);
+            break;
+        default:
+            return;
+    }
+    if (compiler)
+    {
+        compiler->addObject(static_cast<MapCompiler::ObjectType>(type),
+            name, x, y, width, height);
+    }
+}
+
+void MapReader::readProperties(const XmlNodePtr node, Properties *const props,
+                               MapCompiler *const compiler)
 {
     if (!node || !props)
         return;
@@ -410,64 +543,212 @@ void MapReader::readProperties(const XmlNodePtr node, Properties *const props)
         const std::string value = XML::getProperty(childNode, "value", "");
 
         if (!name.empty() && !value.empty())
+        {
             props->setProperty(name, value);
+            if (compiler)
+                compiler->addProperty(name, value);
+        }
+    }
+}
+
+static Map::BlockType getCollisionType(const Map *const map, const int gid)
+{
+    const Tileset * const set = map->getTilesetWithGid(gid);
+    if (!set)
+        return Map::BLOCKTYPE_NONE;
+
+    if (map->getVersion() >= 1)
+    {
+        switch (gid - set->getFirstGid())
+        {
+            case Map::COLLISION_EMPTY:
+                return Map::BLOCKTYPE_GROUND;
+            case Map::COLLISION_WALL:
+                return Map::BLOCKTYPE_WALL;
+            case Map::COLLISION_AIR:
+                return Map::BLOCKTYPE_AIR;
+            case Map::COLLISION_WATER:
+                return Map::BLOCKTYPE_WATER;
+            case Map::COLLISION_GROUNDTOP:
+                return Map::BLOCKTYPE_GROUNDTOP;
+            default:
+                return Map::BLOCKTYPE_NONE;
+        }
+    }
+    else
+    {
+        if (gid - set->getFirstGid() != 0)
+            return Map::BLOCKTYPE_WALL;
+        return Map::BLOCKTYPE_NONE;
     }
 }
 
 inline static void setTile(Map *const map, MapLayer *const layer,
+                           MapCompiler *const compiler,
                            const int x, const int y, const int gid)
 {
-    const Tileset * const set = map->getTilesetWithGid(gid);
     if (layer)
     {
         // Set regular tile on a layer
-        Image * const img = set ? set->get(gid - set->getFirstGid()) : nullptr;
-        layer->setTile(x, y, img);
+        layer->setTile(x, y, map->getImageWithGid(gid));
+        if (compiler)
+            compiler->setTile(x, y, gid);
     }
     else
     {
         // Set collision tile
-        if (set)
+        const Map::BlockType type = getCollisionType(map, gid);
+        map->blockTile(x, y, type);
+        if (compiler)
+            compiler->setTile(x, y, type + 1);
+    }
+}
+
+namespace
+{
+    // Size of decoded and inflated chunks of layer data
+    const int layerChunkSize = 16 * 1024;
+
+    // Values of base64 characters, 0xff for characters to skip
+    struct Base64Table final
+    {
+        Base64Table()
         {
-            if (map->getVersion() >= 1)
+            memset(values, 0xff, sizeof(values));
+            const char *const chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                "abcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int f = 0; f < 64; f ++)
+                values[static_cast<unsigned char>(chars[f])] = f;
+        }
+
+        unsigned char values[256];
+    } base64Table;
+
+    /**
+     * Sets tiles from layer data as it is decoded.
+     */
+    class LayerTiles final
+    {
+        public:
+            LayerTiles(Map *const map, MapLayer *const layer,
+                       MapCompiler *const compiler,
+                       int &x, int &y, const int w, const int h) :
+                mMap(map),
+                mLayer(layer),
+                mCompiler(compiler),
+                mX(x),
+                mY(y),
+                mW(w),
+                mH(h),
+                mBytes(0),
+                mGid(),
+                mHasAnimations(!map->getTileAnimations().empty())
+            {
+            }
+
+            A_DELETE_COPY(LayerTiles)
+
+            /**
+             * Returns false after last tile of layer was set.
+             */
+            bool add(const unsigned char *data, int len)
             {
-                switch (gid - set->getFirstGid())
+                while (len > 0)
                 {
-                    case Map::COLLISION_EMPTY:
-                        map->blockTile(x, y, Map::BLOCKTYPE_GROUND);
-                        break;
-                    case Map::COLLISION_WALL:
-                        map->blockTile(x, y, Map::BLOCKTYPE_WALL);
-                        break;
-                    case Map::COLLISION_AIR:
-                        map->blockTile(x, y, Map::BLOCKTYPE_AIR);
-                        break;
-                    case Map::COLLISION_WATER:
-                        map->blockTile(x, y, Map::BLOCKTYPE_WATER);
-                        break;
-                    case Map::COLLISION_GROUNDTOP:
-                        map->blockTile(x, y, Map::BLOCKTYPE_GROUNDTOP);
-                        break;
-                    default:
-                        break;
+                    mGid[mBytes ++] = *data ++;
+                    len --;
+                    if (mBytes < 4)
+                        continue;
+                    mBytes = 0;
+
+                    const int gid = mGid[0] | mGid[1] << 8
+                        | mGid[2] << 16 | mGid[3] << 24;
+                    setTile(mMap, mLayer, mCompiler, mX, mY, gid);
+                    if (mHasAnimations && mMap->isAnimatedGid(gid))
+                    {
+                        mMap->getAnimationForGid(gid)->addAffectedTile(
+                            mLayer, mX + mY * mW);
+                    }
+                    mX ++;
+                    if (mX == mW)
+                    {
+                        mX = 0;
+                        mY ++;
+                        // When we're done, don't crash on too much data
+                        if (mY == mH)
+                            return false;
+                    }
                 }
+                return true;
             }
-            else
+
+        private:
+            Map *mMap;
+            MapLayer *mLayer;
+            MapCompiler *mCompiler;
+            int &mX;
+            int &mY;
+            int mW;
+            int mH;
+            int mBytes;
+            unsigned char mGid[4];
+            bool mHasAnimations;
+    };
+
+    /**
+     * Decodes base64 text into buffer, skipping white space. Returns
+     * count of decoded bytes and moves text to first not decoded character.
+     */
+    int decodeBase64(const unsigned char *&text,
+                     unsigned char *const out, const int size)
+    {
+        const unsigned char *const values = base64Table.values;
+        const unsigned char *ptr = text;
+        int len = 0;
+        unsigned int bits = 0;
+        int count = 0;
+        // stop before out of space, chunks always end on whole groups
+        while (*ptr && *ptr != '=' && len <= size - 3)
+        {
+            const unsigned char value = values[*ptr ++];
+            if (value == 0xff)
+                continue;
+            bits = (bits << 6) | value;
+            count ++;
+            if (count == 4)
             {
-                if (gid - set->getFirstGid() != 0)
-                    map->blockTile(x, y, Map::BLOCKTYPE_WALL);
+                out[len ++] = static_cast<unsigned char>(bits >> 16);
+                out[len ++] = static_cast<unsigned char>(bits >> 8);
+                out[len ++] = static_cast<unsigned char>(bits);
+                bits = 0;
+                count = 0;
             }
         }
+        // partial group at end of data
+        if (count == 2)
+        {
+            out[len ++] = static_cast<unsigned char>(bits >> 4);
+        }
+        else if (count == 3)
+        {
+            out[len ++] = static_cast<unsigned char>(bits >> 10);
+            out[len ++] = static_cast<unsigned char>(bits >> 2);
+        }
+        if (*ptr == '=')
+            ptr += strlen(reinterpret_cast<const char*>(ptr));
+        text = ptr;
+        return len;
     }
-}
+}  // namespace
 
 bool MapReader::readBase64Layer(const XmlNodePtr childNode, Map *const map,
                                 MapLayer *const layer,
+                                MapCompiler *const compiler,
                                 const std::string &compression,
                                 int &x, int &y, const int w, const int h)
 {
-    if (!compression.empty() && compression != "gzip"
-        && compression != "zlib")
+    const bool compressed = compression == "gzip" || compression == "zlib";
+    if (!compression.empty() && !compressed)
     {
         logger->log1("Warning: only gzip and zlib layer"
             " compression supported!");
@@ -479,99 +760,69 @@ bool MapReader::readBase64Layer(const XmlNodePtr childNode, Map *const map,
     if (!dataChild)
         return true;
 
-    const int len = static_cast<int>(strlen(
-        reinterpret_cast<const char*>(dataChild->content)) + 1);
-    unsigned char *charData = new unsigned char[len + 1];
-    xmlChar *const xmlChars = xmlNodeGetContent(dataChild);
-    const char *charStart = reinterpret_cast<const char*>(xmlChars);
-    if (!charStart)
-    {
-        delete [] charData;
+    const unsigned char *text = dataChild->content;
+    if (!text)
         return false;
-    }
 
-    unsigned char *charIndex = charData;
-
-    while (*charStart)
+    // Decode and inflate by chunks, without copies of whole layer
+    LayerTiles tiles(map, layer, compiler, x, y, w, h);
+    unsigned char decoded[layerChunkSize];
+    if (!compressed)
     {
-        if (*charStart != ' ' && *charStart != '\t' &&
-            *charStart != '\n')
+        while (*text)
         {
-            *charIndex = *charStart;
-            charIndex++;
+            const int len = decodeBase64(text, decoded, layerChunkSize);
+            if (!len || !tiles.add(decoded, len))
+                break;
         }
-        charStart++;
+        return true;
     }
-    *charIndex = '\0';
-
-    int binLen;
-    unsigned char *binData = php3_base64_decode(charData,
-        static_cast<int>(strlen(reinterpret_cast<char*>(
-        charData))), &binLen);
 
-    delete [] charData;
-    xmlFree(xmlChars);
+    unsigned char inflated[layerChunkSize];
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.next_in = Z_NULL;
+    strm.avail_in = 0;
+    if (inflateInit2(&strm, 15 + 32) != Z_OK)
+    {
+        logger->log1("Error: Could not decompress layer!");
+        return false;
+    }
 
-    if (binData)
+    int ret = Z_OK;
+    bool done = false;
+    while (!done && ret != Z_STREAM_END)
     {
-        if (compression == "gzip" || compression == "zlib")
+        if (!strm.avail_in)
         {
-            // Inflate the gzipped layer data
-            unsigned char *inflated;
-            const unsigned int inflatedSize =
-                inflateMemory(binData, binLen, inflated);
-
-            free(binData);
-            binData = inflated;
-            binLen = inflatedSize;
-
-            if (!inflated)
-            {
-                logger->log1("Error: Could not decompress layer!");
-                return false;
-            }
+            const int len = decodeBase64(text, decoded, layerChunkSize);
+            if (!len)
+                break;
+            strm.next_in = decoded;
+            strm.avail_in = len;
         }
+        strm.next_out = inflated;
+        strm.avail_out = layerChunkSize;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            break;
+        done = !tiles.add(inflated, layerChunkSize - strm.avail_out);
+    }
+    inflateEnd(&strm);
 
-        std::map<int, TileAnimation*> &tileAnimations
-            = map->getTileAnimations();
-
-        const bool hasAnimations = !tileAnimations.empty();
-        for (int i = 0; i < binLen - 3; i += 4)
-        {
-            const int gid = binData[i] |
-                binData[i + 1] << 8 |
-                binData[i + 2] << 16 |
-                binData[i + 3] << 24;
-
-            setTile(map, layer, x, y, gid);
-
-            if (hasAnimations)
-            {
-                TileAnimationMapCIter it = tileAnimations.find(gid);
-                if (it != tileAnimations.end())
-                {
-                    TileAnimation *const ani = it->second;
-                    if (ani)
-                        ani->addAffectedTile(layer, x + y * w);
-                }
-            }
-            x++;
-            if (x == w)
-            {
-                x = 0; y++;
-
-                // When we're done, don't crash on too much data
-                if (y == h)
-                    break;
-            }
-        }
-        free(binData);
+    if (!done && ret != Z_STREAM_END)
+    {
+        logger->log1("Error: Could not decompress layer!");
+        return false;
     }
     return true;
 }
 
 bool MapReader::readCsvLayer(const XmlNodePtr childNode, Map *const map,
                              MapLayer *const layer,
+                             MapCompiler *const compiler,
                              int &x, int &y, const int w, const int h)
 {
     XmlNodePtr dataChild = childNode->xmlChildrenNode;
@@ -593,7 +844,7 @@ bool MapReader::readCsvLayer(const XmlNodePtr childNode, Map *const map,
             return false;
 
         const int gid = atoi(csv.substr(oldPos, pos - oldPos).c_str());
-        setTile(map, layer, x, y, gid);
+        setTile(map, layer, compiler, x, y, gid);
 
         x++;
         if (x == w)
@@ -611,7 +862,8 @@ bool MapReader::readCsvLayer(const XmlNodePtr childNode, Map *const map,
     return true;
 }
 
-void MapReader::readLayer(const XmlNodePtr node, Map *const map)
+void MapReader::readLayer(const XmlNodePtr node, Map *const map,
+                          MapCompiler *const compiler)
 {
     // Layers are not necessarily the same size as the map
     const int w = XML::getProperty(node, "width", map->getWidth());
@@ -661,6 +913,12 @@ void MapReader::readLayer(const XmlNodePtr node, Map *const map)
             layer = new MapLayer(offsetX, offsetY, w, h, isFringeLayer);
             map->addLayer(layer);
         }
+        if (compiler)
+        {
+            compiler->addLayer(isCollisionLayer ? MapCompiler::LAYER_COLLISION
+                : MapCompiler::LAYER_TILES, offsetX, offsetY, w, h,
+                isFringeLayer);
+        }
 
         const std::string encoding =
             XML::getProperty(childNode, "encoding", "");
@@ -669,7 +927,7 @@ void MapReader::readLayer(const XmlNodePtr node, Map *const map)
 
         if (encoding == "base64")
         {
-            if (readBase64Layer(childNode, map, layer,
+            if (readBase64Layer(childNode, map, layer, compiler,
                 compression, x, y, w, h))
             {
                 continue;
@@ -681,7 +939,7 @@ void MapReader::readLayer(const XmlNodePtr node, Map *const map)
         }
         else if (encoding == "csv")
         {
-            if (readCsvLayer(childNode, map, layer, x, y, w, h))
+            if (readCsvLayer(childNode, map, layer, compiler, x, y, w, h))
                 continue;
             else
                 return;
@@ -695,7 +953,7 @@ void MapReader::readLayer(const XmlNodePtr node, Map *const map)
                     continue;
 
                 const int gid = XML::getProperty(childNode2, "gid", -1);
-                setTile(map, layer, x, y, gid);
+                setTile(map, layer, compiler, x, y, gid);
 
                 x++;
                 if (x == w)
@@ -718,7 +976,7 @@ void MapReader::readLayer(const XmlNodePtr node, Map *const map)
 }
 
 Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
-                                Map *const map)
+                                Map *const map, MapCompiler *const compiler)
 {
     if (!map)
         return nullptr;
@@ -730,6 +988,8 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
     Tileset *set = nullptr;
     std::string pathDir(path);
     std::map<std::string, std::string> props;
+    std::string imagePath;
+    TileAnimationFrames animations;
 
     if (XmlHasProp(node, "source"))
     {
@@ -738,6 +998,8 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
 
         doc = new XML::Document(filename);
         node = doc->rootNode();
+        if (compiler)
+            compiler->addDependency(filename);
         if (!node)
         {
             delete doc;
@@ -765,8 +1027,8 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
             if (!source.empty())
             {
                 ResourceManager *const resman = ResourceManager::getInstance();
-                Image *const tilebmp = resman->getImage(
-                    resolveRelativePath(pathDir, source));
+                imagePath = resolveRelativePath(pathDir, source);
+                Image *const tilebmp = resman->getImage(imagePath);
 
                 if (tilebmp)
                 {
@@ -826,6 +1088,7 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
                     continue;
 
                 Animation *ani = new Animation;
+                AnimationFrames frames;
                 for (int i = 0; ; i++)
                 {
                     const std::string iStr(toString(i));
@@ -839,6 +1102,8 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
                     {
                         ani->addFrame(set->get(iFrame->second),
                             iDelay->second, 0, 0, 100);
+                        frames.push_back(std::make_pair(iFrame->second,
+                            iDelay->second));
                     }
                     else
                     {
@@ -849,6 +1114,7 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
                 if (ani->getLength() > 0)
                 {
                     map->addAnimation(tileGID, new TileAnimation(ani));
+                    animations[tileGID] = frames;
                 }
                 else
                 {
@@ -862,10 +1128,215 @@ Tileset *MapReader::readTileset(XmlNodePtr node, const std::string &path,
     delete doc;
 
     if (set)
+    {
         set->setProperties(props);
+        if (compiler)
+        {
+            compiler->addTileset(firstGid, imagePath, tw, th, margin,
+                spacing, props, animations);
+        }
+    }
     return set;
 }
 
+Map *MapReader::readCompiledMap(const std::string &fileName,
+                                const std::string &path,
+                                const unsigned int crc)
+{
+    MappedFile file;
+    if (!file.open(fileName))
+        return nullptr;
+
+    unsigned int time = SDL_GetTicks();
+    CompiledMapData data(file.getData(), file.getSize());
+    if (!data.readHeader(crc))
+    {
+        logger->log("Compiled map is outdated: %s", fileName.c_str());
+        return nullptr;
+    }
+
+    const int w = data.readInt();
+    const int h = data.readInt();
+    const int tilew = data.readInt();
+    const int tileh = data.readInt();
+
+    // external tilesets are checked, because map file can stay the same
+    const int dependencies = data.readInt();
+    for (int f = 0; f < dependencies && data.isValid(); f ++)
+    {
+        const std::string name = data.readString();
+        if (static_cast<unsigned int>(data.readInt())
+            != MapCompiler::getFileCrc(name))
+        {
+            logger->log("Compiled map is outdated: %s", fileName.c_str());
+            return nullptr;
+        }
+    }
+    if (!data.isValid() || w <= 0 || h <= 0 || tilew <= 0 || tileh <= 0)
+        return nullptr;
+
+    logger->log("Loading compiled map %s", fileName.c_str());
+    Map *const map = createMap(w, h, tilew, tileh, path);
+
+    const int properties = data.readInt();
+    for (int f = 0; f < properties && data.isValid(); f ++)
+    {
+        const std::string name = data.readString();
+        map->setProperty(name, data.readString());
+    }
+    map->setVersion(atoi(map->getProperty("manaplus version").c_str()));
+
+    ResourceManager *const resman = ResourceManager::getInstance();
+    const int tilesets = data.readInt();
+    for (int f = 0; f < tilesets && data.isValid(); f ++)
+    {
+        const int firstGid = data.readInt();
+        const std::string image = data.readString();
+        const int tw = data.readInt();
+        const int th = data.readInt();
+        const int margin = data.readInt();
+        const int spacing = data.readInt();
+        std::map<std::string, std::string> props;
+        const int propsCount = data.readInt();
+        for (int i = 0; i < propsCount && data.isValid(); i ++)
+        {
+            const std::string name = data.readString();
+            props[name] = data.readString();
+        }
+
+        Tileset *set = nullptr;
+        Image *const tilebmp = resman->getImage(image);
+        if (tilebmp)
+        {
+            set = new Tileset(tilebmp, tw, th, firstGid, margin, spacing);
+            tilebmp->decRef();
+        }
+        else
+        {
+            logger->log("Warning: Failed to load tileset (%s)",
+                image.c_str());
+        }
+
+        const int animations = data.readInt();
+        for (int i = 0; i < animations && data.isValid(); i ++)
+        {
+            const int gid = data.readInt();
+            const int frames = data.readInt();
+            Animation *const ani = new Animation;
+            for (int k = 0; k < frames && data.isValid(); k ++)
+            {
+                const int frame = data.readInt();
+                const int delay = data.readInt();
+                if (set)
+                    ani->addFrame(set->get(frame), delay, 0, 0, 100);
+            }
+            if (ani->getLength() > 0)
+                map->addAnimation(gid, new TileAnimation(ani));
+            else
+                delete ani;
+        }
+
+        if (set)
+        {
+            set->setProperties(props);
+            map->addTileset(set);
+        }
+    }
+    unsigned int now = SDL_GetTicks();
+    loadTimes.tilesets = static_cast<int>(now - time);
+    time = now;
+
+    const int layers = data.readInt();
+    for (int f = 0; f < layers && data.isValid(); f ++)
+    {
+        const int type = data.readInt();
+        const int offsetX = data.readInt();
+        const int offsetY = data.readInt();
+        const int lw = data.readInt();
+        const int lh = data.readInt();
+        const bool isFringe = data.readInt() != 0;
+        if (lw < 0 || lh < 0)
+            break;
+
+        if (type == MapCompiler::LAYER_COLLISION)
+        {
+            const unsigned char *const blocks = data.readBytes(lw * lh);
+            if (!blocks)
+                break;
+            for (int y = 0; y < lh; y ++)
+            {
+                for (int x = 0; x < lw; x ++)
+                {
+                    const int value = blocks[x + y * lw];
+                    if (value)
+                    {
+                        map->blockTile(x, y,
+                            static_cast<Map::BlockType>(value - 1));
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Gids are used straight from mapped file
+        const int *const gids = data.readInts(lw * lh);
+        if (!gids)
+            break;
+        map->indexTilesets();
+        MapLayer *const layer = new MapLayer(offsetX, offsetY,
+            lw, lh, isFringe);
+        map->addLayer(layer);
+        const bool hasAnimations = !map->getTileAnimations().empty();
+        for (int y = 0; y < lh; y ++)
+        {
+            for (int x = 0; x < lw; x ++)
+            {
+                const int gid = gids[x + y * lw];
+                layer->setTile(x, y, map->getImageWithGid(gid));
+                if (hasAnimations && map->isAnimatedGid(gid))
+                {
+                    map->getAnimationForGid(gid)->addAffectedTile(
+                        layer, x + y * lw);
+                }
+            }
+        }
+    }
+    now = SDL_GetTicks();
+    loadTimes.layers = static_cast<int>(now - time);
+    time = now;
+
+    const int objects = data.readInt();
+    for (int f = 0; f < objects && data.isValid(); f ++)
+    {
+        const int type = data.readInt();
+        const std::string name = data.readString();
+        const int x = data.readInt();
+        const int y = data.readInt();
+        const int objW = data.readInt();
+        const int objH = data.readInt();
+        if (data.isValid())
+            addObject(map, nullptr, type, name, x, y, objW, objH);
+    }
+
+    const int warpMaps = data.readInt();
+    for (int f = 0; f < warpMaps && data.isValid(); f ++)
+        map->addWarpMap(data.readString());
+    now = SDL_GetTicks();
+    loadTimes.objects = static_cast<int>(now - time);
+    time = now;
+
+    if (!data.isValid())
+    {
+        logger->log("Error: broken compiled map %s", fileName.c_str());
+        delete map;
+        return nullptr;
+    }
+
+    finishMap(map);
+    loadTimes.finish = static_cast<int>(SDL_GetTicks() - time);
+    return map;
+}
+
 Map *MapReader::createEmptyMap(const std::string &filename,
                                const std::string &realFilename)
 {
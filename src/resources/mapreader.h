@@ -28,6 +28,7 @@
 #include <string>
 
 class Map;
+class MapCompiler;
 class MapLayer;
 class Properties;
 class Resource;
@@ -57,6 +58,32 @@ class MapReader final
                                    A_WARN_UNUSED;
 
     private:
+        /**
+         * Reads an XML map, also passing everything read to compiler if it
+         * is set.
+         */
+        static Map *readMap(XmlNodePtr node, const std::string &path,
+                            MapCompiler *const compiler) A_WARN_UNUSED;
+
+        /**
+         * Reads a compiled map. Returns nullptr if compiled map is missing
+         * or was not made from map file with the given checksum.
+         */
+        static Map *readCompiledMap(const std::string &fileName,
+                                    const std::string &path,
+                                    const unsigned int crc) A_WARN_UNUSED;
+
+        static Map *createMap(const int width, const int height,
+                              const int tileWidth, const int tileHeight,
+                              const std::string &path) A_WARN_UNUSED;
+
+        static void finishMap(Map *const map);
+
+        static void addObject(Map *const map, MapCompiler *const compiler,
+                              const int type, const std::string &name,
+                              const int x, const int y,
+                              const int width, const int height);
+
         /**
          * Reads the properties element.
          *
@@ -65,27 +92,33 @@ class MapReader final
          *              be assigned.
          */
         static void readProperties(const XmlNodePtr node,
-                                   Properties *const props);
+                                   Properties *const props,
+                                   MapCompiler *const compiler);
 
         /**
          * Reads a map layer and adds it to the given map.
          */
-        static void readLayer(const XmlNodePtr node, Map *const map);
+        static void readLayer(const XmlNodePtr node, Map *const map,
+                              MapCompiler *const compiler);
 
         static bool readBase64Layer(const XmlNodePtr childNode, Map *const map,
                                     MapLayer *const layer,
+                                    MapCompiler *const compiler,
                                     const std::string &compression,
                                     int &x, int &y, const int w, const int h);
 
         static bool readCsvLayer(const XmlNodePtr childNode, Map *const map,
                                  MapLayer *const layer,
+                                 MapCompiler *const compiler,
                                  int &x, int &y, const int w, const int h);
 
         /**
          * Reads a tile set.
          */
         static Tileset *readTileset(XmlNodePtr node, const std::string &path,
-                                    Map *const map) A_WARN_UNUSED;
+                                    Map *const map,
+                                    MapCompiler *const compiler)
+                                    A_WARN_UNUSED;
 
         static void updateMusic(Map *const map);
 };
@@ -25,6 +25,7 @@
 #ifdef USE_OPENGL
 
 #include "client.h"
+#include "framebudget.h"
 #include "game.h"
 #include "graphicsmanager.h"
 #include "logger.h"
@@ -206,6 +207,7 @@ Image *OpenGLImageHelper::glLoad(SDL_Surface *tmpImage,
         || amask != tmpImage->format->Amask)
     {
         oldImage = tmpImage;
+        FrameBudget::count(FrameBudget::COUNTER_SURFACES);
         tmpImage = SDL_CreateRGBSurface(SDL_SWSURFACE, realWidth, realHeight,
             32, rmask, gmask, bmask, amask);
 
@@ -339,6 +341,7 @@ SDL_Surface *OpenGLImageHelper::create32BitSurface(int width, int height) const
     width = powerOfTwo(width);
     height = powerOfTwo(height);
 
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     return SDL_CreateRGBSurface(SDL_SWSURFACE,
         width, height, 32, rmask, gmask, bmask, amask);
 }
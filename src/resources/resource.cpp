@@ -29,6 +29,8 @@
 
 #include "debug.h"
 
+unsigned int Resource::mLastId = 0;
+
 Resource::~Resource()
 {
 }
@@ -44,6 +44,7 @@ class Resource
         Resource() :
             mIdPath(),
             mSource(),
+            mId(++mLastId),
             mTimeStamp(0),
             mProtected(false),
 #ifdef DEBUG_DUMP_LEAKS
@@ -77,6 +78,13 @@ class Resource
         const std::string &getIdPath() const A_WARN_UNUSED
         { return mIdPath; }
 
+        /**
+         * Returns id of this resource. Ids are never reused, unlike
+         * addresses of deleted resources.
+         */
+        unsigned int getId() const A_WARN_UNUSED
+        { return mId; }
+
         /**
          * Return refCount for this resource.
          */
@@ -113,6 +121,9 @@ class Resource
         std::string mSource;
 
     private:
+        static unsigned int mLastId;
+
+        unsigned int mId;
         time_t mTimeStamp;   /**< Time at which the resource was orphaned. */
         bool mProtected;
         unsigned mRefCount;  /**< Reference count. */
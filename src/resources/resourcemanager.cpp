@@ -25,6 +25,7 @@
 #include "animationdelayload.h"
 #include "client.h"
 #include "configuration.h"
+#include "framebudget.h"
 #include "logger.h"
 #include "map.h"
 #include "navigationmanager.h"
@@ -40,6 +41,7 @@
 #include "resources/soundeffect.h"
 #include "resources/spritedef.h"
 
+#include "utils/archiveindex.h"
 #include "utils/mkdir.h"
 #include "utils/physfsrwops.h"
 
@@ -511,7 +513,10 @@ Resource *ResourceManager::get(const std::string &idPath, const generator fun,
     Resource *resource = getFromCache(idPath);
     if (resource)
         return resource;
-    resource = fun(data);
+    {
+        BUDGET_BLOCK(ZONE_RESOURCES)
+        resource = fun(data);
+    }
 
     if (resource)
     {
@@ -525,7 +530,11 @@ Resource *ResourceManager::get(const std::string &idPath, const generator fun,
         logger->log("Error loaging image: " + idPath);
     }
 #else
-    Resource *resource = fun(data);
+    Resource *resource = nullptr;
+    {
+        BUDGET_BLOCK(ZONE_RESOURCES)
+        resource = fun(data);
+    }
 
     if (resource)
     {
@@ -922,6 +931,14 @@ void ResourceManager::deleteInstance()
 
 void *ResourceManager::loadFile(const std::string &fileName, int &fileSize)
 {
+    void *const data = archiveIndex.loadFile(fileName, fileSize);
+    if (data)
+    {
+        logger->log("Loaded %s/%s", archiveIndex.getRealDir(fileName),
+                    fileName.c_str());
+        return data;
+    }
+
     // Attempt to open the specified file using PhysicsFS
     PHYSFS_file *const file = PhysFs::openRead(fileName.c_str());
 
@@ -1098,27 +1115,15 @@ Image *ResourceManager::getRescaled(Image *const image,
 void ResourceManager::delayedLoad()
 {
     BLOCK_START("ResourceManager::delayedLoad")
-    static int loadTime = 0;
-    if (loadTime < cur_time)
+    // called by frame scheduler, which also postpones next call
+    // if loading was slow
+    const DelayedAnimIter it = mDelayedAnimations.begin();
+    if (it != mDelayedAnimations.end())
     {
-        loadTime = tick_time;
-
-        int k = 0;
-        DelayedAnimIter it = mDelayedAnimations.begin();
-        const DelayedAnimIter it_end = mDelayedAnimations.end();
-        while (it != it_end && k < 1)
-        {
-            (*it)->load();
-            AnimationDelayLoad *tmp = *it;
-            it = mDelayedAnimations.erase(it);
-            delete tmp;
-            k ++;
-        }
-        const int time2 = tick_time;
-        if (time2 > loadTime)
-            loadTime = time2 + (time2 - loadTime) * 2 + 10;
-        else
-            loadTime = time2 + 3;
+        AnimationDelayLoad *const tmp = *it;
+        mDelayedAnimations.erase(it);
+        tmp->load();
+        delete tmp;
     }
     BLOCK_END("ResourceManager::delayedLoad")
 }
@@ -26,6 +26,7 @@
 #include "resources/resourcemanager.h"
 
 #include "client.h"
+#include "framebudget.h"
 #include "logger.h"
 #include "main.h"
 
@@ -319,6 +320,7 @@ SDL_Surface *SDLImageHelper::create32BitSurface(int width, int height) const
     const int amask = 0xff000000;
 #endif
 
+    FrameBudget::count(FrameBudget::COUNTER_SURFACES);
     return SDL_CreateRGBSurface(SDL_SWSURFACE,
         width, height, 32, rmask, gmask, bmask, amask);
 }
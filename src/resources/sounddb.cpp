@@ -23,6 +23,9 @@
 #include "client.h"
 #include "logger.h"
 #include "notifymanager.h"
+#include "soundmanager.h"
+
+#include "resources/soundinfo.h"
 
 #include "utils/xml.h"
 
@@ -57,6 +60,8 @@ void SoundDB::load()
             {
                 const std::string value = XML::getProperty(node, "value", "");
                 mSounds[id] = value;
+                if (!value.empty())
+                    soundManager.loadSfx(SoundInfo(value, 0));
             }
         }
     }
@@ -59,11 +59,11 @@ class SoundEffect final : public Resource
          * @param volume    Sample playback volume.
          * @param channel   Sample playback channel.
          *
-         * @return <code>true</code> if the playback started properly
-         *         <code>false</code> otherwise.
+         * @return channel where sample is played, or -1 if the playback
+         *         failed.
          */
-        bool play(const int loops, const int volume,
-                  const int channel = -1) const;
+        int play(const int loops, const int volume,
+                 const int channel = -1) const;
 
     protected:
         /**
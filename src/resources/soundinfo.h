@@ -30,12 +30,15 @@ struct SoundInfo final
 {
     SoundInfo(const std::string &sound0, const int delay0) :
         sound(sound0),
-        delay(delay0)
+        delay(delay0),
+        handle(-1)
     {
     }
 
     std::string sound;
     int delay;
+    /** Sound effect handle, set by sound manager on first use. */
+    mutable int handle;
 };
 
 typedef std::vector<SoundInfo> SoundInfoVect;
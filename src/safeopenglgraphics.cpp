@@ -26,6 +26,7 @@
 #include "safeopenglgraphics.h"
 
 #include "configuration.h"
+#include "framebudget.h"
 #include "graphicsmanager.h"
 #include "graphicsvertexes.h"
 #include "logger.h"
@@ -593,6 +594,7 @@ void SafeOpenGLGraphics::bindTexture(const GLenum target, const GLuint texture)
     if (mLastImage != texture)
     {
         mLastImage = texture;
+        FrameBudget::count(FrameBudget::COUNTER_TEXTURE_BINDS);
         glBindTexture(target, texture);
     }
 }
@@ -0,0 +1,330 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screenshotwriter.h"
+
+#include "client.h"
+#include "configuration.h"
+#include "graphics.h"
+#include "logger.h"
+
+#include "gui/widgets/chattab.h"
+
+#include "resources/imagewriter.h"
+
+#include "utils/gettext.h"
+#include "utils/mkdir.h"
+#include "utils/physfstools.h"
+#include "utils/stringutils.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include <dirent.h>
+
+#include "debug.h"
+
+ScreenshotWriter *screenshotWriter = nullptr;
+
+// frames waiting for encoder, new frames are skipped after it
+static const int maxQueuedFrames = 16;
+
+ScreenshotWriter::ScreenshotWriter() :
+    mQueue(),
+    mResults(),
+    mDirectory(Client::getScreenshotDirectory()),
+    mAppName(branding.getValue("appName", "ManaPlus")),
+    mMutex(SDL_CreateMutex()),
+    mCond(SDL_CreateCond()),
+    mThread(nullptr),
+    mCompression(config.getIntValue("screenshotCompression")),
+    mScreenshotNumber(-1),
+    mCaptureNumber(-1),
+    mCaptureStep(0),
+    mCaptureFrame(0),
+    mCaptureSaved(0),
+    mCaptureDropped(0),
+    mFramesQueued(0),
+    mCaptureRaw(false),
+    mRunning(true)
+{
+    if (mkdir_r(mDirectory.c_str()) != 0)
+    {
+        logger->log("Directory %s doesn't exist and can't be created! "
+                    "Setting screenshot directory to home.",
+                    mDirectory.c_str());
+        mDirectory = std::string(PhysFs::getUserDir());
+    }
+
+    if (mMutex && mCond)
+        mThread = SDL_CreateThread(writerThread, this);
+    if (!mThread)
+        logger->log1("Warning: screenshots will be written synchronously.");
+}
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+    if (mThread)
+    {
+        SDL_mutexP(mMutex);
+        mRunning = false;
+        SDL_CondSignal(mCond);
+        SDL_mutexV(mMutex);
+        SDL_WaitThread(mThread, nullptr);
+        mThread = nullptr;
+    }
+    logic();
+    if (mCond)
+        SDL_DestroyCond(mCond);
+    if (mMutex)
+        SDL_DestroyMutex(mMutex);
+}
+
+int ScreenshotWriter::writerThread(void *ptr)
+{
+    ScreenshotWriter *const writer = static_cast<ScreenshotWriter*>(ptr);
+    if (!writer)
+        return 0;
+
+    SDL_mutexP(writer->mMutex);
+    while (writer->mRunning || !writer->mQueue.empty())
+    {
+        if (writer->mQueue.empty())
+        {
+            SDL_CondWait(writer->mCond, writer->mMutex);
+            continue;
+        }
+
+        const Job job = writer->mQueue.front();
+        writer->mQueue.pop_front();
+        SDL_mutexV(writer->mMutex);
+
+        writer->write(job);
+
+        SDL_mutexP(writer->mMutex);
+        if (job.type != JOB_SCREENSHOT)
+            writer->mFramesQueued --;
+    }
+    SDL_mutexV(writer->mMutex);
+    return 0;
+}
+
+void ScreenshotWriter::write(const Job &job)
+{
+    // logger is not thread safe, so result is reported from logic
+    std::string error;
+    bool success;
+    if (job.type == JOB_FRAME_RAW)
+    {
+        success = ImageWriter::writePPM(job.surface, job.fileName, error);
+    }
+    else
+    {
+        success = ImageWriter::writePNG(job.surface, job.fileName,
+            mCompression, error);
+    }
+    SDL_FreeSurface(job.surface);
+
+    if (job.type == JOB_SCREENSHOT || !success)
+    {
+        if (mMutex)
+            SDL_mutexP(mMutex);
+        mResults.push_back(Result(job.shortName, error, success,
+            job.type != JOB_SCREENSHOT));
+        if (mMutex)
+            SDL_mutexV(mMutex);
+    }
+}
+
+void ScreenshotWriter::queue(const Job &job)
+{
+    if (!mThread)
+    {
+        write(job);
+        logic();
+        return;
+    }
+
+    SDL_mutexP(mMutex);
+    mQueue.push_back(job);
+    if (job.type != JOB_SCREENSHOT)
+        mFramesQueued ++;
+    SDL_CondSignal(mCond);
+    SDL_mutexV(mMutex);
+}
+
+int ScreenshotWriter::findFreeNumber(const std::string &prefix) const
+{
+    int number = 0;
+    DIR *const dir = opendir(mDirectory.c_str());
+    if (!dir)
+        return 1;
+
+    const size_t sz = prefix.size();
+    for (const dirent *entry = readdir(dir); entry; entry = readdir(dir))
+    {
+        const char *const name = entry->d_name;
+        if (!strncmp(name, prefix.c_str(), sz))
+        {
+            const int num = atoi(name + sz);
+            if (num > number)
+                number = num;
+        }
+    }
+    closedir(dir);
+    return number + 1;
+}
+
+void ScreenshotWriter::save(SDL_Surface *const screenshot)
+{
+    if (!screenshot)
+        return;
+
+    // directory is scanned once, later names are only counted
+    const std::string prefix = mAppName + "_Screenshot_";
+    if (mScreenshotNumber < 0)
+        mScreenshotNumber = findFreeNumber(prefix);
+    const std::string shortName = strprintf("%s%d.png",
+        prefix.c_str(), mScreenshotNumber);
+    mScreenshotNumber ++;
+
+    queue(Job(screenshot, std::string(mDirectory).append("/").append(
+        shortName), shortName, JOB_SCREENSHOT));
+}
+
+void ScreenshotWriter::startCapture(const int frameStep, const bool raw)
+{
+    stopCapture();
+    if (frameStep <= 0)
+        return;
+
+    const std::string prefix = mAppName + "_Capture_";
+    if (mCaptureNumber < 0)
+        mCaptureNumber = findFreeNumber(prefix);
+    else
+        mCaptureNumber ++;
+    mCaptureStep = frameStep;
+    mCaptureRaw = raw;
+    mCaptureFrame = 0;
+    mCaptureSaved = 0;
+    mCaptureDropped = 0;
+    logger->log("Frame capture started: %s%d", prefix.c_str(),
+        mCaptureNumber);
+}
+
+void ScreenshotWriter::stopCapture()
+{
+    if (!mCaptureStep)
+        return;
+
+    mCaptureStep = 0;
+    logger->log("Frame capture stopped, %d frames saved, %d skipped",
+        mCaptureSaved, mCaptureDropped);
+    if (localChatTab)
+    {
+        // TRANSLATORS: frame capture message
+        localChatTab->chatLog(strprintf(_("Frame capture stopped, "
+            "%d frames saved, %d skipped."), mCaptureSaved,
+            mCaptureDropped), BY_SERVER);
+    }
+}
+
+void ScreenshotWriter::captureFrame()
+{
+    if (!mCaptureStep || !mainGraphics)
+        return;
+
+    const int frame = mCaptureFrame ++;
+    if (frame % mCaptureStep)
+        return;
+
+    if (mThread)
+    {
+        SDL_mutexP(mMutex);
+        const bool full = mFramesQueued >= maxQueuedFrames;
+        SDL_mutexV(mMutex);
+        if (full)
+        {
+            mCaptureDropped ++;
+            return;
+        }
+    }
+
+    SDL_Surface *const surface = mainGraphics->getScreenshot();
+    if (!surface)
+    {
+        mCaptureDropped ++;
+        return;
+    }
+
+    const std::string shortName = strprintf("%s_Capture_%d_%06d.%s",
+        mAppName.c_str(), mCaptureNumber, frame,
+        mCaptureRaw ? "ppm" : "png");
+    queue(Job(surface, std::string(mDirectory).append("/").append(
+        shortName), shortName, mCaptureRaw ? JOB_FRAME_RAW : JOB_FRAME_PNG));
+    mCaptureSaved ++;
+}
+
+void ScreenshotWriter::logic()
+{
+    if (mMutex)
+        SDL_mutexP(mMutex);
+    if (mResults.empty())
+    {
+        if (mMutex)
+            SDL_mutexV(mMutex);
+        return;
+    }
+    std::list<Result> results;
+    results.swap(mResults);
+    if (mMutex)
+        SDL_mutexV(mMutex);
+
+    FOR_EACH (std::list<Result>::const_iterator, it, results)
+    {
+        const Result &result = *it;
+        if (result.success)
+        {
+            if (localChatTab)
+            {
+                // TRANSLATORS: save file message
+                localChatTab->chatLog(strprintf(_("Screenshot saved as %s"),
+                    result.shortName.c_str()), BY_SERVER);
+            }
+            continue;
+        }
+
+        if (!result.error.empty())
+            logger->log1(result.error.c_str());
+        logger->log("Error: could not save screenshot %s.",
+            result.shortName.c_str());
+        if (result.frame)
+        {
+            // no reason to fill disk with failed frames
+            stopCapture();
+        }
+        else if (localChatTab)
+        {
+            // TRANSLATORS: save file message
+            localChatTab->chatLog(_("Saving screenshot failed!"),
+                BY_SERVER);
+        }
+    }
+}
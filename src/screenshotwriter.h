@@ -0,0 +1,150 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCREENSHOTWRITER_H
+#define SCREENSHOTWRITER_H
+
+#include <list>
+#include <string>
+
+#include "localconsts.h"
+
+struct SDL_cond;
+struct SDL_mutex;
+struct SDL_Surface;
+struct SDL_Thread;
+
+/**
+ * Saves screenshots and captured frames in background thread, so drawing
+ * waits only for copy of screen.
+ */
+class ScreenshotWriter final
+{
+    public:
+        ScreenshotWriter();
+
+        A_DELETE_COPY(ScreenshotWriter)
+
+        /**
+         * Waits until all queued images are written.
+         */
+        ~ScreenshotWriter();
+
+        /**
+         * Queues screenshot for saving. Takes ownership of surface.
+         */
+        void save(SDL_Surface *const screenshot);
+
+        /**
+         * Starts saving every frameStep drawn frame as png or ppm file.
+         */
+        void startCapture(const int frameStep, const bool raw);
+
+        void stopCapture();
+
+        bool isCapturing() const A_WARN_UNUSED
+        { return mCaptureStep > 0; }
+
+        /**
+         * Called after each drawn frame.
+         */
+        void captureFrame();
+
+        /**
+         * Reports written screenshots. Called from main thread.
+         */
+        void logic();
+
+    private:
+        enum JobType
+        {
+            JOB_SCREENSHOT = 0,
+            JOB_FRAME_PNG,
+            JOB_FRAME_RAW
+        };
+
+        struct Job final
+        {
+            Job(SDL_Surface *const surface0, const std::string &fileName0,
+                const std::string &shortName0, const JobType type0) :
+                surface(surface0),
+                fileName(fileName0),
+                shortName(shortName0),
+                type(type0)
+            {
+            }
+
+            SDL_Surface *surface;
+            std::string fileName;
+            std::string shortName;
+            JobType type;
+        };
+
+        struct Result final
+        {
+            Result(const std::string &shortName0, const std::string &error0,
+                   const bool success0, const bool frame0) :
+                shortName(shortName0),
+                error(error0),
+                success(success0),
+                frame(frame0)
+            {
+            }
+
+            std::string shortName;
+            std::string error;
+            bool success;
+            bool frame;
+        };
+
+        static int writerThread(void *ptr);
+
+        void write(const Job &job);
+
+        void queue(const Job &job);
+
+        /**
+         * Returns number after last file with given prefix in screenshot
+         * directory.
+         */
+        int findFreeNumber(const std::string &prefix) const A_WARN_UNUSED;
+
+        std::list<Job> mQueue;
+        std::list<Result> mResults;
+        std::string mDirectory;
+        std::string mAppName;
+        SDL_mutex *mMutex;
+        SDL_cond *mCond;
+        SDL_Thread *mThread;
+        int mCompression;
+        int mScreenshotNumber;
+        int mCaptureNumber;
+        int mCaptureStep;
+        int mCaptureFrame;
+        int mCaptureSaved;
+        int mCaptureDropped;
+        int mFramesQueued;
+        bool mCaptureRaw;
+        bool mRunning;
+};
+
+extern ScreenshotWriter *screenshotWriter;
+
+#endif  // SCREENSHOTWRITER_H
@@ -28,11 +28,18 @@
 #include "resources/sdlmusic.h"
 #include "resources/resourcemanager.h"
 #include "resources/soundeffect.h"
+#include "resources/soundinfo.h"
 
 #include <SDL.h>
 
 #include "debug.h"
 
+static const int sfxChannels = 16;
+// same sound started in this time (ms) is played once
+static const unsigned int sfxCoalesceTime = 30;
+// max channels playing same sound at once
+static const int maxSfxVoices = 3;
+
 /**
  * This will be set to true, when a music can be freed after a fade out
  * Currently used by fadeOutCallBack()
@@ -59,7 +66,13 @@ SoundManager::SoundManager():
     mPlayGui(false),
     mPlayMusic(false),
     mFadeoutMusic(true),
-    mGuiChannel(-1)
+    mGuiChannel(-1),
+    mSfx(),
+    mSfxHandles(),
+    mChannels(sfxChannels),
+    mSfxPlayed(0),
+    mSfxCoalesced(0),
+    mSfxDropped(0)
 {
     // This set up our callback function used to
     // handle fade outs endings.
@@ -150,7 +163,7 @@ void SoundManager::init()
         logger->log("Fallback to stereo audio");
     }
 
-    Mix_AllocateChannels(16);
+    Mix_AllocateChannels(sfxChannels);
     Mix_VolumeMusic(mMusicVolume);
     Mix_Volume(-1, mSfxVolume);
 
@@ -337,39 +350,172 @@ void SoundManager::logic()
     BLOCK_END("SoundManager::logic")
 }
 
-void SoundManager::playSfx(const std::string &path,
-                           const int x, const int y) const
+int SoundManager::getSfxHandle(const std::string &path)
 {
-    if (!mInstalled || path.empty() || !mPlayBattle)
-        return;
-
     std::string tmpPath;
     if (!path.compare(0, 4, "sfx/"))
         tmpPath = path;
     else
         tmpPath = paths.getValue("sfx", "sfx/").append(path);
-    ResourceManager *const resman = ResourceManager::getInstance();
-    const SoundEffect *const sample = resman->getSoundEffect(tmpPath);
-    if (sample)
+
+    const std::map<std::string, int>::const_iterator it
+        = mSfxHandles.find(tmpPath);
+    if (it != mSfxHandles.end())
+        return it->second;
+
+    const int handle = static_cast<int>(mSfx.size());
+    mSfx.push_back(SfxSample(tmpPath));
+    mSfxHandles[tmpPath] = handle;
+    return handle;
+}
+
+const SoundEffect *SoundManager::getSample(const int handle)
+{
+    if (handle < 0 || handle >= static_cast<int>(mSfx.size()))
+        return nullptr;
+
+    SfxSample &sfx = mSfx[handle];
+    if (!sfx.sample && !sfx.failed)
+    {
+        // one reference is kept until sound is closed
+        sfx.sample = ResourceManager::getInstance()->getSoundEffect(
+            sfx.path);
+        sfx.failed = !sfx.sample;
+    }
+    return sfx.sample;
+}
+
+void SoundManager::releaseSamples()
+{
+    FOR_EACH (std::vector<SfxSample>::iterator, it, mSfx)
+    {
+        if ((*it).sample)
+        {
+            (*it).sample->decRef();
+            (*it).sample = nullptr;
+        }
+        (*it).failed = false;
+        (*it).lastChannel = -1;
+    }
+    mChannels.assign(sfxChannels, SfxChannel());
+}
+
+void SoundManager::loadSfx(const SoundInfo &sound)
+{
+    if (!mInstalled || sound.sound.empty())
+        return;
+
+    if (sound.handle < 0)
+        sound.handle = getSfxHandle(sound.sound);
+    if (!getSample(sound.handle))
+        logger->log("Cant preload sound: %s", sound.sound.c_str());
+}
+
+void SoundManager::playSfx(const std::string &path,
+                           const int x, const int y)
+{
+    if (!mInstalled || path.empty() || !mPlayBattle)
+        return;
+
+    playSfx(getSfxHandle(path), x, y);
+}
+
+void SoundManager::playSfx(const SoundInfo &sound, const int x, const int y)
+{
+    if (!mInstalled || sound.sound.empty() || !mPlayBattle)
+        return;
+
+    if (sound.handle < 0)
+        sound.handle = getSfxHandle(sound.sound);
+    playSfx(sound.handle, x, y);
+}
+
+void SoundManager::playSfx(const int handle, const int x, const int y)
+{
+    if (!mInstalled || !mPlayBattle)
+        return;
+
+    const SoundEffect *const sample = getSample(handle);
+    if (!sample)
+        return;
+
+    int vol = 120;
+    if (player_node && (x > 0 || y > 0))
+    {
+        int dx = player_node->getTileX() - x;
+        int dy = player_node->getTileY() - y;
+        if (dx < 0)
+            dx = -dx;
+        if (dy < 0)
+            dy = -dy;
+        const int dist = dx > dy ? dx : dy;
+        if (dist * 8 > vol)
+            return;
+
+        vol -= dist * 8;
+    }
+
+    SfxSample &sfx = mSfx[handle];
+    const unsigned int time = SDL_GetTicks();
+    if (sfx.lastChannel >= 0 && time - sfx.lastTime < sfxCoalesceTime
+        && mChannels[sfx.lastChannel].handle == handle
+        && Mix_Playing(sfx.lastChannel))
+    {
+        mSfxCoalesced ++;
+        return;
+    }
+
+    int voices = 0;
+    int channel = -1;
+    int quietChannel = -1;
+    for (int f = 0; f < sfxChannels; f ++)
     {
-        logger->log("SoundManager::playSfx() Playing: %s", path.c_str());
-        int vol = 120;
-        if (player_node && (x > 0 || y > 0))
+        if (f == mGuiChannel)
+            continue;
+        if (!Mix_Playing(f))
+        {
+            if (channel == -1)
+                channel = f;
+            continue;
+        }
+        if (mChannels[f].handle == handle)
+            voices ++;
+        if (quietChannel == -1
+            || mChannels[f].volume < mChannels[quietChannel].volume)
         {
-            int dx = player_node->getTileX() - x;
-            int dy = player_node->getTileY() - y;
-            if (dx < 0)
-                dx = -dx;
-            if (dy < 0)
-                dy = -dy;
-            const int dist = dx > dy ? dx : dy;
-            if (dist * 8 > vol)
-                return;
-
-            vol -= dist * 8;
+            quietChannel = f;
         }
-        sample->play(0, vol);
     }
+
+    if (voices >= maxSfxVoices)
+    {
+        mSfxDropped ++;
+        return;
+    }
+    if (channel == -1)
+    {
+        // all channels busy, replace most far sound if it is quieter
+        if (quietChannel == -1 || mChannels[quietChannel].volume >= vol)
+        {
+            mSfxDropped ++;
+            return;
+        }
+        Mix_HaltChannel(quietChannel);
+        channel = quietChannel;
+        mSfxDropped ++;
+    }
+
+    channel = sample->play(0, vol, channel);
+    if (channel < 0 || channel >= sfxChannels)
+    {
+        mSfxDropped ++;
+        return;
+    }
+    mChannels[channel].handle = handle;
+    mChannels[channel].volume = vol;
+    sfx.lastTime = time;
+    sfx.lastChannel = channel;
+    mSfxPlayed ++;
 }
 
 void SoundManager::playGuiSound(const std::string &name)
@@ -383,19 +529,16 @@ void SoundManager::playGuiSfx(const std::string &path)
     if (!mInstalled || path.empty() || !mPlayGui)
         return;
 
-    std::string tmpPath;
-    if (!path.compare(0, 4, "sfx/"))
-        tmpPath = path;
-    else
-        tmpPath = paths.getValue("sfx", "sfx/").append(path);
-    ResourceManager *const resman = ResourceManager::getInstance();
-    const SoundEffect *const sample = resman->getSoundEffect(tmpPath);
+    const SoundEffect *const sample = getSample(getSfxHandle(path));
     if (sample)
     {
-        logger->log("SoundManager::playGuiSfx() Playing: %s", path.c_str());
         const int ret = sample->play(0, 120, mGuiChannel);
         if (ret != -1)
+        {
             mGuiChannel = ret;
+            if (ret < sfxChannels)
+                mChannels[ret].handle = -1;
+        }
     }
 }
 
@@ -406,6 +549,8 @@ void SoundManager::close()
 
     haltMusic();
     logger->log1("SoundManager::close() Shutting down sound...");
+    Mix_HaltChannel(-1);
+    releaseSamples();
     Mix_CloseAudio();
 
     mInstalled = false;
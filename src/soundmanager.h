@@ -27,11 +27,16 @@
 
 #include "configlistener.h"
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "localconsts.h"
 
 class SDLMusic;
+class SoundEffect;
+
+struct SoundInfo;
 
 static const std::string SOUND_INFO = "soundinfo";
 static const std::string SOUND_ERROR = "sounderror";
@@ -112,13 +117,35 @@ class SoundManager final : public ConfigListener
 
         void setSfxVolume(const int volume);
 
+        /**
+         * Returns handle of sound effect. Handles stay valid until client
+         * exit, sample itself is loaded when first needed.
+         *
+         * @param path The resource path to the sound file.
+         */
+        int getSfxHandle(const std::string &path) A_WARN_UNUSED;
+
+        /**
+         * Resolves handle of sound and loads its sample.
+         */
+        void loadSfx(const SoundInfo &sound);
+
         /**
          * Plays an item.
          *
          * @param path The resource path to the sound file.
          */
         void playSfx(const std::string &path, const int x = 0,
-                     const int y = 0) const;
+                     const int y = 0);
+
+        void playSfx(const SoundInfo &sound, const int x, const int y);
+
+        /**
+         * Plays sound effect for event at tile x, y. Same sound played
+         * few ms ago is not played again, and sounds far from player give
+         * their channels to near ones when all channels are busy.
+         */
+        void playSfx(const int handle, const int x, const int y);
 
         /**
          * Plays an item for gui.
@@ -147,7 +174,54 @@ class SoundManager final : public ConfigListener
 
         void shutdown();
 
+        int getSfxPlayed() const A_WARN_UNUSED
+        { return mSfxPlayed; }
+
+        int getSfxCoalesced() const A_WARN_UNUSED
+        { return mSfxCoalesced; }
+
+        int getSfxDropped() const A_WARN_UNUSED
+        { return mSfxDropped; }
+
     private:
+        struct SfxSample final
+        {
+            explicit SfxSample(const std::string &path0) :
+                path(path0),
+                sample(nullptr),
+                lastTime(0),
+                lastChannel(-1),
+                failed(false)
+            {
+            }
+
+            std::string path;
+            SoundEffect *sample;
+            unsigned int lastTime;
+            int lastChannel;
+            bool failed;
+        };
+
+        struct SfxChannel final
+        {
+            SfxChannel() :
+                handle(-1),
+                volume(0)
+            {
+            }
+
+            int handle;
+            int volume;
+        };
+
+        /**
+         * Returns sample for handle, loading it if needed.
+         */
+        const SoundEffect *getSample(const int handle) A_WARN_UNUSED;
+
+        /** Frees samples, handles are kept. */
+        void releaseSamples();
+
         /** Logs various info about sound device. */
         void info() const;
 
@@ -172,6 +246,13 @@ class SoundManager final : public ConfigListener
         bool mPlayMusic;
         bool mFadeoutMusic;
         int mGuiChannel;
+
+        std::vector<SfxSample> mSfx;
+        std::map<std::string, int> mSfxHandles;
+        std::vector<SfxChannel> mChannels;
+        int mSfxPlayed;
+        int mSfxCoalesced;
+        int mSfxDropped;
 };
 
 extern SoundManager soundManager;
@@ -0,0 +1,174 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "soundmanager.h"
+
+#include "client.h"
+#include "configuration.h"
+#include "logger.h"
+
+#include "resources/resourcemanager.h"
+
+#include "utils/mkdir.h"
+#include "utils/stringutils.h"
+
+#include "gtest/gtest.h"
+
+#include <physfs.h>
+
+#include <SDL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "debug.h"
+
+namespace
+{
+    const int samplesCount = 17;
+
+    void putUInt16(std::string &str, const unsigned int value)
+    {
+        str.push_back(static_cast<char>(value & 0xff));
+        str.push_back(static_cast<char>((value >> 8) & 0xff));
+    }
+
+    void putUInt32(std::string &str, const unsigned int value)
+    {
+        putUInt16(str, value & 0xffff);
+        putUInt16(str, value >> 16);
+    }
+
+    // two seconds of 8 bit mono silence
+    void writeWav(const std::string &fileName)
+    {
+        const unsigned int rate = 11025;
+        const unsigned int size = rate * 2;
+        std::string data;
+        data.append("RIFF");
+        putUInt32(data, 36 + size);
+        data.append("WAVEfmt ");
+        putUInt32(data, 16);
+        putUInt16(data, 1);
+        putUInt16(data, 1);
+        putUInt32(data, rate);
+        putUInt32(data, rate);
+        putUInt16(data, 1);
+        putUInt16(data, 8);
+        data.append("data");
+        putUInt32(data, size);
+        data.append(size, static_cast<char>(0x80));
+
+        FILE *const file = fopen(fileName.c_str(), "wb");
+        ASSERT_TRUE(file != nullptr);
+        fwrite(data.c_str(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    std::string samplePath(const int n)
+    {
+        return strprintf("sfx/test%d.wav", n);
+    }
+
+    void initSoundTest()
+    {
+        PHYSFS_init("manaplus");
+        if (!logger)
+            logger = new Logger();
+        putenv(const_cast<char*>("SDL_AUDIODRIVER=dummy"));
+        SDL_Init(SDL_INIT_TIMER);
+
+        mkdir_r("/tmp/manaplustest/sound/sfx");
+        for (int f = 0; f < samplesCount; f ++)
+            writeWav("/tmp/manaplustest/sound/" + samplePath(f));
+        ResourceManager::getInstance()->addToSearchPath(
+            "/tmp/manaplustest/sound", false);
+
+        config.setValue("playBattleSound", true);
+        config.setValue("playGuiSound", false);
+        config.setValue("playMusic", false);
+        config.setValue("sfxVolume", 100);
+        config.setValue("musicVolume", 60);
+        config.setValue("audioFrequency", 22050);
+        config.setValue("audioChannels", 2);
+    }
+}  // namespace
+
+TEST(soundmanager, voices)
+{
+    Client::Options options;
+    Client client(options);
+    initSoundTest();
+
+    SoundManager manager;
+    manager.init();
+    ASSERT_EQ(0, manager.getSfxPlayed());
+
+    const int handle = manager.getSfxHandle(samplePath(0));
+    EXPECT_EQ(handle, manager.getSfxHandle(samplePath(0)));
+
+    // same event inside coalescing window is played once
+    manager.playSfx(handle, 0, 0);
+    manager.playSfx(handle, 0, 0);
+    manager.playSfx(handle, 0, 0);
+    EXPECT_EQ(1, manager.getSfxPlayed());
+    EXPECT_EQ(2, manager.getSfxCoalesced());
+    EXPECT_EQ(0, manager.getSfxDropped());
+
+    // later events overlap, but only few voices of one sound allowed
+    for (int f = 0; f < 4; f ++)
+    {
+        SDL_Delay(50);
+        manager.playSfx(handle, 0, 0);
+    }
+    EXPECT_EQ(3, manager.getSfxPlayed());
+    EXPECT_EQ(2, manager.getSfxCoalesced());
+    EXPECT_EQ(2, manager.getSfxDropped());
+
+    manager.close();
+    manager.shutdown();
+}
+
+TEST(soundmanager, channels)
+{
+    Client::Options options;
+    Client client(options);
+    initSoundTest();
+
+    SoundManager manager;
+    manager.init();
+
+    // each sound takes one channel until all channels are busy
+    for (int f = 0; f < samplesCount; f ++)
+        manager.playSfx(manager.getSfxHandle(samplePath(f)), 0, 0);
+    EXPECT_EQ(samplesCount - 1, manager.getSfxPlayed());
+    EXPECT_EQ(0, manager.getSfxCoalesced());
+    EXPECT_EQ(1, manager.getSfxDropped());
+
+    // channels are free again after halt
+    Mix_HaltChannel(-1);
+    manager.playSfx(manager.getSfxHandle(samplePath(samplesCount - 1)), 0, 0);
+    EXPECT_EQ(samplesCount, manager.getSfxPlayed());
+    EXPECT_EQ(1, manager.getSfxDropped());
+
+    manager.close();
+    manager.shutdown();
+}
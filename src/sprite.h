@@ -29,6 +29,9 @@
 class Graphics;
 class Image;
 
+// resource id and image data in it
+typedef std::pair<unsigned int, const void*> SpriteHash;
+
 class Sprite
 {
     public:
@@ -113,8 +116,12 @@ class Sprite
          */
         virtual unsigned int getFrameCount() const A_WARN_UNUSED = 0;
 
-        virtual void *getHash() A_WARN_UNUSED
-        { return nullptr; }
+        /**
+         * Sets key of currently drawn image for sharing composed images.
+         * Returns false if sprite can not be shared.
+         */
+        virtual bool getHash(SpriteHash &hash A_UNUSED) const A_WARN_UNUSED
+        { return false; }
 
         virtual void *getHash2() A_WARN_UNUSED
         { return this; }
@@ -53,7 +53,9 @@ Text::Text(const std::string &text, const int x, const int y,
     mText(text),
     mColor(color),
     mOutlineColor(Theme::getThemeColor(Theme::OUTLINE)),
-    mIsSpeech(isSpeech)
+    mIsSpeech(isSpeech),
+    mListIter(),
+    mPositionIter()
 {
     if (!textManager)
     {
@@ -126,6 +128,10 @@ void Text::adviseXY(const int x, const int y, const bool move)
     {
         textManager->moveText(this, x - mXOffset, y);
     }
+    else if (textManager)
+    {
+        textManager->setTextPosition(this, x - mXOffset, y);
+    }
     else
     {
         mX = x - mXOffset;
@@ -147,7 +153,19 @@ void Text::draw(Graphics *const graphics, const int xOff, const int yOff)
     if (!mIsSpeech)
         graphics->setColor2(mOutlineColor);
 
-    mFont->drawString(graphics, mText, mX - xOff, mY - yOff);
+    // animated colors are cached by palette slot instead of value
+    const int phase = Palette::getGradientPhase(mColor);
+    SDLFont *const font = phase >= 0 ? dynamic_cast<SDLFont*>(mFont)
+        : nullptr;
+    if (font)
+    {
+        font->drawGradientString(graphics, mText, mX - xOff, mY - yOff,
+            mColor, phase);
+    }
+    else
+    {
+        mFont->drawString(graphics, mText, mX - xOff, mY - yOff);
+    }
     BLOCK_END("Text::draw")
 }
 
@@ -26,11 +26,10 @@
 
 #include "graphics.h"
 #include "localconsts.h"
+#include "textmanager.h"
 
 #include <guichan/color.hpp>
 
-class TextManager;
-
 class Text
 {
     friend class TextManager;
@@ -53,6 +52,12 @@ class Text
 
         void setColor(const gcn::Color *const color);
 
+        int getX() const A_WARN_UNUSED
+        { return mX; }
+
+        int getY() const A_WARN_UNUSED
+        { return mY; }
+
         int getWidth() const A_WARN_UNUSED
         { return mWidth; }
 
@@ -82,6 +87,9 @@ class Text
         const gcn::Color *mColor;     /**< The color of the text. */
         const gcn::Color mOutlineColor;
         bool mIsSpeech;        /**< Is this text a speech bubble? */
+        /** Handles for fast removing from text manager */
+        TextManager::TextList::iterator mListIter;
+        TextManager::TextPositions::iterator mPositionIter;
 
     protected:
         static ImageRect mBubble;   /**< Speech bubble graphic */
@@ -30,33 +30,50 @@
 TextManager *textManager = nullptr;
 
 TextManager::TextManager() :
-    mTextList()
+    mTextList(),
+    mTextPositions(),
+    mMaxHeight(0)
 {
 }
 
 void TextManager::addText(Text *const text)
 {
+    if (text->mHeight > mMaxHeight)
+        mMaxHeight = text->mHeight;
     place(text, nullptr, text->mX, text->mY, text->mHeight);
-    mTextList.push_back(text);
+    text->mListIter = mTextList.insert(mTextList.end(), text);
+    text->mPositionIter = mTextPositions.insert(
+        TextPositions::value_type(text->mY, text));
 }
 
-void TextManager::moveText(Text *const text, const int x, const int y) const
+void TextManager::moveText(Text *const text, const int x, const int y)
 {
     text->mX = x;
     text->mY = y;
     place(text, text, text->mX, text->mY, text->mHeight);
+    updatePosition(text);
 }
 
-void TextManager::removeText(const Text *const text)
+void TextManager::setTextPosition(Text *const text, const int x, const int y)
 {
-    FOR_EACH (TextList::iterator, ptr, mTextList)
-    {
-        if (*ptr == text)
-        {
-            mTextList.erase(ptr);
-            return;
-        }
-    }
+    text->mX = x;
+    text->mY = y;
+    updatePosition(text);
+}
+
+void TextManager::updatePosition(Text *const text)
+{
+    if (text->mPositionIter->first == text->mY)
+        return;
+    mTextPositions.erase(text->mPositionIter);
+    text->mPositionIter = mTextPositions.insert(
+        TextPositions::value_type(text->mY, text));
+}
+
+void TextManager::removeText(Text *const text)
+{
+    mTextList.erase(text->mListIter);
+    mTextPositions.erase(text->mPositionIter);
 }
 
 TextManager::~TextManager()
@@ -78,18 +95,20 @@ void TextManager::place(const Text *const textObj, const Text *const omit,
     const int xLeft = textObj->mX;
     const int xRight1 = xLeft + textObj->mWidth;
     const int TEST = 50;  // Number of lines to test for text
-    const int nBeings = 30;
     bool occupied[TEST];  // is some other text obscuring this line?
     std::memset(&occupied, 0, sizeof(occupied));  // set all to false
     const int wantedTop = (TEST - h) / 2;   // Entry in occupied at top of text
     const int occupiedTop = y - wantedTop;  // Line in map representing
                                             // to of occupied
-    int cnt = 0;
 
-    for (TextList::const_iterator ptr = mTextList.begin(),
-         pEnd = mTextList.end(); ptr != pEnd && cnt < nBeings; ++ptr, cnt ++)
+    // only texts which tops are in tested lines or few lines above them
+    // can obscure tested lines
+    const TextPositions::const_iterator pEnd
+        = mTextPositions.lower_bound(occupiedTop + TEST);
+    for (TextPositions::const_iterator ptr = mTextPositions.lower_bound(
+         occupiedTop - mMaxHeight + 1); ptr != pEnd; ++ptr)
     {
-        const Text *const text = *ptr;
+        const Text *const text = ptr->second;
 
         if (text != omit && text->mX + 1 <= xRight1
             && text->mX + text->mWidth > xLeft)
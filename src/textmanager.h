@@ -23,6 +23,7 @@
 #define TEXTMANAGER_H
 
 #include <list>
+#include <map>
 
 #include "localconsts.h"
 
@@ -32,6 +33,9 @@ class Text;
 class TextManager final
 {
     public:
+        typedef std::list<Text *> TextList; /**< The container type */
+        typedef std::multimap<int, Text*> TextPositions;
+
         /**
          * Constructor
          */
@@ -52,12 +56,17 @@ class TextManager final
         /**
          * Move the text around the screen
          */
-        void moveText(Text *const text, const int x, const int y) const;
+        void moveText(Text *const text, const int x, const int y);
+
+        /**
+         * Sets text position without searching free place for it
+         */
+        void setTextPosition(Text *const text, const int x, const int y);
 
         /**
          * Remove the text from the manager
          */
-        void removeText(const Text *const text);
+        void removeText(Text *const text);
 
         /**
          * Draw the text
@@ -72,8 +81,12 @@ class TextManager final
         void place(const Text *const textObj, const Text *const omit,
                    const int &x, int &y, const int h) const;
 
-        typedef std::list<Text *> TextList; /**< The container type */
-        TextList mTextList; /**< The container */
+        void updatePosition(Text *const text);
+
+        TextList mTextList; /**< The container, in drawing order */
+        /** Texts sorted by top, to find texts near placed one */
+        TextPositions mTextPositions;
+        int mMaxHeight;     /**< Height of highest text */
 };
 
 extern TextManager *textManager;
@@ -0,0 +1,135 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+
+#include "client.h"
+#include "text.h"
+#include "textmanager.h"
+
+#include "gui/sdlfont.h"
+#include "gui/theme.h"
+
+#include "utils/stringutils.h"
+
+#include "gtest/gtest.h"
+
+#include <physfs.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <SDL_timer.h>
+
+#include "debug.h"
+
+extern const char *dirSeparator;
+
+static SDLFont *initTextTest()
+{
+    PHYSFS_init("manaplus");
+    dirSeparator = "/";
+    if (!logger)
+        logger = new Logger();
+    Theme::instance();
+    return new SDLFont("/usr/share/fonts/truetype/"
+        "ttf-dejavu/DejaVuSans-Oblique.ttf", 18);
+}
+
+TEST(textmanager, place)
+{
+    Client::Options options;
+    Client client(options);
+    SDLFont *const font = initTextTest();
+    const gcn::Color color(1, 2, 3);
+
+    Text *const text1 = new Text("test", 100, 100, gcn::Graphics::LEFT,
+        &color, false, font);
+    EXPECT_TRUE(textManager != nullptr);
+    EXPECT_EQ(100, text1->getY());
+    const int height = text1->getHeight();
+
+    // second text is moved up or down to not cover first one
+    Text *const text2 = new Text("test", 100, 100, gcn::Graphics::LEFT,
+        &color, false, font);
+    EXPECT_GE(abs(text2->getY() - text1->getY()), height);
+
+    // text far from others is not moved
+    Text *const text3 = new Text("test", 1000, 100, gcn::Graphics::LEFT,
+        &color, false, font);
+    EXPECT_EQ(100, text3->getY());
+    text3->adviseXY(1000, 100 + height, true);
+    EXPECT_EQ(100 + height, text3->getY());
+
+    // moved text avoids texts at new place
+    text3->adviseXY(110, 100, true);
+    EXPECT_GE(abs(text3->getY() - text1->getY()), height);
+    EXPECT_GE(abs(text3->getY() - text2->getY()), height);
+
+    // after removing text its place is free again
+    delete text2;
+    delete text3;
+    Text *const text4 = new Text("test", 100, 100 + height,
+        gcn::Graphics::LEFT, &color, false, font);
+    EXPECT_EQ(100 + height, text4->getY());
+
+    delete text4;
+    delete text1;
+    EXPECT_EQ(nullptr, textManager);
+    delete font;
+}
+
+TEST(textmanager, benchmark)
+{
+    Client::Options options;
+    Client client(options);
+    SDLFont *const font = initTextTest();
+    const gcn::Color color(1, 2, 3);
+    const int count = 5000;
+    // labels spread over map of 200x200 tiles
+    const int mapSize = 200 * 32;
+
+    srand(1);
+    std::vector<Text*> texts;
+    const unsigned int startTime = SDL_GetTicks();
+    for (int f = 0; f < count; f ++)
+    {
+        texts.push_back(new Text(strprintf("being %d", f),
+            rand() % mapSize, rand() % mapSize, gcn::Graphics::CENTER,
+            &color, false, font));
+    }
+    const unsigned int addTime = SDL_GetTicks();
+
+    // every label walks few pixels, as names of moving beings
+    for (int n = 0; n < 10; n ++)
+    {
+        for (int f = 0; f < count; f ++)
+            texts[f]->adviseXY(rand() % mapSize, rand() % mapSize, true);
+    }
+    const unsigned int moveTime = SDL_GetTicks();
+
+    for (int f = 0; f < count; f ++)
+        delete texts[f];
+    EXPECT_EQ(nullptr, textManager);
+
+    RecordProperty("addTime", addTime - startTime);
+    RecordProperty("moveTime", moveTime - addTime);
+    delete font;
+}
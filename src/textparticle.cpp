@@ -22,8 +22,10 @@
 
 #include "textparticle.h"
 
+#include "framebudget.h"
 #include "graphics.h"
 
+#include "gui/sdlfont.h"
 #include "gui/theme.h"
 
 #include <guichan/color.hpp>
@@ -50,6 +52,7 @@ bool TextParticle::draw(Graphics *const graphics,
         return false;
 
     BLOCK_START("TextParticle::draw")
+    BUDGET_BLOCK(ZONE_PARTICLES)
     if (!isAlive())
     {
         BLOCK_END("TextParticle::draw")
@@ -83,7 +86,19 @@ bool TextParticle::draw(Graphics *const graphics,
         graphics->setColor2(Theme::getThemeColor(
             Theme::OUTLINE, static_cast<int>(alpha)));
     }
-    mTextFont->drawString(graphics, mText, screenX - mTextWidth, screenY);
+    // animated colors are cached by palette slot instead of value
+    const int phase = Palette::getGradientPhase(mColor);
+    SDLFont *const font = phase >= 0 ? dynamic_cast<SDLFont*>(mTextFont)
+        : nullptr;
+    if (font)
+    {
+        font->drawGradientString(graphics, mText, screenX - mTextWidth,
+            screenY, mColor, phase);
+    }
+    else
+    {
+        mTextFont->drawString(graphics, mText, screenX - mTextWidth, screenY);
+    }
     BLOCK_END("TextParticle::draw")
     return true;
 }
@@ -0,0 +1,662 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/archiveindex.h"
+
+#include "logger.h"
+
+#include "utils/mappedfile.h"
+#include "utils/stringutils.h"
+
+#include <SDL_rwops.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "debug.h"
+
+ArchiveIndex archiveIndex;
+
+// 'MPAI', also tells if file was written with other byte order
+static const int archiveIndexMagic = 0x4941504d;
+static const int archiveIndexVersion = 1;
+// strings longer than this are treated as broken file
+static const int maxStringSize = 1024;
+
+// zip format values
+static const unsigned int zipEndSignature = 0x06054b50;
+static const unsigned int zipDirSignature = 0x02014b50;
+static const unsigned int zipLocalSignature = 0x04034b50;
+static const int zipEndSize = 22;
+static const int zipDirSize = 46;
+static const int zipLocalSize = 30;
+static const int zipMaxComment = 65535;
+static const int zipStored = 0;
+static const int zipDeflated = 8;
+// entries which can not be read here, but still hide older archives
+static const int zipUnsupported = -1;
+
+namespace
+{
+    bool writeInt(FILE *const file, const int value)
+    {
+        return fwrite(&value, sizeof(int), 1, file) == 1;
+    }
+
+    bool writeString(FILE *const file, const std::string &str)
+    {
+        const int len = static_cast<int>(str.size());
+        return writeInt(file, len) && (!len
+            || fwrite(str.c_str(), 1, len, file) == static_cast<size_t>(len));
+    }
+
+    bool readInt(FILE *const file, int &value)
+    {
+        return fread(&value, sizeof(int), 1, file) == 1;
+    }
+
+    bool readString(FILE *const file, std::string &str)
+    {
+        int len = 0;
+        if (!readInt(file, len) || len < 0 || len > maxStringSize)
+            return false;
+        str.resize(len);
+        return !len
+            || fread(&str[0], 1, len, file) == static_cast<size_t>(len);
+    }
+
+    // zip values are little endian
+    unsigned int getUInt16(const unsigned char *const ptr)
+    {
+        return ptr[0] | (ptr[1] << 8);
+    }
+
+    unsigned int getUInt32(const unsigned char *const ptr)
+    {
+        return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16)
+            | (static_cast<unsigned int>(ptr[3]) << 24);
+    }
+
+    struct MemoryFile final
+    {
+        MemoryFile(const unsigned char *const data0, const int size0,
+                   const bool owned0) :
+            data(data0),
+            size(size0),
+            pos(0),
+            owned(owned0)
+        {
+        }
+
+        A_DELETE_COPY(MemoryFile)
+
+        const unsigned char *data;
+        int size;
+        int pos;
+        bool owned;
+    };
+
+    int memoryfile_seek(SDL_RWops *const rw, const int offset,
+                        const int whence)
+    {
+        MemoryFile *const file = static_cast<MemoryFile*>(
+            rw->hidden.unknown.data1);
+        int pos = offset;
+        if (whence == SEEK_CUR)
+            pos += file->pos;
+        else if (whence == SEEK_END)
+            pos += file->size;
+        else if (whence != SEEK_SET)
+            return -1;
+
+        if (pos < 0 || pos > file->size)
+        {
+            SDL_SetError("Seek outside of file");
+            return -1;
+        }
+        file->pos = pos;
+        return pos;
+    }
+
+    int memoryfile_read(SDL_RWops *const rw, void *ptr,
+                        const int size, const int maxnum)
+    {
+        MemoryFile *const file = static_cast<MemoryFile*>(
+            rw->hidden.unknown.data1);
+        if (size <= 0 || maxnum <= 0)
+            return 0;
+        int num = (file->size - file->pos) / size;
+        if (num > maxnum)
+            num = maxnum;
+        memcpy(ptr, file->data + file->pos, num * size);
+        file->pos += num * size;
+        return num;
+    }
+
+    int memoryfile_write(SDL_RWops *const rw A_UNUSED,
+                         const void *ptr A_UNUSED,
+                         const int size A_UNUSED, const int num A_UNUSED)
+    {
+        SDL_SetError("Archive files are read only");
+        return -1;
+    }
+
+    int memoryfile_close(SDL_RWops *const rw)
+    {
+        MemoryFile *const file = static_cast<MemoryFile*>(
+            rw->hidden.unknown.data1);
+        if (file->owned)
+            free(const_cast<unsigned char*>(file->data));
+        delete file;
+        SDL_FreeRW(rw);
+        return 0;
+    }
+
+    SDL_RWops *createRWops(const unsigned char *const data, const int size,
+                           const bool owned)
+    {
+        SDL_RWops *const rw = SDL_AllocRW();
+        if (!rw)
+        {
+            if (owned)
+                free(const_cast<unsigned char*>(data));
+            return nullptr;
+        }
+        rw->seek = memoryfile_seek;
+        rw->read = memoryfile_read;
+        rw->write = memoryfile_write;
+        rw->close = memoryfile_close;
+        rw->hidden.unknown.data1 = new MemoryFile(data, size, owned);
+        return rw;
+    }
+}  // namespace
+
+ArchiveIndex::ArchiveIndex() :
+    mIndex(),
+    mArchives(),
+    mShadows(),
+    mCache(),
+    mRetired(),
+    mCacheFile(),
+    mOrder(0)
+{
+}
+
+ArchiveIndex::~ArchiveIndex()
+{
+    clear();
+}
+
+void ArchiveIndex::addPath(const std::string &path, const bool append)
+{
+    // appended paths are searched after everything indexed
+    if (append)
+        return;
+
+    mOrder ++;
+    struct stat statbuf;
+    const bool found = !stat(path.c_str(), &statbuf);
+    if (found && S_ISDIR(statbuf.st_mode))
+    {
+        mShadows.push_back(Shadow(path, mOrder, true));
+        return;
+    }
+
+    Archive *archive = nullptr;
+    const Archives::iterator it = mCache.find(path);
+    if (it != mCache.end())
+    {
+        if (found && it->second->size == static_cast<int>(statbuf.st_size)
+            && it->second->time == static_cast<int>(statbuf.st_mtime))
+        {
+            archive = it->second;
+        }
+        else
+        {
+            delete it->second;
+        }
+        mCache.erase(it);
+    }
+
+    std::string ext = path.size() > 4 ? path.substr(path.size() - 4) : "";
+    if (!archive && found && toLower(ext) == ".zip")
+    {
+        MappedFile file;
+        archive = new Archive;
+        archive->path = path;
+        archive->size = static_cast<int>(statbuf.st_size);
+        archive->time = static_cast<int>(statbuf.st_mtime);
+        if (!file.open(path) || !readArchive(archive, file))
+        {
+            logger->log("Cant index archive: %s", path.c_str());
+            delete archive;
+            archive = nullptr;
+        }
+    }
+
+    if (!archive)
+    {
+        // unknown archive hides files of all older ones
+        mShadows.push_back(Shadow(path, mOrder, false));
+        return;
+    }
+
+    archive->order = mOrder;
+    mArchives.push_back(archive);
+    addToIndex(archive);
+}
+
+void ArchiveIndex::removePath(const std::string &path)
+{
+    FOR_EACH (std::vector<Shadow>::iterator, it, mShadows)
+    {
+        if ((*it).path == path)
+        {
+            mShadows.erase(it);
+            return;
+        }
+    }
+
+    FOR_EACH (std::vector<Archive*>::iterator, it, mArchives)
+    {
+        Archive *const archive = *it;
+        if (archive->path != path)
+            continue;
+
+        // files opened from mapped archive can be still in use
+        if (archive->file)
+        {
+            mRetired.push_back(archive->file);
+            archive->file = nullptr;
+        }
+        mArchives.erase(it);
+        const Archives::iterator it2 = mCache.find(path);
+        if (it2 != mCache.end())
+        {
+            delete it2->second;
+            mCache.erase(it2);
+        }
+        mCache[path] = archive;
+        rebuildIndex();
+        return;
+    }
+}
+
+const ArchiveIndex::IndexItem *ArchiveIndex::find(
+    const std::string &name) const
+{
+    const Index::const_iterator it = mIndex.find(name);
+    if (it == mIndex.end())
+        return nullptr;
+
+    const int order = it->second.archive->order;
+    FOR_EACH (std::vector<Shadow>::const_iterator, it2, mShadows)
+    {
+        const Shadow &shadow = *it2;
+        if (shadow.order < order)
+            continue;
+        if (!shadow.directory)
+            return nullptr;
+        struct stat statbuf;
+        if (!stat((shadow.path + "/" + name).c_str(), &statbuf))
+            return nullptr;
+    }
+    return &it->second;
+}
+
+bool ArchiveIndex::exists(const std::string &name) const
+{
+    return find(name) != nullptr;
+}
+
+const char *ArchiveIndex::getRealDir(const std::string &name) const
+{
+    const IndexItem *const item = find(name);
+    if (!item)
+        return nullptr;
+    return item->archive->path.c_str();
+}
+
+const unsigned char *ArchiveIndex::getData(const IndexItem &item)
+{
+    const ArchiveEntry *const entry = item.entry;
+    if (entry->method != zipStored && entry->method != zipDeflated)
+        return nullptr;
+
+    // archives from cache are mapped only when used
+    Archive *const archive = const_cast<Archive*>(item.archive);
+    if (!archive->file)
+    {
+        archive->file = new MappedFile;
+        if (!archive->file->open(archive->path))
+        {
+            delete archive->file;
+            archive->file = nullptr;
+            return nullptr;
+        }
+    }
+
+    const unsigned char *const data = static_cast<const unsigned char*>(
+        archive->file->getData());
+    const unsigned int size = static_cast<unsigned int>(
+        archive->file->getSize());
+    const unsigned int offset = entry->offset;
+    if (offset > size || size - offset < zipLocalSize
+        || getUInt32(data + offset) != zipLocalSignature)
+    {
+        return nullptr;
+    }
+
+    const unsigned int start = offset + zipLocalSize
+        + getUInt16(data + offset + 26) + getUInt16(data + offset + 28);
+    if (start > size || size - start < entry->compressedSize)
+        return nullptr;
+    return data + start;
+}
+
+bool ArchiveIndex::inflateData(const unsigned char *const src,
+                               const unsigned int srcSize,
+                               unsigned char *const dst,
+                               const unsigned int dstSize)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    // zip stores raw deflate data without zlib header
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+        return false;
+
+    strm.next_in = const_cast<Bytef*>(src);
+    strm.avail_in = srcSize;
+    strm.next_out = dst;
+    strm.avail_out = dstSize;
+    const int ret = inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+    return ret == Z_STREAM_END && strm.total_out == dstSize;
+}
+
+SDL_RWops *ArchiveIndex::openRead(const std::string &name)
+{
+    const IndexItem *const item = find(name);
+    if (!item)
+        return nullptr;
+
+    const unsigned char *const data = getData(*item);
+    if (!data)
+        return nullptr;
+
+    const ArchiveEntry *const entry = item->entry;
+    if (entry->method == zipStored)
+        return createRWops(data, entry->size, false);
+
+    unsigned char *const buf = static_cast<unsigned char*>(
+        malloc(entry->size ? entry->size : 1));
+    if (!buf || !inflateData(data, entry->compressedSize, buf, entry->size))
+    {
+        free(buf);
+        return nullptr;
+    }
+    return createRWops(buf, entry->size, true);
+}
+
+void *ArchiveIndex::loadFile(const std::string &name, int &fileSize)
+{
+    const IndexItem *const item = find(name);
+    if (!item)
+        return nullptr;
+
+    const unsigned char *const data = getData(*item);
+    if (!data)
+        return nullptr;
+
+    const ArchiveEntry *const entry = item->entry;
+    unsigned char *const buf = static_cast<unsigned char*>(
+        malloc(entry->size ? entry->size : 1));
+    if (!buf)
+        return nullptr;
+
+    if (entry->method == zipStored)
+    {
+        memcpy(buf, data, entry->size);
+    }
+    else if (!inflateData(data, entry->compressedSize, buf, entry->size))
+    {
+        free(buf);
+        return nullptr;
+    }
+    fileSize = static_cast<int>(entry->size);
+    return buf;
+}
+
+bool ArchiveIndex::readArchive(Archive *const archive,
+                               const MappedFile &file)
+{
+    const unsigned char *const data = static_cast<const unsigned char*>(
+        file.getData());
+    const int size = file.getSize();
+    if (!data || size < zipEndSize)
+        return false;
+
+    // end of central directory is followed only by archive comment
+    int pos = size - zipEndSize;
+    const int minPos = pos > zipMaxComment ? pos - zipMaxComment : 0;
+    while (pos >= minPos && getUInt32(data + pos) != zipEndSignature)
+        pos --;
+    if (pos < minPos)
+        return false;
+
+    const unsigned int count = getUInt16(data + pos + 10);
+    const unsigned int dirSize = getUInt32(data + pos + 12);
+    unsigned int dirPos = getUInt32(data + pos + 16);
+    // zip64 archives are left to PhysicsFS
+    if (count == 0xffff || dirPos == 0xffffffff
+        || dirPos > static_cast<unsigned int>(pos)
+        || dirSize > static_cast<unsigned int>(pos) - dirPos)
+    {
+        return false;
+    }
+
+    const unsigned int dirEnd = dirPos + dirSize;
+    archive->entries.reserve(count);
+    for (unsigned int f = 0; f < count; f ++)
+    {
+        if (dirEnd - dirPos < static_cast<unsigned int>(zipDirSize))
+            return false;
+        const unsigned char *const ptr = data + dirPos;
+        if (getUInt32(ptr) != zipDirSignature)
+            return false;
+
+        const unsigned int nameSize = getUInt16(ptr + 28);
+        const unsigned int recordSize = zipDirSize + nameSize
+            + getUInt16(ptr + 30) + getUInt16(ptr + 32);
+        if (dirEnd - dirPos < recordSize)
+            return false;
+        dirPos += recordSize;
+
+        // directories are not files
+        if (!nameSize || ptr[zipDirSize + nameSize - 1] == '/')
+            continue;
+
+        ArchiveEntry entry;
+        entry.name.assign(reinterpret_cast<const char*>(ptr + zipDirSize),
+            nameSize);
+        entry.method = static_cast<int>(getUInt16(ptr + 10));
+        entry.compressedSize = getUInt32(ptr + 20);
+        entry.size = getUInt32(ptr + 24);
+        entry.offset = getUInt32(ptr + 42);
+        // encrypted and zip64 entries
+        if ((getUInt16(ptr + 8) & 1) || entry.size == 0xffffffff
+            || entry.compressedSize == 0xffffffff
+            || entry.offset == 0xffffffff)
+        {
+            entry.method = zipUnsupported;
+        }
+        archive->entries.push_back(entry);
+    }
+    return true;
+}
+
+void ArchiveIndex::addToIndex(const Archive *const archive)
+{
+    FOR_EACH (std::vector<ArchiveEntry>::const_iterator, it,
+              archive->entries)
+    {
+        const ArchiveEntry &entry = *it;
+        mIndex[entry.name] = IndexItem(archive, &entry);
+    }
+}
+
+void ArchiveIndex::rebuildIndex()
+{
+    mIndex.clear();
+    FOR_EACH (std::vector<Archive*>::const_iterator, it, mArchives)
+        addToIndex(*it);
+}
+
+void ArchiveIndex::loadCache(const std::string &fileName)
+{
+    mCacheFile = fileName;
+    FILE *const file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return;
+
+    int magic = 0;
+    int version = 0;
+    int count = 0;
+    if (!readInt(file, magic) || magic != archiveIndexMagic
+        || !readInt(file, version) || version != archiveIndexVersion
+        || !readInt(file, count))
+    {
+        logger->log("Ignoring broken archive index: %s", fileName.c_str());
+        fclose(file);
+        return;
+    }
+
+    for (int f = 0; f < count; f ++)
+    {
+        Archive *const archive = new Archive;
+        int entries = 0;
+        bool ok = readString(file, archive->path)
+            && readInt(file, archive->size)
+            && readInt(file, archive->time)
+            && readInt(file, entries) && entries >= 0;
+        if (ok)
+            archive->entries.resize(entries);
+        for (int i = 0; i < entries && ok; i ++)
+        {
+            ArchiveEntry &entry = archive->entries[i];
+            int offset = 0;
+            int compressedSize = 0;
+            int size = 0;
+            ok = readString(file, entry.name) && readInt(file, offset)
+                && readInt(file, compressedSize) && readInt(file, size)
+                && readInt(file, entry.method);
+            entry.offset = static_cast<unsigned int>(offset);
+            entry.compressedSize = static_cast<unsigned int>(compressedSize);
+            entry.size = static_cast<unsigned int>(size);
+        }
+        if (!ok)
+        {
+            logger->log("Ignoring broken archive index: %s",
+                fileName.c_str());
+            delete archive;
+            break;
+        }
+
+        const Archives::iterator it = mCache.find(archive->path);
+        if (it != mCache.end())
+            delete it->second;
+        mCache[archive->path] = archive;
+    }
+    fclose(file);
+}
+
+void ArchiveIndex::saveCache() const
+{
+    if (mCacheFile.empty())
+        return;
+
+    FILE *const file = fopen(mCacheFile.c_str(), "wb");
+    if (!file)
+    {
+        logger->log("Error: cant save archive index: %s",
+            mCacheFile.c_str());
+        return;
+    }
+
+    // archives not mounted now are kept for next start
+    std::vector<const Archive*> archives(mArchives.begin(), mArchives.end());
+    FOR_EACH (Archives::const_iterator, it, mCache)
+        archives.push_back(it->second);
+
+    bool ok = writeInt(file, archiveIndexMagic)
+        && writeInt(file, archiveIndexVersion)
+        && writeInt(file, static_cast<int>(archives.size()));
+
+    for (std::vector<const Archive*>::const_iterator it = archives.begin(),
+         it_end = archives.end(); it != it_end && ok; ++ it)
+    {
+        const Archive *const archive = *it;
+        ok = writeString(file, archive->path)
+            && writeInt(file, archive->size)
+            && writeInt(file, archive->time)
+            && writeInt(file, static_cast<int>(archive->entries.size()));
+        for (std::vector<ArchiveEntry>::const_iterator
+             it2 = archive->entries.begin(), it2_end = archive->entries.end();
+             it2 != it2_end && ok; ++ it2)
+        {
+            const ArchiveEntry &entry = *it2;
+            ok = writeString(file, entry.name)
+                && writeInt(file, static_cast<int>(entry.offset))
+                && writeInt(file, static_cast<int>(entry.compressedSize))
+                && writeInt(file, static_cast<int>(entry.size))
+                && writeInt(file, entry.method);
+        }
+    }
+
+    if (fclose(file))
+        ok = false;
+    if (!ok)
+    {
+        logger->log("Error: cant save archive index: %s",
+            mCacheFile.c_str());
+        remove(mCacheFile.c_str());
+    }
+}
+
+void ArchiveIndex::clear()
+{
+    mIndex.clear();
+    FOR_EACH (std::vector<Archive*>::iterator, it, mArchives)
+    {
+        delete (*it)->file;
+        delete *it;
+    }
+    mArchives.clear();
+    FOR_EACH (Archives::iterator, it, mCache)
+        delete it->second;
+    mCache.clear();
+    FOR_EACH (std::vector<MappedFile*>::iterator, it, mRetired)
+        delete *it;
+    mRetired.clear();
+    mShadows.clear();
+}
@@ -0,0 +1,205 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTILS_ARCHIVEINDEX_H
+#define UTILS_ARCHIVEINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "localconsts.h"
+
+class MappedFile;
+
+struct SDL_RWops;
+
+/**
+ * One index of all files in zip archives prepended to search path, so
+ * file lookup does not walk every archive. Newer archives override older
+ * ones. Archives stay mounted in PhysicsFS, which is used for everything
+ * not found here.
+ *
+ * Stored files are read directly from memory mapped archive, deflated
+ * ones are unpacked to memory. Archive contents are saved to cache file
+ * and read again only if archive is changed.
+ */
+class ArchiveIndex final
+{
+    public:
+        ArchiveIndex();
+
+        A_DELETE_COPY(ArchiveIndex)
+
+        ~ArchiveIndex();
+
+        /**
+         * Called after path is added to PhysicsFS search path.
+         */
+        void addPath(const std::string &path, const bool append);
+
+        /**
+         * Called after path is removed from PhysicsFS search path.
+         */
+        void removePath(const std::string &path);
+
+        bool exists(const std::string &name) const A_WARN_UNUSED;
+
+        /**
+         * Returns archive with file, or nullptr if file is not indexed.
+         */
+        const char *getRealDir(const std::string &name) const A_WARN_UNUSED;
+
+        /**
+         * Opens indexed file. Returns nullptr if file is not indexed or can
+         * not be read here.
+         */
+        SDL_RWops *openRead(const std::string &name) A_WARN_UNUSED;
+
+        /**
+         * Returns malloc'ed copy of indexed file.
+         */
+        void *loadFile(const std::string &name, int &fileSize) A_WARN_UNUSED;
+
+        void loadCache(const std::string &fileName);
+
+        void saveCache() const;
+
+        void clear();
+
+        int getArchivesCount() const A_WARN_UNUSED
+        { return static_cast<int>(mArchives.size()); }
+
+        int getFilesCount() const A_WARN_UNUSED
+        { return static_cast<int>(mIndex.size()); }
+
+    private:
+        struct ArchiveEntry final
+        {
+            ArchiveEntry() :
+                name(),
+                offset(0),
+                compressedSize(0),
+                size(0),
+                method(0)
+            {
+            }
+
+            std::string name;
+            unsigned int offset;
+            unsigned int compressedSize;
+            unsigned int size;
+            int method;
+        };
+
+        struct Archive final
+        {
+            Archive() :
+                path(),
+                entries(),
+                file(nullptr),
+                size(0),
+                time(0),
+                order(0)
+            {
+            }
+
+            A_DELETE_COPY(Archive)
+
+            std::string path;
+            std::vector<ArchiveEntry> entries;
+            MappedFile *file;
+            int size;
+            int time;
+            int order;
+        };
+
+        /** Path prepended after some archives, which can hide their files */
+        struct Shadow final
+        {
+            Shadow(const std::string &path0, const int order0,
+                   const bool directory0) :
+                path(path0),
+                order(order0),
+                directory(directory0)
+            {
+            }
+
+            std::string path;
+            int order;
+            bool directory;
+        };
+
+        struct IndexItem final
+        {
+            IndexItem() :
+                archive(nullptr),
+                entry(nullptr)
+            {
+            }
+
+            IndexItem(const Archive *const archive0,
+                      const ArchiveEntry *const entry0) :
+                archive(archive0),
+                entry(entry0)
+            {
+            }
+
+            const Archive *archive;
+            const ArchiveEntry *entry;
+        };
+
+        typedef std::map<std::string, IndexItem> Index;
+        typedef std::map<std::string, Archive*> Archives;
+
+        const IndexItem *find(const std::string &name) const A_WARN_UNUSED;
+
+        /**
+         * Returns start of file data in mapped archive.
+         */
+        const unsigned char *getData(const IndexItem &item) A_WARN_UNUSED;
+
+        /**
+         * Reads central directory of zip archive.
+         */
+        static bool readArchive(Archive *const archive,
+                                const MappedFile &file) A_WARN_UNUSED;
+
+        static bool inflateData(const unsigned char *const src,
+                                const unsigned int srcSize,
+                                unsigned char *const dst,
+                                const unsigned int dstSize) A_WARN_UNUSED;
+
+        void addToIndex(const Archive *const archive);
+
+        void rebuildIndex();
+
+        Index mIndex;
+        std::vector<Archive*> mArchives;
+        std::vector<Shadow> mShadows;
+        Archives mCache;
+        std::vector<MappedFile*> mRetired;
+        std::string mCacheFile;
+        int mOrder;
+};
+
+extern ArchiveIndex archiveIndex;
+
+#endif  // UTILS_ARCHIVEINDEX_H
@@ -0,0 +1,320 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+
+#include "client.h"
+
+#include "utils/archiveindex.h"
+#include "utils/mkdir.h"
+#include "utils/stringutils.h"
+
+#include "gtest/gtest.h"
+
+#include <physfs.h>
+
+#include <SDL_rwops.h>
+#include <SDL_timer.h>
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "debug.h"
+
+namespace
+{
+    typedef std::vector<std::pair<std::string, std::string> > ZipFiles;
+
+    void putUInt16(std::string &str, const unsigned int value)
+    {
+        str.push_back(static_cast<char>(value & 0xff));
+        str.push_back(static_cast<char>((value >> 8) & 0xff));
+    }
+
+    void putUInt32(std::string &str, const unsigned int value)
+    {
+        putUInt16(str, value & 0xffff);
+        putUInt16(str, value >> 16);
+    }
+
+    std::string deflateString(const std::string &str)
+    {
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+            Z_DEFAULT_STRATEGY);
+        std::string out(deflateBound(&strm, str.size()), '\0');
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(
+            str.c_str()));
+        strm.avail_in = static_cast<uInt>(str.size());
+        strm.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        strm.avail_out = static_cast<uInt>(out.size());
+        deflate(&strm, Z_FINISH);
+        out.resize(strm.total_out);
+        deflateEnd(&strm);
+        return out;
+    }
+
+    // minimal zip writer, enough for PhysicsFS and index
+    void writeZip(const std::string &fileName, const ZipFiles &files,
+                  const bool compress)
+    {
+        std::string data;
+        std::string dir;
+        FOR_EACH (ZipFiles::const_iterator, it, files)
+        {
+            const std::string &name = it->first;
+            const std::string &str = it->second;
+            const std::string packed = compress ? deflateString(str) : str;
+            const unsigned int crc = static_cast<unsigned int>(crc32(0,
+                reinterpret_cast<const Bytef*>(str.c_str()),
+                static_cast<uInt>(str.size())));
+            const unsigned int offset = static_cast<unsigned int>(
+                data.size());
+
+            putUInt32(data, 0x04034b50);
+            putUInt16(data, 20);
+            putUInt16(data, 0);
+            putUInt16(data, compress ? 8 : 0);
+            putUInt32(data, 0);
+            putUInt32(data, crc);
+            putUInt32(data, static_cast<unsigned int>(packed.size()));
+            putUInt32(data, static_cast<unsigned int>(str.size()));
+            putUInt16(data, static_cast<unsigned int>(name.size()));
+            putUInt16(data, 0);
+            data.append(name).append(packed);
+
+            putUInt32(dir, 0x02014b50);
+            putUInt16(dir, 20);
+            putUInt16(dir, 20);
+            putUInt16(dir, 0);
+            putUInt16(dir, compress ? 8 : 0);
+            putUInt32(dir, 0);
+            putUInt32(dir, crc);
+            putUInt32(dir, static_cast<unsigned int>(packed.size()));
+            putUInt32(dir, static_cast<unsigned int>(str.size()));
+            putUInt16(dir, static_cast<unsigned int>(name.size()));
+            putUInt16(dir, 0);
+            putUInt16(dir, 0);
+            putUInt16(dir, 0);
+            putUInt16(dir, 0);
+            putUInt32(dir, 0);
+            putUInt32(dir, offset);
+            dir.append(name);
+        }
+
+        const unsigned int dirOffset = static_cast<unsigned int>(
+            data.size());
+        data.append(dir);
+        putUInt32(data, 0x06054b50);
+        putUInt16(data, 0);
+        putUInt16(data, 0);
+        putUInt16(data, static_cast<unsigned int>(files.size()));
+        putUInt16(data, static_cast<unsigned int>(files.size()));
+        putUInt32(data, static_cast<unsigned int>(dir.size()));
+        putUInt32(data, dirOffset);
+        putUInt16(data, 0);
+
+        FILE *const file = fopen(fileName.c_str(), "wb");
+        ASSERT_TRUE(file != nullptr);
+        fwrite(data.c_str(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    std::string readRW(SDL_RWops *const rw)
+    {
+        std::string str;
+        if (!rw)
+            return str;
+        char buf[256];
+        int sz;
+        while ((sz = SDL_RWread(rw, buf, 1, sizeof(buf))) > 0)
+            str.append(buf, sz);
+        SDL_RWclose(rw);
+        return str;
+    }
+
+    std::string loadString(ArchiveIndex &index, const std::string &name)
+    {
+        int size = 0;
+        void *const data = index.loadFile(name, size);
+        if (!data)
+            return std::string();
+        const std::string str(static_cast<const char*>(data), size);
+        free(data);
+        return str;
+    }
+
+    void initArchiveTest()
+    {
+        PHYSFS_init("manaplus");
+        if (!logger)
+            logger = new Logger();
+        mkdir_r("/tmp/manaplustest/shadow/data");
+    }
+}  // namespace
+
+TEST(archiveindex, override)
+{
+    Client::Options options;
+    Client client(options);
+    initArchiveTest();
+
+    ZipFiles files1;
+    files1.push_back(std::make_pair("data/a.xml", "old a"));
+    files1.push_back(std::make_pair("data/b.xml", "old b"));
+    files1.push_back(std::make_pair("data/", ""));
+    writeZip("/tmp/manaplustest/test1.zip", files1, false);
+    ZipFiles files2;
+    files2.push_back(std::make_pair("data/a.xml", "new a"));
+    files2.push_back(std::make_pair("data/c.xml",
+        "compressed compressed compressed compressed"));
+    writeZip("/tmp/manaplustest/test2.zip", files2, true);
+
+    ArchiveIndex index;
+    index.addPath("/tmp/manaplustest/test1.zip", false);
+    index.addPath("/tmp/manaplustest/test2.zip", false);
+    EXPECT_EQ(2, index.getArchivesCount());
+    EXPECT_EQ(3, index.getFilesCount());
+    EXPECT_FALSE(index.exists("data"));
+    EXPECT_FALSE(index.exists("data/d.xml"));
+    EXPECT_EQ("new a", readRW(index.openRead("data/a.xml")));
+    EXPECT_EQ("old b", readRW(index.openRead("data/b.xml")));
+    EXPECT_EQ("compressed compressed compressed compressed",
+        readRW(index.openRead("data/c.xml")));
+    EXPECT_EQ("new a", loadString(index, "data/a.xml"));
+    EXPECT_EQ("compressed compressed compressed compressed",
+        loadString(index, "data/c.xml"));
+    EXPECT_EQ(std::string("/tmp/manaplustest/test1.zip"),
+        index.getRealDir("data/b.xml"));
+
+    SDL_RWops *const rw = index.openRead("data/b.xml");
+    ASSERT_TRUE(rw != nullptr);
+    EXPECT_EQ(5, SDL_RWseek(rw, 0, SEEK_END));
+    EXPECT_EQ(2, SDL_RWseek(rw, 2, SEEK_SET));
+    char buf[3];
+    EXPECT_EQ(1, SDL_RWread(rw, buf, 3, 1));
+    EXPECT_EQ(0, memcmp(buf, "d b", 3));
+    SDL_RWclose(rw);
+
+    // removed archive uncovers older files
+    index.removePath("/tmp/manaplustest/test2.zip");
+    EXPECT_EQ(1, index.getArchivesCount());
+    EXPECT_EQ("old a", readRW(index.openRead("data/a.xml")));
+    EXPECT_FALSE(index.exists("data/c.xml"));
+
+    // directory added later hides files it has
+    FILE *const file = fopen("/tmp/manaplustest/shadow/data/b.xml", "wb");
+    ASSERT_TRUE(file != nullptr);
+    fclose(file);
+    index.addPath("/tmp/manaplustest/shadow", false);
+    EXPECT_FALSE(index.exists("data/b.xml"));
+    EXPECT_TRUE(index.exists("data/a.xml"));
+    index.removePath("/tmp/manaplustest/shadow");
+    EXPECT_TRUE(index.exists("data/b.xml"));
+
+    // appended paths are searched after indexed archives
+    index.addPath("/tmp/manaplustest/test2.zip", true);
+    EXPECT_EQ("old a", readRW(index.openRead("data/a.xml")));
+
+    // index is restored from cache file
+    index.addPath("/tmp/manaplustest/test2.zip", false);
+    index.loadCache("/tmp/manaplustest/archiveindex.bin");
+    index.saveCache();
+    ArchiveIndex index2;
+    index2.loadCache("/tmp/manaplustest/archiveindex.bin");
+    index2.addPath("/tmp/manaplustest/test1.zip", false);
+    index2.addPath("/tmp/manaplustest/test2.zip", false);
+    EXPECT_EQ(3, index2.getFilesCount());
+    EXPECT_EQ("new a", readRW(index2.openRead("data/a.xml")));
+    EXPECT_EQ("compressed compressed compressed compressed",
+        readRW(index2.openRead("data/c.xml")));
+}
+
+TEST(archiveindex, benchmark)
+{
+    Client::Options options;
+    Client client(options);
+    initArchiveTest();
+
+    const int archives = 20;
+    const int filesCount = 100;
+    ArchiveIndex index;
+    std::vector<std::string> paths;
+    for (int f = 0; f < archives; f ++)
+    {
+        ZipFiles files;
+        for (int i = 0; i < filesCount; i ++)
+        {
+            files.push_back(std::make_pair(strprintf("data/%d/file%d.xml",
+                f, i), std::string(1000, static_cast<char>('a' + i % 26))));
+        }
+        const std::string path = strprintf("/tmp/manaplustest/bench%d.zip",
+            f);
+        writeZip(path, files, false);
+        PHYSFS_addToSearchPath(path.c_str(), 0);
+        index.addPath(path, false);
+        paths.push_back(path);
+    }
+
+    // files from oldest archive are worst case for search path walk
+    std::vector<std::string> names;
+    for (int i = 0; i < filesCount; i ++)
+        names.push_back(strprintf("data/0/file%d.xml", i));
+    const int loops = 10;
+    char buf[1000];
+
+    const unsigned int startTime = SDL_GetTicks();
+    for (int k = 0; k < loops; k ++)
+    {
+        FOR_EACH (std::vector<std::string>::const_iterator, it, names)
+        {
+            ASSERT_TRUE(PHYSFS_exists((*it).c_str()));
+            PHYSFS_file *const file = PHYSFS_openRead((*it).c_str());
+            ASSERT_TRUE(file != nullptr);
+            EXPECT_EQ(1, PHYSFS_read(file, buf, sizeof(buf), 1));
+            PHYSFS_close(file);
+        }
+    }
+    const unsigned int physfsTime = SDL_GetTicks();
+    for (int k = 0; k < loops; k ++)
+    {
+        FOR_EACH (std::vector<std::string>::const_iterator, it, names)
+        {
+            ASSERT_TRUE(index.exists(*it));
+            SDL_RWops *const rw = index.openRead(*it);
+            ASSERT_TRUE(rw != nullptr);
+            EXPECT_EQ(1, SDL_RWread(rw, buf, sizeof(buf), 1));
+            SDL_RWclose(rw);
+        }
+    }
+    const unsigned int indexTime = SDL_GetTicks();
+
+    RecordProperty("physfsTime", physfsTime - startTime);
+    RecordProperty("indexTime", indexTime - physfsTime);
+
+    FOR_EACH (std::vector<std::string>::const_iterator, it, paths)
+        PHYSFS_removeFromSearchPath((*it).c_str());
+}
@@ -0,0 +1,117 @@
+/*
+ *  The ManaPlus Client
+ *  Copyright (C) 2013  The ManaPlus Developers
+ *
+ *  This file is part of The ManaPlus Client.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/mappedfile.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "debug.h"
+
+MappedFile::MappedFile() :
+    mData(nullptr),
+    mSize(0),
+    mMapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &fileName)
+{
+    close();
+
+#ifndef WIN32
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) || statbuf.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *const data = mmap(nullptr, statbuf.st_size, PROT_READ,
+        MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data != MAP_FAILED)
+    {
+        mData = data;
+        mSize = static_cast<int>(statbuf.st_size);
+        mMapped = true;
+        return true;
+    }
+#endif
+
+    FILE *const file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0)
+    {
+        mData = malloc(size);
+        if (mData && fread(mData, 1, size, file)
+            == static_cast<size_t>(size))
+        {
+            mSize = static_cast<int>(size);
+        }
+        else
+        {
+            free(mData);
+            mData = nullptr;
+        }
+    }
+    fclose(file);
+    return mData != nullptr;
+}
+
+void MappedFile::close()
+{
+    if (!mData)
+        return;
+
+#ifndef WIN32
+    if (mMapped)
+        munmap(mData, mSize);
+    else
+        free(mData);
+#else
+    free(mData);
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    mMapped = false;
+}
@@ -24,59 +24,426 @@
 
 #include "utils/perfomance.h"
 
-#include "configuration.h"
+#include "utils/dtor.h"
+
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+#include <pthread.h>
 
 #include <algorithm>
-#include <cstdarg>
 #include <cstdio>
-#include <fstream>
-#include <iostream>
+#include <cstring>
+#include <ctime>
+#include <vector>
 
 #include "debug.h"
 
 static const clockid_t clockType = CLOCK_MONOTONIC;
 
-#define timeData ((static_cast<long long int>(time.tv_sec) * 1000000000LL \
-    + static_cast<long long int>(time.tv_nsec)) / 1000)
-
-namespace Perfomance
+namespace
 {
-    std::ofstream file;
-    long long unsigned int startTime;
+    // zone 0 marks frames
+    const int maxZones = 1024;
+    const unsigned int bufferSize = 65536;
+    const int flushDelay = 20;
+
+    enum EventType
+    {
+        EVENT_START = 0,
+        EVENT_END,
+        EVENT_FRAME
+    };
+
+    struct Event final
+    {
+        long long int time;
+        int zone;
+        int type;
+    };
 
-    void init(const std::string &path)
+    struct ZoneStart final
+    {
+        ZoneStart(const int zone0, const long long int time0) :
+            zone(zone0),
+            time(time0)
+        {
+        }
+
+        int zone;
+        long long int time;
+    };
+
+    /**
+     * Ring buffer written only by its thread and read only by flush
+     * thread. Buffer released by finished thread is reused by new thread
+     * after flush thread read all its events.
+     */
+    struct ThreadBuffer final
+    {
+        explicit ThreadBuffer(const int id0) :
+            events(new Event[bufferSize]),
+            stack(),
+            head(0),
+            tail(0),
+            dropped(0),
+            id(id0),
+            released(false)
+        {
+        }
+
+        A_DELETE_COPY(ThreadBuffer)
+
+        ~ThreadBuffer()
+        {
+            delete [] events;
+        }
+
+        Event *events;
+        // open zones, used by flush thread
+        std::vector<ZoneStart> stack;
+        unsigned int head;
+        unsigned int tail;
+        unsigned int dropped;
+        int id;
+        bool released;
+    };
+
+    struct ZoneStats final
+    {
+        long long int frameTime;
+        long long int minTime;
+        long long int maxTime;
+        long long int totalTime;
+        int frameCalls;
+        int calls;
+        int frames;
+    };
+
+    const char *zoneNames[maxZones];
+    ZoneStats zoneStats[maxZones];
+    int zonesCount = 1;
+
+    std::vector<ThreadBuffer*> buffers;
+    // drained buffers of finished threads
+    std::vector<ThreadBuffer*> freeBuffers;
+    int threadsCount = 0;
+    __thread ThreadBuffer *threadBuffer = nullptr;
+    pthread_key_t threadKey;
+    bool threadKeyCreated = false;
+
+    SDL_mutex *mutex = nullptr;
+    SDL_Thread *flushThread = nullptr;
+    FILE *logFile = nullptr;
+    FILE *traceFile = nullptr;
+    long long int startTime = 0;
+    bool running = false;
+    bool firstEvent = true;
+
+    long long int getTime()
     {
-        file.open(path.c_str(), std::ios_base::trunc);
         timespec time;
         clock_gettime(clockType, &time);
-        startTime = timeData;
+        return static_cast<long long int>(time.tv_sec) * 1000000000LL
+            + static_cast<long long int>(time.tv_nsec);
+    }
+
+    bool isRunning()
+    {
+        return __atomic_load_n(&running, __ATOMIC_RELAXED);
+    }
+
+    // called on thread exit
+    void releaseBuffer(void *ptr)
+    {
+        ThreadBuffer *const buffer = static_cast<ThreadBuffer*>(ptr);
+        // events written before must be visible with flag
+        __atomic_store_n(&buffer->released, true, __ATOMIC_RELEASE);
+    }
+
+    ThreadBuffer *getBuffer()
+    {
+        ThreadBuffer *buffer;
+        SDL_mutexP(mutex);
+        if (!freeBuffers.empty())
+        {
+            buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            buffer->stack.clear();
+            buffer->head = 0;
+            buffer->tail = 0;
+            buffer->id = threadsCount;
+            buffer->released = false;
+        }
+        else
+        {
+            buffer = new ThreadBuffer(threadsCount);
+        }
+        threadsCount ++;
+        buffers.push_back(buffer);
+        SDL_mutexV(mutex);
+        pthread_setspecific(threadKey, buffer);
+        return buffer;
+    }
+
+    void addEvent(const int zone, const int type)
+    {
+        if (!isRunning())
+            return;
+
+        ThreadBuffer *buffer = threadBuffer;
+        if (!buffer)
+        {
+            buffer = getBuffer();
+            threadBuffer = buffer;
+        }
+
+        const unsigned int head = buffer->head;
+        if (head - __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE)
+            >= bufferSize)
+        {
+            buffer->dropped ++;
+            return;
+        }
+        Event &event = buffer->events[head % bufferSize];
+        event.time = getTime();
+        event.zone = zone;
+        event.type = type;
+        // event must be visible before new head
+        __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    void endFrame()
+    {
+        for (int f = 1; f < zonesCount; f ++)
+        {
+            ZoneStats &stats = zoneStats[f];
+            if (!stats.frameCalls)
+                continue;
+            if (!stats.frames || stats.frameTime < stats.minTime)
+                stats.minTime = stats.frameTime;
+            if (stats.frameTime > stats.maxTime)
+                stats.maxTime = stats.frameTime;
+            stats.totalTime += stats.frameTime;
+            stats.calls += stats.frameCalls;
+            stats.frames ++;
+            stats.frameTime = 0;
+            stats.frameCalls = 0;
+        }
+    }
+
+    void writeEvent(const ThreadBuffer *const buffer, const Event &event)
+    {
+        if (!traceFile)
+            return;
+        const char *const phase = event.type == EVENT_START ? "B"
+            : event.type == EVENT_END ? "E" : "i";
+        fprintf(traceFile, "%s{\"name\":\"", firstEvent ? "" : ",\n");
+        for (const char *ptr = zoneNames[event.zone]; *ptr; ptr ++)
+        {
+            if (*ptr == '"' || *ptr == '\\')
+                fputc('\\', traceFile);
+            fputc(*ptr, traceFile);
+        }
+        fprintf(traceFile, "\",\"ph\":\"%s\",\"ts\":%lld,\"pid\":1,"
+            "\"tid\":%d%s}", phase, (event.time - startTime) / 1000,
+            buffer->id, event.type == EVENT_FRAME ? ",\"s\":\"g\"" : "");
+        firstEvent = false;
+    }
+
+    void processEvent(ThreadBuffer *const buffer, const Event &event)
+    {
+        writeEvent(buffer, event);
+        std::vector<ZoneStart> &stack = buffer->stack;
+        switch (event.type)
+        {
+            case EVENT_START:
+                stack.push_back(ZoneStart(event.zone, event.time));
+                break;
+            case EVENT_END:
+            {
+                // zones left without end are closed here too
+                size_t pos = stack.size();
+                while (pos > 0 && stack[pos - 1].zone != event.zone)
+                    pos --;
+                if (!pos)
+                    break;
+                ZoneStats &stats = zoneStats[event.zone];
+                stats.frameTime += event.time - stack[pos - 1].time;
+                stats.frameCalls ++;
+                stack.erase(stack.begin() + (pos - 1), stack.end());
+                break;
+            }
+            case EVENT_FRAME:
+            default:
+                endFrame();
+                break;
+        }
+    }
+
+    void flush()
+    {
+        SDL_mutexP(mutex);
+        const std::vector<ThreadBuffer*> list = buffers;
+        SDL_mutexV(mutex);
+
+        std::vector<ThreadBuffer*> drained;
+        FOR_EACH (std::vector<ThreadBuffer*>::const_iterator, it, list)
+        {
+            ThreadBuffer *const buffer = *it;
+            // flag read before head, so all events of finished thread read
+            const bool released = __atomic_load_n(&buffer->released,
+                __ATOMIC_ACQUIRE);
+            const unsigned int head = __atomic_load_n(&buffer->head,
+                __ATOMIC_ACQUIRE);
+            for (unsigned int f = buffer->tail; f != head; f ++)
+                processEvent(buffer, buffer->events[f % bufferSize]);
+            __atomic_store_n(&buffer->tail, head, __ATOMIC_RELEASE);
+            if (released)
+                drained.push_back(buffer);
+        }
+
+        if (drained.empty())
+            return;
+        SDL_mutexP(mutex);
+        FOR_EACH (std::vector<ThreadBuffer*>::const_iterator, it, drained)
+        {
+            buffers.erase(std::find(buffers.begin(), buffers.end(), *it));
+            freeBuffers.push_back(*it);
+        }
+        SDL_mutexV(mutex);
+    }
+
+    int flushThreadFunc(void *ptr A_UNUSED)
+    {
+        while (isRunning())
+        {
+            flush();
+            SDL_Delay(flushDelay);
+        }
+        return 0;
+    }
+
+    void writeStats()
+    {
+        if (!logFile)
+            return;
+
+        fprintf(logFile, "zone: frames, calls, min/avg/max us per frame\n");
+        for (int f = 1; f < zonesCount; f ++)
+        {
+            const ZoneStats &stats = zoneStats[f];
+            if (!stats.frames)
+                continue;
+            fprintf(logFile, "%s: %d, %d, %lld/%lld/%lld\n", zoneNames[f],
+                stats.frames, stats.calls, stats.minTime / 1000,
+                stats.totalTime / stats.frames / 1000, stats.maxTime / 1000);
+        }
+
+        unsigned int dropped = 0;
+        FOR_EACH (std::vector<ThreadBuffer*>::const_iterator, it, buffers)
+            dropped += (*it)->dropped;
+        FOR_EACH (std::vector<ThreadBuffer*>::const_iterator, it, freeBuffers)
+            dropped += (*it)->dropped;
+        fprintf(logFile, "threads: %d, dropped events: %u\n",
+            threadsCount, dropped);
+    }
+}  // namespace
+
+namespace Perfomance
+{
+    void init(const std::string &logName, const std::string &traceName)
+    {
+        if (running)
+            return;
+
+        logFile = fopen(logName.c_str(), "w");
+        traceFile = fopen(traceName.c_str(), "w");
+        if (traceFile)
+            fprintf(traceFile, "[\n");
+        zoneNames[0] = "frame";
+        startTime = getTime();
+        if (!mutex)
+            mutex = SDL_CreateMutex();
+        if (!threadKeyCreated)
+        {
+            pthread_key_create(&threadKey, releaseBuffer);
+            threadKeyCreated = true;
+        }
+        __atomic_store_n(&running, true, __ATOMIC_RELAXED);
+        flushThread = SDL_CreateThread(flushThreadFunc, nullptr);
+        if (!flushThread)
+            __atomic_store_n(&running, false, __ATOMIC_RELAXED);
     }
 
     void clear()
     {
-        if (file.is_open())
-            file.close();
+        if (!running)
+            return;
+
+        __atomic_store_n(&running, false, __ATOMIC_RELAXED);
+        SDL_WaitThread(flushThread, nullptr);
+        flushThread = nullptr;
+        flush();
+        endFrame();
+        writeStats();
+        // buffers of running threads are kept, they can still have them
+        delete_all(freeBuffers);
+        freeBuffers.clear();
+        if (logFile)
+        {
+            fclose(logFile);
+            logFile = nullptr;
+        }
+        if (traceFile)
+        {
+            fprintf(traceFile, "\n]\n");
+            fclose(traceFile);
+            traceFile = nullptr;
+        }
     }
 
     void start()
     {
-        timespec time;
-        clock_gettime(clockType, &time);
-        file << (timeData - startTime) << " __init__" << std::endl;
+        addEvent(0, EVENT_FRAME);
     }
 
-    void blockStart(const std::string &name)
+    int registerZone(const char *const name)
     {
-        timespec time;
-        clock_gettime(clockType, &time);
-        file << (timeData - startTime) << " start: " << name << std::endl;
+        if (!mutex)
+            mutex = SDL_CreateMutex();
+
+        SDL_mutexP(mutex);
+        int zone = 1;
+        while (zone < zonesCount && strcmp(zoneNames[zone], name))
+            zone ++;
+        if (zone == zonesCount)
+        {
+            if (zonesCount < maxZones)
+            {
+                zoneNames[zone] = name;
+                memset(&zoneStats[zone], 0, sizeof(ZoneStats));
+                zonesCount ++;
+            }
+            else
+            {
+                zone = 0;
+            }
+        }
+        SDL_mutexV(mutex);
+        return zone;
     }
 
-    void blockEnd(const std::string &name)
+    void blockStart(const int zone)
     {
-        timespec time;
-        clock_gettime(clockType, &time);
-        file << (timeData - startTime) << " end: " << name << std::endl;
+        if (zone)
+            addEvent(zone, EVENT_START);
+    }
+
+    void blockEnd(const int zone)
+    {
+        if (zone)
+            addEvent(zone, EVENT_END);
     }
 }  // namespace Perfomance
 
@@ -23,45 +23,67 @@
 
 #ifdef USE_PROFILER
 #include <string>
-#include <sstream>
-#include <list>
-#include <set>
-#include <vector>
 
 #include "localconsts.h"
 
 #define PROFILER_START() Perfomance::start();
-#define BLOCK_START(name) Perfomance::blockStart(name);
-#define BLOCK_END(name) Perfomance::blockEnd(name);
-#define FUNC_BLOCK(name, id) Perfomance::Func PerfomanceFunc##id(name);
+// zone id is looked up once per call site
+#define BLOCK_START(name) \
+    { \
+        static const int perfomanceZone = Perfomance::registerZone(name); \
+        Perfomance::blockStart(perfomanceZone); \
+    }
+#define BLOCK_END(name) \
+    { \
+        static const int perfomanceZone = Perfomance::registerZone(name); \
+        Perfomance::blockEnd(perfomanceZone); \
+    }
+#define FUNC_BLOCK(name, id) \
+    static const int PerfomanceZone##id = Perfomance::registerZone(name); \
+    Perfomance::Func PerfomanceFunc##id(PerfomanceZone##id);
 
+/**
+ * Instrumenting profiler. Threads write zone events to own ring buffers
+ * without locks, background thread reads them, writes trace in Chrome
+ * trace event format and collects time per zone for each frame.
+ */
 namespace Perfomance
 {
+    /**
+     * Marks start of new frame.
+     */
     void start();
 
-    void init(const std::string &path);
+    void init(const std::string &logName, const std::string &traceName);
 
+    /**
+     * Stops profiler and writes zone statistics to log.
+     */
     void clear();
 
-    void blockStart(const std::string &name);
+    int registerZone(const char *const name) A_WARN_UNUSED;
+
+    void blockStart(const int zone);
 
-    void blockEnd(const std::string &name);
+    void blockEnd(const int zone);
 
-    class Func
+    class Func final
     {
         public:
-            explicit Func(const std::string &str) :
-                name(str)
+            explicit Func(const int zone0) :
+                zone(zone0)
             {
-                blockStart(str);
+                blockStart(zone);
             }
 
+            A_DELETE_COPY(Func)
+
             ~Func()
             {
-                blockEnd(name);
+                blockEnd(zone);
             }
 
-            std::string name;
+            int zone;
     };
 }  // namespace Perfomance
 
@@ -24,6 +24,8 @@
 
 #include "utils/physfsrwops.h"
 
+#include "utils/archiveindex.h"
+
 #include <stdio.h>  /* used for SEEK_SET, SEEK_CUR, SEEK_END ... */
 
 #include "debug.h"
@@ -193,6 +195,12 @@ SDL_RWops *PHYSFSRWOPS_openRead(const char *const fname)
     if (!checkFilePath(fname))
         return nullptr;
 #endif
+    if (fname)
+    {
+        SDL_RWops *const rw = archiveIndex.openRead(fname);
+        if (rw)
+            return rw;
+    }
     return create_rwops(PhysFs::openRead(fname));
 } /* PHYSFSRWOPS_openRead */
 
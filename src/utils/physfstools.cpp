@@ -22,6 +22,8 @@
 
 #include "logger.h"
 
+#include "utils/archiveindex.h"
+
 const char *dirSeparator = nullptr;
 
 namespace PhysFs
@@ -48,7 +50,7 @@ namespace PhysFs
 
     bool exists(const char *const fname)
     {
-        return PHYSFS_exists(fname);
+        return archiveIndex.exists(fname) || PHYSFS_exists(fname);
     }
 
     char **enumerateFiles(const char *const dir)
@@ -88,16 +90,25 @@ namespace PhysFs
 
     bool addToSearchPath(const char *const newDir, const int appendToPath)
     {
-        return PHYSFS_addToSearchPath(newDir, appendToPath);
+        if (!PHYSFS_addToSearchPath(newDir, appendToPath))
+            return false;
+        archiveIndex.addPath(newDir, appendToPath != 0);
+        return true;
     }
 
     bool removeFromSearchPath(const char *const oldDir)
     {
-        return PHYSFS_removeFromSearchPath(oldDir);
+        if (!PHYSFS_removeFromSearchPath(oldDir))
+            return false;
+        archiveIndex.removePath(oldDir);
+        return true;
     }
 
     const char *getRealDir(const char *const filename)
     {
+        const char *const dir = archiveIndex.getRealDir(filename);
+        if (dir)
+            return dir;
         return PHYSFS_getRealDir(filename);
     }
 
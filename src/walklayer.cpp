@@ -26,6 +26,7 @@ WalkLayer::WalkLayer(const int width, const int height) :
     Resource(),
     mWidth(width),
     mHeight(height),
+    mComponents(0),
     mTiles(new int[width * height])
 {
     std::fill_n(mTiles, width * height, 0);
@@ -39,9 +39,19 @@ class WalkLayer final : public Resource
 
         int getDataAt(const int x, const int y) const;
 
+        /**
+         * Returns number for new component of walkable tiles.
+         */
+        int addComponent()
+        { return ++ mComponents; }
+
+        void setComponents(const int n)
+        { mComponents = n; }
+
     private:
         int mWidth;
         int mHeight;
+        int mComponents;
         int *mTiles;
 };
 